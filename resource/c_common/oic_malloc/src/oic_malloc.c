@@ -23,6 +23,7 @@
 //-----------------------------------------------------------------------------
 #include <stdlib.h>
 #include "oic_malloc.h"
+#include "oic_metrics.h"
 
 // Enable extra debug logging for malloc.  Comment out to disable
 #ifdef ENABLE_MALLOC_DEBUG
@@ -73,7 +74,12 @@ void *OICMalloc(size_t size)
     OIC_LOG_V(INFO, TAG, "malloc: ptr=%p, size=%u, count=%u", ptr, size, count);
     return ptr;
 #else
-    return malloc(size);
+    void *ptr = malloc(size);
+    if (ptr)
+    {
+        OIC_METRIC_INC(OIC_METRIC_ALLOCATIONS);
+    }
+    return ptr;
 #endif
 }
 
@@ -93,7 +99,12 @@ void *OICCalloc(size_t num, size_t size)
     OIC_LOG_V(INFO, TAG, "calloc: ptr=%p, num=%u, size=%u, count=%u", ptr, num, size, count);
     return ptr;
 #else
-    return calloc(num, size);
+    void *ptr = calloc(num, size);
+    if (ptr)
+    {
+        OIC_METRIC_INC(OIC_METRIC_ALLOCATIONS);
+    }
+    return ptr;
 #endif
 }
 
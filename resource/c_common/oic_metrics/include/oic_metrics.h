@@ -0,0 +1,189 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Stack wide counters, gauges and histograms.
+ *
+ * The stack updates the metrics through the OIC_METRIC_* macros, which compile to
+ * nothing unless the stack is built with WITH_METRICS. Updates are lock free so they
+ * can be made from the CA send/receive threads as well as from the thread running
+ * OCProcess().
+ */
+
+#ifndef OIC_METRICS_H_
+#define OIC_METRICS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/** Number of buckets of each histogram. */
+#define OIC_HISTOGRAM_BUCKETS (20)
+
+/**
+ * Counters and gauges kept by the stack.
+ * Gauges (marked as such) go up and down, all other metrics only ever increase.
+ */
+typedef enum
+{
+    /** Requests delivered to the resource layer. */
+    OIC_METRIC_REQUESTS_RECEIVED = 0,
+    /** Requests answered with an error before or by the resource layer. */
+    OIC_METRIC_REQUESTS_REJECTED,
+    /** Requests handed to CA by OCDoResource and friends. */
+    OIC_METRIC_REQUESTS_SENT,
+    /** Responses delivered to the resource layer. */
+    OIC_METRIC_RESPONSES_RECEIVED,
+    /** Responses handed to CA by the server. */
+    OIC_METRIC_RESPONSES_SENT,
+    /** Registered observers (gauge). */
+    OIC_METRIC_OBSERVERS,
+    /** Notifications sent to observers. */
+    OIC_METRIC_NOTIFICATIONS_SENT,
+    /** CoAP messages written to an adapter. */
+    OIC_METRIC_MESSAGES_SENT,
+    /** CoAP messages read from an adapter. */
+    OIC_METRIC_MESSAGES_RECEIVED,
+    /** Messages waiting in the CA send queue (gauge). */
+    OIC_METRIC_SEND_QUEUE_DEPTH,
+    /** Messages waiting in the CA receive queue (gauge). */
+    OIC_METRIC_RECEIVE_QUEUE_DEPTH,
+    /** Confirmable messages sent again. */
+    OIC_METRIC_RETRANSMISSIONS,
+    /** Confirmable messages given up on after the last retransmission. */
+    OIC_METRIC_RETRANSMISSION_TIMEOUTS,
+    /** Confirmable messages awaiting an acknowledgement (gauge). */
+    OIC_METRIC_RETRANSMISSIONS_PENDING,
+    /** Established DTLS sessions (gauge). */
+    OIC_METRIC_DTLS_SESSIONS,
+    /** Successful OICMalloc and OICCalloc calls. */
+    OIC_METRIC_ALLOCATIONS,
+    /** Number of metrics, not a metric. */
+    OIC_METRIC_COUNT
+} OICMetricId;
+
+/**
+ * Histograms kept by the stack.
+ * Bucket 0 counts values of 0, bucket n counts values in [2^(n-1), 2^n) and the
+ * last bucket also counts every value above its range.
+ */
+typedef enum
+{
+    /** Time spent handling a request in the resource layer, in microseconds. */
+    OIC_HISTOGRAM_REQUEST_HANDLING_US = 0,
+    /** Size of received request payloads, in bytes. */
+    OIC_HISTOGRAM_REQUEST_PAYLOAD_SIZE,
+    /** Size of CoAP messages written to an adapter, in bytes. */
+    OIC_HISTOGRAM_MESSAGE_SIZE,
+    /** Number of histograms, not a histogram. */
+    OIC_HISTOGRAM_COUNT
+} OICHistogramId;
+
+/**
+ * Adds to a metric.
+ *
+ * @param id      Metric to update.
+ * @param delta   Value to add, negative values decrease gauges.
+ */
+void OICMetricAdd(OICMetricId id, int32_t delta);
+
+/**
+ * Sets a gauge.
+ *
+ * @param id      Metric to update.
+ * @param value   New value of the metric.
+ */
+void OICMetricSet(OICMetricId id, uint32_t value);
+
+/**
+ * Reads a metric.
+ *
+ * @param id      Metric to read.
+ *
+ * @return current value of the metric, 0 for an unknown metric.
+ */
+uint32_t OICMetricGet(OICMetricId id);
+
+/**
+ * Returns the name the metric is published under.
+ *
+ * @param id      Metric to name.
+ *
+ * @return name of the metric, NULL for an unknown metric.
+ */
+const char *OICMetricName(OICMetricId id);
+
+/**
+ * Records a sample in a histogram.
+ *
+ * @param id      Histogram to update.
+ * @param value   Sample to record.
+ */
+void OICHistogramRecord(OICHistogramId id, uint64_t value);
+
+/**
+ * Copies the buckets of a histogram.
+ *
+ * @param id         Histogram to read.
+ * @param buckets    Array of ::OIC_HISTOGRAM_BUCKETS counts to fill.
+ *
+ * @return true if the histogram exists, false otherwise.
+ */
+bool OICHistogramGet(OICHistogramId id, uint32_t buckets[OIC_HISTOGRAM_BUCKETS]);
+
+/**
+ * Returns the name the histogram is published under.
+ *
+ * @param id      Histogram to name.
+ *
+ * @return name of the histogram, NULL for an unknown histogram.
+ */
+const char *OICHistogramName(OICHistogramId id);
+
+/**
+ * Clears every metric and histogram.
+ */
+void OICMetricsReset();
+
+#ifdef WITH_METRICS
+#define OIC_METRIC_ADD(id, delta) OICMetricAdd((id), (delta))
+#define OIC_METRIC_INC(id) OICMetricAdd((id), 1)
+#define OIC_METRIC_DEC(id) OICMetricAdd((id), -1)
+#define OIC_METRIC_SET(id, value) OICMetricSet((id), (value))
+#define OIC_HISTOGRAM_RECORD(id, value) OICHistogramRecord((id), (value))
+#else
+#define OIC_METRIC_ADD(id, delta)
+#define OIC_METRIC_INC(id)
+#define OIC_METRIC_DEC(id)
+#define OIC_METRIC_SET(id, value)
+#define OIC_HISTOGRAM_RECORD(id, value)
+#endif // WITH_METRICS
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_METRICS_H_
@@ -0,0 +1,161 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "oic_metrics.h"
+
+#include <stddef.h>
+#include "platform_features.h"
+
+// Relaxed ordering is enough, the metrics are independent of each other and readers
+// only need to see every update eventually.
+#ifdef __GNUC__
+#define METRIC_ADD(ptr, delta) __atomic_fetch_add((ptr), (delta), __ATOMIC_RELAXED)
+#define METRIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define METRIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#else
+#define METRIC_ADD(ptr, delta) (*(ptr) += (delta))
+#define METRIC_STORE(ptr, value) (*(ptr) = (value))
+#define METRIC_LOAD(ptr) (*(ptr))
+#endif
+
+static uint32_t g_metrics[OIC_METRIC_COUNT];
+
+static uint32_t g_histograms[OIC_HISTOGRAM_COUNT][OIC_HISTOGRAM_BUCKETS];
+
+static const char * const g_metricNames[] =
+{
+    "requestsReceived",
+    "requestsRejected",
+    "requestsSent",
+    "responsesReceived",
+    "responsesSent",
+    "observers",
+    "notificationsSent",
+    "messagesSent",
+    "messagesReceived",
+    "sendQueueDepth",
+    "receiveQueueDepth",
+    "retransmissions",
+    "retransmissionTimeouts",
+    "retransmissionsPending",
+    "dtlsSessions",
+    "allocations"
+};
+
+static const char * const g_histogramNames[] =
+{
+    "requestHandlingUs",
+    "requestPayloadSize",
+    "messageSize"
+};
+
+void OICMetricAdd(OICMetricId id, int32_t delta)
+{
+    OC_STATIC_ASSERT(sizeof(g_metricNames) / sizeof(g_metricNames[0]) == OIC_METRIC_COUNT,
+                     "Every metric needs a name");
+    if ((unsigned)id < OIC_METRIC_COUNT)
+    {
+        // Two's complement wrap around turns negative deltas into decrements
+        METRIC_ADD(&g_metrics[id], (uint32_t)delta);
+    }
+}
+
+void OICMetricSet(OICMetricId id, uint32_t value)
+{
+    if ((unsigned)id < OIC_METRIC_COUNT)
+    {
+        METRIC_STORE(&g_metrics[id], value);
+    }
+}
+
+uint32_t OICMetricGet(OICMetricId id)
+{
+    if ((unsigned)id < OIC_METRIC_COUNT)
+    {
+        return METRIC_LOAD(&g_metrics[id]);
+    }
+    return 0;
+}
+
+const char *OICMetricName(OICMetricId id)
+{
+    if ((unsigned)id < OIC_METRIC_COUNT)
+    {
+        return g_metricNames[id];
+    }
+    return NULL;
+}
+
+void OICHistogramRecord(OICHistogramId id, uint64_t value)
+{
+    OC_STATIC_ASSERT(sizeof(g_histogramNames) / sizeof(g_histogramNames[0]) ==
+                     OIC_HISTOGRAM_COUNT, "Every histogram needs a name");
+    if ((unsigned)id >= OIC_HISTOGRAM_COUNT)
+    {
+        return;
+    }
+
+    // Bucket index is the number of significant bits of the value
+    size_t bucket = 0;
+    while (value && bucket < OIC_HISTOGRAM_BUCKETS - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+    METRIC_ADD(&g_histograms[id][bucket], 1);
+}
+
+bool OICHistogramGet(OICHistogramId id, uint32_t buckets[OIC_HISTOGRAM_BUCKETS])
+{
+    if ((unsigned)id >= OIC_HISTOGRAM_COUNT || !buckets)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < OIC_HISTOGRAM_BUCKETS; i++)
+    {
+        buckets[i] = METRIC_LOAD(&g_histograms[id][i]);
+    }
+    return true;
+}
+
+const char *OICHistogramName(OICHistogramId id)
+{
+    if ((unsigned)id < OIC_HISTOGRAM_COUNT)
+    {
+        return g_histogramNames[id];
+    }
+    return NULL;
+}
+
+void OICMetricsReset()
+{
+    for (size_t i = 0; i < OIC_METRIC_COUNT; i++)
+    {
+        METRIC_STORE(&g_metrics[i], 0);
+    }
+    for (size_t i = 0; i < OIC_HISTOGRAM_COUNT; i++)
+    {
+        for (size_t j = 0; j < OIC_HISTOGRAM_BUCKETS; j++)
+        {
+            METRIC_STORE(&g_histograms[i][j], 0);
+        }
+    }
+}
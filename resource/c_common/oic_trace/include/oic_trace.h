@@ -0,0 +1,157 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Per message latency tracing.
+ *
+ * The connectivity layer and the stack timestamp a message at fixed trace points through
+ * the OIC_TRACE macro, which compiles to nothing unless the stack is built with
+ * WITH_TRACING. Events are keyed by a hash of the CoAP token, so a request and its
+ * response share a key, and are kept in a lock free ring buffer holding the last
+ * ::OIC_TRACE_BUFFER_SIZE events.
+ */
+
+#ifndef OIC_TRACE_H_
+#define OIC_TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/** Number of events kept by the ring buffer, must be a power of two. */
+#ifndef OIC_TRACE_BUFFER_SIZE
+#define OIC_TRACE_BUFFER_SIZE (4096)
+#endif
+
+/**
+ * Points a message is timestamped at, in the order a request normally goes through them.
+ */
+typedef enum
+{
+    /** CA parsed a message read from an adapter. */
+    OIC_TRACE_ADAPTER_RECEIVE = 0,
+    /** The message left the CA receive queue. */
+    OIC_TRACE_RECEIVE_DEQUEUE,
+    /** The stack started handling a request. */
+    OIC_TRACE_HANDLE_REQUEST,
+    /** The entity handler was called. */
+    OIC_TRACE_ENTITY_HANDLER_ENTER,
+    /** The entity handler returned. */
+    OIC_TRACE_ENTITY_HANDLER_EXIT,
+    /** OCDoResponse was called. */
+    OIC_TRACE_DO_RESPONSE,
+    /** Encoding of the response payload started. */
+    OIC_TRACE_ENCODE_BEGIN,
+    /** Encoding of the response payload ended. */
+    OIC_TRACE_ENCODE_END,
+    /** The message left the CA send queue. */
+    OIC_TRACE_SEND_DEQUEUE,
+    /** CA wrote the message to an adapter. */
+    OIC_TRACE_ADAPTER_SEND,
+    /** Number of trace points, not a trace point. */
+    OIC_TRACE_POINT_COUNT
+} OICTracePoint;
+
+/** A timestamped trace point. */
+typedef struct
+{
+    /** Time of the event in microseconds, see OICGetCurrentTime(). */
+    uint64_t timestamp;
+    /** Hash of the token of the message, see OICTraceKey(). */
+    uint32_t key;
+    /** Trace point reached. */
+    OICTracePoint point;
+} OICTraceEvent;
+
+/**
+ * Computes the key events of a message are recorded under.
+ *
+ * @param token         Token of the message.
+ * @param tokenLength   Length of the token.
+ *
+ * @return the key, 0 for an empty token.
+ */
+uint32_t OICTraceKey(const void *token, uint8_t tokenLength);
+
+/**
+ * Records an event in the ring buffer, overwriting the oldest one when it is full.
+ *
+ * @param point   Trace point reached.
+ * @param key     Key of the message, see OICTraceKey().
+ */
+void OICTraceRecord(OICTracePoint point, uint32_t key);
+
+/**
+ * Copies the events held by the ring buffer, oldest first. Events overwritten while
+ * they are copied are skipped.
+ *
+ * @param events      Array receiving the events.
+ * @param maxEvents   Capacity of the array.
+ *
+ * @return number of events copied.
+ */
+size_t OICTraceGetEvents(OICTraceEvent *events, size_t maxEvents);
+
+/**
+ * Returns the name of a trace point.
+ *
+ * @param point   Trace point to name.
+ *
+ * @return name of the trace point, NULL for an unknown point.
+ */
+const char *OICTracePointName(OICTracePoint point);
+
+/**
+ * Discards every recorded event.
+ */
+void OICTraceReset();
+
+#ifndef WITH_ARDUINO
+/**
+ * Writes the events held by the ring buffer to a file in the Chrome trace event format,
+ * which chrome://tracing and Perfetto load. Every event is an instant event in the
+ * "ca" or "ri" thread of the process, with the message key as argument.
+ *
+ * @param path   File to write, replaced if it exists.
+ *
+ * @return true on success, false if the file could not be written.
+ */
+bool OICTraceDumpChromeJson(const char *path);
+#endif
+
+#ifdef WITH_TRACING
+#define OIC_TRACE(point, token, tokenLength) \
+    OICTraceRecord((point), OICTraceKey((token), (tokenLength)))
+#else
+#define OIC_TRACE(point, token, tokenLength)
+#endif // WITH_TRACING
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_TRACE_H_
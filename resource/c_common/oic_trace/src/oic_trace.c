@@ -0,0 +1,235 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "oic_trace.h"
+
+#ifndef WITH_ARDUINO
+#include <stdio.h>
+#include <inttypes.h>
+#endif
+#include "oic_malloc.h"
+#include "oic_time.h"
+#include "platform_features.h"
+
+// Each slot is guarded by its sequence number like a seqlock: a writer clears it,
+// fills the slot and publishes the number of the event, a reader keeps the slot only
+// if the number is the expected one before and after copying it.
+#ifdef __GNUC__
+#define TRACE_FETCH_ADD(ptr, delta) __atomic_fetch_add((ptr), (delta), __ATOMIC_RELAXED)
+#define TRACE_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define TRACE_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define TRACE_PUBLISH(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define TRACE_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define TRACE_RELEASE_FENCE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define TRACE_ACQUIRE_FENCE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#else
+#define TRACE_FETCH_ADD(ptr, delta) ((*(ptr) += (delta)) - (delta))
+#define TRACE_STORE(ptr, value) (*(ptr) = (value))
+#define TRACE_LOAD(ptr) (*(ptr))
+#define TRACE_PUBLISH(ptr, value) (*(ptr) = (value))
+#define TRACE_ACQUIRE(ptr) (*(ptr))
+#define TRACE_RELEASE_FENCE()
+#define TRACE_ACQUIRE_FENCE()
+#endif
+
+#define TRACE_BUFFER_MASK (OIC_TRACE_BUFFER_SIZE - 1)
+
+typedef struct
+{
+    uint64_t timestamp;
+    uint32_t key;
+    uint32_t point;
+    /** Number of the event held plus one, 0 while the slot is written. */
+    uint32_t sequence;
+} TraceSlot;
+
+static TraceSlot g_traceBuffer[OIC_TRACE_BUFFER_SIZE];
+
+/** Number of events recorded since the last reset. */
+static uint32_t g_traceCount = 0;
+
+static const char * const g_tracePointNames[] =
+{
+    "adapterReceive",
+    "receiveDequeue",
+    "handleRequest",
+    "entityHandlerEnter",
+    "entityHandlerExit",
+    "doResponse",
+    "encodeBegin",
+    "encodeEnd",
+    "sendDequeue",
+    "adapterSend"
+};
+
+uint32_t OICTraceKey(const void *token, uint8_t tokenLength)
+{
+    if (!token || !tokenLength)
+    {
+        return 0;
+    }
+
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)token;
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < tokenLength; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void OICTraceRecord(OICTracePoint point, uint32_t key)
+{
+    OC_STATIC_ASSERT(0 == (OIC_TRACE_BUFFER_SIZE & TRACE_BUFFER_MASK),
+                     "OIC_TRACE_BUFFER_SIZE must be a power of two");
+    OC_STATIC_ASSERT(sizeof(g_tracePointNames) / sizeof(g_tracePointNames[0]) ==
+                     OIC_TRACE_POINT_COUNT, "Every trace point needs a name");
+
+    uint64_t timestamp = OICGetCurrentTime(TIME_IN_US);
+    uint32_t number = TRACE_FETCH_ADD(&g_traceCount, 1);
+    TraceSlot *slot = &g_traceBuffer[number & TRACE_BUFFER_MASK];
+
+    TRACE_STORE(&slot->sequence, 0);
+    TRACE_RELEASE_FENCE();
+    TRACE_STORE(&slot->timestamp, timestamp);
+    TRACE_STORE(&slot->key, key);
+    TRACE_STORE(&slot->point, (uint32_t)point);
+    TRACE_PUBLISH(&slot->sequence, number + 1);
+}
+
+size_t OICTraceGetEvents(OICTraceEvent *events, size_t maxEvents)
+{
+    if (!events || !maxEvents)
+    {
+        return 0;
+    }
+
+    uint32_t end = TRACE_ACQUIRE(&g_traceCount);
+    uint32_t begin = (end > OIC_TRACE_BUFFER_SIZE) ? end - OIC_TRACE_BUFFER_SIZE : 0;
+    if (end - begin > maxEvents)
+    {
+        begin = end - (uint32_t)maxEvents;
+    }
+
+    size_t count = 0;
+    for (uint32_t number = begin; number != end; number++)
+    {
+        TraceSlot *slot = &g_traceBuffer[number & TRACE_BUFFER_MASK];
+        uint32_t sequence = TRACE_ACQUIRE(&slot->sequence);
+        if (sequence != number + 1)
+        {
+            continue;
+        }
+
+        OICTraceEvent *event = &events[count];
+        event->timestamp = TRACE_LOAD(&slot->timestamp);
+        event->key = TRACE_LOAD(&slot->key);
+        event->point = (OICTracePoint)TRACE_LOAD(&slot->point);
+
+        TRACE_ACQUIRE_FENCE();
+        if (TRACE_LOAD(&slot->sequence) == sequence)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+const char *OICTracePointName(OICTracePoint point)
+{
+    if ((unsigned)point < OIC_TRACE_POINT_COUNT)
+    {
+        return g_tracePointNames[point];
+    }
+    return NULL;
+}
+
+void OICTraceReset()
+{
+    for (size_t i = 0; i < OIC_TRACE_BUFFER_SIZE; i++)
+    {
+        TRACE_STORE(&g_traceBuffer[i].sequence, 0);
+    }
+    TRACE_STORE(&g_traceCount, 0);
+}
+
+#ifndef WITH_ARDUINO
+/** Chrome trace thread the events of a trace point are shown in, 1 for CA and 2 for RI. */
+static int TracePointThread(OICTracePoint point)
+{
+    switch (point)
+    {
+        case OIC_TRACE_ADAPTER_RECEIVE:
+        case OIC_TRACE_RECEIVE_DEQUEUE:
+        case OIC_TRACE_SEND_DEQUEUE:
+        case OIC_TRACE_ADAPTER_SEND:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+bool OICTraceDumpChromeJson(const char *path)
+{
+    if (!path)
+    {
+        return false;
+    }
+
+    OICTraceEvent *events = (OICTraceEvent *)OICMalloc(OIC_TRACE_BUFFER_SIZE *
+                                                        sizeof(OICTraceEvent));
+    if (!events)
+    {
+        return false;
+    }
+    size_t count = OICTraceGetEvents(events, OIC_TRACE_BUFFER_SIZE);
+
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        OICFree(events);
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n"
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+            "\"args\":{\"name\":\"ca\"}},\n"
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+            "\"args\":{\"name\":\"ri\"}}");
+    for (size_t i = 0; i < count; i++)
+    {
+        fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"oic\",\"ph\":\"i\",\"s\":\"t\","
+                "\"ts\":%" PRIu64 ",\"pid\":1,\"tid\":%d,\"args\":{\"key\":\"0x%08" PRIx32 "\"}}",
+                OICTracePointName(events[i].point), events[i].timestamp,
+                TracePointThread(events[i].point), events[i].key);
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    bool result = !ferror(file);
+    if (0 != fclose(file))
+    {
+        result = false;
+    }
+    OICFree(events);
+    return result;
+}
+#endif
@@ -41,4 +41,14 @@
     #define OC_STATIC_ASSERT(condition, msg) ((void)sizeof(char[2*!!(condition) - 1]))
 #endif
 
+/** Storage class of variables with one instance per thread.*/
+#if defined(_MSC_VER)
+    #define OC_THREAD_LOCAL __declspec(thread)
+#elif defined(WITH_ARDUINO)
+    // Single threaded
+    #define OC_THREAD_LOCAL
+#else
+    #define OC_THREAD_LOCAL __thread
+#endif
+
 #endif
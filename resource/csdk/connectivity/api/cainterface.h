@@ -187,6 +187,19 @@ void CADestroyToken(CAToken_t token);
  */
 CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requestInfo);
 
+/**
+ * Send several control Requests at once. They are handed to the send thread together.
+ * @param[in]   objects       Endpoints where the requests need to be sent, objects[i] is
+ *                            the endpoint of requestInfos[i].
+ * @param[in]   requestInfos  Information for the requests.
+ * @param[in]   count         Number of requests.
+ * @param[out]  results       Result of each request, as returned by ::CASendRequest.
+ * @return ::CA_STATUS_OK if every request was queued, otherwise the result of the first
+ *         request that was not.
+ */
+CAResult_t CASendRequests(const CAEndpoint_t *objects, const CARequestInfo_t *requestInfos,
+                          uint32_t count, CAResult_t *results);
+
 /**
  * Send the response.
  * @param[in]   object           Endpoint where the payload need to be sent.
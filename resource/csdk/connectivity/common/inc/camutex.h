@@ -55,6 +55,15 @@ typedef enum
  */
 ca_mutex ca_mutex_new(void);
 
+/**
+ * Creates new mutex which the thread holding it can lock again. It stays locked until it
+ * is unlocked as many times as it was locked.
+ *
+ * @return  Reference to newly created mutex, otherwise NULL.
+ *
+ */
+ca_mutex ca_mutex_new_recursive(void);
+
 /**
  * Lock the mutex.
  *
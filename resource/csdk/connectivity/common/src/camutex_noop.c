@@ -60,6 +60,11 @@ ca_mutex ca_mutex_new(void)
     return &g_mutexInfo;
 }
 
+ca_mutex ca_mutex_new_recursive(void)
+{
+    return &g_mutexInfo;
+}
+
 bool ca_mutex_free(ca_mutex mutex)
 {
     return true;
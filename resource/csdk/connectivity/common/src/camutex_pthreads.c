@@ -107,6 +107,38 @@ ca_mutex ca_mutex_new(void)
     return retVal;
 }
 
+ca_mutex ca_mutex_new_recursive(void)
+{
+    ca_mutex retVal = NULL;
+    ca_mutex_internal *mutexInfo = (ca_mutex_internal*) OICMalloc(sizeof(ca_mutex_internal));
+    if (NULL != mutexInfo)
+    {
+        pthread_mutexattr_t attr;
+        int ret = pthread_mutexattr_init(&attr);
+        if (0 == ret)
+        {
+            ret = pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+            if (0 == ret)
+            {
+                ret = pthread_mutex_init(&(mutexInfo->mutex), &attr);
+            }
+            pthread_mutexattr_destroy(&attr);
+        }
+
+        if (0 == ret)
+        {
+            retVal = (ca_mutex) mutexInfo;
+        }
+        else
+        {
+            OIC_LOG_V(ERROR, TAG, "%s Failed to initialize mutex !", __func__);
+            OICFree(mutexInfo);
+        }
+    }
+
+    return retVal;
+}
+
 bool ca_mutex_free(ca_mutex mutex)
 {
     bool bRet=false;
@@ -71,6 +71,19 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint,
                                const void *sendMsg,
                                CADataType_t dataType);
 
+/**
+ * Detaches control from the caller for sending several requests, which are handed to
+ * the send thread together.
+ * @param[in]  endpoints       endpoints where the requests have to be sent.
+ * @param[in]  requestInfos    requests that need to be sent.
+ * @param[in]  count           number of requests.
+ * @param[out] results         result of each request, may be NULL.
+ * @return  ::CA_STATUS_OK or the error of the first request that failed.
+ */
+CAResult_t CADetachSendRequests(const CAEndpoint_t *endpoints,
+                                const CARequestInfo_t *requestInfos,
+                                uint32_t count, CAResult_t *results);
+
 /**
  * Setting the request and response callbacks for network packets.
  * @param[in] ReqHandler      callback for receiving the requests.
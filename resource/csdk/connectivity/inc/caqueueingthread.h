@@ -33,6 +33,7 @@
 #include "camutex.h"
 #include "uqueue.h"
 #include "cacommon.h"
+#include "oic_metrics.h"
 #ifdef __cplusplus
 extern "C"
 {
@@ -60,6 +61,8 @@ typedef struct
     bool isStop;
     /** Que on which the thread is operating. **/
     u_queue_t *dataQueue;
+    /** Gauge tracking the queue depth, OIC_METRIC_COUNT for none. **/
+    OICMetricId depthMetric;
 } CAQueueingThread_t;
 
 /**
@@ -89,6 +92,18 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Add several data for the queuing thread at once, waking it up once.
+ * @param[in]   thread       thread data for new thread control.
+ * @param[in]   dataList     data that needs to be given for each thread.
+ * @param[in]   count        number of data in dataList.
+ * @param[in]   size         length of each data.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ *          On error none of the data was added.
+ */
+CAResult_t CAQueueingThreadAddDataList(CAQueueingThread_t *thread, void **dataList,
+                                       uint32_t count, uint32_t size);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
@@ -22,6 +22,7 @@
 #include "caipinterface.h"
 #include "dtls.h"
 #include "oic_malloc.h"
+#include "oic_metrics.h"
 #include "oic_string.h"
 #include "global.h"
 #include "timer.h"
@@ -161,6 +162,7 @@ static CAResult_t CAAddIdToPeerInfoList(const char *peerAddr, uint32_t port,
         OICFree(peer);
         return CA_STATUS_FAILED;
     }
+    OIC_METRIC_SET(OIC_METRIC_DTLS_SESSIONS, u_arraylist_length(g_caDtlsContext->peerInfoList));
 
     return CA_STATUS_OK;
 }
@@ -176,6 +178,7 @@ static void CAFreePeerInfoList()
     }
     u_arraylist_free(&(g_caDtlsContext->peerInfoList));
     g_caDtlsContext->peerInfoList = NULL;
+    OIC_METRIC_SET(OIC_METRIC_DTLS_SESSIONS, 0);
 }
 
 static void CARemovePeerFromPeerInfoList(const char * addr, uint16_t port)
@@ -199,6 +202,8 @@ static void CARemovePeerFromPeerInfoList(const char * addr, uint16_t port)
                 (port == peerInfo->port))
         {
             OICFree(u_arraylist_remove(g_caDtlsContext->peerInfoList, list_index));
+            OIC_METRIC_SET(OIC_METRIC_DTLS_SESSIONS,
+                           u_arraylist_length(g_caDtlsContext->peerInfoList));
             return;
         }
     }
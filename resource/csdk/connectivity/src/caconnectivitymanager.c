@@ -271,6 +271,23 @@ CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requ
     return CADetachSendMessage(object, requestInfo, CA_REQUEST_DATA);
 }
 
+CAResult_t CASendRequests(const CAEndpoint_t *objects, const CARequestInfo_t *requestInfos,
+                          uint32_t count, CAResult_t *results)
+{
+    OIC_LOG_V(DEBUG, TAG, "CASendRequests %u", count);
+
+    if(!g_isInitialized)
+    {
+        for (uint32_t i = 0; results && i < count; i++)
+        {
+            results[i] = CA_STATUS_NOT_INITIALIZED;
+        }
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CADetachSendRequests(objects, requestInfos, count, results);
+}
+
 CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo)
 {
     OIC_LOG(DEBUG, TAG, "CASendResponse");
@@ -30,6 +30,8 @@
 #include "logger.h"
 #include "config.h" /* for coap protocol */
 #include "oic_malloc.h"
+#include "oic_metrics.h"
+#include "oic_trace.h"
 #include "canetworkconfigurator.h"
 #include "caadapterutils.h"
 #include "cainterfacecontroller.h"
@@ -87,6 +89,32 @@ static void CALogPayloadInfo(CAInfo_t *info);
 static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoint, uint16_t id,
                                 CAToken_t token, uint8_t tokenLength);
 
+#ifdef WITH_TRACING
+/**
+ * Records a trace point for a request or response, keyed by its token.
+ */
+static void CATraceData(OICTracePoint point, const CAData_t *data)
+{
+    const CAInfo_t *info = NULL;
+    if (data->requestInfo)
+    {
+        info = &data->requestInfo->info;
+    }
+    else if (data->responseInfo)
+    {
+        info = &data->responseInfo->info;
+    }
+
+    if (info)
+    {
+        OICTraceRecord(point, OICTraceKey(info->token, info->tokenLength));
+    }
+}
+#define CA_TRACE_DATA(point, data) CATraceData((point), (data))
+#else
+#define CA_TRACE_DATA(point, data)
+#endif
+
 #ifdef WITH_BWT
 void CAAddDataToSendThread(CAData_t *data)
 {
@@ -387,6 +415,7 @@ static void CAReceiveThreadProcess(void *threadData)
 {
 #ifndef SINGLE_HANDLE
     CAData_t *data = (CAData_t *) threadData;
+    CA_TRACE_DATA(OIC_TRACE_RECEIVE_DEQUEUE, data);
     CAProcessReceivedData(data);
 #else
     (void)threadData;
@@ -491,6 +520,9 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
         OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
         goto exit;
     }
+    OIC_METRIC_INC(OIC_METRIC_MESSAGES_SENT);
+    OIC_HISTOGRAM_RECORD(OIC_HISTOGRAM_MESSAGE_SIZE, pdu->length);
+    OIC_TRACE(OIC_TRACE_ADAPTER_SEND, info->token, info->tokenLength);
 
     coap_delete_list(options);
     coap_delete_pdu(pdu);
@@ -594,6 +626,9 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                 coap_delete_pdu(pdu);
                 return res;
             }
+            OIC_METRIC_INC(OIC_METRIC_MESSAGES_SENT);
+            OIC_HISTOGRAM_RECORD(OIC_HISTOGRAM_MESSAGE_SIZE, pdu->length);
+            OIC_TRACE(OIC_TRACE_ADAPTER_SEND, info->token, info->tokenLength);
 
 #ifdef WITH_TCP
             if (CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter))
@@ -671,6 +706,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
 static void CASendThreadProcess(void *threadData)
 {
     CAData_t *data = (CAData_t *) threadData;
+    CA_TRACE_DATA(OIC_TRACE_SEND_DEQUEUE, data);
     CAProcessSendData(data);
 }
 #endif
@@ -758,6 +794,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         OIC_LOG(ERROR, TAG, "Parse PDU failed");
         return;
     }
+    OIC_METRIC_INC(OIC_METRIC_MESSAGES_RECEIVED);
 
     OIC_LOG_V(DEBUG, TAG, "code = %d", code);
     if (CA_GET == code || CA_POST == code || CA_PUT == code || CA_DELETE == code)
@@ -816,6 +853,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     }
 
     cadata->type = SEND_TYPE_UNICAST;
+    CA_TRACE_DATA(OIC_TRACE_ADAPTER_RECEIVE, cadata);
 
 #ifdef SINGLE_THREAD
     CAProcessReceivedData(cadata);
@@ -873,6 +911,7 @@ void CAHandleRequestResponseCallbacks()
     ca_mutex_lock(g_receiveThread.threadMutex);
 
     u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
+    OIC_METRIC_SET(g_receiveThread.depthMetric, u_queue_get_size(g_receiveThread.dataQueue));
 
     ca_mutex_unlock(g_receiveThread.threadMutex);
 
@@ -883,6 +922,7 @@ void CAHandleRequestResponseCallbacks()
 
     // get endpoint
     CAData_t *td = (CAData_t *) item->msg;
+    CA_TRACE_DATA(OIC_TRACE_RECEIVE_DEQUEUE, td);
 
     if (td->requestInfo && g_requestHandler)
     {
@@ -1039,6 +1079,136 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     return CA_STATUS_OK;
 }
 
+CAResult_t CADetachSendRequests(const CAEndpoint_t *endpoints,
+                                const CARequestInfo_t *requestInfos,
+                                uint32_t count, CAResult_t *results)
+{
+    VERIFY_NON_NULL(endpoints, TAG, "endpoints");
+    VERIFY_NON_NULL(requestInfos, TAG, "requestInfos");
+
+    CAResult_t result = CA_STATUS_OK;
+
+#if defined(SINGLE_THREAD) || defined(ARDUINO)
+    // Sent right away or bounded by the retransmission queue, so one at a time
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAResult_t res = CADetachSendMessage(&endpoints[i], &requestInfos[i], CA_REQUEST_DATA);
+        if (results)
+        {
+            results[i] = res;
+        }
+        if (CA_STATUS_OK == result)
+        {
+            result = res;
+        }
+    }
+#else
+    if (false == CAIsSelectedNetworkAvailable())
+    {
+        result = CA_STATUS_FAILED;
+    }
+
+    void **dataList = NULL;
+    uint32_t *dataIndexes = NULL;
+    if (CA_STATUS_OK == result && count)
+    {
+        dataList = (void **) OICMalloc(count * sizeof(void *));
+        dataIndexes = (uint32_t *) OICMalloc(count * sizeof(uint32_t));
+        if (!dataList || !dataIndexes)
+        {
+            OIC_LOG(ERROR, TAG, "memory error!!");
+            OICFree(dataList);
+            OICFree(dataIndexes);
+            result = CA_MEMORY_ALLOC_FAILED;
+        }
+    }
+
+    if (CA_STATUS_OK != result)
+    {
+        for (uint32_t i = 0; results && i < count; i++)
+        {
+            results[i] = result;
+        }
+        return result;
+    }
+
+    uint32_t numData = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAResult_t res = CA_STATUS_OK;
+        CAData_t *data = CAPrepareSendData(&endpoints[i], &requestInfos[i], CA_REQUEST_DATA);
+        if (!data)
+        {
+            OIC_LOG(ERROR, TAG, "CAPrepareSendData failed");
+            res = CA_MEMORY_ALLOC_FAILED;
+        }
+#ifdef WITH_BWT
+        else if (CA_ADAPTER_GATT_BTLE != endpoints[i].adapter
+#ifdef WITH_TCP
+                && !CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter)
+#endif
+                )
+        {
+            // send block data, normal messages are queued with the others
+            res = CASendBlockWiseData(data);
+            if (CA_NOT_SUPPORTED == res)
+            {
+                dataIndexes[numData] = i;
+                dataList[numData++] = data;
+                res = CA_STATUS_OK;
+            }
+            else
+            {
+                CADestroyData(data, sizeof(CAData_t));
+            }
+        }
+#endif // WITH_BWT
+        else
+        {
+            dataIndexes[numData] = i;
+            dataList[numData++] = data;
+        }
+
+        if (results)
+        {
+            results[i] = res;
+        }
+        if (CA_STATUS_OK == result)
+        {
+            result = res;
+        }
+    }
+
+    if (CA_STATUS_OK != CAQueueingThreadAddDataList(&g_sendThread, dataList, numData,
+                                                    sizeof(CAData_t)))
+    {
+        // Queue them one by one, the ones that still cannot be queued are not sent
+        for (uint32_t i = 0; i < numData; i++)
+        {
+            CAResult_t res = CAQueueingThreadAddData(&g_sendThread, dataList[i],
+                                                     sizeof(CAData_t));
+            if (CA_STATUS_OK != res)
+            {
+                OIC_LOG(ERROR, TAG, "CAQueueingThreadAddData failed");
+                CADestroyData(dataList[i], sizeof(CAData_t));
+                if (results)
+                {
+                    results[dataIndexes[i]] = res;
+                }
+                if (CA_STATUS_OK == result)
+                {
+                    result = res;
+                }
+            }
+        }
+    }
+    OICFree(dataList);
+    OICFree(dataIndexes);
+#endif // SINGLE_THREAD || ARDUINO
+
+    return result;
+}
+
 void CASetInterfaceCallbacks(CARequestCallback ReqHandler, CAResponseCallback RespHandler,
                              CAErrorCallback errorHandler)
 {
@@ -1078,6 +1248,7 @@ CAResult_t CAInitializeMessageHandler()
         g_threadPoolHandle = NULL;
         return res;
     }
+    g_sendThread.depthMetric = OIC_METRIC_SEND_QUEUE_DEPTH;
 
     // start send thread
     res = CAQueueingThreadStart(&g_sendThread);
@@ -1101,6 +1272,7 @@ CAResult_t CAInitializeMessageHandler()
         CAQueueingThreadDestroy(&g_sendThread);
         return res;
     }
+    g_receiveThread.depthMetric = OIC_METRIC_RECEIVE_QUEUE_DEPTH;
 
 #ifndef SINGLE_HANDLE // This will be enabled when RI supports multi threading
     // start receive thread
@@ -69,6 +69,7 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
 
         // get data
         u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        OIC_METRIC_SET(thread->depthMetric, u_queue_get_size(thread->dataQueue));
         // mutex unlock
         ca_mutex_unlock(thread->threadMutex);
         if (NULL == message)
@@ -146,6 +147,7 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->depthMetric = OIC_METRIC_COUNT;
     if(NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
         goto ERROR_MEM_FAILURE;
 
@@ -238,6 +240,7 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
 
     // add thread data into list
     u_queue_add_element(thread->dataQueue, message);
+    OIC_METRIC_SET(thread->depthMetric, u_queue_get_size(thread->dataQueue));
 
     // notity the thread
     ca_cond_signal(thread->threadCond);
@@ -248,6 +251,72 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
     return CA_STATUS_OK;
 }
 
+CAResult_t CAQueueingThreadAddDataList(CAQueueingThread_t *thread, void **dataList,
+                                       uint32_t count, uint32_t size)
+{
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL == dataList || 0 == size)
+    {
+        OIC_LOG(ERROR, TAG, "data is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (0 == count)
+    {
+        return CA_STATUS_OK;
+    }
+
+    // create thread data for all of them first, so that they are queued together
+    u_queue_message_t **messageList =
+        (u_queue_message_t **) OICMalloc(count * sizeof(u_queue_message_t *));
+    if (NULL == messageList)
+    {
+        OIC_LOG(ERROR, TAG, "memory error!!");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        messageList[i] = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
+        if (NULL == messageList[i])
+        {
+            OIC_LOG(ERROR, TAG, "memory error!!");
+            for (uint32_t j = 0; j < i; j++)
+            {
+                OICFree(messageList[j]);
+            }
+            OICFree(messageList);
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        messageList[i]->msg = dataList[i];
+        messageList[i]->size = size;
+    }
+
+    // mutex lock
+    ca_mutex_lock(thread->threadMutex);
+
+    // add thread data into list
+    for (uint32_t i = 0; i < count; i++)
+    {
+        u_queue_add_element(thread->dataQueue, messageList[i]);
+    }
+    OIC_METRIC_SET(thread->depthMetric, u_queue_get_size(thread->dataQueue));
+
+    // notity the thread once for all of them
+    ca_cond_signal(thread->threadCond);
+
+    // mutex unlock
+    ca_mutex_unlock(thread->threadMutex);
+
+    OICFree(messageList);
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
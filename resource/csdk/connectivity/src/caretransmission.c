@@ -59,6 +59,7 @@
 #include "caremotehandler.h"
 #include "caprotocolmessage.h"
 #include "oic_malloc.h"
+#include "oic_metrics.h"
 #include "logger.h"
 
 #define TAG "OIC_CA_RETRANS"
@@ -191,6 +192,7 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
                 OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
                           retData->messageId);
                 context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
+                OIC_METRIC_INC(OIC_METRIC_RETRANSMISSIONS);
             }
 
             // #3. increase the retransmission count and update timestamp.
@@ -211,6 +213,9 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
             }
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
                       "msgid=%d", removedData->messageId);
+            OIC_METRIC_INC(OIC_METRIC_RETRANSMISSION_TIMEOUTS);
+            OIC_METRIC_SET(OIC_METRIC_RETRANSMISSIONS_PENDING,
+                           u_arraylist_length(context->dataList));
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
@@ -453,6 +458,7 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     }
 
     u_arraylist_add(context->dataList, (void *) retData);
+    OIC_METRIC_SET(OIC_METRIC_RETRANSMISSIONS_PENDING, u_arraylist_length(context->dataList));
 
     // notify the thread
     ca_cond_signal(context->threadCond);
@@ -462,6 +468,7 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
 
 #else
     u_arraylist_add(context->dataList, (void *) retData);
+    OIC_METRIC_SET(OIC_METRIC_RETRANSMISSIONS_PENDING, u_arraylist_length(context->dataList));
 
     CACheckRetransmissionList(context);
 #endif
@@ -565,6 +572,8 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
             }
 
             OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+            OIC_METRIC_SET(OIC_METRIC_RETRANSMISSIONS_PENDING,
+                           u_arraylist_length(context->dataList));
 
             CAFreeEndpoint(removedData->endpoint);
             OICFree(removedData->pdu);
@@ -622,6 +631,7 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     context->threadMutex = NULL;
     ca_cond_free(context->threadCond);
     u_arraylist_free(&context->dataList);
+    OIC_METRIC_SET(OIC_METRIC_RETRANSMISSIONS_PENDING, 0);
 
     return CA_STATUS_OK;
 }
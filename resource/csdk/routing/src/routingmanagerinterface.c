@@ -27,6 +27,7 @@
 #include "ocobserve.h"
 #include "include/logger.h"
 #include "ocrandom.h"
+#include "ocpayload.h"
 
 /**
  * Logging tag for module name.
@@ -143,8 +144,10 @@ OCStackApplicationResult RMDiscoverGatewayCallback(void* ctx, OCDoHandle handle,
         return OC_STACK_KEEP_TRANSACTION;
     }
 
+    OCRepPayload *decoded = NULL;
     OCStackResult result = RMHandleResponsePayload(&(clientResponse->devAddr),
-                                                   (OCRepPayload *)clientResponse->payload);
+                               OCPayloadGetRepresentation(clientResponse->payload, &decoded));
+    OCRepPayloadDestroy(decoded);
     if (OC_STACK_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "RMHandleResponsePayload Failed[%d]", result);
@@ -235,8 +238,10 @@ OCStackApplicationResult RMObserveRequestCallback(void* ctx, OCDoHandle handle,
         return OC_STACK_KEEP_TRANSACTION;
     }
 
+    OCRepPayload *decoded = NULL;
     OCStackResult result = RMHandleResponsePayload(&(clientResponse->devAddr),
-                                                   (OCRepPayload *)clientResponse->payload);
+                               OCPayloadGetRepresentation(clientResponse->payload, &decoded));
+    OCRepPayloadDestroy(decoded);
     if (OC_STACK_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "RMHandleResponsePayload Failed[%d]", result);
@@ -35,6 +35,7 @@
 #include "cainterface.h"
 #include "credresource.h"
 #include "ocserverrequest.h"
+#include "ocstackinternal.h"
 #include "srmutility.h"
 #include "pinoxmcommon.h"
 
@@ -644,6 +645,7 @@ static OCEntityHandlerResult HandleDoxmPutRequest (const OCEntityHandlerRequest
             (memcmp(&(gDoxm->owner), &(newDoxm->owner), sizeof(OicUuid_t)) == 0))
         {
             gDoxm->owned = true;
+            OCServerInstanceIDChanged();
             // Update new state in persistent storage
             if (UpdatePersistentStorage(gDoxm))
             {
@@ -849,6 +851,9 @@ OCStackResult InitDoxmResource()
     ret = CheckDeviceID();
     if (ret == OC_STACK_OK)
     {
+        // The device ID was loaded or generated, drop what the stack read before
+        OCServerInstanceIDChanged();
+
         //Instantiate 'oic.sec.doxm'
         ret = CreateDoxmResource();
     }
@@ -935,6 +940,7 @@ void RestoreDoxmToInitState()
         memcpy(&(gDoxm->owner), &emptyUuid, sizeof(OicUuid_t));
         gDoxm->owned = false;
         gDoxm->oxmSel = OIC_JUST_WORKS;
+        OCServerInstanceIDChanged();
 
         if(!UpdatePersistentStorage(gDoxm))
         {
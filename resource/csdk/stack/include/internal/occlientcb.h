@@ -126,6 +126,19 @@ typedef struct ClientCB {
      * can be explicitly cancelled.*/
     uint32_t TTL;
 
+    /** Set for callbacks the stack registered for itself, called with the lock of the
+     *  stack held. Callbacks of the application are called without it.*/
+    bool callBackLocked;
+
+    /** How representation payloads of the responses are parsed before callBack is called.*/
+    OCPayloadParseMode parseMode;
+
+    /** Number of calls of callBack in progress, the node is freed after the last one.*/
+    uint32_t holdCount;
+
+    /** Set when the node was deleted while callBack was running.*/
+    bool deletePending;
+
     /** next node in this list.*/
     struct ClientCB    *next;
 } ClientCB;
@@ -164,12 +177,32 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
 
 /** @ingroup ocstack
  *
- * This method is used to remove a callback node from cbList.
+ * This method is used to remove a callback node from cbList. A node whose callback is
+ * running is only unlinked, and freed by ReleaseClientCB once the callback returns.
  *
  * @param[in] cbNode        Address to client callback node.
  */
 void DeleteClientCB(ClientCB *cbNode);
 
+/** @ingroup ocstack
+ *
+ * This method keeps a callback node allocated while its callback runs.
+ *
+ * @param[in] cbNode        Address to client callback node.
+ */
+void HoldClientCB(ClientCB *cbNode);
+
+/** @ingroup ocstack
+ *
+ * This method releases a callback node held by HoldClientCB, freeing it if it was deleted
+ * meanwhile and this was the last hold.
+ *
+ * @param[in] cbNode        Address to client callback node.
+ *
+ * @return true if the node is still in cbList, false if it was deleted.
+ */
+bool ReleaseClientCB(ClientCB *cbNode);
+
 
 /** @ingroup ocstack
  *
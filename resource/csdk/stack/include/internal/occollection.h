@@ -24,7 +24,22 @@
 #include "ocstack.h"
 #include "ocresourcehandler.h"
 
-uint8_t GetNumOfResourcesInCollection (OCResource *resource);
+uint32_t GetNumOfResourcesInCollection (OCResource *resource);
+
+/**
+ * Start worker threads for the child entity handlers of batch interface requests,
+ * replacing any previous workers.
+ *
+ * @param numWorkers   Number of worker threads, 0 to call child handlers in turn.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult SetCollectionBatchWorkers(uint32_t numWorkers);
+
+/**
+ * Stop the batch worker threads, if any, once they ran the child handlers already queued.
+ */
+void TerminateCollectionBatchWorkers();
 
 OCStackResult DefaultCollectionEntityHandler (OCEntityHandlerFlag flag,
                                               OCEntityHandlerRequest *entityHandlerRequest);
@@ -131,6 +131,22 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         const OCRepPayload *payload, uint32_t maxAge,
         OCQualityOfService qos);
 
+/**
+ * Notify specific observers, each with its own representation, in one pass. Observers given
+ * the same payload share its encoding.
+ *
+ * @param resource      Observed resource.
+ * @param obsIdList     List of observation ids that need to be notified.
+ * @param payloadList   Representation or encoded payload sent to each observer of obsIdList.
+ * @param numberOfIds   Number of observation ids included in obsIdList.
+ * @param qos           Desired quality of service of the observation notifications.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult SendObserverNotificationList (OCResource *resource,
+        OCObservationId *obsIdList, const OCPayload **payloadList, uint8_t numberOfIds,
+        OCQualityOfService qos);
+
 /**
  * Delete all observers in the observe list.
  */
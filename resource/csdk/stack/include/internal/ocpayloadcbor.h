@@ -30,8 +30,87 @@ extern "C"
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
+/**
+ * Parse a payload like OCParsePayload, choosing how representation payloads are built.
+ *
+ * With ::OC_PAYLOAD_PARSE_ARENA a representation payload, including its nested objects,
+ * arrays and strings, is placed in one arena sized from payloadSize. Strings are copied
+ * into the arena since the payload API hands out NUL-terminated strings. With
+ * ::OC_PAYLOAD_PARSE_ENCODED a representation payload is not parsed, a copy of it is
+ * returned as an OCEncodedPayload. Other payload types are always parsed with
+ * ::OC_PAYLOAD_PARSE_DEFAULT.
+ *
+ * @param outPayload   Out parsed payload, released with OCPayloadDestroy.
+ * @param type         Type of the payload.
+ * @param payload      CBOR encoded payload.
+ * @param payloadSize  Size of the encoded payload.
+ * @param mode         How representation payloads are built.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCParsePayloadWithMode(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize, OCPayloadParseMode mode);
+
+/**
+ * Size of the memory needed by OCRepPayloadIndexInit for count values.
+ *
+ * @param count  Number of values to index.
+ *
+ * @return Size in bytes.
+ */
+size_t OCRepPayloadIndexSize(size_t count);
+
+/**
+ * Index the values of a payload in caller provided memory, e.g. from a parse arena.
+ *
+ * @param payload  Payload whose values are indexed, its previous index is not freed.
+ * @param memory   At least OCRepPayloadIndexSize(count) bytes.
+ * @param count    Number of values in the payload.
+ */
+void OCRepPayloadIndexInit(OCRepPayload* payload, void* memory, size_t count);
+
+/**
+ * Release the arena of a payload parsed with ::OC_PAYLOAD_PARSE_ARENA. Nothing is done
+ * unless payload is the top level payload owning the arena.
+ *
+ * @param payload  Payload whose arena member is set.
+ */
+void OCPayloadArenaRelease(OCRepPayload* payload);
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
+/**
+ * Encode a payload into a caller owned buffer that can be reused across calls,
+ * e.g. by code sending the same kind of payload repeatedly.
+ *
+ * The buffer is sized from an upper bound of the encoded size before encoding,
+ * so the payload is normally encoded exactly once.
+ *
+ * @param payload     Payload to encode.
+ * @param buffer      In/out buffer, may be NULL initially. Grown with OICRealloc when
+ *                    too small; the caller releases it with OICFree.
+ * @param bufferSize  In/out allocated size of *buffer.
+ * @param size        Out number of encoded bytes in *buffer.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCConvertPayloadToBuffer(OCPayload* payload, uint8_t** buffer, size_t* bufferSize,
+        size_t* size);
+
+/**
+ * Encode a payload into a buffer that cannot grow, e.g. scratch space of a request.
+ *
+ * @param payload     Payload to encode.
+ * @param buffer      Buffer to encode into.
+ * @param bufferSize  Size of buffer.
+ * @param size        Out number of encoded bytes in buffer.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_NO_MEMORY when the payload may not fit,
+ *         in which case the caller falls back to OCConvertPayload.
+ */
+OCStackResult OCConvertPayloadToFixedBuffer(OCPayload* payload, uint8_t* buffer,
+        size_t bufferSize, size_t* size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -123,6 +123,9 @@ typedef struct ocactionset
 
     /** head pointer of a linked list of Actions.*/
     OCAction* head;
+
+    /** Pending schedules of this action set; maintained by the group scheduler.*/
+    struct scheduledresourceinfo *schedule;
 } OCActionSet;
 
 /**
@@ -199,6 +202,9 @@ typedef struct OCResource {
     /** Points to next resource in list.*/
     struct OCResource *next;
 
+    /** Context the resource belongs to.*/
+    OCStackContext *context;
+
     /** Relative path on the device; will be combined with base url to create fully qualified path.*/
     char *uri;
 
@@ -224,6 +230,10 @@ typedef struct OCResource {
     /** Callback parameter.*/
     void * entityHandlerCallbackParam;
 
+    /** Set when the entity handler was bound by the stack itself, it then runs with the
+     *  lock of the stack held. Entity handlers of the application run without it.*/
+    bool entityHandlerLocked;
+
     /** Properties on the resource – defines meta information on the resource.
      * (ACTIVE, DISCOVERABLE etc ). */
 
@@ -167,6 +167,18 @@ void DeletePlatformInfo();
  */
 void DeleteDeviceInfo();
 
+/**
+ * Internal API used to drop the cached, pre-encoded /oic/res responses.
+ * Must be called whenever the set of resources or any of their discovery
+ * attributes (types, interfaces, properties, bindings) changes.
+ */
+void InvalidateDiscoveryCache();
+
+/**
+ * Internal API returning the number of cached /oic/res responses of the current context.
+ */
+size_t GetDiscoveryCacheSize();
+
 /*
  * Prepare payload for resource representation.
  */
@@ -48,11 +48,12 @@ typedef struct OCServerRequest
     /** Accept format retrieved from the received request PDU. */
     OCPayloadFormat acceptFormat;
 
-    /** resourceUrl will be filled in occoap using the path options in received request PDU.*/
-    char resourceUrl[MAX_URI_LENGTH];
+    /** resourceUrl will be filled in occoap using the path options in received request PDU.
+     *  Stored in the allocation of the request, sized to the received URL.*/
+    char *resourceUrl;
 
-    /** resource query send by client.*/
-    char query[MAX_QUERY_LENGTH];
+    /** resource query send by client, an empty string if there is none.*/
+    char *query;
 
     /** qos is indicating if the request is CON or NON.*/
     OCQualityOfService qos;
@@ -65,7 +66,7 @@ typedef struct OCServerRequest
     OCStackResult observeResult;
 
     /** number of Responses.*/
-    uint8_t numResponses;
+    uint32_t numResponses;
 
     /** Response Entity Handler .*/
     OCEHResponseHandler ehResponseHandler;
@@ -88,8 +89,9 @@ typedef struct OCServerRequest
     /** Number of vendor specific header options.*/
     uint8_t numRcvdVendorSpecificHeaderOptions;
 
-    /** An Array  of received vendor specific header options.*/
-    OCHeaderOption rcvdVendorSpecificHeaderOptions[MAX_HEADER_OPTIONS];
+    /** An Array  of received vendor specific header options, stored in the allocation
+     *  of the request.*/
+    OCHeaderOption *rcvdVendorSpecificHeaderOptions;
 
     /** Request to complete.*/
     uint8_t requestComplete;
@@ -97,6 +99,21 @@ typedef struct OCServerRequest
     /** Linked list; for multiple server request.*/
     struct OCServerRequest * next;
 
+    /** Previous server request, so that a request is unlinked in constant time.*/
+    struct OCServerRequest * prev;
+
+    /** Next server request in the same bucket of the handle index.*/
+    struct OCServerRequest * handleNext;
+
+    /** Next server request in the same bucket of the token index.*/
+    struct OCServerRequest * tokenNext;
+
+    /** Aggregated response being built for this request, if any.*/
+    struct OCServerResponse * response;
+
+    /** Time the request was added, in milliseconds.*/
+    uint64_t timeStamp;
+
     /** Flag indicating slow response.*/
     uint8_t slowFlag;
 
@@ -106,6 +123,22 @@ typedef struct OCServerRequest
     /** Payload Size.*/
     size_t payloadSize;
 
+    /** Scratch space in the same allocation as the request, released with it.*/
+    uint8_t *arena;
+
+    /** Size of the scratch space.*/
+    size_t arenaSize;
+
+    /** Bytes of the scratch space in use.*/
+    size_t arenaUsed;
+
+    /** Number of callers running an entity handler for the request without the lock of
+     *  the stack, see PinServerRequest().*/
+    uint32_t pinCount;
+
+    /** Set when the request was deleted while pinned, it is freed by the last unpin.*/
+    bool deletePending;
+
     /** payload is retrieved from the payload of the received request PDU.*/
     uint8_t payload[1];
 
@@ -143,6 +176,20 @@ typedef struct OCServerResponse {
  */
 OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Handler function for sending a response whose payload has already been CBOR encoded,
+ * e.g. a cached discovery response. The encoded payload is not consumed.
+ *
+ * @param ehResponse   Pointer to the response from the resource. Its payload is ignored.
+ * @param payload      CBOR encoded payload to send.
+ * @param payloadSize  Size of the encoded payload.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult HandleSingleEncodedResponse(OCEntityHandlerResponse * ehResponse,
+                                          const uint8_t *payload, size_t payloadSize);
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
@@ -168,6 +215,19 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse);
  */
 OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tokenLength);
 
+/**
+ * Delete server requests that have been waiting for a response from their entity
+ * handler for longer than ::SERVER_REQUEST_TIMEOUT_SECONDS. Slow requests, which the
+ * application still holds the handle of, and requests whose entity handler is running
+ * are kept until they are answered.
+ */
+void ProcessServerRequestTimeouts();
+
+/**
+ * Delete all server requests and responses and release the request indexes.
+ */
+void DeleteServerRequestList();
+
 /**
  * Get a server request from the server request list using the specified handle
  *
@@ -254,6 +314,34 @@ OCStackResult FormOCEntityHandlerRequest(
         OCObserveAction observeAction,
         OCObservationId observeID);
 
+/**
+ * Select how FormOCEntityHandlerRequest() parses request payloads.
+ *
+ * @param mode                Parse mode, ::OC_PAYLOAD_PARSE_DEFAULT or ::OC_PAYLOAD_PARSE_ARENA.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for any other mode.
+ */
+OCStackResult SetRequestPayloadParseMode(OCPayloadParseMode mode);
+
+/**
+ * Keep a server request allocated while an entity handler runs for it without the lock of
+ * the stack. The request may still be deleted, e.g. by the response of the handler, it is
+ * then removed from the server request list and freed by the last UnpinServerRequest().
+ *
+ * @param serverRequest       server request to pin.
+ */
+void PinServerRequest(OCServerRequest * serverRequest);
+
+/**
+ * Release a server request pinned by PinServerRequest().
+ *
+ * @param serverRequest       server request to unpin.
+ *
+ * @return true if the request is still in the server request list, false if it was deleted
+ *         while pinned and must not be used anymore.
+ */
+bool UnpinServerRequest(OCServerRequest * serverRequest);
+
 /**
  * Find a server request in the server request list and delete
  *
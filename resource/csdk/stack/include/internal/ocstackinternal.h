@@ -53,11 +53,8 @@ extern "C" {
 // Global variables
 //-----------------------------------------------------------------------------
 
-/** Default device entity Handler.*/
-extern OCDeviceEntityHandler defaultDeviceHandler;
-
-/** Default Callback parameter.*/
-extern void* defaultDeviceHandlerCallbackParameter;
+/** Contexts hosted by the stack, the default context first.*/
+extern OCStackContext *stackContexts;
 
 //-----------------------------------------------------------------------------
 // Defines
@@ -69,6 +66,51 @@ extern void* defaultDeviceHandlerCallbackParameter;
 /** the first outgoing sequence number will be 5*/
 #define OC_OFFSET_SEQUENCE_NUMBER (4)
 
+/**
+ * State of a virtual device, see OCCreateContext().
+ */
+struct OCStackContext
+{
+    /** URI prefix of the resources of the context, NULL for the default context.*/
+    char *uriPrefix;
+
+    /** Length of the URI prefix.*/
+    size_t uriPrefixLength;
+
+    /** Resources of the context.*/
+    struct OCResource *headResource;
+
+    /** Last resource of the context.*/
+    struct OCResource *tailResource;
+
+    /** /oic/d resource of the context.*/
+    OCResourceHandle deviceResource;
+
+    /** /oic/p resource of the context.*/
+    OCResourceHandle platformResource;
+
+    /** Default device entity Handler.*/
+    OCDeviceEntityHandler defaultDeviceHandler;
+
+    /** Default Callback parameter.*/
+    void *defaultDeviceHandlerCallbackParameter;
+
+    /** Device ID, the default context uses OCGetServerInstanceID() instead.*/
+    OicUuid_t deviceId;
+
+    /** Information set with OCSetDeviceInfo.*/
+    OCDeviceInfo deviceInfo;
+
+    /** Information set with OCSetPlatformInfo.*/
+    OCPlatformInfo platformInfo;
+
+    /** Pre-encoded /oic/res responses of the context.*/
+    struct DiscoveryCacheEntry *discoveryCache;
+
+    /** Linked list of contexts.*/
+    struct OCStackContext *next;
+};
+
 /**
  * This structure will be created in occoap and passed up the stack on the server side.
  */
@@ -83,11 +125,12 @@ typedef struct
     /** the requested payload format. */
     OCPayloadFormat acceptFormat;
 
-    /** resourceUrl will be filled in occoap using the path options in received request PDU.*/
-    char resourceUrl[MAX_URI_LENGTH];
+    /** resourceUrl will be filled in occoap using the path options in received request PDU.
+     *  Borrowed for the duration of HandleStackRequests.*/
+    char *resourceUrl;
 
-    /** resource query send by client.*/
-    char query[MAX_QUERY_LENGTH];
+    /** resource query send by client, NULL if there is none.*/
+    char *query;
 
     /** reqJSON is retrieved from the payload of the received request PDU.*/
     uint8_t *payload;
@@ -98,8 +141,8 @@ typedef struct
     /** Number of the received vendor specific header options.*/
     uint8_t numRcvdVendorSpecificHeaderOptions;
 
-    /** Array of received vendor specific header option .*/
-    OCHeaderOption rcvdVendorSpecificHeaderOptions[MAX_HEADER_OPTIONS];
+    /** Array of received vendor specific header option, borrowed from the received PDU.*/
+    OCHeaderOption *rcvdVendorSpecificHeaderOptions;
 
     /** Remote end-point address **/
     OCDevAddr devAddr;
@@ -204,6 +247,63 @@ OCStackResult SendDirectStackResponse(const CAEndpoint_t* endPoint, const uint16
         const uint8_t numOptions, const CAHeaderOption_t *options,
         CAToken_t token, uint8_t tokenLength, const char *resourceUri);
 
+/**
+ * Take the lock of the stack, does nothing before the first call to OCInit.
+ * The lock is recursive.
+ */
+void OCStackLock();
+
+/**
+ * Release the lock of the stack taken by OCStackLock.
+ */
+void OCStackUnlock();
+
+/**
+ * Release the lock of the stack before calling into the application or waiting for other
+ * threads, if the calling thread holds it exactly once. When it holds it more than once,
+ * stack code up the call chain is in the middle of a change the application must not see,
+ * so the lock is kept.
+ *
+ * @return true if the lock was released, to pass to OCStackReacquireLock().
+ */
+bool OCStackReleaseLock();
+
+/**
+ * Take back the lock of the stack released by OCStackReleaseLock().
+ *
+ * @param released  Value returned by OCStackReleaseLock().
+ */
+void OCStackReacquireLock(bool released);
+
+/**
+ * Call an entity handler. Entity handlers of the application run without the lock of the
+ * stack, see OCStackReleaseLock(), those of the stack itself with the lock held.
+ *
+ * The handler, its parameter and lock flag are passed rather than the resource, which may
+ * be deleted while the handler runs. The caller must pin whatever it uses after the call.
+ *
+ * @param entityHandler   Entity handler to call.
+ * @param callbackParam   Parameter of the entity handler.
+ * @param locked          Whether the handler runs with the lock of the stack held.
+ * @param flag            Entity handler flag.
+ * @param ehRequest       Request passed to the entity handler.
+ *
+ * @return the result of the entity handler.
+ */
+OCEntityHandlerResult OCStackCallEntityHandler(OCEntityHandler entityHandler,
+                                               void *callbackParam, bool locked,
+                                               OCEntityHandlerFlag flag,
+                                               OCEntityHandlerRequest *ehRequest);
+
+/**
+ * Check that a resource was not deleted, e.g. after calling into the application.
+ *
+ * @param handle  Handle of the resource.
+ *
+ * @return true if the resource is in the resource list of a context.
+ */
+bool IsResourceInStack(OCResourceHandle handle);
+
 #ifdef WITH_PRESENCE
 
 /**
@@ -278,6 +378,12 @@ OCStackResult CAResultToOCResult(CAResult_t caResult);
  */
 const OicUuid_t* OCGetServerInstanceID(void);
 
+/**
+ * Drops the cached server instance ID and the discovery responses carrying it.
+ * Called by the security resources whenever the device ID or ownership of the doxm changes.
+ */
+void OCServerInstanceIDChanged(void);
+
 /**
  * Map OCQualityOfService to CAMessageType.
  *
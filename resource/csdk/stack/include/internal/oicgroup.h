@@ -24,6 +24,7 @@
 #include "ocstackinternal.h"
 #include "ocstack.h"
 #include "ocresource.h"
+#include "ocserverrequest.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -56,6 +57,59 @@ OCStackApplicationResult ActionSetCB(void* context, OCDoHandle handle,
 
 void ActionSetCD(void *context);
 
+OCStackResult DoAction(OCResource* resource, OCActionSet* actionset,
+        OCServerRequest* requestHandle);
+
+/**
+ * Sets the time after which an executing ActionSet reports its result without
+ * waiting for the remaining members, ::ACTIONSET_RESPONSE_TIMEOUT_SECONDS by default.
+ */
+void SetActionSetResponseTimeout(uint32_t seconds);
+
+/**
+ * Returns the number of ActionSet executions still referenced, completed or not.
+ */
+size_t GetNumActionSetFanOuts();
+
+/**
+ * Reports executing ActionSets whose response deadline has passed.
+ * Called from the stack's process loop.
+ */
+void ProcessActionSetTimeouts();
+
+/**
+ * Schedules an action set to run after the given delay in seconds.
+ */
+OCStackResult AddScheduledResource(OCResource *resource, OCActionSet *actionset,
+        OCServerRequest *ehRequest, long int delay);
+
+/**
+ * Cancels one pending schedule of an action set.
+ */
+OCStackResult CancelScheduledResource(OCActionSet *actionset);
+
+/**
+ * Cancels every schedule of an action set that is about to be deleted.
+ *
+ * @return true if a run of the action set is in progress, which then deletes it.
+ */
+bool CancelAllScheduledResources(OCActionSet *actionset);
+
+/**
+ * Returns the number of schedules waiting for their deadline.
+ */
+size_t GetNumScheduledResources();
+
+/**
+ * Returns the action set due first, NULL if nothing is scheduled.
+ */
+OCActionSet *GetNextScheduledActionSet();
+
+/**
+ * Stops the group action scheduler and drops every pending schedule.
+ */
+void TerminateScheduledGroupActions();
+
 
 OCStackResult
 BuildCollectionGroupActionCBORResponse(OCMethod method/*OCEntityHandlerFlag flag*/,
@@ -93,6 +93,59 @@ void HandleKeepAliveConnCB(const CAEndpoint_t *endpoint);
  */
 void HandleKeepAliveDisconnCB(const CAEndpoint_t *endpoint);
 
+/**
+ * Entry of the KeepAlive table, one per connected remote endpoint.
+ */
+typedef struct KeepAliveEntry KeepAliveEntry_t;
+
+/**
+ * Add keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference uri and transport type).
+ * @param[in]   mode        Whether it is OIC Server or OIC Client.
+ * @param[in]   intervalArray   Received interval values from cloud server.
+ * @return  The KeepAlive entry added in KeepAlive Table.
+ */
+KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
+                                    int64_t *intervalArray);
+
+/**
+ * Remove keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference uri and transport type).
+ * @return  ::OC_STACK_OK or Appropriate error code.
+ */
+OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint);
+
+/**
+ * Gets keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference uri and transport type) to
+ *                          which the ping message has to be sent.
+ * @return  KeepAlive entry to send ping message.
+ */
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint);
+
+/**
+ * Move a keepalive entry to the timer wheel slot of the given deadline.
+ * @param[in]   entry       KeepAlive entry.
+ * @param[in]   deadline    Deadline in microseconds.
+ */
+void ScheduleKeepAliveEntry(KeepAliveEntry_t *entry, uint64_t deadline);
+
+/**
+ * Number of entries in the KeepAlive table.
+ * @return  Entry count.
+ */
+size_t GetNumKeepAliveEntries();
+
+/**
+ * Next time a keepalive entry is looked at.
+ * @param[in]   entry       KeepAlive entry.
+ * @return  Deadline in microseconds.
+ */
+uint64_t GetKeepAliveEntryDeadline(const KeepAliveEntry_t *entry);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
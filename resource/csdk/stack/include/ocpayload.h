@@ -222,6 +222,40 @@ OCDiscoveryPayload* OCDiscoveryPayloadCreate();
 OCSecurityPayload* OCSecurityPayloadCreate(const char* securityData);
 void OCSecurityPayloadDestroy(OCSecurityPayload* payload);
 
+// Encoded Payload
+/**
+ * Create a payload sending a representation already encoded in CBOR.
+ *
+ * @param data  CBOR encoding allocated with OICMalloc, owned by the payload on success.
+ * @param size  Size of data in bytes.
+ *
+ * @return the payload, NULL if data is empty or memory is exhausted.
+ */
+OCEncodedPayload* OCEncodedPayloadCreate(uint8_t* data, size_t size);
+void OCEncodedPayloadDestroy(OCEncodedPayload* payload);
+
+/**
+ * Parse the representation held by an encoded payload.
+ *
+ * @param payload     Encoded payload.
+ * @param outPayload  Out representation, released with OCRepPayloadDestroy.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCEncodedPayloadDecode(const OCEncodedPayload* payload, OCRepPayload** outPayload);
+
+/**
+ * Representation held by a received payload, whether it was parsed or kept encoded
+ * because of ::OC_PAYLOAD_PARSE_ENCODED.
+ *
+ * @param payload  Received payload, may be NULL.
+ * @param decoded  Out representation decoded from an encoded payload, to release with
+ *                 OCRepPayloadDestroy. Set to NULL when nothing was decoded.
+ *
+ * @return the representation, NULL if payload holds none.
+ */
+OCRepPayload* OCPayloadGetRepresentation(OCPayload* payload, OCRepPayload** decoded);
+
 void OCDiscoveryPayloadAddResource(OCDiscoveryPayload* payload, const OCResource* res,
         uint16_t port);
 void OCDiscoveryPayloadAddNewResource(OCDiscoveryPayload* payload, OCResourcePayload* res);
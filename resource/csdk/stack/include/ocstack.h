@@ -157,8 +157,55 @@ OCStackResult OCDoResource(OCDoHandle *handle,
                             OCCallbackData *cbData,
                             OCHeaderOption *options,
                             uint8_t numOptions);
+
+/**
+ * This function performs a request as @ref OCDoResource does, choosing how representation
+ * payloads of its responses are parsed before they are handed to the callback of cbData.
+ *
+ * With ::OC_PAYLOAD_PARSE_ENCODED the callback receives representations as an
+ * OCEncodedPayload holding the received CBOR, which OCPayloadGetRepresentation parses when
+ * needed. The mode only applies to this request, other callbacks of the process still get
+ * their payloads as set with OCSetResponsePayloadParseMode.
+ *
+ * @param parseMode         Parse mode of the responses, ::OC_PAYLOAD_PARSE_DEFAULT for the
+ *                          one set with OCSetResponsePayloadParseMode.
+ *
+ * @see OCDoResource for the other parameters.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for an unknown mode, some other
+ *         value upon failure.
+ */
+OCStackResult OCDoResourceWithParseMode(OCDoHandle *handle,
+                                        OCMethod method,
+                                        const char *requestUri,
+                                        const OCDevAddr *destination,
+                                        OCPayload* payload,
+                                        OCConnectivityType connectivityType,
+                                        OCQualityOfService qos,
+                                        OCCallbackData *cbData,
+                                        OCHeaderOption *options,
+                                        uint8_t numOptions,
+                                        OCPayloadParseMode parseMode);
+
+/**
+ * This function performs several requests as @ref OCDoResource does, in one pass. Their
+ * callbacks are registered and their messages built first, then they are all handed to
+ * the send thread at once.
+ *
+ * @param requests      Requests to perform. The stack sets the handle and result of each,
+ *                      and owns their payloads. The context deleter of each request that
+ *                      is not sent is called before this function returns.
+ * @param numRequests   Number of requests.
+ *
+ * @return ::OC_STACK_OK if every request was sent, otherwise the result of the first
+ *         request that was not.
+ */
+OCStackResult OCDoResources(OCDoResourceRequest *requests, size_t numRequests);
+
 /**
  * This function cancels a request associated with a specific @ref OCDoResource invocation.
+ * A GET, PUT, POST or DELETE request is cancelled by dropping its callback, whose context
+ * deleter is called; the server is not told.
  *
  * @param handle       Used to identify a specific OCDoResource invocation.
  * @param qos          Used to specify Quality of Service(read below).
@@ -215,6 +262,88 @@ OCStackResult OCStartPresence(const uint32_t ttl);
 OCStackResult OCStopPresence();
 #endif
 
+#ifdef WITH_METRICS
+/**
+ * This function creates the discoverable monitoring resource (::OC_RSRVD_MONITORING_URI),
+ * which answers GET requests with the current stack metrics. Every counter is published as
+ * an integer and every histogram as an integer array of its log2 buckets, under the names
+ * returned by OICMetricName() and OICHistogramName().
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCStartMonitoringResource();
+
+/**
+ * This function deletes the monitoring resource created by OCStartMonitoringResource().
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_ERROR if the resource is not created.
+ */
+OCStackResult OCStopMonitoringResource();
+#endif
+
+/**
+ * This function creates a context, a virtual device hosted by the stack next to the default
+ * one. A context has its own resources, device and platform information, device entity
+ * handler and device ID, and shares the connectivity layer, its threads and its sockets with
+ * every other context. Resources of the context are served under its URI prefix: its
+ * /oic/res, /oic/d and /oic/p are reached with prefix/oic/res and so on.
+ *
+ * Every function acting on the resources or the information of the device acts on the
+ * current context, see OCSetCurrentContext(), or on the context passed to its InContext
+ * variant. Multicast discovery is answered by the default context only.
+ *
+ * @param uriPrefix   URI prefix of the context, such as "/bridge/light1". It must start with
+ *                    a '/', must not end with one and must not contain or be contained by the
+ *                    prefix of another context.
+ * @param context     Set to the new context on success.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCCreateContext(const char *uriPrefix, OCStackContext **context);
+
+/**
+ * This function deletes a context created by OCCreateContext() with all its resources.
+ * The default context becomes the current one if the context was current.
+ *
+ * @param context     Context to delete.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCDeleteContext(OCStackContext *context);
+
+/**
+ * This function selects the context the following calls of the calling thread act on.
+ * Each thread keeps its own selection until it is changed or the context is deleted, and
+ * starts with the default context. Entity handlers see the context of the request they
+ * handle.
+ *
+ * @param context     Context to select, NULL for the default context.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for an unknown context.
+ */
+OCStackResult OCSetCurrentContext(OCStackContext *context);
+
+/**
+ * This function returns the current context of the calling thread, see
+ * OCSetCurrentContext().
+ *
+ * @return the current context, never NULL.
+ */
+OCStackContext *OCGetCurrentContext();
+
+/**
+ * This function sets the default device entity handler of a context, see
+ * OCSetDefaultDeviceEntityHandler(). The current context is left as it is.
+ *
+ * @param context            Context of the handler, NULL for the default context.
+ * @param entityHandler      Entity handler function, NULL to remove it.
+ * @param callbackParameter  Parameter passed back when entityHandler is called.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for an unknown context.
+ */
+OCStackResult OCSetDefaultDeviceEntityHandlerInContext(OCStackContext *context,
+                                                       OCDeviceEntityHandler entityHandler,
+                                                       void* callbackParameter);
 
 /**
  * This function sets default device entity handler.
@@ -228,6 +357,80 @@ OCStackResult OCStopPresence();
  */
 OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandler, void* callbackParameter);
 
+/**
+ * This function makes batch interface requests on collections call the entity handlers
+ * of the contained resources concurrently on a pool of worker threads. The request is
+ * then handled as a slow response: the thread calling OCProcess does not wait for the
+ * children, whose responses are aggregated as they complete.
+ *
+ * Entity handlers of resources contained in collections must then be safe to call from
+ * several threads at once. As for any slow response, their calls into the stack run
+ * concurrently with OCProcess. Replacing the workers runs the child handlers already
+ * queued first.
+ *
+ * @param numWorkers   Number of worker threads, 0 (the default) calls the entity handlers
+ *                     one after another on the thread calling OCProcess.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSetCollectionBatchWorkers(uint32_t numWorkers);
+
+/**
+ * This function selects how representation payloads of responses are parsed before they
+ * are handed to client callbacks.
+ *
+ * With ::OC_PAYLOAD_PARSE_ARENA a response payload is parsed into a single allocation that
+ * is released at once after the callback returns. Callbacks must then only read the
+ * payload; OCRepPayloadClone gives a copy that can be modified or kept.
+ *
+ * The mode applies to the responses of requests made afterwards without a mode of their
+ * own, see OCDoResourceWithParseMode. ::OC_PAYLOAD_PARSE_ENCODED can only be selected per
+ * request, since most callbacks expect an OCRepPayload.
+ *
+ * @param mode   Parse mode, ::OC_PAYLOAD_PARSE_DEFAULT unless set.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for any other mode.
+ */
+OCStackResult OCSetResponsePayloadParseMode(OCPayloadParseMode mode);
+
+/**
+ * This function selects how representation payloads of requests are parsed before they
+ * are handed to entity handlers.
+ *
+ * By default entity handlers receive a payload they may modify. With
+ * ::OC_PAYLOAD_PARSE_ARENA a request payload is parsed into a single allocation that is
+ * released at once after the entity handler returns. Only select it when no entity handler
+ * of the process modifies or keeps the request payload; OCRepPayloadClone gives a copy that
+ * can be.
+ *
+ * @param mode   Parse mode, ::OC_PAYLOAD_PARSE_DEFAULT or ::OC_PAYLOAD_PARSE_ARENA.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for any other mode.
+ */
+OCStackResult OCSetRequestPayloadParseMode(OCPayloadParseMode mode);
+
+/**
+ * This function sets the limits the stack applies to the URI, query and header options of
+ * received requests, and to the URIs of created resources. The URI, query and header
+ * options of a request are stored in space sized to what the request carries, so raising
+ * the limits costs no memory for small requests.
+ *
+ * Responses still carry at most ::MAX_HEADER_OPTIONS header options. Call this before
+ * OCInit.
+ *
+ * @param maxUriLength       URIs of this length or longer are rejected, ::MAX_URI_LENGTH
+ *                           unless set.
+ * @param maxQueryLength     Queries of this length or longer are rejected,
+ *                           ::MAX_QUERY_LENGTH unless set.
+ * @param maxHeaderOptions   Requests with more header options are rejected,
+ *                           ::MAX_HEADER_OPTIONS unless set.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_ERROR if the stack is initialized,
+ *         ::OC_STACK_INVALID_PARAM for a zero URI or query length.
+ */
+OCStackResult OCSetRequestLimits(uint16_t maxUriLength, uint16_t maxQueryLength,
+                                 uint8_t maxHeaderOptions);
+
 /**
  * This function sets device information.
  *
@@ -240,6 +443,17 @@ OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandle
  */
 OCStackResult OCSetDeviceInfo(OCDeviceInfo deviceInfo);
 
+/**
+ * This function sets the device information of a context, see OCSetDeviceInfo(). The
+ * current context is left as it is.
+ *
+ * @param context      Context of the device, NULL for the default context.
+ * @param deviceInfo   Structure containing the device information.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSetDeviceInfoInContext(OCStackContext *context, OCDeviceInfo deviceInfo);
+
 /**
  * This function sets platform information.
  *
@@ -254,6 +468,17 @@ OCStackResult OCSetDeviceInfo(OCDeviceInfo deviceInfo);
  */
 OCStackResult OCSetPlatformInfo(OCPlatformInfo platformInfo);
 
+/**
+ * This function sets the platform information of a context, see OCSetPlatformInfo(). The
+ * current context is left as it is.
+ *
+ * @param context        Context of the platform, NULL for the default context.
+ * @param platformInfo   Structure containing the platform information.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSetPlatformInfoInContext(OCStackContext *context, OCPlatformInfo platformInfo);
+
 /**
  * This function creates a resource.
  *
@@ -279,6 +504,23 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
                                void* callbackParam,
                                uint8_t resourceProperties);
 
+/**
+ * This function creates a resource in a context, see OCCreateResource(). The current
+ * context is left as it is, so threads serving different contexts need not select them.
+ *
+ * @param context   Context of the resource, NULL for the default context.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for an unknown context, some
+ *         other value upon failure.
+ */
+OCStackResult OCCreateResourceInContext(OCStackContext *context,
+                                        OCResourceHandle *handle,
+                                        const char *resourceTypeName,
+                                        const char *resourceInterfaceName,
+                                        const char *uri,
+                                        OCEntityHandler entityHandler,
+                                        void* callbackParam,
+                                        uint8_t resourceProperties);
 
 /**
  * This function adds a resource to a collection resource.
@@ -504,6 +746,30 @@ OCNotifyListOfObservers (OCResourceHandle handle,
                             const OCRepPayload *payload,
                             OCQualityOfService qos);
 
+/**
+ * Notify specific observers, each with its own representation, in one pass.
+ * Unlike calling ::OCNotifyListOfObservers once per representation, the resource changes once
+ * and a payload given to several observers is encoded once.
+ *
+ * @param handle                    Handle of resource.
+ * @param obsIdList                 List of observation IDs that need to be notified.
+ * @param payloadList               Payload sent to each observer of obsIdList, an OCRepPayload
+ *                                  or an OCEncodedPayload sent as is.
+ * @param numberOfIds               Number of observation IDs included in obsIdList.
+ * @param qos                       Desired quality of service of the observation notifications.
+ *
+ * @note: The memory for obsIdList and payloadList is managed by the entity invoking the API.
+ *
+ * @return ::OC_STACK_OK when all the observers were notified, ::OC_STACK_NO_OBSERVERS when
+ *         none was, some other value upon failure.
+ */
+OCStackResult
+OCNotifyListOfObserversWithPayloads (OCResourceHandle handle,
+                                     OCObservationId *obsIdList,
+                                     const OCPayload **payloadList,
+                                     uint8_t numberOfIds,
+                                     OCQualityOfService qos);
+
 
 /**
  * This function sends a response to a request.
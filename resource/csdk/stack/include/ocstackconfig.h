@@ -54,11 +54,47 @@
 #define MAX_MANUFACTURER_URL_LENGTH (32)
 
 /**
- * Maximum number of resources which can be contained inside collection
- * resource.
+ * Former maximum number of resources contained inside a collection resource.
+ * Collections no longer limit their resources; kept for source compatibility.
  */
 #define MAX_CONTAINED_RESOURCES  (5)
 
+/**
+ * Maximum number of pre-encoded /oic/res responses, one per distinct discovery
+ * filter, kept by the server to answer repeated discovery requests.
+ */
+#define MAX_DISCOVERY_CACHE_ENTRIES (8)
+
+/**
+ * Number of properties from which a representation payload keeps a hash index of
+ * its values, so that getting and setting a property no longer walks the list.
+ */
+#define REP_PAYLOAD_INDEX_THRESHOLD (16)
+
+/**
+ * Largest encoded payload OCConvertPayload allocates. Larger payloads fail to
+ * convert with ::OC_STACK_NO_MEMORY instead of growing the buffer further.
+ */
+#define MAX_PAYLOAD_ENCODE_SIZE (64 * 1024)
+
+/**
+ * Scratch space allocated together with each server request, from which the
+ * response header options and encoded response payload are taken when they fit.
+ */
+#define SERVER_REQUEST_ARENA_SIZE (512)
+
+/**
+ * Time after which a server request that its entity handler never responded to is
+ * deleted. Responses sent after that are rejected.
+ */
+#define SERVER_REQUEST_TIMEOUT_SECONDS (2 * 60 * 60)  // 2 hours = 7200 seconds.
+
+/**
+ * Initial bucket count of the server request handle and token indexes.
+ * Must be a power of two.
+ */
+#define SERVER_REQUEST_INDEX_INITIAL_SIZE (16)
+
 /**
  *  Maximum number of vendor specific header options an application can set or receive
  *  in PDU
@@ -80,4 +116,10 @@
  */
 #define MAX_CB_TIMEOUT_SECONDS   (2 * 60 * 60)  // 2 hours = 7200 seconds.
 
+/**
+ * Time after which an executing ActionSet reports its aggregated result even if some
+ * member resources have not answered yet. Those members are reported as timed out.
+ */
+#define ACTIONSET_RESPONSE_TIMEOUT_SECONDS (30)
+
 #endif //OCSTACK_CONFIG_H_
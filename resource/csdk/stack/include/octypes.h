@@ -68,6 +68,10 @@ extern "C" {
 /** Gateway URI.*/
 #define OC_RSRVD_GATEWAY_URI                  "/oic/gateway"
 #endif
+#ifdef WITH_METRICS
+/** Monitoring URI through which the stack metrics are published.*/
+#define OC_RSRVD_MONITORING_URI               "/oic/mon"
+#endif
 #ifdef WITH_PRESENCE
 
 /** Presence URI through which the OIC devices advertise their presence.*/
@@ -143,6 +147,9 @@ extern "C" {
 /** To represent resource type with platform.*/
 #define OC_RSRVD_RESOURCE_TYPE_PLATFORM "oic.wk.p"
 
+/** To represent resource type with monitoring.*/
+#define OC_RSRVD_RESOURCE_TYPE_MONITORING "oic.wk.mon"
+
 /** To represent interface.*/
 #define OC_RSRVD_INTERFACE              "if"
 
@@ -734,6 +741,9 @@ typedef enum
      */
     OC_STACK_AUTHENTICATION_FAILURE,
 
+    /** Request cancelled with OCCancel before its response was received. */
+    OC_STACK_REQUEST_CANCELLED,
+
     /** Insert all new error codes here!.*/
     #ifdef WITH_PRESENCE
     OC_STACK_PRESENCE_STOPPED = 128,
@@ -760,6 +770,11 @@ typedef void * OCResourceHandle;
  */
 typedef void * OCRequestHandle;
 
+/**
+ * A virtual device hosted by the stack, see OCCreateContext().
+ */
+typedef struct OCStackContext OCStackContext;
+
 /**
  * Unique identifier for each observation request. Used when observations are
  * registered or de-registered. Used by entity handler to signal specific
@@ -959,9 +974,25 @@ typedef enum
     PAYLOAD_TYPE_REPRESENTATION,
     PAYLOAD_TYPE_SECURITY,
     PAYLOAD_TYPE_PRESENCE,
-    PAYLOAD_TYPE_RD
+    PAYLOAD_TYPE_RD,
+    PAYLOAD_TYPE_ENCODED
 } OCPayloadType;
 
+/** Enum to describe how received representation payloads are built by the parser.*/
+typedef enum
+{
+    /** Every node, name and value is allocated separately and may be modified.*/
+    OC_PAYLOAD_PARSE_DEFAULT = 0,
+
+    /** The whole payload is carved out of one arena, which makes parsing cheaper and
+     *  OCPayloadDestroy a single free. The payload must be treated as read-only.*/
+    OC_PAYLOAD_PARSE_ARENA,
+
+    /** The payload is not parsed, its CBOR encoding is handed out as an OCEncodedPayload
+     *  for callers decoding it themselves, such as the C++ OCRepresentation codec.*/
+    OC_PAYLOAD_PARSE_ENCODED
+} OCPayloadParseMode;
+
 typedef struct
 {
     // The type of message that was received
@@ -1046,6 +1077,12 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+    /** Hash index of values, built once the payload has many properties. The values list
+     *  keeps insertion order, so it must only be changed through the OCRepPayload API.*/
+    struct OCRepPayloadIndex* index;
+    /** Set when the payload was parsed with ::OC_PAYLOAD_PARSE_ARENA, the payload is
+     *  then read-only and all of its nodes are released with the top level payload.*/
+    struct OCPayloadArena* arena;
 } OCRepPayload;
 
 // used inside a discovery payload
@@ -1202,6 +1239,16 @@ typedef struct
     OCPayload base;
     char* securityData;
 } OCSecurityPayload;
+
+/** A representation kept in its CBOR encoding, sent and received as is.*/
+typedef struct
+{
+    OCPayload base;
+    /** CBOR encoding of the representation.*/
+    uint8_t* data;
+    /** Size of data in bytes.*/
+    size_t size;
+} OCEncodedPayload;
 #ifdef WITH_PRESENCE
 typedef struct
 {
@@ -1246,7 +1293,8 @@ typedef struct
     /** Pointer to the array of the received vendor specific header options.*/
     OCHeaderOption * rcvdVendorSpecificHeaderOptions;
 
-    /** the payload from the request PDU.*/
+    /** the payload from the request PDU. It is read-only and released once the entity
+     *  handler returns, so it must be cloned to be kept or modified.*/
     OCPayload *payload;
 
 } OCEntityHandlerRequest;
@@ -1410,6 +1458,48 @@ typedef struct OCCallbackData
 #endif
 } OCCallbackData;
 
+/**
+ * One request of a batch passed to OCDoResources, with the arguments OCDoResource takes.
+ */
+typedef struct
+{
+    /** Method to perform on the resource.*/
+    OCMethod method;
+
+    /** URI of the resource to interact with.*/
+    const char *requestUri;
+
+    /** Complete description of destination, NULL to use the address in requestUri.*/
+    const OCDevAddr *destination;
+
+    /** Request payload, owned by the stack once passed to OCDoResources.*/
+    OCPayload *payload;
+
+    /** Modifier flags when destination is not given.*/
+    OCConnectivityType connectivityType;
+
+    /** Quality of service.*/
+    OCQualityOfService qos;
+
+    /** Callback invoked for the responses to this request.*/
+    OCCallbackData cbData;
+
+    /** Vendor specific header options to be sent with the request.*/
+    OCHeaderOption *options;
+
+    /** Number of header options.*/
+    uint8_t numOptions;
+
+    /** Parse mode of the responses as for OCDoResourceWithParseMode.*/
+    OCPayloadParseMode parseMode;
+
+    /** Set by the stack to the handle of the request, NULL if it was not sent.*/
+    OCDoHandle handle;
+
+    /** Set by the stack to the result of the request.*/
+    OCStackResult result;
+} OCDoResourceRequest;
+
 /**
  * Application server implementations must implement this callback to consume requests OTA.
  * Entity handler callback needs to fill the resPayload of the entityHandlerRequest.
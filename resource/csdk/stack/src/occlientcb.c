@@ -84,6 +84,9 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             cbNode->handle = *handle;
             cbNode->method = method;
             cbNode->sequenceNumber = 0;
+            cbNode->callBackLocked = false;
+            cbNode->holdCount = 0;
+            cbNode->deletePending = false;
 #ifdef WITH_PRESENCE
             cbNode->presence = NULL;
             cbNode->filterResourceType = NULL;
@@ -145,47 +148,56 @@ exit:
     return OC_STACK_NO_MEMORY;
 }
 
-void DeleteClientCB(ClientCB * cbNode)
+static void FreeClientCB(ClientCB *cbNode)
 {
-    if (cbNode)
+    OIC_LOG (INFO, TAG, "Deleting token");
+    OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
+    CADestroyToken (cbNode->token);
+    OICFree(cbNode->devAddr);
+    OICFree(cbNode->handle);
+    OIC_LOG_V (INFO, TAG, "Deleting callback with uri %s", cbNode->requestUri);
+    OICFree(cbNode->requestUri);
+    if (cbNode->deleteCallback)
     {
-        LL_DELETE(cbList, cbNode);
-        OIC_LOG (INFO, TAG, "Deleting token");
-        OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
-        CADestroyToken (cbNode->token);
-        OICFree(cbNode->devAddr);
-        OICFree(cbNode->handle);
-        OIC_LOG_V (INFO, TAG, "Deleting callback with uri %s", cbNode->requestUri);
-        OICFree(cbNode->requestUri);
-        if (cbNode->deleteCallback)
-        {
-            cbNode->deleteCallback(cbNode->context);
-        }
+        cbNode->deleteCallback(cbNode->context);
+    }
 
 #ifdef WITH_PRESENCE
-        if (cbNode->presence)
+    if (cbNode->presence)
+    {
+        OICFree(cbNode->presence->timeOut);
+        OICFree(cbNode->presence);
+    }
+    if (cbNode->method == OC_REST_PRESENCE)
+    {
+        OCResourceType * pointer = cbNode->filterResourceType;
+        OCResourceType * next = NULL;
+        while(pointer)
         {
-            OICFree(cbNode->presence->timeOut);
-            OICFree(cbNode->presence);
+            next = pointer->next;
+            OICFree(pointer->resourcetypename);
+            OICFree(pointer);
+            pointer = next;
         }
-        if (cbNode->method == OC_REST_PRESENCE)
+    }
+#endif // WITH_PRESENCE
+    OICFree(cbNode);
+}
+
+void DeleteClientCB(ClientCB * cbNode)
+{
+    if (cbNode && !cbNode->deletePending)
+    {
+        LL_DELETE(cbList, cbNode);
+        if (cbNode->holdCount)
         {
-            OCResourceType * pointer = cbNode->filterResourceType;
-            OCResourceType * next = NULL;
-            while(pointer)
-            {
-                next = pointer->next;
-                OICFree(pointer->resourcetypename);
-                OICFree(pointer);
-                pointer = next;
-            }
+            // The callback is running, the node goes once it returns
+            cbNode->deletePending = true;
+            return;
         }
-#endif // WITH_PRESENCE
-        OICFree(cbNode);
-        cbNode = NULL;
+        FreeClientCB(cbNode);
     }
 }
-
 /*
  * This function checks if the node is past its time to live and
  * deletes it if timed-out. Calling this function with a  presence or observe
@@ -217,13 +229,14 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
         OCDoHandle handle, const char * requestUri)
 {
     ClientCB* out = NULL;
+    ClientCB* tmp = NULL;
 
     if (token && *token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
     {
         OIC_LOG (INFO, TAG,  "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
         OIC_LOG(INFO, TAG, "\tFound in callback list");
-        LL_FOREACH(cbList, out)
+        LL_FOREACH_SAFE(cbList, out, tmp)
         {
             OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
 
@@ -236,7 +249,7 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     }
     else if (handle)
     {
-        LL_FOREACH(cbList, out)
+        LL_FOREACH_SAFE(cbList, out, tmp)
         {
             if (out->handle == handle)
             {
@@ -248,7 +261,7 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     else if (requestUri)
     {
         OIC_LOG_V(INFO, TAG, "Looking for uri %s", requestUri);
-        LL_FOREACH(cbList, out)
+        LL_FOREACH_SAFE(cbList, out, tmp)
         {
             OIC_LOG_V(INFO, TAG, "\tFound %s", out->requestUri);
             if (out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
@@ -285,6 +298,22 @@ OCStackResult InsertResourceTypeFilter(ClientCB * cbNode, char * resourceTypeNam
 }
 #endif // WITH_PRESENCE
 
+void HoldClientCB(ClientCB *cbNode)
+{
+    cbNode->holdCount++;
+}
+
+bool ReleaseClientCB(ClientCB *cbNode)
+{
+    if (--cbNode->holdCount || !cbNode->deletePending)
+    {
+        return !cbNode->deletePending;
+    }
+    // Already unlinked by DeleteClientCB
+    FreeClientCB(cbNode);
+    return false;
+}
+
 void DeleteClientCBList()
 {
     ClientCB* out;
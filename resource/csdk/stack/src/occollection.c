@@ -36,6 +36,12 @@
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "payload_logging.h"
+#include "ocserverrequest.h"
+#include "utlist.h"
+#ifndef WITH_ARDUINO
+#include "camutex.h"
+#include "cathreadpool.h"
+#endif
 
 /// Module Name
 #include <stdio.h>
@@ -49,6 +55,62 @@
 #define NUM_PARAM_IN_QUERY   2 // The expected number of parameters in a query
 #define NUM_FIELDS_IN_QUERY  2 // The expected number of fields in a query
 
+typedef struct BatchJob BatchJob;
+
+/**
+ * Child entity handler call of a batch request, run in turn or by a batch worker.
+ */
+typedef struct BatchTask
+{
+    /** Entity handler of the child resource, copied as the resource may be deleted while
+     *  the task is queued or the handler runs.*/
+    OCEntityHandler entityHandler;
+
+    /** Callback parameter of the entity handler.*/
+    void *callbackParam;
+
+    /** Whether the entity handler runs with the lock of the stack held.*/
+    bool locked;
+
+    /** Copy of the collection request, pointing at the child resource.*/
+    OCEntityHandlerRequest ehRequest;
+
+    /** Batch request the task belongs to.*/
+    BatchJob *job;
+
+    struct BatchTask *next;
+} BatchTask;
+
+#ifndef WITH_ARDUINO
+/**
+ * Batch request dispatched to the batch workers. The stack frees the payload of the
+ * collection request once the collection handler returns, the job owns a copy for its
+ * tasks.
+ */
+struct BatchJob
+{
+    /** One task per child resource.*/
+    BatchTask *tasks;
+
+    /** Copy of the request payload, shared by the tasks.*/
+    OCPayload *payload;
+
+    /** Number of unfinished tasks, the last one frees the job.*/
+    uint32_t pending;
+};
+
+/** Number of batch worker threads, 0 when child handlers are called in turn. Changed with
+ *  the lock of the stack held.*/
+static uint32_t batchWorkerCount = 0;
+static ca_thread_pool_t batchThreadPool = NULL;
+
+/** Protects the task queue, pending counts and the stop flag.*/
+static ca_mutex batchQueueMutex = NULL;
+static ca_cond batchQueueCond = NULL;
+static BatchTask *batchQueue = NULL;
+static bool batchWorkersStop = false;
+#endif
+
 static OCStackResult CheckRTParamSupport(const OCResource* resource, const char* rtPtr)
 {
     if (!resource || !rtPtr)
@@ -278,6 +340,265 @@ HandleLinkedListInterface(OCEntityHandlerRequest *ehRequest,
     return ret;
 }
 
+static OCEntityHandlerResult RunBatchTask(BatchTask *task)
+{
+    return OCStackCallEntityHandler(task->entityHandler, task->callbackParam, task->locked,
+                                    OC_REQUEST_FLAG, &task->ehRequest);
+}
+
+/**
+ * Fill one task per child of a collection, each with a copy of the collection request
+ * pointing at the child.
+ */
+static void FillBatchTasks(BatchTask *tasks, uint32_t numTasks,
+                           OCEntityHandlerRequest *ehRequest, OCResource *collResource)
+{
+    OCChildResource *child = collResource->rsrcChildResourcesHead;
+    for (uint32_t i = 0; i < numTasks; i++, child = child->next)
+    {
+        tasks[i].entityHandler = child->rsrcResource->entityHandler;
+        tasks[i].callbackParam = child->rsrcResource->entityHandlerCallbackParam;
+        tasks[i].locked = child->rsrcResource->entityHandlerLocked;
+        tasks[i].ehRequest = *ehRequest;
+        tasks[i].ehRequest.resource = (OCResourceHandle) child->rsrcResource;
+    }
+}
+
+static uint32_t CountBatchChildren(OCResource *collResource)
+{
+    uint32_t numChildren = 0;
+    for (OCChildResource *child = collResource->rsrcChildResourcesHead;
+         child && child->rsrcResource; child = child->next)
+    {
+        numChildren++;
+    }
+    return numChildren;
+}
+
+/**
+ * Call the entity handlers of all children of a collection in turn. Handlers of the
+ * application run without the lock of the stack and may answer meanwhile, so the request
+ * is pinned until the results are in.
+ */
+static OCStackResult
+RunBatchChildren(OCEntityHandlerRequest *ehRequest, OCResource *collResource)
+{
+    uint32_t numChildren = CountBatchChildren(collResource);
+    if (!numChildren)
+    {
+        return OC_STACK_OK;
+    }
+
+    BatchTask *tasks = (BatchTask *)OICCalloc(numChildren, sizeof(BatchTask));
+    if (!tasks)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    FillBatchTasks(tasks, numChildren, ehRequest, collResource);
+
+    // The last child response sends the aggregate response and deletes the request
+    OCServerRequest *request = (OCServerRequest *)ehRequest->requestHandle;
+    PinServerRequest(request);
+
+    // The default collection handler is returning as OK
+    OCStackResult stackRet = OC_STACK_OK;
+    for (uint32_t i = 0; i < numChildren; i++)
+    {
+        // if a single resource is slow, then entire response will be treated
+        // as slow response
+        if (RunBatchTask(&tasks[i]) == OC_EH_SLOW)
+        {
+            stackRet = EntityHandlerCodeToOCStackCode(OC_EH_SLOW);
+        }
+    }
+    if (UnpinServerRequest(request) && stackRet == OC_STACK_SLOW_RESOURCE)
+    {
+        OIC_LOG(INFO, TAG, "This is a slow resource");
+        request->slowFlag = 1;
+    }
+    OICFree(tasks);
+    return stackRet;
+}
+
+#ifndef WITH_ARDUINO
+static void FreeBatchJob(BatchJob *job)
+{
+    OCPayloadDestroy(job->payload);
+    OICFree(job->tasks);
+    OICFree(job);
+}
+
+static void BatchWorker(void *data)
+{
+    (void)data;
+
+    ca_mutex_lock(batchQueueMutex);
+    // Tasks queued before the workers were stopped are still run
+    while (batchQueue || !batchWorkersStop)
+    {
+        BatchTask *task = batchQueue;
+        if (!task)
+        {
+            ca_cond_wait(batchQueueCond, batchQueueMutex);
+            continue;
+        }
+        LL_DELETE(batchQueue, task);
+        ca_mutex_unlock(batchQueueMutex);
+
+        // The batch is a slow response already, the child answers through OCDoResponse
+        RunBatchTask(task);
+
+        ca_mutex_lock(batchQueueMutex);
+        BatchJob *job = task->job;
+        if (--job->pending == 0)
+        {
+            ca_mutex_unlock(batchQueueMutex);
+            FreeBatchJob(job);
+            ca_mutex_lock(batchQueueMutex);
+        }
+    }
+    ca_mutex_unlock(batchQueueMutex);
+}
+
+/**
+ * Queue the entity handlers of all children of a collection on the batch workers and
+ * return without waiting for them. The request becomes a slow response: children respond
+ * through OCDoResponse as they complete and the last response sends the aggregate, so a
+ * batch costs the slowest child rather than the sum of all children. Called with the lock
+ * of the stack held, which the workers take to answer, so they wait for the request to be
+ * marked slow.
+ */
+static OCStackResult
+DispatchBatchChildren(OCEntityHandlerRequest *ehRequest, OCResource *collResource)
+{
+    uint32_t numChildren = CountBatchChildren(collResource);
+    if (!numChildren)
+    {
+        return OC_STACK_OK;
+    }
+
+    BatchJob *job = (BatchJob *)OICCalloc(1, sizeof(BatchJob));
+    if (!job)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    job->tasks = (BatchTask *)OICCalloc(numChildren, sizeof(BatchTask));
+    if (ehRequest->payload && PAYLOAD_TYPE_REPRESENTATION == ehRequest->payload->type)
+    {
+        job->payload = (OCPayload *)OCRepPayloadClone((OCRepPayload *)ehRequest->payload);
+    }
+    if (!job->tasks || (ehRequest->payload && !job->payload))
+    {
+        FreeBatchJob(job);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    FillBatchTasks(job->tasks, numChildren, ehRequest, collResource);
+    for (uint32_t i = 0; i < numChildren; i++)
+    {
+        job->tasks[i].ehRequest.payload = job->payload;
+        job->tasks[i].job = job;
+    }
+    job->pending = numChildren;
+
+    OIC_LOG(INFO, TAG, "Batch request dispatched to the workers as a slow resource");
+    ((OCServerRequest *)ehRequest->requestHandle)->slowFlag = 1;
+
+    ca_mutex_lock(batchQueueMutex);
+    for (uint32_t i = 0; i < numChildren; i++)
+    {
+        LL_APPEND(batchQueue, &job->tasks[i]);
+    }
+    ca_cond_broadcast(batchQueueCond);
+    ca_mutex_unlock(batchQueueMutex);
+
+    return EntityHandlerCodeToOCStackCode(OC_EH_SLOW);
+}
+
+static void FreeBatchWorkerSync()
+{
+    ca_cond_free(batchQueueCond);
+    ca_mutex_free(batchQueueMutex);
+    batchQueueCond = NULL;
+    batchQueueMutex = NULL;
+}
+#endif
+
+OCStackResult SetCollectionBatchWorkers(uint32_t numWorkers)
+{
+#ifndef WITH_ARDUINO
+    TerminateCollectionBatchWorkers();
+    if (!numWorkers)
+    {
+        return OC_STACK_OK;
+    }
+
+    batchQueueMutex = ca_mutex_new();
+    batchQueueCond = ca_cond_new();
+    if (!batchQueueMutex || !batchQueueCond)
+    {
+        FreeBatchWorkerSync();
+        return OC_STACK_NO_MEMORY;
+    }
+
+    if (CA_STATUS_OK != ca_thread_pool_init(numWorkers, &batchThreadPool))
+    {
+        FreeBatchWorkerSync();
+        return OC_STACK_ERROR;
+    }
+
+    batchWorkersStop = false;
+    uint32_t startedWorkers = 0;
+    for (uint32_t i = 0; i < numWorkers; i++)
+    {
+        if (CA_STATUS_OK != ca_thread_pool_add_task(batchThreadPool, BatchWorker, NULL))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to start batch worker");
+            break;
+        }
+        startedWorkers++;
+    }
+
+    OCStackLock();
+    batchWorkerCount = startedWorkers;
+    OCStackUnlock();
+    if (!batchWorkerCount)
+    {
+        TerminateCollectionBatchWorkers();
+        return OC_STACK_ERROR;
+    }
+    return OC_STACK_OK;
+#else
+    (void)numWorkers;
+    return OC_STACK_NOTIMPL;
+#endif
+}
+
+void TerminateCollectionBatchWorkers()
+{
+#ifndef WITH_ARDUINO
+    if (!batchThreadPool)
+    {
+        return;
+    }
+
+    // Taken with the lock of the stack, which batches are dispatched with, so that no
+    // batch goes to the workers anymore. The workers answer with the lock of the stack, so
+    // it is not held while they are joined.
+    OCStackLock();
+    ca_mutex_lock(batchQueueMutex);
+    batchWorkersStop = true;
+    batchWorkerCount = 0;
+    ca_cond_broadcast(batchQueueCond);
+    ca_mutex_unlock(batchQueueMutex);
+    OCStackUnlock();
+
+    ca_thread_pool_free(batchThreadPool);
+    batchThreadPool = NULL;
+    FreeBatchWorkerSync();
+#endif
+}
+
 static OCStackResult
 HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
 {
@@ -287,7 +608,6 @@ HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
     }
 
     OCResource * collResource = (OCResource *) ehRequest->resource;
-    OCChildResource *tempChildResource = NULL;
 
     OCRepPayload* payload = OCRepPayloadCreate();
     if (!payload)
@@ -310,55 +630,22 @@ HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
 
     if (stackRet == OC_STACK_OK)
     {
-        tempChildResource = collResource->rsrcChildResourcesHead;
-
-        while(tempChildResource)
+#ifndef WITH_ARDUINO
+        if (batchWorkerCount)
         {
-            OCResource* tempRsrcResource = tempChildResource->rsrcResource;
-
-            if (tempRsrcResource)
-            {
-                // Note that all entity handlers called through a collection
-                // will get the same pointer to ehRequest, the only difference
-                // is ehRequest->resource
-                ehRequest->resource = (OCResourceHandle) tempRsrcResource;
-
-                OCEntityHandlerResult ehResult = tempRsrcResource->entityHandler(OC_REQUEST_FLAG, ehRequest,
-                                                        tempRsrcResource->entityHandlerCallbackParam);
-
-                // The default collection handler is returning as OK
-                if (stackRet != OC_STACK_SLOW_RESOURCE)
-                {
-                    stackRet = OC_STACK_OK;
-                }
-                // if a single resource is slow, then entire response will be treated
-                // as slow response
-                if (ehResult == OC_EH_SLOW)
-                {
-                    OIC_LOG(INFO, TAG, "This is a slow resource");
-                    ((OCServerRequest *)ehRequest->requestHandle)->slowFlag = 1;
-                    stackRet = EntityHandlerCodeToOCStackCode(ehResult);
-                }
-            }
-            else
-            {
-                break;
-            }
-
-            tempChildResource = tempChildResource->next;
-
+            return DispatchBatchChildren(ehRequest, collResource);
         }
-
-        ehRequest->resource = (OCResourceHandle) collResource;
+#endif
+        stackRet = RunBatchChildren(ehRequest, collResource);
     }
     return stackRet;
 }
 
-uint8_t GetNumOfResourcesInCollection (OCResource *resource)
+uint32_t GetNumOfResourcesInCollection (OCResource *resource)
 {
     if (resource)
     {
-        uint8_t num = 0;
+        uint32_t num = 0;
         OCChildResource *tempChildResource = NULL;
 
         tempChildResource = resource->rsrcChildResourcesHead;
@@ -373,7 +660,7 @@ uint8_t GetNumOfResourcesInCollection (OCResource *resource)
     }
     else
     {
-        return -1;
+        return 0;
     }
 }
 
@@ -0,0 +1,165 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file implements the monitoring resource, which publishes the stack metrics
+ * kept in oic_metrics as a read only representation.
+ */
+
+#include <string.h>
+#include "ocstack.h"
+#include "ocpayload.h"
+#include "oic_metrics.h"
+#include "logger.h"
+
+#define TAG "OIC_RI_MONITOR"
+
+/** Handle of the monitoring resource, NULL while it is not created. */
+static OCResourceHandle g_monitoringHandle = NULL;
+
+/**
+ * Builds a payload holding every metric as an integer and every histogram as an
+ * integer array of its buckets.
+ *
+ * @return the payload, NULL on allocation failure.
+ */
+static OCRepPayload *BuildMonitoringPayload()
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    OCRepPayloadSetUri(payload, OC_RSRVD_MONITORING_URI);
+
+    for (int id = 0; id < OIC_METRIC_COUNT; id++)
+    {
+        if (!OCRepPayloadSetPropInt(payload, OICMetricName((OICMetricId)id),
+                                    OICMetricGet((OICMetricId)id)))
+        {
+            goto error;
+        }
+    }
+
+    for (int id = 0; id < OIC_HISTOGRAM_COUNT; id++)
+    {
+        uint32_t buckets[OIC_HISTOGRAM_BUCKETS];
+        int64_t values[OIC_HISTOGRAM_BUCKETS];
+        size_t dimensions[MAX_REP_ARRAY_DEPTH] = {OIC_HISTOGRAM_BUCKETS, 0, 0};
+
+        OICHistogramGet((OICHistogramId)id, buckets);
+        for (size_t i = 0; i < OIC_HISTOGRAM_BUCKETS; i++)
+        {
+            values[i] = buckets[i];
+        }
+        if (!OCRepPayloadSetIntArray(payload, OICHistogramName((OICHistogramId)id),
+                                     values, dimensions))
+        {
+            goto error;
+        }
+    }
+    return payload;
+
+error:
+    OCRepPayloadDestroy(payload);
+    return NULL;
+}
+
+static OCEntityHandlerResult MonitoringEntityHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *entityHandlerRequest, void *callbackParam)
+{
+    (void)callbackParam;
+
+    if (!(flag & OC_REQUEST_FLAG) || !entityHandlerRequest)
+    {
+        return OC_EH_ERROR;
+    }
+
+    if (OC_REST_GET != entityHandlerRequest->method)
+    {
+        OIC_LOG_V(INFO, TAG, "Method %d not supported by the monitoring resource",
+                  entityHandlerRequest->method);
+        return OC_EH_ERROR;
+    }
+
+    OCRepPayload *payload = BuildMonitoringPayload();
+    if (!payload)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to build the monitoring payload");
+        return OC_EH_ERROR;
+    }
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+
+    OCEntityHandlerResult ehResult = OC_EH_OK;
+    if (OC_STACK_OK != OCDoResponse(&response))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to send the monitoring response");
+        ehResult = OC_EH_ERROR;
+    }
+    OCRepPayloadDestroy(payload);
+    return ehResult;
+}
+
+OCStackResult OCStartMonitoringResource()
+{
+    if (g_monitoringHandle)
+    {
+        return OC_STACK_OK;
+    }
+
+    OCStackResult result = OCCreateResource(&g_monitoringHandle,
+                                            OC_RSRVD_RESOURCE_TYPE_MONITORING,
+                                            OC_RSRVD_INTERFACE_READ,
+                                            OC_RSRVD_MONITORING_URI,
+                                            MonitoringEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Create resource for monitoring failed[%d]", result);
+        g_monitoringHandle = NULL;
+    }
+    return result;
+}
+
+OCStackResult OCStopMonitoringResource()
+{
+    if (!g_monitoringHandle)
+    {
+        return OC_STACK_ERROR;
+    }
+
+    OCStackResult result = OCDeleteResource(g_monitoringHandle);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Delete resource for monitoring failed[%d]", result);
+    }
+    g_monitoringHandle = NULL;
+    return result;
+}
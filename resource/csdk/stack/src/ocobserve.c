@@ -27,7 +27,9 @@
 #include "ocrandom.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_metrics.h"
 #include "ocpayload.h"
+#include "ocpayloadcbor.h"
 #include "ocserverrequest.h"
 #include "logger.h"
 
@@ -111,19 +113,47 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
-    uint8_t numObs = 0;
+    ResourceObserver * resourceObserver = NULL;
+    size_t numObs = 0;
     OCServerRequest * request = NULL;
     OCEntityHandlerRequest ehRequest = {0};
     OCEntityHandlerResult ehResult = OC_EH_ERROR;
     bool observeErrorFlag = false;
+    bool resourceDeleted = false;
 
-    // Find clients that are observing this resource
-    while (resourceObserver)
+    // Find clients that are observing this resource. The entity handler runs without the
+    // lock of the stack and may change the observer list, so they are kept by ID.
+    LL_FOREACH(g_serverObsList, resourceObserver)
     {
         if (resourceObserver->resource == resPtr)
         {
             numObs++;
+        }
+    }
+    if (numObs == 0)
+    {
+        OIC_LOG(INFO, TAG, "Resource has no observers");
+        return OC_STACK_NO_OBSERVERS;
+    }
+    OCObservationId *observeIds = (OCObservationId *) OICMalloc(numObs * sizeof(*observeIds));
+    if (!observeIds)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    size_t index = 0;
+    LL_FOREACH(g_serverObsList, resourceObserver)
+    {
+        if (resourceObserver->resource == resPtr)
+        {
+            observeIds[index++] = resourceObserver->observeId;
+        }
+    }
+
+    for (index = 0; index < numObs; index++)
+    {
+        resourceObserver = GetObserverUsingId(observeIds[index]);
+        if (resourceObserver && resourceObserver->resource == resPtr)
+        {
 #ifdef WITH_PRESENCE
             if (method != OC_REST_PRESENCE)
             {
@@ -158,14 +188,20 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
                                     0);
                         if (result == OC_STACK_OK)
                         {
-                            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
-                                                resPtr->entityHandlerCallbackParam);
-                            if (ehResult == OC_EH_ERROR)
+                            PinServerRequest(request);
+                            ehResult = OCStackCallEntityHandler(resPtr->entityHandler,
+                                                resPtr->entityHandlerCallbackParam,
+                                                resPtr->entityHandlerLocked,
+                                                OC_REQUEST_FLAG, &ehRequest);
+                            // The request is gone if the handler responded meanwhile
+                            if (UnpinServerRequest(request) && ehResult == OC_EH_ERROR)
                             {
                                 FindAndDeleteServerRequest(request);
                             }
                         }
                         OCPayloadDestroy(ehRequest.payload);
+                        // The handler or another thread may delete the resource meanwhile
+                        resourceDeleted = !IsResourceInStack((OCResourceHandle) resPtr);
                     }
                 }
 #ifdef WITH_PRESENCE
@@ -191,6 +227,7 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
 
                     if (!presenceResBuf)
                     {
+                        OICFree(observeIds);
                         return OC_STACK_NO_MEMORY;
                     }
 
@@ -216,16 +253,19 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
             {
                 observeErrorFlag = true;
             }
+            else
+            {
+                OIC_METRIC_INC(OIC_METRIC_NOTIFICATIONS_SENT);
+            }
+            if (resourceDeleted)
+            {
+                break;
+            }
         }
-        resourceObserver = resourceObserver->next;
     }
+    OICFree(observeIds);
 
-    if (numObs == 0)
-    {
-        OIC_LOG(INFO, TAG, "Resource has no observers");
-        result = OC_STACK_NO_OBSERVERS;
-    }
-    else if (observeErrorFlag)
+    if (observeErrorFlag)
     {
         OIC_LOG(ERROR, TAG, "Observer notification error");
         result = OC_STACK_ERROR;
@@ -233,6 +273,124 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     return result;
 }
 
+/**
+ * Encode the payload of a notification, unless it already is encoded.
+ *
+ * @param payload   Representation or encoded payload of the notification.
+ * @param encoded   Encoded payload, to release with OCPayloadDestroy when it is not payload.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult EncodeNotificationPayload(const OCPayload *payload, OCPayload **encoded)
+{
+    if (PAYLOAD_TYPE_ENCODED == payload->type)
+    {
+        *encoded = (OCPayload *)payload;
+        return OC_STACK_OK;
+    }
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    OCStackResult result = OCConvertPayload((OCPayload *)payload, &data, &size);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG(ERROR, TAG, "Error encoding notification payload");
+        return result;
+    }
+
+    *encoded = (OCPayload *)OCEncodedPayloadCreate(data, size);
+    if (!*encoded)
+    {
+        OICFree(data);
+        return OC_STACK_NO_MEMORY;
+    }
+    return OC_STACK_OK;
+}
+
+/**
+ * Send an encoded notification to one observer of a resource.
+ *
+ * @param resource   Observed resource.
+ * @param obsId      Observation ID of the observer.
+ * @param payload    Encoded payload of the notification.
+ * @param qos        Desired quality of service of the notification.
+ *
+ * @return ::OC_STACK_OK when notified, ::OC_STACK_NO_OBSERVERS when the resource has no such
+ *         observer, some other value upon failure.
+ */
+static OCStackResult SendObserverNotification(OCResource *resource, OCObservationId obsId,
+                                              OCPayload *payload, OCQualityOfService qos)
+{
+    ResourceObserver *observer = GetObserverUsingId(obsId);
+    if (!observer || observer->resource != resource)
+    {
+        return OC_STACK_NO_OBSERVERS;
+    }
+
+    OCServerRequest *request = NULL;
+    qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
+    OCStackResult result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+            0, resource->sequenceNum, qos, observer->query,
+            NULL, NULL, observer->token, observer->tokenLength,
+            observer->resUri, 0, observer->acceptFormat,
+            &observer->devAddr);
+    if (OC_STACK_OK != result || !request)
+    {
+        FindAndDeleteServerRequest(request);
+        return (OC_STACK_OK != result) ? result : OC_STACK_ERROR;
+    }
+    request->observeResult = OC_STACK_OK;
+
+    OCEntityHandlerResponse ehResponse = {0};
+    ehResponse.ehResult = OC_EH_OK;
+    ehResponse.payload = payload;
+    ehResponse.persistentBufferFlag = 0;
+    ehResponse.requestHandle = (OCRequestHandle) request;
+    ehResponse.resourceHandle = (OCResourceHandle) resource;
+    result = OCDoResponse(&ehResponse);
+    if (OC_STACK_OK == result)
+    {
+        OIC_LOG_V(INFO, TAG, "Observer id %d notified.", obsId);
+        OIC_METRIC_INC(OIC_METRIC_NOTIFICATIONS_SENT);
+    }
+    else
+    {
+        OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", obsId);
+    }
+
+    // Sending the response deletes the request, unless it failed before
+    FindAndDeleteServerRequest(request);
+    return result;
+}
+
+/**
+ * Result of notifying a list of observers.
+ *
+ * @param numSentNotification   Number of observers notified.
+ * @param numberOfIds           Number of observers to notify.
+ * @param observeErrorFlag      Whether notifying an observer failed.
+ *
+ * @return ::OC_STACK_OK when all were notified, ::OC_STACK_NO_OBSERVERS when none was,
+ *         ::OC_STACK_ERROR otherwise.
+ */
+static OCStackResult ListNotificationResult(uint8_t numSentNotification, uint8_t numberOfIds,
+                                            bool observeErrorFlag)
+{
+    if (numSentNotification == numberOfIds && !observeErrorFlag)
+    {
+        return OC_STACK_OK;
+    }
+    else if (numSentNotification == 0)
+    {
+        return OC_STACK_NO_OBSERVERS;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "Observer notification error");
+        return OC_STACK_ERROR;
+    }
+}
+
 OCStackResult SendListObserverNotification (OCResource * resource,
         OCObservationId  *obsIdList, uint8_t numberOfIds,
         const OCRepPayload *payload,
@@ -245,94 +403,119 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         return OC_STACK_INVALID_PARAM;
     }
 
-    uint8_t numIds = numberOfIds;
-    ResourceObserver *observer = NULL;
+    OIC_LOG(INFO, TAG, "Entering SendListObserverNotification");
+
+    // Encoded once for all the observers
+    OCPayload *encoded = NULL;
+    OCStackResult result = EncodeNotificationPayload((const OCPayload *)payload, &encoded);
+    if (OC_STACK_OK != result)
+    {
+        return result;
+    }
+
     uint8_t numSentNotification = 0;
-    OCServerRequest * request = NULL;
-    OCStackResult result = OC_STACK_ERROR;
     bool observeErrorFlag = false;
-
-    OIC_LOG(INFO, TAG, "Entering SendListObserverNotification");
-    while(numIds)
+    for (uint8_t i = 0; i < numberOfIds; i++)
     {
-        observer = GetObserverUsingId (*obsIdList);
-        if (observer)
+        result = SendObserverNotification(resource, obsIdList[i], encoded, qos);
+        if (OC_STACK_OK == result)
         {
-            // Found observer - verify if it matches the resource handle
-            if (observer->resource == resource)
-            {
-                qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
-
-
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resource->sequenceNum, qos, observer->query,
-                        NULL, NULL, observer->token, observer->tokenLength,
-                        observer->resUri, 0, observer->acceptFormat,
-                        &observer->devAddr);
+            numSentNotification++;
+        }
+        else if (OC_STACK_NO_OBSERVERS != result)
+        {
+            observeErrorFlag = true;
+        }
+    }
 
-                if (request)
-                {
-                    request->observeResult = OC_STACK_OK;
-                    if (result == OC_STACK_OK)
-                    {
-                        OCEntityHandlerResponse ehResponse = {0};
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
-                        if (!ehResponse.payload)
-                        {
-                            FindAndDeleteServerRequest(request);
-                            continue;
-                        }
-                        memcpy(ehResponse.payload, payload, sizeof(*payload));
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        ehResponse.resourceHandle = (OCResourceHandle) resource;
-                        result = OCDoResponse(&ehResponse);
-                        if (result == OC_STACK_OK)
-                        {
-                            OIC_LOG_V(INFO, TAG, "Observer id %d notified.", *obsIdList);
+    if (encoded != (OCPayload *)payload)
+    {
+        OCPayloadDestroy(encoded);
+    }
+    return ListNotificationResult(numSentNotification, numberOfIds, observeErrorFlag);
+}
 
-                            // Increment only if OCDoResponse is successful
-                            numSentNotification++;
+/**
+ * Payload of a notification and its encoding.
+ */
+typedef struct
+{
+    const OCPayload *payload;
+    OCPayload *encoded;
+} NotificationEncoding;
 
-                            OICFree(ehResponse.payload);
-                            FindAndDeleteServerRequest(request);
-                        }
-                        else
-                        {
-                            OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", *obsIdList);
-                        }
-                    }
-                    else
-                    {
-                        FindAndDeleteServerRequest(request);
-                    }
-                }
-                // Since we are in a loop, set an error flag to indicate
-                // at least one error occurred.
-                if (result != OC_STACK_OK)
-                {
-                    observeErrorFlag = true;
-                }
-            }
+OCStackResult SendObserverNotificationList (OCResource *resource,
+        OCObservationId *obsIdList, const OCPayload **payloadList, uint8_t numberOfIds,
+        OCQualityOfService qos)
+{
+    if (!resource || !obsIdList || !payloadList)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    for (uint8_t i = 0; i < numberOfIds; i++)
+    {
+        if (!payloadList[i])
+        {
+            return OC_STACK_INVALID_PARAM;
         }
-        obsIdList++;
-        numIds--;
     }
-
-    if (numSentNotification == numberOfIds && !observeErrorFlag)
+    if (0 == numberOfIds)
     {
         return OC_STACK_OK;
     }
-    else if (numSentNotification == 0)
+
+    OIC_LOG(INFO, TAG, "Entering SendObserverNotificationList");
+
+    // Each distinct payload is encoded once, for the first observer it is sent to
+    NotificationEncoding *encodings =
+            (NotificationEncoding *)OICCalloc(numberOfIds, sizeof(NotificationEncoding));
+    if (!encodings)
     {
-        return OC_STACK_NO_OBSERVERS;
+        return OC_STACK_NO_MEMORY;
     }
-    else
+    size_t numEncodings = 0;
+
+    uint8_t numSentNotification = 0;
+    bool observeErrorFlag = false;
+    for (uint8_t i = 0; i < numberOfIds; i++)
     {
-        OIC_LOG(ERROR, TAG, "Observer notification error");
-        return OC_STACK_ERROR;
+        size_t e = 0;
+        while (e < numEncodings && encodings[e].payload != payloadList[i])
+        {
+            e++;
+        }
+        if (e == numEncodings)
+        {
+            if (OC_STACK_OK != EncodeNotificationPayload(payloadList[i], &encodings[e].encoded))
+            {
+                observeErrorFlag = true;
+                continue;
+            }
+            encodings[e].payload = payloadList[i];
+            numEncodings++;
+        }
+
+        OCStackResult result = SendObserverNotification(resource, obsIdList[i],
+                                                        encodings[e].encoded, qos);
+        if (OC_STACK_OK == result)
+        {
+            numSentNotification++;
+        }
+        else if (OC_STACK_NO_OBSERVERS != result)
+        {
+            observeErrorFlag = true;
+        }
+    }
+
+    for (size_t e = 0; e < numEncodings; e++)
+    {
+        if (encodings[e].encoded != (OCPayload *)encodings[e].payload)
+        {
+            OCPayloadDestroy(encodings[e].encoded);
+        }
     }
+    OICFree(encodings);
+    return ListNotificationResult(numSentNotification, numberOfIds, observeErrorFlag);
 }
 
 OCStackResult GenerateObserverId (OCObservationId *observationId)
@@ -410,6 +593,7 @@ OCStackResult AddObserver (const char         *resUri,
         obsNode->resource = resHandle;
 
         LL_APPEND (g_serverObsList, obsNode);
+        OIC_METRIC_INC(OIC_METRIC_OBSERVERS);
 
         return OC_STACK_OK;
     }
@@ -483,6 +667,7 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
         LL_DELETE (g_serverObsList, obsNode);
+        OIC_METRIC_DEC(OIC_METRIC_OBSERVERS);
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
         OICFree(obsNode->token);
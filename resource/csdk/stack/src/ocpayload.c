@@ -26,6 +26,7 @@
 #include "oic_string.h"
 #include "ocstackinternal.h"
 #include "ocresource.h"
+#include "ocpayloadcbor.h"
 #include "logger.h"
 #include "rdpayload.h"
 
@@ -63,6 +64,9 @@ void OCPayloadDestroy(OCPayload* payload)
         case PAYLOAD_TYPE_RD:
            OCRDPayloadDestroy((OCRDPayload*)payload);
            break;
+        case PAYLOAD_TYPE_ENCODED:
+            OCEncodedPayloadDestroy((OCEncodedPayload*)payload);
+            break;
         default:
             OIC_LOG_V(ERROR, TAG, "Unsupported payload type in destroy: %d", payload->type);
             OICFree(payload);
@@ -83,9 +87,23 @@ OCRepPayload* OCRepPayloadCreate()
     return payload;
 }
 
+/**
+ * Payloads parsed with ::OC_PAYLOAD_PARSE_ARENA are read-only, their nodes live in the
+ * arena and cannot be freed or replaced one by one.
+ */
+static bool OCRepPayloadIsReadOnly(const OCRepPayload* payload)
+{
+    if (payload && payload->arena)
+    {
+        OIC_LOG(ERROR, TAG, "Arena payloads are read-only, modify a clone instead");
+        return true;
+    }
+    return false;
+}
+
 void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
 {
-    if (!parent)
+    if (!parent || OCRepPayloadIsReadOnly(parent))
     {
         return;
     }
@@ -99,6 +117,102 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
+/**
+ * Open addressing hash table over the values of a payload, at most half full.
+ * Values are never removed, so no tombstones are needed.
+ */
+typedef struct OCRepPayloadIndex
+{
+    size_t capacity;
+    size_t count;
+    OCRepPayloadValue* tail;
+    OCRepPayloadValue* slots[];
+} OCRepPayloadIndex;
+
+static size_t OCRepPayloadHashName(const char* name)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*name)
+    {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t OCRepPayloadIndexCapacity(size_t count)
+{
+    size_t capacity = REP_PAYLOAD_INDEX_THRESHOLD * 2;
+    while (capacity < count * 2)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+size_t OCRepPayloadIndexSize(size_t count)
+{
+    return sizeof(OCRepPayloadIndex) +
+        OCRepPayloadIndexCapacity(count) * sizeof(OCRepPayloadValue*);
+}
+
+static void OCRepPayloadIndexInsert(OCRepPayloadIndex* index, OCRepPayloadValue* val)
+{
+    size_t mask = index->capacity - 1;
+    size_t slot = OCRepPayloadHashName(val->name) & mask;
+    while (index->slots[slot])
+    {
+        slot = (slot + 1) & mask;
+    }
+    index->slots[slot] = val;
+    index->tail = val;
+    ++index->count;
+}
+
+void OCRepPayloadIndexInit(OCRepPayload* payload, void* memory, size_t count)
+{
+    OCRepPayloadIndex* index = (OCRepPayloadIndex*)memory;
+    index->capacity = OCRepPayloadIndexCapacity(count);
+    index->count = 0;
+    index->tail = NULL;
+    memset(index->slots, 0, index->capacity * sizeof(OCRepPayloadValue*));
+
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        OCRepPayloadIndexInsert(index, val);
+    }
+    payload->index = index;
+}
+
+static bool OCRepPayloadBuildIndex(OCRepPayload* payload, size_t count)
+{
+    void* memory = OICMalloc(OCRepPayloadIndexSize(count));
+    if (!memory)
+    {
+        return false;
+    }
+
+    OICFree(payload->index);
+    OCRepPayloadIndexInit(payload, memory, count);
+    return true;
+}
+
+static OCRepPayloadValue* OCRepPayloadIndexFind(const OCRepPayloadIndex* index, const char* name)
+{
+    size_t mask = index->capacity - 1;
+    size_t slot = OCRepPayloadHashName(name) & mask;
+    while (index->slots[slot])
+    {
+        if (0 == strcmp(index->slots[slot]->name, name))
+        {
+            return index->slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
 static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if (!payload || !name)
@@ -106,6 +220,11 @@ static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, con
         return NULL;
     }
 
+    if (payload->index)
+    {
+        return OCRepPayloadIndexFind(payload->index, name);
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -303,71 +422,90 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, const char* name,
         OCRepPayloadPropType type)
 {
-    if (!payload || !name)
+    if (!payload || !name || OCRepPayloadIsReadOnly(payload))
     {
         return NULL;
     }
 
-    OCRepPayloadValue* val = payload->values;
-    if (val == NULL)
+    OCRepPayloadValue* val = NULL;
+    OCRepPayloadValue* tail = NULL;
+    size_t count = 0;
+
+    if (payload->index)
     {
-        payload->values = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!payload->values)
-        {
-            return NULL;
-        }
-        payload->values->name = OICStrdup(name);
-        if (!payload->values->name)
-        {
-            OICFree(payload->values);
-            payload->values = NULL;
-            return NULL;
-        }
-        payload->values->type =type;
-        return payload->values;
+        val = OCRepPayloadIndexFind(payload->index, name);
+        tail = payload->index->tail;
+        count = payload->index->count;
     }
-
-    while(val)
+    else
     {
-        if (0 == strcmp(val->name, name))
+        for (val = payload->values; val; val = val->next)
         {
-            OCFreeRepPayloadValueContents(val);
-            val->type = type;
-            return val;
-        }
-        else if (val->next == NULL)
-        {
-            val->next = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-            if (!val->next)
+            if (0 == strcmp(val->name, name))
             {
-                return NULL;
-            }
-            val->next->name = OICStrdup(name);
-            if (!val->next->name)
-            {
-                OICFree(val->next);
-                val->next = NULL;
-                return NULL;
+                break;
             }
-            val->next->type =type;
-            return val->next;
+            tail = val;
+            ++count;
         }
+    }
 
-        val = val->next;
+    if (val)
+    {
+        OCFreeRepPayloadValueContents(val);
+        val->type = type;
+        return val;
     }
 
-    OIC_LOG(ERROR, TAG, "FindAndSetValue reached point after while loop, pointer corruption?");
-    return NULL;
+    val = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
+    if (!val)
+    {
+        return NULL;
+    }
+    val->name = OICStrdup(name);
+    if (!val->name)
+    {
+        OICFree(val);
+        return NULL;
+    }
+    val->type = type;
+
+    // Append, so encoding keeps insertion order
+    if (tail)
+    {
+        tail->next = val;
+    }
+    else
+    {
+        payload->values = val;
+    }
+    ++count;
+
+    if (payload->index && count * 2 <= payload->index->capacity)
+    {
+        OCRepPayloadIndexInsert(payload->index, val);
+    }
+    else if (count >= REP_PAYLOAD_INDEX_THRESHOLD && !OCRepPayloadBuildIndex(payload, count))
+    {
+        // Lookups fall back to walking the list
+        OICFree(payload->index);
+        payload->index = NULL;
+    }
+    return val;
 }
 
 bool OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType)
 {
+    if (OCRepPayloadIsReadOnly(payload))
+    {
+        return false;
+    }
     return OCRepPayloadAddResourceTypeAsOwner(payload, OICStrdup(resourceType));
 }
 
 bool OCRepPayloadAddResourceTypeAsOwner(OCRepPayload* payload, char* resourceType)
 {
-    if (!payload || !resourceType)
+    if (!payload || !resourceType || OCRepPayloadIsReadOnly(payload))
     {
         return false;
     }
@@ -403,12 +541,16 @@ bool OCRepPayloadAddResourceTypeAsOwner(OCRepPayload* payload, char* resourceTyp
 
 bool OCRepPayloadAddInterface(OCRepPayload* payload, const char* interface)
 {
+    if (OCRepPayloadIsReadOnly(payload))
+    {
+        return false;
+    }
     return OCRepPayloadAddInterfaceAsOwner(payload, OICStrdup(interface));
 }
 
 bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* interface)
 {
-    if (!payload || !interface)
+    if (!payload || !interface || OCRepPayloadIsReadOnly(payload))
     {
         return false;
     }
@@ -443,7 +585,7 @@ bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* interface)
 
 bool OCRepPayloadSetUri(OCRepPayload* payload, const char*  uri)
 {
-    if (!payload)
+    if (!payload || OCRepPayloadIsReadOnly(payload))
     {
         return false;
     }
@@ -1255,6 +1397,11 @@ OCRepPayload* OCRepPayloadClone (const OCRepPayload* payload)
     clone->types = CloneOCStringLL (payload->types);
     clone->interfaces = CloneOCStringLL (payload->interfaces);
     clone->values = OCRepPayloadValueClone (payload->values);
+    if (payload->index)
+    {
+        // Without an index lookups walk the values, which is still correct
+        OCRepPayloadBuildIndex(clone, payload->index->count);
+    }
 
     return clone;
 }
@@ -1267,10 +1414,17 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
         return;
     }
 
+    if (payload->arena)
+    {
+        OCPayloadArenaRelease(payload);
+        return;
+    }
+
     OICFree(payload->uri);
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
     OCFreeRepPayloadValue(payload->values);
+    OICFree(payload->index);
     OCRepPayloadDestroy(payload->next);
     OICFree(payload);
 }
@@ -1315,6 +1469,82 @@ void OCSecurityPayloadDestroy(OCSecurityPayload* payload)
     OICFree(payload);
 }
 
+OCEncodedPayload* OCEncodedPayloadCreate(uint8_t* data, size_t size)
+{
+    if (!data || !size)
+    {
+        return NULL;
+    }
+
+    OCEncodedPayload* payload = (OCEncodedPayload*)OICCalloc(1, sizeof(OCEncodedPayload));
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_ENCODED;
+    payload->data = data;
+    payload->size = size;
+
+    return payload;
+}
+
+void OCEncodedPayloadDestroy(OCEncodedPayload* payload)
+{
+    if (!payload)
+    {
+        return;
+    }
+
+    OICFree(payload->data);
+    OICFree(payload);
+}
+
+OCStackResult OCEncodedPayloadDecode(const OCEncodedPayload* payload, OCRepPayload** outPayload)
+{
+    if (!payload || !outPayload)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    *outPayload = NULL;
+    OCPayload* decoded = NULL;
+    OCStackResult result = OCParsePayload(&decoded, PAYLOAD_TYPE_REPRESENTATION,
+                                          payload->data, payload->size);
+    if (OC_STACK_OK != result)
+    {
+        OCPayloadDestroy(decoded);
+        return result;
+    }
+
+    *outPayload = (OCRepPayload*)decoded;
+    return OC_STACK_OK;
+}
+
+OCRepPayload* OCPayloadGetRepresentation(OCPayload* payload, OCRepPayload** decoded)
+{
+    if (decoded)
+    {
+        *decoded = NULL;
+    }
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    if (PAYLOAD_TYPE_ENCODED == payload->type)
+    {
+        if (!decoded ||
+            OC_STACK_OK != OCEncodedPayloadDecode((OCEncodedPayload*)payload, decoded))
+        {
+            return NULL;
+        }
+        return *decoded;
+    }
+
+    return (PAYLOAD_TYPE_REPRESENTATION == payload->type) ? (OCRepPayload*)payload : NULL;
+}
+
 size_t OCDiscoveryPayloadGetResourceCount(OCDiscoveryPayload* payload)
 {
     size_t i = 0;
@@ -21,6 +21,7 @@
 #include "ocpayloadcbor.h"
 #include "platform_features.h"
 #include <stdlib.h>
+#include <string.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
@@ -35,8 +36,11 @@
 // Arbitrarily chosen size that seems to contain the majority of packages
 #define INIT_SIZE (255)
 
-// This is six times of the init_size to handle MAX payload.
-#define MAX_SIZE (1530)
+// Worst case size of a CBOR item header: initial byte followed by a 64 bit argument.
+#define CBOR_MAX_HEADER_SIZE (9)
+
+// Worst case size of a CBOR container: header plus the break byte of indefinite containers.
+#define CBOR_MAX_CONTAINER_SIZE (CBOR_MAX_HEADER_SIZE + 1)
 
 // Discovery Links Map Length.
 #define LINKS_MAP_LEN 4
@@ -55,15 +59,52 @@ static int64_t OCConvertPresencePayload(OCPresencePayload *payload, uint8_t *out
         size_t *size);
 static int64_t OCConvertSecurityPayload(OCSecurityPayload *payload, uint8_t *outPayload,
         size_t *size);
+static int64_t OCConvertEncodedPayload(const OCEncodedPayload *payload, uint8_t *outPayload,
+        size_t *size);
 static int64_t OCConvertSingleRepPayload(CborEncoder *parent, const OCRepPayload *payload);
 static int64_t OCConvertArray(CborEncoder *parent, const OCRepPayloadValueArray *valArray);
 
+static size_t OCEstimatePayloadSize(const OCPayload *payload);
+static size_t OCEstimateRepMapSize(const OCRepPayload *payload);
+
 static int64_t AddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
 static int64_t ConditionalAddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
 
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size)
+{
+    OCStackResult ret = OC_STACK_INVALID_PARAM;
+    uint8_t *out = NULL;
+    size_t outSize = 0;
+
+    VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
+
+    ret = OCConvertPayloadToBuffer(payload, &out, &outSize, size);
+    if (ret != OC_STACK_OK)
+    {
+        OICFree(out);
+        return ret;
+    }
+
+    // The estimate is an upper bound and the caller keeps the buffer as long as the message,
+    // so significant slack is given back. A failed shrink keeps the larger buffer.
+    if (*size && outSize - *size > outSize / 4)
+    {
+        uint8_t *shrunk = (uint8_t *)OICRealloc(out, *size);
+        if (shrunk)
+        {
+            out = shrunk;
+        }
+    }
+
+    *outPayload = out;
+exit:
+    return ret;
+}
+
+OCStackResult OCConvertPayloadToBuffer(OCPayload* payload, uint8_t** buffer, size_t* bufferSize,
+        size_t* size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
     // strategy to work.  If you receive the following assertion error, please do a git-pull
@@ -74,56 +115,97 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
 
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     int64_t err;
-    uint8_t *out = NULL;
-    size_t curSize = INIT_SIZE;
+    size_t curSize;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
-    VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "Buffer parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, bufferSize, "BufferSize parameter is NULL");
     VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
 
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
 
-    out = (uint8_t *)OICCalloc(1, curSize);
-    VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
-    err = OCConvertPayloadHelper(payload, out, &curSize);
+    // Size the buffer up front so that the payload gets encoded only once.
+    curSize = OCEstimatePayloadSize(payload);
+    if (curSize > MAX_PAYLOAD_ENCODE_SIZE)
+    {
+        curSize = MAX_PAYLOAD_ENCODE_SIZE;
+    }
     ret = OC_STACK_NO_MEMORY;
+    if (!*buffer || *bufferSize < curSize)
+    {
+        uint8_t *out = (uint8_t *)OICRealloc(*buffer, curSize);
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        *buffer = out;
+        *bufferSize = curSize;
+    }
 
-    if (err == CborErrorOutOfMemory)
+    curSize = *bufferSize;
+    err = OCConvertPayloadHelper(payload, *buffer, &curSize);
+
+    // Only payloads without a size estimate end up here. On failure tinycbor reports
+    // the exact size it needed, so one more pass is enough.
+    while (err == CborErrorOutOfMemory && curSize > *bufferSize
+           && curSize <= MAX_PAYLOAD_ENCODE_SIZE)
     {
-        // reallocate "out" and try again!
-        uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-        out = out2;
-        err = OCConvertPayloadHelper(payload, out, &curSize);
-        while (err == CborErrorOutOfMemory && curSize < MAX_SIZE)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-            err = OCConvertPayloadHelper(payload, out, &curSize);
-        }
+        uint8_t *out = (uint8_t *)OICRealloc(*buffer, curSize);
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to increase payload size");
+        *buffer = out;
+        *bufferSize = curSize;
+        err = OCConvertPayloadHelper(payload, *buffer, &curSize);
     }
 
     if (err == CborNoError)
     {
-        if (curSize < INIT_SIZE)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-        }
-
         *size = curSize;
-        *outPayload = out;
-        OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : %s \n", *size, *outPayload);
+        OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : %s \n", *size, *buffer);
         return OC_STACK_OK;
     }
 
+    if (err == CborErrorOutOfMemory)
+    {
+        OIC_LOG_V(ERROR, TAG, "Payload needs %zu bytes, more than %d", curSize,
+                  MAX_PAYLOAD_ENCODE_SIZE);
+        ret = OC_STACK_NO_MEMORY;
+        goto exit;
+    }
+
     //TODO: Proper conversion from CborError to OCStackResult.
     ret = (OCStackResult)-err;
 
 exit:
-    OICFree(out);
+    return ret;
+}
+
+OCStackResult OCConvertPayloadToFixedBuffer(OCPayload* payload, uint8_t* buffer,
+        size_t bufferSize, size_t* size)
+{
+    OCStackResult ret = OC_STACK_INVALID_PARAM;
+    int64_t err;
+    size_t curSize = bufferSize;
+
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "Buffer parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
+
+    // Skip the encoding attempt unless the payload surely fits
+    ret = OC_STACK_NO_MEMORY;
+    if (OCEstimatePayloadSize(payload) > bufferSize)
+    {
+        goto exit;
+    }
+
+    err = OCConvertPayloadHelper(payload, buffer, &curSize);
+    if (err == CborNoError)
+    {
+        *size = curSize;
+        return OC_STACK_OK;
+    }
+    if (err != CborErrorOutOfMemory)
+    {
+        ret = (OCStackResult)-err;
+    }
+
+exit:
     return ret;
 }
 
@@ -145,12 +227,211 @@ static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, s
             return OCConvertSecurityPayload((OCSecurityPayload*)payload, outPayload, size);
         case PAYLOAD_TYPE_RD:
             return OCRDPayloadToCbor((OCRDPayload*)payload, outPayload, size);
+        case PAYLOAD_TYPE_ENCODED:
+            return OCConvertEncodedPayload((OCEncodedPayload*)payload, outPayload, size);
         default:
             OIC_LOG_V(INFO,TAG, "ConvertPayload default %d", payload->type);
             return CborErrorUnknownType;
     }
 }
 
+static size_t OCEstimateTextStringSize(const char *value)
+{
+    return CBOR_MAX_HEADER_SIZE + (value ? strlen(value) : 0);
+}
+
+static size_t OCEstimateTextPairSize(const char *key, const char *value)
+{
+    return value ? OCEstimateTextStringSize(key) + OCEstimateTextStringSize(value) : 0;
+}
+
+static size_t OCEstimateStringLLSize(const OCStringLL *val)
+{
+    // Joined with single spaces, see OCStringLLJoin.
+    size_t size = CBOR_MAX_HEADER_SIZE;
+    for (; val; val = val->next)
+    {
+        size += strlen(val->value) + 1;
+    }
+    return size;
+}
+
+static size_t OCEstimateArraySize(const OCRepPayloadValueArray *valArray)
+{
+    size_t count = calcDimTotal(valArray->dimensions);
+    size_t size = CBOR_MAX_CONTAINER_SIZE;
+
+    // Headers of the nested arrays.
+    if (valArray->dimensions[1])
+    {
+        size += valArray->dimensions[0] * CBOR_MAX_CONTAINER_SIZE;
+        if (valArray->dimensions[2])
+        {
+            size += valArray->dimensions[0] * valArray->dimensions[1] * CBOR_MAX_CONTAINER_SIZE;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (valArray->type)
+        {
+            case OCREP_PROP_STRING:
+                size += OCEstimateTextStringSize(valArray->strArray[i]);
+                break;
+            case OCREP_PROP_BYTE_STRING:
+                size += CBOR_MAX_HEADER_SIZE + valArray->ocByteStrArray[i].len;
+                break;
+            case OCREP_PROP_OBJECT:
+                size += valArray->objArray[i] ?
+                        OCEstimateRepMapSize(valArray->objArray[i]) : CBOR_MAX_HEADER_SIZE;
+                break;
+            default:
+                size += CBOR_MAX_HEADER_SIZE;
+                break;
+        }
+    }
+    return size;
+}
+
+static size_t OCEstimateRepValuesSize(const OCRepPayload *payload)
+{
+    size_t size = 0;
+    for (const OCRepPayloadValue *value = payload->values; value; value = value->next)
+    {
+        size += OCEstimateTextStringSize(value->name);
+        switch (value->type)
+        {
+            case OCREP_PROP_STRING:
+                size += OCEstimateTextStringSize(value->str);
+                break;
+            case OCREP_PROP_BYTE_STRING:
+                size += CBOR_MAX_HEADER_SIZE + value->ocByteStr.len;
+                break;
+            case OCREP_PROP_OBJECT:
+                size += OCEstimateRepMapSize(value->obj);
+                break;
+            case OCREP_PROP_ARRAY:
+                size += OCEstimateArraySize(&value->arr);
+                break;
+            default:
+                size += CBOR_MAX_HEADER_SIZE;
+                break;
+        }
+    }
+    return size;
+}
+
+static size_t OCEstimateRepMapSize(const OCRepPayload *payload)
+{
+    return CBOR_MAX_CONTAINER_SIZE + (payload ? OCEstimateRepValuesSize(payload) : 0);
+}
+
+static size_t OCEstimateRepPayloadSize(const OCRepPayload *payload)
+{
+    size_t size = CBOR_MAX_CONTAINER_SIZE;
+    for (; payload; payload = payload->next)
+    {
+        size += CBOR_MAX_CONTAINER_SIZE;
+        size += OCEstimateTextPairSize(OC_RSRVD_HREF, payload->uri);
+        if (payload->types)
+        {
+            size += OCEstimateTextStringSize(OC_RSRVD_RESOURCE_TYPE) +
+                    OCEstimateStringLLSize(payload->types);
+        }
+        if (payload->interfaces)
+        {
+            size += OCEstimateTextStringSize(OC_RSRVD_INTERFACE) +
+                    OCEstimateStringLLSize(payload->interfaces);
+        }
+        size += OCEstimateRepValuesSize(payload);
+    }
+    return size;
+}
+
+static size_t OCEstimateDiscoveryPayloadSize(const OCDiscoveryPayload *payload)
+{
+    size_t size = 2 * CBOR_MAX_CONTAINER_SIZE;
+    size += OCEstimateTextStringSize(OC_RSRVD_DEVICE_ID) + CBOR_MAX_HEADER_SIZE + UUID_SIZE;
+    size += OCEstimateTextPairSize(OC_RSRVD_BASE_URI, payload->baseURI);
+    size += OCEstimateTextStringSize(OC_RSRVD_LINKS) + CBOR_MAX_CONTAINER_SIZE;
+
+    for (const OCResourcePayload *resource = payload->resources; resource;
+         resource = resource->next)
+    {
+        size += 2 * CBOR_MAX_CONTAINER_SIZE;
+        size += OCEstimateTextPairSize(OC_RSRVD_HREF, resource->uri);
+        size += OCEstimateTextStringSize(OC_RSRVD_RESOURCE_TYPE) +
+                OCEstimateStringLLSize(resource->types);
+        size += OCEstimateTextStringSize(OC_RSRVD_INTERFACE) +
+                OCEstimateStringLLSize(resource->interfaces);
+        size += OCEstimateTextStringSize(OC_RSRVD_POLICY);
+        size += OCEstimateTextStringSize(OC_RSRVD_BITMAP) + CBOR_MAX_HEADER_SIZE;
+        size += OCEstimateTextStringSize(OC_RSRVD_SECURE) + CBOR_MAX_HEADER_SIZE;
+        size += OCEstimateTextStringSize(OC_RSRVD_HOSTING_PORT) + CBOR_MAX_HEADER_SIZE;
+    }
+    return size;
+}
+
+static size_t OCEstimateDevicePayloadSize(const OCDevicePayload *payload)
+{
+    return CBOR_MAX_CONTAINER_SIZE +
+           OCEstimateTextStringSize(OC_RSRVD_DEVICE_ID) + CBOR_MAX_HEADER_SIZE + UUID_SIZE +
+           OCEstimateTextPairSize(OC_RSRVD_DEVICE_NAME, payload->deviceName) +
+           OCEstimateTextPairSize(OC_RSRVD_SPEC_VERSION, payload->specVersion) +
+           OCEstimateTextPairSize(OC_RSRVD_DATA_MODEL_VERSION, payload->dataModelVersion);
+}
+
+static size_t OCEstimatePlatformPayloadSize(const OCPlatformPayload *payload)
+{
+    const OCPlatformInfo *info = &payload->info;
+    return CBOR_MAX_CONTAINER_SIZE +
+           OCEstimateTextPairSize(OC_RSRVD_PLATFORM_ID, info->platformID) +
+           OCEstimateTextPairSize(OC_RSRVD_MFG_NAME, info->manufacturerName) +
+           OCEstimateTextPairSize(OC_RSRVD_MFG_URL, info->manufacturerUrl) +
+           OCEstimateTextPairSize(OC_RSRVD_MODEL_NUM, info->modelNumber) +
+           OCEstimateTextPairSize(OC_RSRVD_MFG_DATE, info->dateOfManufacture) +
+           OCEstimateTextPairSize(OC_RSRVD_PLATFORM_VERSION, info->platformVersion) +
+           OCEstimateTextPairSize(OC_RSRVD_OS_VERSION, info->operatingSystemVersion) +
+           OCEstimateTextPairSize(OC_RSRVD_HARDWARE_VERSION, info->hardwareVersion) +
+           OCEstimateTextPairSize(OC_RSRVD_FIRMWARE_VERSION, info->firmwareVersion) +
+           OCEstimateTextPairSize(OC_RSRVD_SUPPORT_URL, info->supportUrl) +
+           OCEstimateTextPairSize(OC_RSRVD_SYSTEM_TIME, info->systemTime);
+}
+
+/*
+ * Returns an upper bound of the encoded size of the payload, or INIT_SIZE for
+ * payload types without an estimate.
+ */
+static size_t OCEstimatePayloadSize(const OCPayload *payload)
+{
+    size_t size = 0;
+    switch(payload->type)
+    {
+        case PAYLOAD_TYPE_DISCOVERY:
+            size = OCEstimateDiscoveryPayloadSize((const OCDiscoveryPayload *)payload);
+            break;
+        case PAYLOAD_TYPE_DEVICE:
+            size = OCEstimateDevicePayloadSize((const OCDevicePayload *)payload);
+            break;
+        case PAYLOAD_TYPE_PLATFORM:
+            size = OCEstimatePlatformPayloadSize((const OCPlatformPayload *)payload);
+            break;
+        case PAYLOAD_TYPE_REPRESENTATION:
+            size = OCEstimateRepPayloadSize((const OCRepPayload *)payload);
+            break;
+        case PAYLOAD_TYPE_SECURITY:
+            size = CBOR_MAX_CONTAINER_SIZE +
+                   OCEstimateTextStringSize(((const OCSecurityPayload *)payload)->securityData);
+            break;
+        case PAYLOAD_TYPE_ENCODED:
+            size = ((const OCEncodedPayload *)payload)->size;
+            break;
+        default:
+            break;
+    }
+    return (size > INIT_SIZE) ? size : INIT_SIZE;
+}
+
 static int64_t checkError(int64_t err, CborEncoder* encoder, uint8_t* outPayload, size_t* size)
 {
     if (err == CborErrorOutOfMemory)
@@ -193,6 +474,21 @@ exit:
     return checkError(err, &encoder, outPayload, size);
 }
 
+static int64_t OCConvertEncodedPayload(const OCEncodedPayload* payload, uint8_t* outPayload,
+        size_t* size)
+{
+    // Already encoded, report the size needed like tinycbor when it does not fit
+    if (payload->size > *size)
+    {
+        *size = payload->size;
+        return CborErrorOutOfMemory;
+    }
+
+    memcpy(outPayload, payload->data, payload->size);
+    *size = payload->size;
+    return CborNoError;
+}
+
 static char* OCStringLLJoin(OCStringLL* val)
 {
     OCStringLL* temp = val;
@@ -38,19 +38,265 @@
 
 #define TAG "OIC_RI_PAYLOADPARSE"
 
+/** Parsed nodes take several times the space of their encoding.*/
+#define ARENA_SIZE_FACTOR (8)
+
+/** Extra room for payloads made mostly of small nodes.*/
+#define ARENA_SIZE_SLACK (256)
+
+/** Alignment of arena allocations, suitable for every type stored in a payload.*/
+typedef union
+{
+    void *ptr;
+    int64_t i;
+    double d;
+} OCPayloadArenaAlign;
+
+#define ARENA_ALIGN(size) \
+    (((size) + sizeof(OCPayloadArenaAlign) - 1) & ~(sizeof(OCPayloadArenaAlign) - 1))
+
+typedef struct OCPayloadArenaBlock
+{
+    struct OCPayloadArenaBlock *next;
+    size_t size;
+    size_t used;
+} OCPayloadArenaBlock;
+
+#define ARENA_BLOCK_DATA(block) ((uint8_t *)(block) + ARENA_ALIGN(sizeof(OCPayloadArenaBlock)))
+
+typedef struct OCPayloadArena
+{
+    /** Blocks, most recent first. The arena itself lives in the last one.*/
+    OCPayloadArenaBlock *blocks;
+    /** Top level payload, destroying it releases the arena.*/
+    OCRepPayload *root;
+} OCPayloadArena;
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload **outPayload, CborValue *arrayVal);
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot);
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal);
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent,
+        bool isRoot, OCPayloadArena *arena);
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal,
+        OCPayloadArena *arena);
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload **outPayload, CborValue * rrayVal);
 
+static OCPayloadArena *OCPayloadArenaCreate(size_t size)
+{
+    size_t headerSize = ARENA_ALIGN(sizeof(OCPayloadArena));
+    size = ARENA_ALIGN(size) + headerSize;
+
+    OCPayloadArenaBlock *block = (OCPayloadArenaBlock *)
+        OICMalloc(ARENA_ALIGN(sizeof(OCPayloadArenaBlock)) + size);
+    if (!block)
+    {
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = headerSize;
+
+    OCPayloadArena *arena = (OCPayloadArena *)ARENA_BLOCK_DATA(block);
+    arena->blocks = block;
+    arena->root = NULL;
+    return arena;
+}
+
+static void OCPayloadArenaDestroy(OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    OCPayloadArenaBlock *block = arena->blocks;
+    while (block)
+    {
+        OCPayloadArenaBlock *next = block->next;
+        OICFree(block);
+        block = next;
+    }
+}
+
+/**
+ * Zeroed allocation from the arena. A new block, at least as large as the previous one,
+ * is chained when the current block runs out, so the estimate only has to be close.
+ */
+static void *OCPayloadArenaAlloc(OCPayloadArena *arena, size_t size)
+{
+    size = ARENA_ALIGN(size ? size : 1);
+
+    OCPayloadArenaBlock *block = arena->blocks;
+    if (block->size - block->used < size)
+    {
+        size_t blockSize = block->size > size ? block->size : size;
+        OCPayloadArenaBlock *newBlock = (OCPayloadArenaBlock *)
+            OICMalloc(ARENA_ALIGN(sizeof(OCPayloadArenaBlock)) + blockSize);
+        if (!newBlock)
+        {
+            return NULL;
+        }
+        newBlock->next = block;
+        newBlock->size = blockSize;
+        newBlock->used = 0;
+        arena->blocks = newBlock;
+        block = newBlock;
+    }
+
+    void *ptr = ARENA_BLOCK_DATA(block) + block->used;
+    block->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void OCPayloadArenaRelease(OCRepPayload *payload)
+{
+    if (payload && payload->arena && payload->arena->root == payload)
+    {
+        OCPayloadArenaDestroy(payload->arena);
+    }
+}
+
+/** Allocate zeroed storage from the arena, or from the heap when there is none.*/
+static void *OCParseAlloc(OCPayloadArena *arena, size_t count, size_t size)
+{
+    return arena ? OCPayloadArenaAlloc(arena, count * size) : OICCalloc(count, size);
+}
+
+static void OCParseFree(OCPayloadArena *arena, void *ptr)
+{
+    if (!arena)
+    {
+        OICFree(ptr);
+    }
+}
+
+static OCRepPayload *OCParseCreateRepPayload(OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return OCRepPayloadCreate();
+    }
+
+    OCRepPayload *payload = (OCRepPayload *)OCPayloadArenaAlloc(arena, sizeof(OCRepPayload));
+    if (payload)
+    {
+        payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+        payload->arena = arena;
+        if (!arena->root)
+        {
+            arena->root = payload;
+        }
+    }
+    return payload;
+}
+
+static CborError OCParseDupTextString(OCPayloadArena *arena, const CborValue *value,
+        char **str, size_t *len)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_text_string(value, str, len, NULL);
+    }
+
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    size_t size = *len + 1;
+    *str = (char *)OCPayloadArenaAlloc(arena, size);
+    if (!*str)
+    {
+        return CborErrorOutOfMemory;
+    }
+    return cbor_value_copy_text_string(value, *str, &size, NULL);
+}
+
+static CborError OCParseDupByteString(OCPayloadArena *arena, const CborValue *value,
+        uint8_t **bytes, size_t *len)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_byte_string(value, bytes, len, NULL);
+    }
+
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    size_t size = *len;
+    *bytes = (uint8_t *)OCPayloadArenaAlloc(arena, size);
+    if (!*bytes)
+    {
+        return CborErrorOutOfMemory;
+    }
+    return cbor_value_copy_byte_string(value, *bytes, &size, NULL);
+}
+
+/**
+ * Link a new value to the end of an arena payload. Property names are unique within a
+ * received map, so unlike the OCRepPayloadSet* functions no lookup is needed.
+ */
+static OCRepPayloadValue *OCParseAppendArenaValue(OCPayloadArena *arena, OCRepPayload *payload,
+        OCRepPayloadValue **tail, char *name, OCRepPayloadPropType type)
+{
+    OCRepPayloadValue *val = (OCRepPayloadValue *)
+        OCPayloadArenaAlloc(arena, sizeof(OCRepPayloadValue));
+    if (!val)
+    {
+        return NULL;
+    }
+    val->name = name;
+    val->type = type;
+
+    if (*tail)
+    {
+        (*tail)->next = val;
+    }
+    else
+    {
+        payload->values = val;
+    }
+    *tail = val;
+    return val;
+}
+
+static OCStackResult OCParseEncodedPayload(OCPayload **outPayload, const uint8_t *payload,
+        size_t payloadSize)
+{
+    // The received buffer belongs to the caller, the payload keeps a copy
+    uint8_t *data = (uint8_t *)OICMalloc(payloadSize);
+    if (!data)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    memcpy(data, payload, payloadSize);
+
+    *outPayload = (OCPayload *)OCEncodedPayloadCreate(data, payloadSize);
+    if (!*outPayload)
+    {
+        OICFree(data);
+        return OC_STACK_NO_MEMORY;
+    }
+    return OC_STACK_OK;
+}
+
 OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
         const uint8_t *payload, size_t payloadSize)
+{
+    return OCParsePayloadWithMode(outPayload, payloadType, payload, payloadSize,
+            OC_PAYLOAD_PARSE_DEFAULT);
+}
+
+OCStackResult OCParsePayloadWithMode(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize, OCPayloadParseMode mode)
 {
     OCStackResult result = OC_STACK_MALFORMED_RESPONSE;
     CborError err;
+    OCPayloadArena *arena = NULL;
 
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "Conversion of outPayload failed");
     VERIFY_PARAM_NON_NULL(TAG, payload, "Invalid cbor payload value");
@@ -75,7 +321,27 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
             result = OCParsePlatformPayload(outPayload, &rootValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &rootValue);
+            if (OC_PAYLOAD_PARSE_ENCODED == mode)
+            {
+                result = OCParseEncodedPayload(outPayload, payload, payloadSize);
+                break;
+            }
+            if (OC_PAYLOAD_PARSE_ARENA == mode)
+            {
+                arena = OCPayloadArenaCreate(payloadSize * ARENA_SIZE_FACTOR + ARENA_SIZE_SLACK);
+                if (!arena)
+                {
+                    result = OC_STACK_NO_MEMORY;
+                    break;
+                }
+            }
+            result = OCParseRepPayload(outPayload, &rootValue, arena);
+            if (arena && (OC_STACK_OK != result || !*outPayload))
+            {
+                // Nothing was handed out, or the partial payload must go with the arena
+                OCPayloadArenaDestroy(arena);
+                *outPayload = NULL;
+            }
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &rootValue);
@@ -147,7 +413,36 @@ static char* InPlaceStringTrim(char* str)
     return str;
 }
 
-static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource)
+static bool OCParseAddStringLL(OCPayloadArena *arena, OCStringLL **resource,
+        OCStringLL **tail, char *value)
+{
+    if (!arena)
+    {
+        return OCResourcePayloadAddStringLL(resource, value);
+    }
+
+    // The arena copy of the input stays alive, so the node can point into it
+    OCStringLL *node = (OCStringLL *)OCPayloadArenaAlloc(arena, sizeof(OCStringLL));
+    if (!node)
+    {
+        return false;
+    }
+    node->value = value;
+
+    if (*tail)
+    {
+        (*tail)->next = node;
+    }
+    else
+    {
+        *resource = node;
+    }
+    *tail = node;
+    return true;
+}
+
+static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource,
+        OCPayloadArena *arena)
 {
     CborValue val;
     CborError err = cbor_value_map_find_value(map, type, &val);
@@ -158,8 +453,9 @@ static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resour
         char *input = NULL;
         char *savePtr = NULL;
         size_t len = 0;
+        OCStringLL *tail = NULL;
 
-        err = cbor_value_dup_text_string(&val, &input, &len, NULL);
+        err = OCParseDupTextString(arena, &val, &input, &len);
         VERIFY_CBOR_SUCCESS(TAG, err, "to find StringLL value");
 
         if (input)
@@ -170,14 +466,15 @@ static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resour
                 char *trimmed = InPlaceStringTrim(curPtr);
                 if (trimmed[0] !='\0')
                 {
-                    if (!OCResourcePayloadAddStringLL(resource, trimmed))
+                    if (!OCParseAddStringLL(arena, resource, &tail, trimmed))
                     {
+                        OCParseFree(arena, input);
                         return CborErrorOutOfMemory;
                     }
                 }
                 curPtr = strtok_r(NULL, " ", &savePtr);
             }
-            OICFree(input);
+            OCParseFree(arena, input);
         }
     }
 exit:
@@ -247,11 +544,11 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *
         VERIFY_CBOR_SUCCESS(TAG, err, "to find href value");
 
         // ResourceTypes
-        err =  OCParseStringLL(&resourceMap, OC_RSRVD_RESOURCE_TYPE, &resource->types);
+        err =  OCParseStringLL(&resourceMap, OC_RSRVD_RESOURCE_TYPE, &resource->types, NULL);
         VERIFY_CBOR_SUCCESS(TAG, err, "to find resource type tag/value");
 
         // Interface Types
-        err =  OCParseStringLL(&resourceMap, OC_RSRVD_INTERFACE, &resource->interfaces);
+        err =  OCParseStringLL(&resourceMap, OC_RSRVD_INTERFACE, &resource->interfaces, NULL);
         VERIFY_CBOR_SUCCESS(TAG, err, "to find interface tag/value");
 
         // Policy
@@ -579,7 +876,8 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
 }
 
 static CborError OCParseArrayFillArray(const CborValue *parent,
-        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray)
+        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray,
+        OCPayloadArena *arena)
 {
     CborValue insideArray;
 
@@ -612,7 +910,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_DOUBLE:
@@ -623,7 +921,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((double*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((double*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BOOL:
@@ -634,39 +932,39 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((bool*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((bool*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_text_string(&insideArray, &tempStr, &tempLen, NULL);
+                        err = OCParseDupTextString(arena, &insideArray, &tempStr, &tempLen);
                         ((char**)targetArray)[i] = tempStr;
                         tempStr = NULL;
                     }
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((char**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((char**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BYTE_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_byte_string(&insideArray, &(ocByteStr.bytes),
-                                &(ocByteStr.len), NULL);
+                        err = OCParseDupByteString(arena, &insideArray, &(ocByteStr.bytes),
+                                &(ocByteStr.len));
                         ((OCByteString*)targetArray)[i] = ocByteStr;
                     }
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]));
+                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false);
+                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false, arena);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                         noAdvance = true;
@@ -674,7 +972,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 default:
@@ -696,7 +994,49 @@ exit:
     return err;
 }
 
-static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *container)
+static bool OCParseSetArray(OCRepPayload *out, OCRepPayloadValue **tail, char *name,
+        OCRepPayloadPropType type, void *arr, size_t dimensions[MAX_REP_ARRAY_DEPTH],
+        OCPayloadArena *arena)
+{
+    if (arena)
+    {
+        OCRepPayloadValue *val = OCParseAppendArenaValue(arena, out, tail, name,
+                OCREP_PROP_ARRAY);
+        if (!val)
+        {
+            return false;
+        }
+        val->arr.type = type;
+        memcpy(val->arr.dimensions, dimensions, MAX_REP_ARRAY_DEPTH * sizeof(size_t));
+        // All array members of the union share the same storage
+        val->arr.iArray = (int64_t *)arr;
+        return true;
+    }
+
+    switch (type)
+    {
+        case OCREP_PROP_INT:
+            return OCRepPayloadSetIntArrayAsOwner(out, name, (int64_t *)arr, dimensions);
+        case OCREP_PROP_DOUBLE:
+            return OCRepPayloadSetDoubleArrayAsOwner(out, name, (double *)arr, dimensions);
+        case OCREP_PROP_BOOL:
+            return OCRepPayloadSetBoolArrayAsOwner(out, name, (bool *)arr, dimensions);
+        case OCREP_PROP_STRING:
+            return OCRepPayloadSetStringArrayAsOwner(out, name, (char **)arr, dimensions);
+        case OCREP_PROP_BYTE_STRING:
+            return OCRepPayloadSetByteStringArrayAsOwner(out, name, (OCByteString *)arr,
+                    dimensions);
+        case OCREP_PROP_OBJECT:
+            return OCRepPayloadSetPropObjectArrayAsOwner(out, name, (OCRepPayload**)arr,
+                    dimensions);
+        default:
+            OIC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
+            return false;
+    }
+}
+
+static CborError OCParseArray(OCRepPayload *out, OCRepPayloadValue **tail, char *name,
+        CborValue *container, OCPayloadArena *arena)
 {
     void *arr = NULL;
     OCRepPayloadPropType type;
@@ -709,7 +1049,8 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
 
     if (type == OCREP_PROP_NULL)
     {
-        res = OCRepPayloadSetNull(out, name);
+        res = arena ? (NULL != OCParseAppendArenaValue(arena, out, tail, name, OCREP_PROP_NULL))
+                    : OCRepPayloadSetNull(out, name);
         err = (CborError) !res;
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
         err = cbor_value_advance(container);
@@ -719,40 +1060,22 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
 
     dimTotal = calcDimTotal(dimensions);
     allocSize = getAllocSize(type);
-    arr = OICCalloc(dimTotal, allocSize);
+    arr = OCParseAlloc(arena, dimTotal, allocSize);
     VERIFY_PARAM_NON_NULL(TAG, arr, "Array Parse allocation failed");
 
-    res = OCParseArrayFillArray(container, dimensions, type, arr);
+    res = OCParseArrayFillArray(container, dimensions, type, arr, arena);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed parse array");
 
-    switch (type)
-    {
-        case OCREP_PROP_INT:
-            res = OCRepPayloadSetIntArrayAsOwner(out, name, (int64_t *)arr, dimensions);
-            break;
-        case OCREP_PROP_DOUBLE:
-            res = OCRepPayloadSetDoubleArrayAsOwner(out, name, (double *)arr, dimensions);
-            break;
-        case OCREP_PROP_BOOL:
-            res = OCRepPayloadSetBoolArrayAsOwner(out, name, (bool *)arr, dimensions);
-            break;
-        case OCREP_PROP_STRING:
-            res = OCRepPayloadSetStringArrayAsOwner(out, name, (char **)arr, dimensions);
-            break;
-        case OCREP_PROP_BYTE_STRING:
-            res = OCRepPayloadSetByteStringArrayAsOwner(out, name, (OCByteString *)arr, dimensions);
-            break;
-        case OCREP_PROP_OBJECT:
-            res = OCRepPayloadSetPropObjectArrayAsOwner(out, name, (OCRepPayload**)arr, dimensions);
-            break;
-        default:
-            OIC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
-            break;
-    }
+    res = OCParseSetArray(out, tail, name, type, arr, dimensions, arena);
     err = (CborError) !res;
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting array parameter");
     return CborNoError;
 exit:
+    if (arena)
+    {
+        // Released with the arena
+        return err;
+    }
     if (type == OCREP_PROP_STRING)
     {
         for(size_t i = 0; i < dimTotal; ++i)
@@ -778,11 +1101,100 @@ exit:
     return err;
 }
 
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot)
+/**
+ * Index a large arena payload up front, as read-only payloads cannot build their index
+ * lazily while being set.
+ */
+static CborError OCParseIndexArenaPayload(OCPayloadArena *arena, OCRepPayload *payload)
+{
+    size_t count = 0;
+    for (OCRepPayloadValue *val = payload->values; val; val = val->next)
+    {
+        ++count;
+    }
+    if (count < REP_PAYLOAD_INDEX_THRESHOLD)
+    {
+        return CborNoError;
+    }
+
+    void *index = OCPayloadArenaAlloc(arena, OCRepPayloadIndexSize(count));
+    if (!index)
+    {
+        return CborErrorOutOfMemory;
+    }
+    OCRepPayloadIndexInit(payload, index, count);
+    return CborNoError;
+}
+
+/**
+ * Store a scalar, string or object value parsed from a map. In arena mode the value is
+ * linked in directly and keeps pointing into the arena; otherwise ownership of strings
+ * and objects passes to the payload.
+ */
+static bool OCParseSetValue(OCRepPayload *out, OCRepPayloadValue **tail, char *name,
+        OCRepPayloadValue *parsed, OCPayloadArena *arena)
+{
+    if (arena)
+    {
+        OCRepPayloadValue *val = OCParseAppendArenaValue(arena, out, tail, name, parsed->type);
+        if (!val)
+        {
+            return false;
+        }
+        switch (parsed->type)
+        {
+            case OCREP_PROP_INT:
+                val->i = parsed->i;
+                break;
+            case OCREP_PROP_DOUBLE:
+                val->d = parsed->d;
+                break;
+            case OCREP_PROP_BOOL:
+                val->b = parsed->b;
+                break;
+            case OCREP_PROP_STRING:
+                val->str = parsed->str;
+                break;
+            case OCREP_PROP_BYTE_STRING:
+                val->ocByteStr = parsed->ocByteStr;
+                break;
+            case OCREP_PROP_OBJECT:
+                val->obj = parsed->obj;
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+
+    switch (parsed->type)
+    {
+        case OCREP_PROP_NULL:
+            return OCRepPayloadSetNull(out, name);
+        case OCREP_PROP_INT:
+            return OCRepPayloadSetPropInt(out, name, parsed->i);
+        case OCREP_PROP_DOUBLE:
+            return OCRepPayloadSetPropDouble(out, name, parsed->d);
+        case OCREP_PROP_BOOL:
+            return OCRepPayloadSetPropBool(out, name, parsed->b);
+        case OCREP_PROP_STRING:
+            return OCRepPayloadSetPropStringAsOwner(out, name, parsed->str);
+        case OCREP_PROP_BYTE_STRING:
+            return OCRepPayloadSetPropByteStringAsOwner(out, name, &parsed->ocByteStr);
+        case OCREP_PROP_OBJECT:
+            return OCRepPayloadSetPropObjectAsOwner(out, name, parsed->obj);
+        default:
+            return false;
+    }
+}
+
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap,
+        bool isRoot, OCPayloadArena *arena)
 {
     CborError err = CborUnknownError;
     char *name = NULL;
     bool res;
+    OCRepPayloadValue *tail = NULL;
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "Invalid Parameter outPayload");
     VERIFY_PARAM_NON_NULL(TAG, objMap, "Invalid Parameter objMap");
 
@@ -790,7 +1202,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     {
         if (!*outPayload)
         {
-            *outPayload = OCRepPayloadCreate();
+            *outPayload = OCParseCreateRepPayload(arena);
             if (!*outPayload)
             {
                 return CborErrorOutOfMemory;
@@ -808,7 +1220,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
         {
             if (cbor_value_is_text_string(&repMap))
             {
-                err = cbor_value_dup_text_string(&repMap, &name, &len, NULL);
+                err = OCParseDupTextString(arena, &repMap, &name, &len);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
@@ -819,72 +1231,62 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                     (0 == strcmp(OC_RSRVD_INTERFACE, name))))
                 {
                     err = cbor_value_advance(&repMap);
-                    OICFree(name);
+                    OCParseFree(arena, name);
+                    name = NULL;
                     continue;
                 }
             }
             CborType type = cbor_value_get_type(&repMap);
+            OCRepPayloadValue parsed;
+            memset(&parsed, 0, sizeof(parsed));
+            res = true;
             switch (type)
             {
                 case CborNullType:
-                    res = OCRepPayloadSetNull(curPayload, name);
+                    parsed.type = OCREP_PROP_NULL;
                     break;
                 case CborIntegerType:
-                    {
-                        int64_t intval = 0;
-                        err = cbor_value_get_int64(&repMap, &intval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
-                        res = OCRepPayloadSetPropInt(curPayload, name, intval);
-                    }
+                    parsed.type = OCREP_PROP_INT;
+                    err = cbor_value_get_int64(&repMap, &parsed.i);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
                     break;
                 case CborDoubleType:
-                    {
-                        double doubleval = 0;
-                        err = cbor_value_get_double(&repMap, &doubleval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
-                        res = OCRepPayloadSetPropDouble(curPayload, name, doubleval);
-                    }
+                    parsed.type = OCREP_PROP_DOUBLE;
+                    err = cbor_value_get_double(&repMap, &parsed.d);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
                     break;
                 case CborBooleanType:
-                    {
-                        bool boolval = false;
-                        err = cbor_value_get_boolean(&repMap, &boolval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
-                        res = OCRepPayloadSetPropBool(curPayload, name, boolval);
-                    }
+                    parsed.type = OCREP_PROP_BOOL;
+                    err = cbor_value_get_boolean(&repMap, &parsed.b);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
                     break;
                 case CborTextStringType:
-                    {
-                        char *strval = NULL;
-                        err = cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
-                        res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
-                    }
+                    parsed.type = OCREP_PROP_STRING;
+                    err = OCParseDupTextString(arena, &repMap, &parsed.str, &len);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
                     break;
                 case CborByteStringType:
-                    {
-                        uint8_t* bytestrval = NULL;
-                        err = cbor_value_dup_byte_string(&repMap, &bytestrval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
-                        OCByteString tmp = {.bytes = bytestrval, .len = len};
-                        res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
-                    }
+                    parsed.type = OCREP_PROP_BYTE_STRING;
+                    err = OCParseDupByteString(arena, &repMap, &parsed.ocByteStr.bytes,
+                            &parsed.ocByteStr.len);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
                     break;
                 case CborMapType:
-                    {
-                        OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
-                        res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
-                    }
+                    parsed.type = OCREP_PROP_OBJECT;
+                    err = OCParseSingleRepPayload(&parsed.obj, &repMap, false, arena);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
                     break;
                 case CborArrayType:
-                    err = OCParseArray(curPayload, name, &repMap);
+                    err = OCParseArray(curPayload, &tail, name, &repMap, arena);
                     break;
                 default:
                     OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap.type);
                     res = false;
             }
+            if (res && type != CborArrayType)
+            {
+                res = OCParseSetValue(curPayload, &tail, name, &parsed, arena);
+            }
             if (type != CborArrayType)
             {
                 err = (CborError) !res;
@@ -896,9 +1298,14 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advance repMap");
             }
-            OICFree(name);
+            OCParseFree(arena, name);
             name = NULL;
         }
+        if (arena && !err)
+        {
+            err = OCParseIndexArenaPayload(arena, curPayload);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed indexing payload");
+        }
         if (cbor_value_is_container(objMap))
         {
             err = cbor_value_leave_container(objMap, &repMap);
@@ -908,13 +1315,17 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     }
 
 exit:
-    OICFree(name);
-    OCRepPayloadDestroy(*outPayload);
+    if (!arena)
+    {
+        OICFree(name);
+        OCRepPayloadDestroy(*outPayload);
+    }
     *outPayload = NULL;
     return err;
 }
 
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root,
+        OCPayloadArena *arena)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     CborError err;
@@ -932,7 +1343,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     }
     while (cbor_value_is_valid(&rootMap))
     {
-        temp = OCRepPayloadCreate();
+        temp = OCParseCreateRepPayload(arena);
         ret = OC_STACK_NO_MEMORY;
         VERIFY_PARAM_NON_NULL(TAG, temp, "Failed allocating memory");
 
@@ -945,7 +1356,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             if (cbor_value_is_valid(&curVal))
             {
                 size_t len = 0;
-                err = cbor_value_dup_text_string(&curVal, &temp->uri, &len, NULL);
+                err = OCParseDupTextString(arena, &curVal, &temp->uri, &len);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find uri");
             }
         }
@@ -954,7 +1365,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_RESOURCE_TYPE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types);
+                err =  OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find rt type tag/value");
             }
         }
@@ -964,14 +1375,14 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_INTERFACE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces);
+                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find interfaces tag/value");
             }
         }
 
         if (cbor_value_is_map(&rootMap))
         {
-            err = OCParseSingleRepPayload(&temp, &rootMap, true);
+            err = OCParseSingleRepPayload(&temp, &rootMap, true, arena);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to parse single rep payload");
         }
         if(rootPayload == NULL)
@@ -995,8 +1406,11 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     return OC_STACK_OK;
 
 exit:
-    OCRepPayloadDestroy(temp);
-    OCRepPayloadDestroy(rootPayload);
+    if (!arena)
+    {
+        OCRepPayloadDestroy(temp);
+        OCRepPayloadDestroy(rootPayload);
+    }
     OIC_LOG(ERROR, TAG, "CBOR error in ParseRepPayload");
     return ret;
 }
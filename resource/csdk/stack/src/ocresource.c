@@ -32,6 +32,7 @@
 #include "occollection.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_trace.h"
 #include "logger.h"
 #include "cJSON.h"
 #include "ocpayload.h"
@@ -40,6 +41,8 @@
 #include "cainterface.h"
 #include "rdpayload.h"
 #include "ocpayload.h"
+#include "ocpayloadcbor.h"
+#include "utlist.h"
 
 #ifdef WITH_RD
 #include "rd_server.h"
@@ -58,9 +61,31 @@
 #define VERIFY_NON_NULL(arg, logLevel, retVal) { if (!(arg)) { OIC_LOG((logLevel), \
              TAG, #arg " is NULL"); return (retVal); } }
 
-extern OCResource *headResource;
-static OCPlatformInfo savedPlatformInfo = {0};
-static OCDeviceInfo savedDeviceInfo = {0};
+
+/**
+ * Pre-encoded /oic/res response for one combination of discovery filters.
+ */
+typedef struct DiscoveryCacheEntry
+{
+    /** Interface filter of the request, empty string if none.*/
+    char *interfaceFilter;
+
+    /** Resource type filter of the request, empty string if none.*/
+    char *resourceTypeFilter;
+
+    /** Port advertised for secure resources, depends on the requester's IP family.*/
+    uint16_t securePort;
+
+    /** CBOR encoded discovery payload.*/
+    uint8_t *payload;
+
+    /** Size of the encoded payload.*/
+    size_t payloadSize;
+
+    /** Linked list; most recently used entry first.*/
+    struct DiscoveryCacheEntry *next;
+} DiscoveryCacheEntry;
+
 
 /**
  * Prepares a Payload for response.
@@ -303,6 +328,123 @@ OCStackResult BuildVirtualResourceResponse(const OCResource *resourcePtr,
     return OC_STACK_OK;
 }
 
+static void DeleteDiscoveryCacheEntry(DiscoveryCacheEntry *entry)
+{
+    if (entry)
+    {
+        OICFree(entry->interfaceFilter);
+        OICFree(entry->resourceTypeFilter);
+        OICFree(entry->payload);
+        OICFree(entry);
+    }
+}
+
+void InvalidateDiscoveryCache()
+{
+    DiscoveryCacheEntry *entry = NULL;
+    DiscoveryCacheEntry *tmp = NULL;
+
+    // Resources can move between collections of different contexts, drop every cache.
+    for (OCStackContext *context = stackContexts; context; context = context->next)
+    {
+        LL_FOREACH_SAFE(context->discoveryCache, entry, tmp)
+        {
+            LL_DELETE(context->discoveryCache, entry);
+            DeleteDiscoveryCacheEntry(entry);
+        }
+    }
+}
+
+size_t GetDiscoveryCacheSize()
+{
+    size_t count = 0;
+    for (DiscoveryCacheEntry *entry = OCGetCurrentContext()->discoveryCache; entry;
+         entry = entry->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+static DiscoveryCacheEntry *FindDiscoveryCacheEntry(const char *interfaceFilter,
+                                                    const char *resourceTypeFilter,
+                                                    uint16_t securePort)
+{
+    OCStackContext *context = OCGetCurrentContext();
+    DiscoveryCacheEntry *entry = NULL;
+
+    LL_FOREACH(context->discoveryCache, entry)
+    {
+        if (entry->securePort == securePort &&
+            strcmp(entry->interfaceFilter, interfaceFilter) == 0 &&
+            strcmp(entry->resourceTypeFilter, resourceTypeFilter) == 0)
+        {
+            // Keep the most recently used entries at the front.
+            LL_DELETE(context->discoveryCache, entry);
+            LL_PREPEND(context->discoveryCache, entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * On success the cache takes ownership of the encoded payload.
+ */
+static DiscoveryCacheEntry *AddDiscoveryCacheEntry(const char *interfaceFilter,
+                                                   const char *resourceTypeFilter,
+                                                   uint16_t securePort,
+                                                   uint8_t *payload, size_t payloadSize)
+{
+    DiscoveryCacheEntry *entry = (DiscoveryCacheEntry *) OICCalloc(1, sizeof(DiscoveryCacheEntry));
+    if (!entry)
+    {
+        return NULL;
+    }
+
+    entry->interfaceFilter = OICStrdup(interfaceFilter);
+    entry->resourceTypeFilter = OICStrdup(resourceTypeFilter);
+    if (!entry->interfaceFilter || !entry->resourceTypeFilter)
+    {
+        DeleteDiscoveryCacheEntry(entry);
+        return NULL;
+    }
+    entry->securePort = securePort;
+    entry->payload = payload;
+    entry->payloadSize = payloadSize;
+
+    OCStackContext *context = OCGetCurrentContext();
+    size_t count = 0;
+    DiscoveryCacheEntry *last = NULL;
+    for (DiscoveryCacheEntry *tmp = context->discoveryCache; tmp; tmp = tmp->next)
+    {
+        last = tmp;
+        count++;
+    }
+    if (count >= MAX_DISCOVERY_CACHE_ENTRIES)
+    {
+        // Evict the least recently used entry.
+        LL_DELETE(context->discoveryCache, last);
+        DeleteDiscoveryCacheEntry(last);
+    }
+
+    LL_PREPEND(context->discoveryCache, entry);
+    return entry;
+}
+
+static OCStackResult SendEncodedDiscoveryResponse(OCServerRequest *request, OCResource *resource,
+                                                  const uint8_t *payload, size_t payloadSize)
+{
+    OCEntityHandlerResponse response = {0};
+
+    response.ehResult = OC_EH_OK;
+    response.persistentBufferFlag = 0;
+    response.requestHandle = (OCRequestHandle) request;
+    response.resourceHandle = (OCResourceHandle) resource;
+
+    return HandleSingleEncodedResponse(&response, payload, payloadSize);
+}
+
 uint8_t IsCollectionResource (OCResource *resource)
 {
     if(!resource)
@@ -318,6 +460,15 @@ uint8_t IsCollectionResource (OCResource *resource)
     return 0;
 }
 
+/**
+ * Returns the device ID of the current context.
+ */
+static const OicUuid_t *GetDeviceId()
+{
+    OCStackContext *context = OCGetCurrentContext();
+    return context->uriPrefix ? &context->deviceId : OCGetServerInstanceID();
+}
+
 OCResource *FindResourceByUri(const char* resourceUri)
 {
     if(!resourceUri)
@@ -325,7 +476,7 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
+    OCResource * pointer = OCGetCurrentContext()->headResource;
     while (pointer)
     {
         if (strcmp(resourceUri, pointer->uri) == 0)
@@ -355,7 +506,7 @@ OCStackResult DetermineResourceHandling (const OCServerRequest *request,
     {
         OIC_LOG_V (INFO, TAG, "%s is virtual", request->resourceUrl);
         *handling = OC_RESOURCE_VIRTUAL;
-        *resource = headResource;
+        *resource = OCGetCurrentContext()->headResource;
         return OC_STACK_OK;
     }
     if (strlen((const char*)(request->resourceUrl)) == 0)
@@ -370,7 +521,7 @@ OCStackResult DetermineResourceHandling (const OCServerRequest *request,
         *resource = resourcePtr;
         if (!resourcePtr)
         {
-            if(defaultDeviceHandler)
+            if(OCGetCurrentContext()->defaultDeviceHandler)
             {
                 *handling = OC_RESOURCE_DEFAULT_DEVICE_ENTITYHANDLER;
                 return OC_STACK_OK;
@@ -666,6 +817,12 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     bool bMulticast    = false;     // Was the discovery request a multicast request?
     OCPayload* payload = NULL;
 
+    // Only CBOR encoded /oic/res responses are cached.
+    bool cacheResponse = false;
+    const char *cacheIfFilter = NULL;
+    const char *cacheRtFilter = NULL;
+    uint16_t cacheSecurePort = 0;
+
     OIC_LOG(INFO, TAG, "Entering HandleVirtualResource");
 
     OCVirtualResources virtualUriInRequest = GetTypeOfVirtualURI (request->resourceUrl);
@@ -679,6 +836,26 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
         discoveryResult = getQueryParamsForFiltering (virtualUriInRequest, request->query,
                 &filterOne, &filterTwo);
 
+        if (discoveryResult == OC_STACK_OK &&
+            (request->acceptFormat == OC_FORMAT_UNDEFINED ||
+             request->acceptFormat == OC_FORMAT_CBOR))
+        {
+            cacheResponse = true;
+            cacheIfFilter = filterOne ? filterOne : "";
+            cacheRtFilter = filterTwo ? filterTwo : "";
+            GetSecurePortInfo(&request->devAddr, &cacheSecurePort);
+
+            DiscoveryCacheEntry *entry = FindDiscoveryCacheEntry(cacheIfFilter, cacheRtFilter,
+                                                                 cacheSecurePort);
+            if (entry)
+            {
+                OIC_LOG(INFO, TAG, "Sending cached discovery response");
+                SendEncodedDiscoveryResponse(request, resource, entry->payload,
+                                             entry->payloadSize);
+                return OC_STACK_OK;
+            }
+        }
+
         if (discoveryResult == OC_STACK_OK)
         {
             payload = (OCPayload*)OCDiscoveryPayloadCreate();
@@ -686,7 +863,7 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
             if(payload)
             {
                 ((OCDiscoveryPayload*)payload)->sid = (uint8_t*)OICCalloc(1, UUID_SIZE);
-                memcpy(((OCDiscoveryPayload*)payload)->sid, OCGetServerInstanceID(), UUID_SIZE);
+                memcpy(((OCDiscoveryPayload*)payload)->sid, GetDeviceId(), UUID_SIZE);
 
                 bool foundResourceAtRD = false;
                 for(;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
@@ -694,6 +871,8 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 #ifdef WITH_RD
                     if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
                     {
+                        // Published resources can change without notice, don't cache.
+                        cacheResponse = false;
                         OCResource *resource = NULL;
                         OCDevAddr devAddr;
                         discoveryResult = checkResourceExistsAtRD(filterOne, filterTwo,
@@ -737,14 +916,15 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     }
     else if (virtualUriInRequest == OC_DEVICE_URI)
     {
-        const OicUuid_t* deviceId = OCGetServerInstanceID();
+        const OicUuid_t* deviceId = GetDeviceId();
         if (!deviceId)
         {
             discoveryResult = OC_STACK_ERROR;
         }
         else
         {
-            payload = (OCPayload*) OCDevicePayloadCreate((const uint8_t*) &deviceId->id, savedDeviceInfo.deviceName,
+            payload = (OCPayload*) OCDevicePayloadCreate((const uint8_t*) &deviceId->id,
+                    OCGetCurrentContext()->deviceInfo.deviceName,
                     OC_SPEC_VERSION, OC_DATA_MODEL_VERSION);
             if (!payload)
             {
@@ -758,7 +938,7 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     }
     else if (virtualUriInRequest == OC_PLATFORM_URI)
     {
-        payload = (OCPayload*)OCPlatformPayloadCreate(&savedPlatformInfo);
+        payload = (OCPayload*)OCPlatformPayloadCreate(&OCGetCurrentContext()->platformInfo);
         if (!payload)
         {
             discoveryResult = OC_STACK_NO_MEMORY;
@@ -806,7 +986,29 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     if (OC_GATEWAY_URI != virtualUriInRequest)
 #endif
     {
-        if(discoveryResult == OC_STACK_OK)
+        if(discoveryResult == OC_STACK_OK && cacheResponse)
+        {
+            uint8_t *encoded = NULL;
+            size_t encodedSize = 0;
+
+            if (OCConvertPayload(payload, &encoded, &encodedSize) == OC_STACK_OK)
+            {
+                // The filters point into the request, so cache before the request is released.
+                DiscoveryCacheEntry *entry = AddDiscoveryCacheEntry(cacheIfFilter, cacheRtFilter,
+                                                                    cacheSecurePort,
+                                                                    encoded, encodedSize);
+                SendEncodedDiscoveryResponse(request, resource, encoded, encodedSize);
+                if (!entry)
+                {
+                    OICFree(encoded);
+                }
+            }
+            else
+            {
+                SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
+            }
+        }
+        else if(discoveryResult == OC_STACK_OK)
         {
             SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
         }
@@ -859,14 +1061,31 @@ HandleDefaultDeviceEntityHandler (OCServerRequest *request)
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
     // At this point we know for sure that defaultDeviceHandler exists
-    ehResult = defaultDeviceHandler(OC_REQUEST_FLAG, &ehRequest,
-                                  (char*) request->resourceUrl, defaultDeviceHandlerCallbackParameter);
-    if(ehResult == OC_EH_SLOW)
+#ifdef WITH_TRACING
+    // The handler may respond and so free the request, keep its key around
+    uint32_t traceKey = OICTraceKey(request->requestToken, request->tokenLength);
+    OICTraceRecord(OIC_TRACE_ENTITY_HANDLER_ENTER, traceKey);
+#endif
+    OCStackContext *context = OCGetCurrentContext();
+    OCDeviceEntityHandler deviceHandler = context->defaultDeviceHandler;
+    void *deviceHandlerParameter = context->defaultDeviceHandlerCallbackParameter;
+    // The handler runs without the lock of the stack, the request stays allocated meanwhile
+    PinServerRequest(request);
+    bool released = OCStackReleaseLock();
+    ehResult = deviceHandler(OC_REQUEST_FLAG, &ehRequest, (char*) request->resourceUrl,
+                             deviceHandlerParameter);
+    OCStackReacquireLock(released);
+#ifdef WITH_TRACING
+    OICTraceRecord(OIC_TRACE_ENTITY_HANDLER_EXIT, traceKey);
+#endif
+    // The request is gone if the handler responded meanwhile
+    bool requestLive = UnpinServerRequest(request);
+    if(requestLive && ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
         request->slowFlag = 1;
     }
-    else if(ehResult == OC_EH_ERROR)
+    else if(requestLive && ehResult == OC_EH_ERROR)
     {
         FindAndDeleteServerRequest(request);
     }
@@ -1013,13 +1232,26 @@ HandleResourceWithEntityHandler (OCServerRequest *request,
         goto exit;
     }
 
-    ehResult = resource->entityHandler(ehFlag, &ehRequest, resource->entityHandlerCallbackParam);
-    if(ehResult == OC_EH_SLOW)
+#ifdef WITH_TRACING
+    // The handler may respond and so free the request, keep its key around
+    uint32_t traceKey = OICTraceKey(request->requestToken, request->tokenLength);
+    OICTraceRecord(OIC_TRACE_ENTITY_HANDLER_ENTER, traceKey);
+#endif
+    PinServerRequest(request);
+    ehResult = OCStackCallEntityHandler(resource->entityHandler,
+                                        resource->entityHandlerCallbackParam,
+                                        resource->entityHandlerLocked, ehFlag, &ehRequest);
+#ifdef WITH_TRACING
+    OICTraceRecord(OIC_TRACE_ENTITY_HANDLER_EXIT, traceKey);
+#endif
+    // The request is gone if the handler responded meanwhile
+    bool requestLive = UnpinServerRequest(request);
+    if(requestLive && ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
         request->slowFlag = 1;
     }
-    else if(ehResult == OC_EH_ERROR)
+    else if(requestLive && ehResult == OC_EH_ERROR)
     {
         FindAndDeleteServerRequest(request);
     }
@@ -1116,67 +1348,71 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
 
 void DeletePlatformInfo()
 {
+    OCPlatformInfo *savedPlatformInfo = &OCGetCurrentContext()->platformInfo;
+
     OIC_LOG(INFO, TAG, "Deleting platform info.");
 
-    OICFree(savedPlatformInfo.platformID);
-    savedPlatformInfo.platformID = NULL;
+    OICFree(savedPlatformInfo->platformID);
+    savedPlatformInfo->platformID = NULL;
 
-    OICFree(savedPlatformInfo.manufacturerName);
-    savedPlatformInfo.manufacturerName = NULL;
+    OICFree(savedPlatformInfo->manufacturerName);
+    savedPlatformInfo->manufacturerName = NULL;
 
-    OICFree(savedPlatformInfo.manufacturerUrl);
-    savedPlatformInfo.manufacturerUrl = NULL;
+    OICFree(savedPlatformInfo->manufacturerUrl);
+    savedPlatformInfo->manufacturerUrl = NULL;
 
-    OICFree(savedPlatformInfo.modelNumber);
-    savedPlatformInfo.modelNumber = NULL;
+    OICFree(savedPlatformInfo->modelNumber);
+    savedPlatformInfo->modelNumber = NULL;
 
-    OICFree(savedPlatformInfo.dateOfManufacture);
-    savedPlatformInfo.dateOfManufacture = NULL;
+    OICFree(savedPlatformInfo->dateOfManufacture);
+    savedPlatformInfo->dateOfManufacture = NULL;
 
-    OICFree(savedPlatformInfo.platformVersion);
-    savedPlatformInfo.platformVersion = NULL;
+    OICFree(savedPlatformInfo->platformVersion);
+    savedPlatformInfo->platformVersion = NULL;
 
-    OICFree(savedPlatformInfo.operatingSystemVersion);
-    savedPlatformInfo.operatingSystemVersion = NULL;
+    OICFree(savedPlatformInfo->operatingSystemVersion);
+    savedPlatformInfo->operatingSystemVersion = NULL;
 
-    OICFree(savedPlatformInfo.hardwareVersion);
-    savedPlatformInfo.hardwareVersion = NULL;
+    OICFree(savedPlatformInfo->hardwareVersion);
+    savedPlatformInfo->hardwareVersion = NULL;
 
-    OICFree(savedPlatformInfo.firmwareVersion);
-    savedPlatformInfo.firmwareVersion = NULL;
+    OICFree(savedPlatformInfo->firmwareVersion);
+    savedPlatformInfo->firmwareVersion = NULL;
 
-    OICFree(savedPlatformInfo.supportUrl);
-    savedPlatformInfo.supportUrl = NULL;
+    OICFree(savedPlatformInfo->supportUrl);
+    savedPlatformInfo->supportUrl = NULL;
 
-    OICFree(savedPlatformInfo.systemTime);
-    savedPlatformInfo.systemTime = NULL;
+    OICFree(savedPlatformInfo->systemTime);
+    savedPlatformInfo->systemTime = NULL;
 }
 
 static OCStackResult DeepCopyPlatFormInfo(OCPlatformInfo info)
 {
-    savedPlatformInfo.platformID = OICStrdup(info.platformID);
-    savedPlatformInfo.manufacturerName = OICStrdup(info.manufacturerName);
-    savedPlatformInfo.manufacturerUrl = OICStrdup(info.manufacturerUrl);
-    savedPlatformInfo.modelNumber = OICStrdup(info.modelNumber);
-    savedPlatformInfo.dateOfManufacture = OICStrdup(info.dateOfManufacture);
-    savedPlatformInfo.platformVersion = OICStrdup(info.platformVersion);
-    savedPlatformInfo.operatingSystemVersion = OICStrdup(info.operatingSystemVersion);
-    savedPlatformInfo.hardwareVersion = OICStrdup(info.hardwareVersion);
-    savedPlatformInfo.firmwareVersion = OICStrdup(info.firmwareVersion);
-    savedPlatformInfo.supportUrl = OICStrdup(info.supportUrl);
-    savedPlatformInfo.systemTime = OICStrdup(info.systemTime);
-
-    if ((!savedPlatformInfo.platformID && info.platformID)||
-        (!savedPlatformInfo.manufacturerName && info.manufacturerName)||
-        (!savedPlatformInfo.manufacturerUrl && info.manufacturerUrl)||
-        (!savedPlatformInfo.modelNumber && info.modelNumber)||
-        (!savedPlatformInfo.dateOfManufacture && info.dateOfManufacture)||
-        (!savedPlatformInfo.platformVersion && info.platformVersion)||
-        (!savedPlatformInfo.operatingSystemVersion && info.operatingSystemVersion)||
-        (!savedPlatformInfo.hardwareVersion && info.hardwareVersion)||
-        (!savedPlatformInfo.firmwareVersion && info.firmwareVersion)||
-        (!savedPlatformInfo.supportUrl && info.supportUrl)||
-        (!savedPlatformInfo.systemTime && info.systemTime))
+    OCPlatformInfo *savedPlatformInfo = &OCGetCurrentContext()->platformInfo;
+
+    savedPlatformInfo->platformID = OICStrdup(info.platformID);
+    savedPlatformInfo->manufacturerName = OICStrdup(info.manufacturerName);
+    savedPlatformInfo->manufacturerUrl = OICStrdup(info.manufacturerUrl);
+    savedPlatformInfo->modelNumber = OICStrdup(info.modelNumber);
+    savedPlatformInfo->dateOfManufacture = OICStrdup(info.dateOfManufacture);
+    savedPlatformInfo->platformVersion = OICStrdup(info.platformVersion);
+    savedPlatformInfo->operatingSystemVersion = OICStrdup(info.operatingSystemVersion);
+    savedPlatformInfo->hardwareVersion = OICStrdup(info.hardwareVersion);
+    savedPlatformInfo->firmwareVersion = OICStrdup(info.firmwareVersion);
+    savedPlatformInfo->supportUrl = OICStrdup(info.supportUrl);
+    savedPlatformInfo->systemTime = OICStrdup(info.systemTime);
+
+    if ((!savedPlatformInfo->platformID && info.platformID)||
+        (!savedPlatformInfo->manufacturerName && info.manufacturerName)||
+        (!savedPlatformInfo->manufacturerUrl && info.manufacturerUrl)||
+        (!savedPlatformInfo->modelNumber && info.modelNumber)||
+        (!savedPlatformInfo->dateOfManufacture && info.dateOfManufacture)||
+        (!savedPlatformInfo->platformVersion && info.platformVersion)||
+        (!savedPlatformInfo->operatingSystemVersion && info.operatingSystemVersion)||
+        (!savedPlatformInfo->hardwareVersion && info.hardwareVersion)||
+        (!savedPlatformInfo->firmwareVersion && info.firmwareVersion)||
+        (!savedPlatformInfo->supportUrl && info.supportUrl)||
+        (!savedPlatformInfo->systemTime && info.systemTime))
     {
         DeletePlatformInfo();
         return OC_STACK_INVALID_PARAM;
@@ -1206,17 +1442,21 @@ OCStackResult SavePlatformInfo(OCPlatformInfo info)
 
 void DeleteDeviceInfo()
 {
+    OCDeviceInfo *savedDeviceInfo = &OCGetCurrentContext()->deviceInfo;
+
     OIC_LOG(INFO, TAG, "Deleting device info.");
 
-    OICFree(savedDeviceInfo.deviceName);
-    savedDeviceInfo.deviceName = NULL;
+    OICFree(savedDeviceInfo->deviceName);
+    savedDeviceInfo->deviceName = NULL;
 }
 
 static OCStackResult DeepCopyDeviceInfo(OCDeviceInfo info)
 {
-    savedDeviceInfo.deviceName = OICStrdup(info.deviceName);
+    OCDeviceInfo *savedDeviceInfo = &OCGetCurrentContext()->deviceInfo;
+
+    savedDeviceInfo->deviceName = OICStrdup(info.deviceName);
 
-    if(!savedDeviceInfo.deviceName && info.deviceName)
+    if(!savedDeviceInfo->deviceName && info.deviceName)
     {
         DeleteDeviceInfo();
         return OC_STACK_NO_MEMORY;
@@ -24,6 +24,9 @@
 #include "ocresourcehandler.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "oic_metrics.h"
+#include "oic_trace.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 #include "logger.h"
@@ -43,13 +46,147 @@
 
 #define TAG  "OIC_RI_SERVERREQUEST"
 
+/** Alignment of the scratch space of a server request and of allocations from it.*/
+#define SERVER_REQUEST_ALIGN(size) (((size) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1))
+
 static struct OCServerRequest * serverRequestList = NULL;
 static struct OCServerResponse * serverResponseList = NULL;
 
+/** Server requests hashed by handle and by token, sharing one bucket count.*/
+static struct OCServerRequest ** serverRequestHandleIndex = NULL;
+static struct OCServerRequest ** serverRequestTokenIndex = NULL;
+static size_t serverRequestIndexSize = 0;
+static size_t serverRequestCount = 0;
+
+/** How request payloads are parsed for entity handlers, set with OCSetRequestPayloadParseMode.*/
+static OCPayloadParseMode requestPayloadParseMode = OC_PAYLOAD_PARSE_DEFAULT;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
 
+/**
+ * Hash a server request handle
+ *
+ * @param handle - handle of server request
+ *
+ * @return
+ *     hash of the handle
+ */
+static size_t HashServerRequestHandle(const OCServerRequest * handle)
+{
+    uintptr_t value = (uintptr_t)handle / sizeof(uint64_t);
+    return (size_t)(value ^ (value >> 16)) * 2654435761u;
+}
+
+/**
+ * Hash a server request token
+ *
+ * @param token - token of server request
+ * @param tokenLength - length of token
+ *
+ * @return
+ *     FNV-1a hash of the token
+ */
+static size_t HashServerRequestToken(const CAToken_t token, uint8_t tokenLength)
+{
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < tokenLength; i++)
+    {
+        hash = (hash ^ (uint8_t)token[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Link a server request into the handle and token indexes
+ *
+ * @param serverRequest - server request to index
+ */
+static void IndexServerRequest(OCServerRequest * serverRequest)
+{
+    size_t mask = serverRequestIndexSize - 1;
+    size_t bucket = HashServerRequestHandle(serverRequest) & mask;
+    serverRequest->handleNext = serverRequestHandleIndex[bucket];
+    serverRequestHandleIndex[bucket] = serverRequest;
+
+    bucket = HashServerRequestToken(serverRequest->requestToken, serverRequest->tokenLength) & mask;
+    serverRequest->tokenNext = serverRequestTokenIndex[bucket];
+    serverRequestTokenIndex[bucket] = serverRequest;
+}
+
+/**
+ * Unlink a server request from the handle and token indexes
+ *
+ * @param serverRequest - server request to unlink
+ */
+static void UnindexServerRequest(OCServerRequest * serverRequest)
+{
+    size_t mask = serverRequestIndexSize - 1;
+    OCServerRequest **link =
+        &serverRequestHandleIndex[HashServerRequestHandle(serverRequest) & mask];
+    while (*link && *link != serverRequest)
+    {
+        link = &(*link)->handleNext;
+    }
+    if (*link)
+    {
+        *link = serverRequest->handleNext;
+    }
+
+    link = &serverRequestTokenIndex[HashServerRequestToken(serverRequest->requestToken,
+                                                           serverRequest->tokenLength) & mask];
+    while (*link && *link != serverRequest)
+    {
+        link = &(*link)->tokenNext;
+    }
+    if (*link)
+    {
+        *link = serverRequest->tokenNext;
+    }
+}
+
+/**
+ * Make room in the indexes for one more server request, doubling the bucket count once
+ * there are as many requests as buckets
+ *
+ * @return
+ *     OCStackResult
+ */
+static OCStackResult ReserveServerRequestIndex()
+{
+    if (serverRequestCount < serverRequestIndexSize)
+    {
+        return OC_STACK_OK;
+    }
+
+    size_t size = serverRequestIndexSize ? serverRequestIndexSize * 2 :
+                                           SERVER_REQUEST_INDEX_INITIAL_SIZE;
+    OCServerRequest **handleIndex =
+        (OCServerRequest **) OICCalloc(size, sizeof(OCServerRequest *));
+    OCServerRequest **tokenIndex =
+        (OCServerRequest **) OICCalloc(size, sizeof(OCServerRequest *));
+    if (!handleIndex || !tokenIndex)
+    {
+        OICFree(handleIndex);
+        OICFree(tokenIndex);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OICFree(serverRequestHandleIndex);
+    OICFree(serverRequestTokenIndex);
+    serverRequestHandleIndex = handleIndex;
+    serverRequestTokenIndex = tokenIndex;
+    serverRequestIndexSize = size;
+
+    OCServerRequest *tmp = NULL;
+    DL_FOREACH(serverRequestList, tmp)
+    {
+        IndexServerRequest(tmp);
+    }
+    return OC_STACK_OK;
+}
+
 /**
  * Add a server response to the server response list
  *
@@ -75,6 +212,12 @@ static OCStackResult AddServerResponse (OCServerResponse ** response, OCRequestH
 
     serverResponse->requestHandle = requestHandle;
 
+    OCServerRequest *serverRequest = GetServerRequestUsingHandle((OCServerRequest *)requestHandle);
+    if (serverRequest)
+    {
+        serverRequest->response = serverResponse;
+    }
+
     *response = serverResponse;
     OIC_LOG(INFO, TAG, "Server Response Added!!");
     LL_APPEND (serverResponseList, serverResponse);
@@ -91,20 +234,76 @@ exit:
 }
 
 /**
- * Delete a server request from the server request list
+ * Take memory from the scratch space of a server request, or from the heap once the
+ * scratch space is used up. The scratch space is zeroed at allocation and never reused,
+ * so the memory is always zeroed.
  *
- * @param serverRequest - server request to delete
+ * @param serverRequest - server request the memory belongs to
+ * @param size - number of bytes
+ *
+ * @return
+ *     pointer to the memory, released with ServerRequestFree
  */
-static void DeleteServerRequest(OCServerRequest * serverRequest)
+static void * ServerRequestAlloc(OCServerRequest * serverRequest, size_t size)
 {
-    if(serverRequest)
+    size_t alignedSize = SERVER_REQUEST_ALIGN(size);
+    if (serverRequest->arenaSize - serverRequest->arenaUsed >= alignedSize)
     {
-        LL_DELETE(serverRequestList, serverRequest);
-        OICFree(serverRequest->requestToken);
-        OICFree(serverRequest);
-        serverRequest = NULL;
-        OIC_LOG(INFO, TAG, "Server Request Removed!!");
+        void *ptr = serverRequest->arena + serverRequest->arenaUsed;
+        serverRequest->arenaUsed += alignedSize;
+        return ptr;
     }
+    return OICCalloc(1, size);
+}
+
+/**
+ * Release memory from ServerRequestAlloc. Scratch space is left alone, it goes away
+ * with the server request.
+ *
+ * @param serverRequest - server request the memory belongs to
+ * @param ptr - memory to release
+ */
+static void ServerRequestFree(OCServerRequest * serverRequest, void * ptr)
+{
+    uint8_t *bytes = (uint8_t *)ptr;
+    if (bytes < serverRequest->arena || bytes >= serverRequest->arena + serverRequest->arenaSize)
+    {
+        OICFree(ptr);
+    }
+}
+
+/**
+ * Encode a response payload, into the scratch space of the server request when it fits.
+ *
+ * @param serverRequest - server request being responded to
+ * @param payload - payload to encode
+ * @param out - encoded payload, released with ServerRequestFree
+ * @param size - size of the encoded payload
+ *
+ * @return
+ *     OCStackResult
+ */
+static OCStackResult ServerRequestEncodePayload(OCServerRequest * serverRequest,
+                                                OCPayload * payload,
+                                                uint8_t ** out, size_t * size)
+{
+    OIC_TRACE(OIC_TRACE_ENCODE_BEGIN, serverRequest->requestToken, serverRequest->tokenLength);
+
+    uint8_t *buffer = serverRequest->arena + serverRequest->arenaUsed;
+    OCStackResult result = OCConvertPayloadToFixedBuffer(payload, buffer,
+            serverRequest->arenaSize - serverRequest->arenaUsed, size);
+    if (OC_STACK_OK == result)
+    {
+        serverRequest->arenaUsed += SERVER_REQUEST_ALIGN(*size);
+        *out = buffer;
+    }
+    else if (OC_STACK_NO_MEMORY == result)
+    {
+        result = OCConvertPayload(payload, out, size);
+    }
+
+    OIC_TRACE(OIC_TRACE_ENCODE_END, serverRequest->requestToken, serverRequest->tokenLength);
+    return result;
 }
 
 /**
@@ -116,6 +315,12 @@ static void DeleteServerResponse(OCServerResponse * serverResponse)
 {
     if(serverResponse)
     {
+        OCServerRequest *serverRequest =
+            GetServerRequestUsingHandle((OCServerRequest *)serverResponse->requestHandle);
+        if (serverRequest && serverRequest->response == serverResponse)
+        {
+            serverRequest->response = NULL;
+        }
         LL_DELETE(serverResponseList, serverResponse);
         OCPayloadDestroy(serverResponse->payload);
         OICFree(serverResponse);
@@ -123,6 +328,35 @@ static void DeleteServerResponse(OCServerResponse * serverResponse)
     }
 }
 
+/**
+ * Delete a server request from the server request list
+ *
+ * @param serverRequest - server request to delete
+ */
+static void DeleteServerRequest(OCServerRequest * serverRequest)
+{
+    if(serverRequest)
+    {
+        if (serverRequest->response)
+        {
+            DeleteServerResponse(serverRequest->response);
+        }
+        UnindexServerRequest(serverRequest);
+        serverRequestCount--;
+        DL_DELETE(serverRequestList, serverRequest);
+        if (serverRequest->pinCount)
+        {
+            // An entity handler is running for the request, it goes once the handler returns
+            serverRequest->deletePending = true;
+            return;
+        }
+        // The token and any scratch space go with the single allocation
+        OICFree(serverRequest);
+        serverRequest = NULL;
+        OIC_LOG(INFO, TAG, "Server Request Removed!!");
+    }
+}
+
 /**
  * Find a server response and delete it from the server response list
  *
@@ -173,6 +407,7 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
         OIC_LOG_V(ERROR, TAG, "CASendResponse failed with CA error %u", result);
         return CAResultToOCResult(result);
     }
+    OIC_METRIC_INC(OIC_METRIC_RESPONSES_SENT);
     return OC_STACK_OK;
 }
 
@@ -197,16 +432,21 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
         return NULL;
     }
 
-    OCServerRequest * out = NULL;
     OIC_LOG(INFO, TAG,"Get server request with token");
     OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
-    OIC_LOG(INFO, TAG,"Found token");
-    LL_FOREACH (serverRequestList, out)
+    if (!serverRequestIndexSize)
+    {
+        return NULL;
+    }
+
+    size_t bucket = HashServerRequestToken(token, tokenLength) & (serverRequestIndexSize - 1);
+    for (OCServerRequest *out = serverRequestTokenIndex[bucket]; out; out = out->tokenNext)
     {
-        OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->requestToken, tokenLength);
-        if(memcmp(out->requestToken, token, tokenLength) == 0)
+        if (out->tokenLength == tokenLength &&
+            memcmp(out->requestToken, token, tokenLength) == 0)
         {
+            OIC_LOG(INFO, TAG,"Found token");
             return out;
         }
     }
@@ -223,12 +463,15 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
  */
 OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle)
 {
-    OCServerRequest * out = NULL;
-    LL_FOREACH (serverRequestList, out)
+    if (serverRequestIndexSize)
     {
-        if(out == handle)
+        size_t bucket = HashServerRequestHandle(handle) & (serverRequestIndexSize - 1);
+        for (OCServerRequest *out = serverRequestHandleIndex[bucket]; out; out = out->handleNext)
         {
-            return out;
+            if(out == handle)
+            {
+                return out;
+            }
         }
     }
     OIC_LOG(ERROR, TAG, "Server Request not found!!");
@@ -245,13 +488,10 @@ OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle)
  */
 OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest * handle)
 {
-    OCServerResponse * out = NULL;
-    LL_FOREACH (serverResponseList, out)
+    OCServerRequest * serverRequest = GetServerRequestUsingHandle(handle);
+    if (serverRequest && serverRequest->response)
     {
-        if(out->requestHandle == handle)
-        {
-            return out;
-        }
+        return serverRequest->response;
     }
     OIC_LOG(ERROR, TAG, "Server Response not found!!");
     return NULL;
@@ -275,11 +515,35 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
 
     OIC_LOG_V(INFO, TAG, "addserverrequest entry!! [%s:%u]", devAddr->addr, devAddr->port);
 
-    serverRequest = (OCServerRequest *) OICCalloc(1, sizeof(OCServerRequest) +
+    if (OC_STACK_OK != ReserveServerRequestIndex())
+    {
+        *request = NULL;
+        return OC_STACK_NO_MEMORY;
+    }
+
+    if (!rcvdVendorSpecificHeaderOptions)
+    {
+        numRcvdVendorSpecificHeaderOptions = 0;
+    }
+    size_t queryLength = query ? strlen(query) + 1 : 1;
+    size_t resourceUrlLength = resourceUrl ? strlen(resourceUrl) + 1 : 1;
+    size_t optionsSize = numRcvdVendorSpecificHeaderOptions * sizeof(OCHeaderOption);
+
+    // The request, its payload, token, URL, query, header options and scratch space for
+    // the response share one allocation, released in one step once the response is sent.
+    size_t requestSize = SERVER_REQUEST_ALIGN(sizeof(OCServerRequest) +
         (reqTotalSize ? reqTotalSize : 1) - 1);
+    size_t arenaSize = SERVER_REQUEST_ALIGN(tokenLength) + SERVER_REQUEST_ALIGN(optionsSize) +
+        SERVER_REQUEST_ALIGN(queryLength) + SERVER_REQUEST_ALIGN(resourceUrlLength) +
+        SERVER_REQUEST_ARENA_SIZE;
+
+    serverRequest = (OCServerRequest *) OICCalloc(1, requestSize + arenaSize);
     VERIFY_NON_NULL(devAddr);
     VERIFY_NON_NULL(serverRequest);
 
+    serverRequest->arena = (uint8_t *)serverRequest + requestSize;
+    serverRequest->arenaSize = arenaSize;
+
     serverRequest->coapID = coapID;
     serverRequest->delayedResNeeded = delayedResNeeded;
     serverRequest->notificationFlag = notificationFlag;
@@ -293,15 +557,24 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
     serverRequest->ehResponseHandler = HandleSingleResponse;
     serverRequest->numResponses = 1;
 
+    // The arena has room reserved for these, so they do not fail
+    serverRequest->query = (char *) ServerRequestAlloc(serverRequest, queryLength);
+    serverRequest->resourceUrl = (char *) ServerRequestAlloc(serverRequest, resourceUrlLength);
     if(query)
     {
-        OICStrcpy(serverRequest->query, sizeof(serverRequest->query), query);
+        OICStrcpy(serverRequest->query, queryLength, query);
+    }
+    if(resourceUrl)
+    {
+        OICStrcpy(serverRequest->resourceUrl, resourceUrlLength, resourceUrl);
     }
 
-    if(rcvdVendorSpecificHeaderOptions)
+    if(numRcvdVendorSpecificHeaderOptions)
     {
+        serverRequest->rcvdVendorSpecificHeaderOptions =
+            (OCHeaderOption *) ServerRequestAlloc(serverRequest, optionsSize);
         memcpy(serverRequest->rcvdVendorSpecificHeaderOptions, rcvdVendorSpecificHeaderOptions,
-            MAX_HEADER_OPTIONS * sizeof(OCHeaderOption));
+            optionsSize);
     }
     if(payload && reqTotalSize)
     {
@@ -318,7 +591,8 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
         // particular library implementation (it may or may not be a null pointer).
         if (tokenLength)
         {
-            serverRequest->requestToken = (CAToken_t) OICMalloc(tokenLength);
+            serverRequest->requestToken = (CAToken_t) ServerRequestAlloc(serverRequest,
+                                                                         tokenLength);
             VERIFY_NON_NULL(serverRequest->requestToken);
             memcpy(serverRequest->requestToken, requestToken, tokenLength);
         }
@@ -326,17 +600,15 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
     }
     serverRequest->tokenLength = tokenLength;
 
-    if(resourceUrl)
-    {
-        OICStrcpy(serverRequest->resourceUrl, sizeof(serverRequest->resourceUrl),
-            resourceUrl);
-    }
-
     serverRequest->devAddr = *devAddr;
+    serverRequest->timeStamp = OICGetCurrentTime(TIME_IN_MS);
 
     *request = serverRequest;
     OIC_LOG(INFO, TAG, "Server Request Added!!");
-    LL_APPEND (serverRequestList, serverRequest);
+    // Requests are appended in arrival order, which the timeout sweep relies on
+    DL_APPEND (serverRequestList, serverRequest);
+    IndexServerRequest(serverRequest);
+    serverRequestCount++;
     return OC_STACK_OK;
 
 exit:
@@ -376,8 +648,8 @@ OCStackResult FormOCEntityHandlerRequest(
 
         if(payload && payloadSize)
         {
-            if(OCParsePayload(&entityHandlerRequest->payload, payloadType,
-                        payload, payloadSize) != OC_STACK_OK)
+            if(OCParsePayloadWithMode(&entityHandlerRequest->payload, payloadType,
+                        payload, payloadSize, requestPayloadParseMode) != OC_STACK_OK)
             {
                 return OC_STACK_ERROR;
             }
@@ -396,6 +668,17 @@ OCStackResult FormOCEntityHandlerRequest(
     return OC_STACK_INVALID_PARAM;
 }
 
+OCStackResult SetRequestPayloadParseMode(OCPayloadParseMode mode)
+{
+    if (OC_PAYLOAD_PARSE_DEFAULT != mode && OC_PAYLOAD_PARSE_ARENA != mode)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    requestPayloadParseMode = mode;
+    return OC_STACK_OK;
+}
+
 /**
  * Find a server request in the server request list and delete
  *
@@ -403,18 +686,70 @@ OCStackResult FormOCEntityHandlerRequest(
  */
 void FindAndDeleteServerRequest(OCServerRequest * serverRequest)
 {
-    OCServerRequest* tmp;
-    if(serverRequest)
+    if(serverRequest && GetServerRequestUsingHandle(serverRequest))
+    {
+        DeleteServerRequest(serverRequest);
+    }
+}
+
+void PinServerRequest(OCServerRequest * serverRequest)
+{
+    serverRequest->pinCount++;
+}
+
+bool UnpinServerRequest(OCServerRequest * serverRequest)
+{
+    if (--serverRequest->pinCount || !serverRequest->deletePending)
+    {
+        return !serverRequest->deletePending;
+    }
+    OICFree(serverRequest);
+    OIC_LOG(INFO, TAG, "Server Request Removed!!");
+    return false;
+}
+
+void ProcessServerRequestTimeouts()
+{
+    if (!serverRequestList)
+    {
+        return;
+    }
+
+    // The handle of a request is its address, which a later request may get once it is
+    // freed. Requests whose handle an entity handler may still answer, the slow ones and
+    // those whose handler is running, are therefore never expired.
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    OCServerRequest *request = serverRequestList;
+    while (request &&
+           now - request->timeStamp >= SERVER_REQUEST_TIMEOUT_SECONDS * 1000ULL)
     {
-        LL_FOREACH(serverRequestList, tmp)
+        OCServerRequest *next = request->next;
+        if (!request->slowFlag && !request->pinCount)
         {
-            if (serverRequest == tmp)
-            {
-                DeleteServerRequest(tmp);
-                return;
-            }
+            OIC_LOG_V(INFO, TAG, "Server request for %s timed out", request->resourceUrl);
+            DeleteServerRequest(request);
         }
+        request = next;
+    }
+}
+
+void DeleteServerRequestList()
+{
+    while (serverRequestList)
+    {
+        DeleteServerRequest(serverRequestList);
+    }
+    while (serverResponseList)
+    {
+        DeleteServerResponse(serverResponseList);
     }
+
+    OICFree(serverRequestHandleIndex);
+    OICFree(serverRequestTokenIndex);
+    serverRequestHandleIndex = NULL;
+    serverRequestTokenIndex = NULL;
+    serverRequestIndexSize = 0;
+    serverRequestCount = 0;
 }
 
 CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult result, OCMethod method)
@@ -471,14 +806,19 @@ CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult result, OCMe
 
 
 /**
- * Handler function for sending a response from a single resource
+ * Send a response from a single resource.
  *
  * @param ehResponse - pointer to the response from the resource
+ * @param encodedPayload - already CBOR encoded payload to send instead of ehResponse->payload,
+ *                         or NULL to encode ehResponse->payload
+ * @param encodedPayloadSize - size of encodedPayload
  *
  * @return
  *     OCStackResult
  */
-OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+static OCStackResult SendSingleResponse(OCEntityHandlerResponse * ehResponse,
+                                        const uint8_t *encodedPayload,
+                                        size_t encodedPayloadSize)
 {
     OCStackResult result = OC_STACK_ERROR;
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
@@ -491,6 +831,14 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         return OC_STACK_ERROR;
     }
 
+    if (!encodedPayload && ehResponse->payload &&
+        PAYLOAD_TYPE_ENCODED == ehResponse->payload->type)
+    {
+        // Sent as is, the payload keeps ownership of the buffer
+        encodedPayload = ((OCEncodedPayload *)ehResponse->payload)->data;
+        encodedPayloadSize = ((OCEncodedPayload *)ehResponse->payload)->size;
+    }
+
     OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
 
     CopyDevAddrToEndpoint(&serverRequest->devAddr, &responseEndpoint);
@@ -545,7 +893,8 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     if(responseInfo.info.numOptions > 0)
     {
         responseInfo.info.options = (CAHeaderOption_t *)
-                                      OICCalloc(responseInfo.info.numOptions,
+                                      ServerRequestAlloc(serverRequest,
+                                              responseInfo.info.numOptions *
                                               sizeof(CAHeaderOption_t));
 
         if(!responseInfo.info.options)
@@ -594,9 +943,9 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
 
     // Put the JSON prefix and suffix around the payload
-    if(ehResponse->payload)
+    if(encodedPayload || ehResponse->payload)
     {
-        if (ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
+        if (ehResponse->payload && ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
         {
             responseInfo.isMulticast = true;
         }
@@ -610,12 +959,18 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
             case OC_FORMAT_UNDEFINED:
                 // No preference set by the client, so default to CBOR then
             case OC_FORMAT_CBOR:
-                if((result = OCConvertPayload(ehResponse->payload, &responseInfo.info.payload,
-                                &responseInfo.info.payloadSize))
+                if (encodedPayload)
+                {
+                    // CA clones the response info, so the caller keeps ownership of the buffer.
+                    responseInfo.info.payload = (CAPayload_t)encodedPayload;
+                    responseInfo.info.payloadSize = encodedPayloadSize;
+                }
+                else if((result = ServerRequestEncodePayload(serverRequest, ehResponse->payload,
+                                &responseInfo.info.payload, &responseInfo.info.payloadSize))
                         != OC_STACK_OK)
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
-                    OICFree(responseInfo.info.options);
+                    ServerRequestFree(serverRequest, responseInfo.info.options);
                     return result;
                 }
                 responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
@@ -684,13 +1039,41 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     result = OCSendResponse(&responseEndpoint, &responseInfo);
 #endif
 
-    OICFree(responseInfo.info.payload);
-    OICFree(responseInfo.info.options);
+    if (!encodedPayload)
+    {
+        ServerRequestFree(serverRequest, responseInfo.info.payload);
+    }
+    ServerRequestFree(serverRequest, responseInfo.info.options);
     //Delete the request
     FindAndDeleteServerRequest(serverRequest);
     return result;
 }
 
+/**
+ * Handler function for sending a response from a single resource
+ *
+ * @param ehResponse - pointer to the response from the resource
+ *
+ * @return
+ *     OCStackResult
+ */
+OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+{
+    return SendSingleResponse(ehResponse, NULL, 0);
+}
+
+OCStackResult HandleSingleEncodedResponse(OCEntityHandlerResponse * ehResponse,
+                                          const uint8_t *payload, size_t payloadSize)
+{
+    if (!payload || !payloadSize)
+    {
+        OIC_LOG(ERROR, TAG, "Encoded payload is NULL");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    return SendSingleResponse(ehResponse, payload, payloadSize);
+}
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
@@ -733,15 +1116,29 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
             VERIFY_NON_NULL(serverResponse);
         }
 
-        if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+        OCRepPayload *newPayload = NULL;
+        if(ehResponse->payload->type == PAYLOAD_TYPE_ENCODED)
+        {
+            // Fragments are merged as representations
+            stackRet = OCEncodedPayloadDecode((OCEncodedPayload *)ehResponse->payload,
+                                              &newPayload);
+            if (OC_STACK_OK != stackRet)
+            {
+                OIC_LOG(ERROR, TAG, "Error decoding encoded payload");
+                goto exit;
+            }
+        }
+        else if(ehResponse->payload->type == PAYLOAD_TYPE_REPRESENTATION)
+        {
+            newPayload = OCRepPayloadClone((OCRepPayload *)ehResponse->payload);
+        }
+        else
         {
             stackRet = OC_STACK_ERROR;
             OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
             goto exit;
         }
 
-        OCRepPayload *newPayload = OCRepPayloadClone((OCRepPayload *)ehResponse->payload);
-
         if(!serverResponse->payload)
         {
             serverResponse->payload = (OCPayload *)newPayload;
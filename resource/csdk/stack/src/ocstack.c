@@ -48,12 +48,18 @@
 #include "ocrandom.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "oic_metrics.h"
+#include "oic_trace.h"
 #include "logger.h"
 #include "ocserverrequest.h"
+#include "occollection.h"
+#include "oicgroup.h"
 #include "secureresourcemanager.h"
 #include "doxmresource.h"
 #include "cacommon.h"
 #include "cainterface.h"
+#include "camutex.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 
@@ -112,10 +118,30 @@ typedef enum
 //-----------------------------------------------------------------------------
 static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
-OCResource *headResource = NULL;
-static OCResource *tailResource = NULL;
-static OCResourceHandle platformResource = {0};
-static OCResourceHandle deviceResource = {0};
+static OCStackContext defaultContext = {0};
+OCStackContext *stackContexts = &defaultContext;
+
+/**
+ * Context selected with OCSetCurrentContext by each thread, NULL for the default context.
+ * The connectivity thread selects the context of each request it handles without
+ * affecting the selection of the application threads.
+ */
+static OC_THREAD_LOCAL OCStackContext *currentContext = NULL;
+
+/**
+ * Serializes the application threads, the thread running OCProcess and the connectivity
+ * threads delivering messages. Recursive as entity handlers and callbacks call the stack.
+ */
+static ca_mutex stackMutex = NULL;
+
+/** Number of times the calling thread holds stackMutex.*/
+static OC_THREAD_LOCAL uint32_t stackLockDepth = 0;
+
+/** Server instance ID read from the doxm, dropped by OCServerInstanceIDChanged.*/
+static OicUuid_t serverInstanceId;
+static bool serverInstanceIdValid = false;
+static char serverInstanceIdStr[UUID_STRING_SIZE];
+static bool serverInstanceIdStrValid = false;
 #ifdef WITH_PRESENCE
 static OCPresenceState presenceState = OC_PRESENCE_UNINITIALIZED;
 static PresenceResource presenceResource;
@@ -128,9 +154,18 @@ static OCMode myStackMode;
 //TODO: revisit this design
 static bool gRASetInfo = false;
 #endif
-OCDeviceEntityHandler defaultDeviceHandler;
-void* defaultDeviceHandlerCallbackParameter = NULL;
 static const char COAP_TCP[] = "coap+tcp:";
+static OCPayloadParseMode responsePayloadParseMode = OC_PAYLOAD_PARSE_DEFAULT;
+
+/**
+ * Limits applied to received requests and resource URIs, set with OCSetRequestLimits.
+ */
+static struct
+{
+    uint16_t maxUriLength;
+    uint16_t maxQueryLength;
+    uint8_t maxHeaderOptions;
+} requestLimits = { MAX_URI_LENGTH, MAX_QUERY_LENGTH, MAX_HEADER_OPTIONS };
 
 //#ifdef DIRECT_PAIRING
 OCDirectPairingCB gDirectpairingCallback = NULL;
@@ -165,6 +200,20 @@ OCDirectPairingCB gDirectpairingCallback = NULL;
  */
 static OCDoHandle GenerateInvocationHandle();
 
+/**
+ * Call the callback of a client callback node. Callbacks of the application run without
+ * the lock of the stack. The node stays allocated until the call returns, even when it is
+ * deleted meanwhile.
+ *
+ * @param cbNode     Client callback node.
+ * @param response   Response passed to the callback.
+ * @param result     Set to the result of the callback.
+ *
+ * @return true if the node is still registered after the call.
+ */
+static bool InvokeClientCB(ClientCB *cbNode, OCClientResponse *response,
+                           OCStackApplicationResult *result);
+
 /**
  * Initialize resource data structures, variables, etc.
  *
@@ -172,6 +221,53 @@ static OCDoHandle GenerateInvocationHandle();
  */
 static OCStackResult initResources();
 
+/**
+ * Create the /oic/d and /oic/p resources of a context.
+ *
+ * @param context Context the resources are created in.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult initContextResources(OCStackContext *context);
+
+/**
+ * Delete a context created by OCCreateContext with its resources and information.
+ *
+ * @param context Context to be deleted.
+ */
+static void deleteContext(OCStackContext *context);
+
+/**
+ * Find the context serving a request URI.
+ *
+ * @param uri Request URI without query.
+ * @return the context whose prefix starts the URI, the default context if there is none.
+ */
+static OCStackContext *findContextForUri(const char *uri);
+
+/**
+ * Check that a context exists.
+ *
+ * @param context Context to be found.
+ * @return true if the context is the default one or was created and not yet deleted.
+ */
+static bool isContext(const OCStackContext *context);
+
+/**
+ * Get the context selected by the calling thread.
+ *
+ * @return the selected context, the default one if none or a since deleted one was selected.
+ */
+static OCStackContext *getCurrentContext();
+
+/**
+ * Check whether a URI is a URI prefix or lies below it.
+ *
+ * @param prefix URI prefix.
+ * @param uri URI to be checked.
+ * @return true if the URI equals the prefix or continues it with a path segment.
+ */
+static bool isUriInPrefix(const char *prefix, const char *uri);
+
 /**
  * Add a resource to the end of the linked list of resources.
  *
@@ -271,6 +367,17 @@ static OCStackResult deleteResource(OCResource *resource);
  */
 static void deleteAllResources();
 
+/**
+ * Notify all of the observers of a resource, with the lock of the stack held.
+ *
+ * @param handle Handle of the resource.
+ * @param qos    Quality of service of the notifications.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult NotifyAllObserversUnlocked(OCResourceHandle handle,
+                                                OCQualityOfService qos);
+
 /**
  * Increment resource sequence number.  Handles rollover.
  *
@@ -494,6 +601,7 @@ static OCStackResult OCSendRequest(const CAEndpoint_t *object, CARequestInfo_t *
         OIC_LOG_V(ERROR, TAG, "CASendRequest failed with CA error %u", result);
         return CAResultToOCResult(result);
     }
+    OIC_METRIC_INC(OIC_METRIC_REQUESTS_SENT);
     return OC_STACK_OK;
 }
 //-----------------------------------------------------------------------------
@@ -528,8 +636,11 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
             {
                 return result;
             }
-            observer->resource->entityHandler(OC_OBSERVE_FLAG, &ehRequest,
-                            observer->resource->entityHandlerCallbackParam);
+            // The observer is looked up again by its token once the handler returns
+            OCStackCallEntityHandler(observer->resource->entityHandler,
+                                     observer->resource->entityHandlerCallbackParam,
+                                     observer->resource->entityHandlerLocked,
+                                     OC_OBSERVE_FLAG, &ehRequest);
         }
 
         result = DeleteObserverUsingToken (token, tokenLength);
@@ -579,8 +690,11 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
                 {
                     return OC_STACK_ERROR;
                 }
-                observer->resource->entityHandler(OC_OBSERVE_FLAG, &ehRequest,
-                                    observer->resource->entityHandlerCallbackParam);
+                // The observer is looked up again by its token once the handler returns
+                OCStackCallEntityHandler(observer->resource->entityHandler,
+                                         observer->resource->entityHandlerCallbackParam,
+                                         observer->resource->entityHandlerLocked,
+                                         OC_OBSERVE_FLAG, &ehRequest);
 
                 result = DeleteObserverUsingToken (token, tokenLength);
                 if(result == OC_STACK_OK)
@@ -596,10 +710,11 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
             else
             {
                 observer->failedCommCount++;
+                observer->forceHighQos = 1;
+                OIC_LOG_V(DEBUG, TAG, "Failed count for this observer is %d",
+                          observer->failedCommCount);
                 result = OC_STACK_CONTINUE;
             }
-            observer->forceHighQos = 1;
-            OIC_LOG_V(DEBUG, TAG, "Failed count for this observer is %d",observer->failedCommCount);
         }
         break;
     default:
@@ -1058,9 +1173,8 @@ OCStackResult HandlePresenceResponse(const CAEndpoint_t *endpoint,
         }
     }
 
-    cbResult = cbNode->callBack(cbNode->context, cbNode->handle, &response);
-
-    if (cbResult == OC_STACK_DELETE_TRANSACTION)
+    if (InvokeClientCB(cbNode, &response, &cbResult) &&
+        cbResult == OC_STACK_DELETE_TRANSACTION)
     {
         FindAndDeleteClientCB(cbNode);
     }
@@ -1117,9 +1231,11 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
             response.identity.id_length = responseInfo->info.identity.id_length;
 
             response.result = CAToOCStackResult(responseInfo->result);
-            cbNode->callBack(cbNode->context,
-                    cbNode->handle, &response);
-            FindAndDeleteClientCB(cbNode);
+            OCStackApplicationResult appFeedback = OC_STACK_DELETE_TRANSACTION;
+            if (InvokeClientCB(cbNode, &response, &appFeedback))
+            {
+                FindAndDeleteClientCB(cbNode);
+            }
         }
         else
         {
@@ -1221,10 +1337,11 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                     return;
                 }
 
-                if(OC_STACK_OK != OCParsePayload(&response.payload,
+                if(OC_STACK_OK != OCParsePayloadWithMode(&response.payload,
                             type,
                             responseInfo->info.payload,
-                            responseInfo->info.payloadSize))
+                            responseInfo->info.payloadSize,
+                            cbNode->parseMode))
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
                     OCPayloadDestroy(response.payload);
@@ -1282,17 +1399,16 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
             }
             else
             {
-                OCStackApplicationResult appFeedback = cbNode->callBack(cbNode->context,
-                                                                        cbNode->handle,
-                                                                        &response);
-                cbNode->sequenceNumber = response.sequenceNumber;
-
-                if (appFeedback == OC_STACK_DELETE_TRANSACTION)
+                OCStackApplicationResult appFeedback = OC_STACK_DELETE_TRANSACTION;
+                // The node is gone if it was deleted while the callback ran, e.g. by OCCancel
+                bool cbNodeLive = InvokeClientCB(cbNode, &response, &appFeedback);
+                if (cbNodeLive && appFeedback == OC_STACK_DELETE_TRANSACTION)
                 {
                     FindAndDeleteClientCB(cbNode);
                 }
-                else
+                else if (cbNodeLive)
                 {
+                    cbNode->sequenceNumber = response.sequenceNumber;
                     // To keep discovery callbacks active.
                     cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
                                             MILLISECONDS_PER_SECOND);
@@ -1379,7 +1495,8 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
     OIC_LOG(INFO, TAG, "Exit HandleCAResponses");
 }
 
-void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* responseInfo)
+static void HandleCAResponsesUnlocked(const CAEndpoint_t* endPoint,
+                                      const CAResponseInfo_t* responseInfo)
 {
     VERIFY_NON_NULL_NR(endPoint, FATAL);
     VERIFY_NON_NULL_NR(responseInfo, FATAL);
@@ -1414,11 +1531,19 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
                  (CAEndpoint_t *) endPoint);
 #endif
 
+    OIC_METRIC_INC(OIC_METRIC_RESPONSES_RECEIVED);
     OCHandleResponse(endPoint, responseInfo);
 
     OIC_LOG(INFO, TAG, "Exit HandleCAResponses");
 }
 
+void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* responseInfo)
+{
+    OCStackLock();
+    HandleCAResponsesUnlocked(endPoint, responseInfo);
+    OCStackUnlock();
+}
+
 /*
  * This function handles error response from CA
  * code shall be added to handle the errors
@@ -1628,7 +1753,9 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     }
 
     OCServerProtocolRequest serverRequest = {0};
+    OCStackContext *previousContext = currentContext;
 
+    OIC_METRIC_INC(OIC_METRIC_REQUESTS_RECEIVED);
     OIC_LOG_V(INFO, TAG, "Endpoint URI : %s", requestInfo->info.resourceUri);
 
     char * uriWithoutQuery = NULL;
@@ -1639,50 +1766,58 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     if (requestResult != OC_STACK_OK || !uriWithoutQuery)
     {
         OIC_LOG_V(ERROR, TAG, "getQueryFromUri() failed with OC error code %d\n", requestResult);
+        OIC_METRIC_INC(OIC_METRIC_REQUESTS_REJECTED);
         return;
     }
     OIC_LOG_V(INFO, TAG, "URI without query: %s", uriWithoutQuery);
     OIC_LOG_V(INFO, TAG, "Query : %s", query);
 
-    if(strlen(uriWithoutQuery) < MAX_URI_LENGTH)
+    if(strlen(uriWithoutQuery) >= requestLimits.maxUriLength)
     {
-        OICStrcpy(serverRequest.resourceUrl, sizeof(serverRequest.resourceUrl), uriWithoutQuery);
-        OICFree(uriWithoutQuery);
+        OIC_LOG_V(ERROR, TAG, "URI length exceeds the limit of %u.", requestLimits.maxUriLength);
+        requestResult = OC_STACK_INVALID_URI;
+        goto exit;
     }
-    else
+    if(query && strlen(query) >= requestLimits.maxQueryLength)
     {
-        OIC_LOG(ERROR, TAG, "URI length exceeds MAX_URI_LENGTH.");
-        OICFree(uriWithoutQuery);
-        OICFree(query);
-        return;
+        OIC_LOG_V(ERROR, TAG, "Query length exceeds the limit of %u.",
+                  requestLimits.maxQueryLength);
+        requestResult = OC_STACK_INVALID_QUERY;
+        goto exit;
     }
 
-    if(query)
+    // The request is handled by the context owning the URI, which serves its virtual
+    // resources under its prefix.
+    OCStackContext *context = findContextForUri(uriWithoutQuery);
+    currentContext = context;
+    if (context->uriPrefix)
     {
-        if(strlen(query) < MAX_QUERY_LENGTH)
-        {
-            OICStrcpy(serverRequest.query, sizeof(serverRequest.query), query);
-            OICFree(query);
-        }
-        else
+        char *contextUri = uriWithoutQuery + context->uriPrefixLength;
+        if (strcmp(contextUri, OC_RSRVD_WELL_KNOWN_URI) == 0 ||
+            strcmp(contextUri, OC_RSRVD_DEVICE_URI) == 0 ||
+            strcmp(contextUri, OC_RSRVD_PLATFORM_URI) == 0)
         {
-            OIC_LOG(ERROR, TAG, "Query length exceeds MAX_QUERY_LENGTH.");
-            OICFree(query);
-            return;
+            memmove(uriWithoutQuery, contextUri, strlen(contextUri) + 1);
         }
     }
 
+    // The URI and query are released once the request is handled, AddServerRequest copies
+    // them into the allocation of the server request.
+    serverRequest.resourceUrl = uriWithoutQuery;
+    serverRequest.query = query;
+
+    // The payload and token are only borrowed from CA for the duration of this call,
+    // AddServerRequest copies them into the allocation of the server request.
     if ((requestInfo->info.payload) && (0 < requestInfo->info.payloadSize))
     {
         serverRequest.reqTotalSize = requestInfo->info.payloadSize;
-        serverRequest.payload = (uint8_t *) OICMalloc(requestInfo->info.payloadSize);
-        memcpy (serverRequest.payload, requestInfo->info.payload,
-                requestInfo->info.payloadSize);
+        serverRequest.payload = requestInfo->info.payload;
     }
     else
     {
         serverRequest.reqTotalSize = 0;
     }
+    OIC_HISTOGRAM_RECORD(OIC_HISTOGRAM_REQUEST_PAYLOAD_SIZE, serverRequest.reqTotalSize);
 
     switch (requestInfo->method)
     {
@@ -1704,8 +1839,8 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                         requestInfo->info.type, requestInfo->info.numOptions,
                         requestInfo->info.options, requestInfo->info.token,
                         requestInfo->info.tokenLength, requestInfo->info.resourceUri);
-            OICFree(serverRequest.payload);
-            return;
+            requestResult = OC_STACK_INVALID_METHOD;
+            goto exit;
     }
 
     OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)requestInfo->info.token,
@@ -1714,19 +1849,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     serverRequest.tokenLength = requestInfo->info.tokenLength;
     if (serverRequest.tokenLength) {
         // Non empty token
-        serverRequest.requestToken = (CAToken_t)OICMalloc(requestInfo->info.tokenLength);
-
-        if (!serverRequest.requestToken)
-        {
-            OIC_LOG(FATAL, TAG, "Allocation for token failed.");
-            SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_INTERNAL_SERVER_ERROR,
-                    requestInfo->info.type, requestInfo->info.numOptions,
-                    requestInfo->info.options, requestInfo->info.token,
-                    requestInfo->info.tokenLength, requestInfo->info.resourceUri);
-            OICFree(serverRequest.payload);
-            return;
-        }
-        memcpy(serverRequest.requestToken, requestInfo->info.token, requestInfo->info.tokenLength);
+        serverRequest.requestToken = requestInfo->info.token;
     }
 
     switch (requestInfo->info.acceptFormat)
@@ -1766,26 +1889,31 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     serverRequest.observationOption = OC_OBSERVE_NO_OPTION;
 
     GetObserveHeaderOption(&serverRequest.observationOption, requestInfo->info.options, &tempNum);
-    if (requestInfo->info.numOptions > MAX_HEADER_OPTIONS)
+    if (requestInfo->info.numOptions > requestLimits.maxHeaderOptions)
     {
-        OIC_LOG(ERROR, TAG,
-                "The request info numOptions is greater than MAX_HEADER_OPTIONS");
+        OIC_LOG_V(ERROR, TAG, "The request info numOptions is greater than the limit of %u",
+                  requestLimits.maxHeaderOptions);
         SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_BAD_OPT,
                 requestInfo->info.type, requestInfo->info.numOptions,
                 requestInfo->info.options, requestInfo->info.token,
                 requestInfo->info.tokenLength, requestInfo->info.resourceUri);
-        OICFree(serverRequest.payload);
-        OICFree(serverRequest.requestToken);
-        return;
+        requestResult = OC_STACK_INVALID_OPTION;
+        goto exit;
     }
     serverRequest.numRcvdVendorSpecificHeaderOptions = tempNum;
     if (serverRequest.numRcvdVendorSpecificHeaderOptions)
     {
-        memcpy (&(serverRequest.rcvdVendorSpecificHeaderOptions), requestInfo->info.options,
-            sizeof(CAHeaderOption_t)*tempNum);
+        // Borrowed like the payload, CA header options are laid out as OCHeaderOption
+        serverRequest.rcvdVendorSpecificHeaderOptions =
+            (OCHeaderOption *) requestInfo->info.options;
     }
 
+#ifdef WITH_METRICS
+    uint64_t handlingStart = OICGetCurrentTime(TIME_IN_US);
+#endif
     requestResult = HandleStackRequests (&serverRequest);
+    OIC_HISTOGRAM_RECORD(OIC_HISTOGRAM_REQUEST_HANDLING_US,
+                         OICGetCurrentTime(TIME_IN_US) - handlingStart);
 
     // Send ACK to client as precursor to slow response
     if(requestResult == OC_STACK_SLOW_RESOURCE)
@@ -1805,15 +1933,21 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                 requestInfo->info.options, requestInfo->info.token,
                 requestInfo->info.tokenLength, requestInfo->info.resourceUri);
     }
-    // requestToken is fed to HandleStackRequests, which then goes to AddServerRequest.
-    // The token is copied in there, and is thus still owned by this function.
-    OICFree(serverRequest.payload);
-    OICFree(serverRequest.requestToken);
+
+exit:
+    if (OC_STACK_OK != requestResult && OC_STACK_SLOW_RESOURCE != requestResult)
+    {
+        OIC_METRIC_INC(OIC_METRIC_REQUESTS_REJECTED);
+    }
+    currentContext = previousContext;
+    OICFree(uriWithoutQuery);
+    OICFree(query);
     OIC_LOG(INFO, TAG, "Exit OCHandleRequests");
 }
 
 //This function will be called back by CA layer when a request is received
-void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* requestInfo)
+static void HandleCARequestsUnlocked(const CAEndpoint_t* endPoint,
+                                     const CARequestInfo_t* requestInfo)
 {
     OIC_LOG(INFO, TAG, "Enter HandleCARequests");
     if(!endPoint)
@@ -1827,6 +1961,7 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
         OIC_LOG(ERROR, TAG, "requestInfo is NULL");
         return;
     }
+    OIC_TRACE(OIC_TRACE_HANDLE_REQUEST, requestInfo->info.token, requestInfo->info.tokenLength);
 
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
 #ifdef ROUTING_GATEWAY
@@ -1881,6 +2016,13 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     OIC_LOG(INFO, TAG, "Exit HandleCARequests");
 }
 
+void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* requestInfo)
+{
+    OCStackLock();
+    HandleCARequestsUnlocked(endPoint, requestInfo);
+    OCStackUnlock();
+}
+
 bool validatePlatformInfo(OCPlatformInfo info)
 {
 
@@ -2002,8 +2144,20 @@ OCStackResult OCInit1(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
         caglobals.clientFlags = (CATransportFlags_t)(caglobals.clientFlags|CA_IPV4|CA_IPV6);
     }
 
-    defaultDeviceHandler = NULL;
-    defaultDeviceHandlerCallbackParameter = NULL;
+    // Kept across OCStop, a connectivity thread may still be releasing it
+    if (!stackMutex)
+    {
+        stackMutex = ca_mutex_new_recursive();
+        if (!stackMutex)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create the stack mutex");
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    currentContext = NULL;
+    defaultContext.defaultDeviceHandler = NULL;
+    defaultContext.defaultDeviceHandlerCallbackParameter = NULL;
 
     result = CAResultToOCResult(CAInitialize());
     VERIFY_SUCCESS(result, OC_STACK_OK);
@@ -2043,6 +2197,9 @@ OCStackResult OCInit1(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
     PresenceTimeOutSize = sizeof (PresenceTimeOut) / sizeof (PresenceTimeOut[0]) - 1;
 #endif // WITH_PRESENCE
 
+    // Requests may already come in, the resources of the stack are created with its lock held
+    OCStackLock();
+
     //Update Stack state to initialized
     stackState = OC_STACK_INITIALIZED;
 
@@ -2074,12 +2231,16 @@ OCStackResult OCInit1(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
         result = InitializeKeepAlive(myStackMode);
     }
 #endif
+    OCStackUnlock();
 
 exit:
     if(result != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "Stack initialization error");
+        OCStackLock();
         deleteAllResources();
+        OCStackUnlock();
+        // The connectivity threads may be waiting for the lock, it is not held while they stop
         CATerminate();
         stackState = OC_STACK_UNINITIALIZED;
     }
@@ -2117,18 +2278,39 @@ OCStackResult OCStop()
 #endif
 
 #ifdef TCP_ADAPTER
+    OCStackLock();
     TerminateKeepAlive(myStackMode);
+    OCStackUnlock();
+#endif
+
+    // Threads running action sets and batch requests take the lock of the stack, they are
+    // stopped before it is held below. Queued children of batch requests still run, before
+    // their resources go.
+    TerminateScheduledGroupActions();
+    TerminateCollectionBatchWorkers();
+
+#ifdef WITH_METRICS
+    // The resource is deleted below, only the handle is left to forget
+    OCStopMonitoringResource();
 #endif
 
     // Free memory dynamically allocated for resources
+    OCStackLock();
     deleteAllResources();
+    InvalidateDiscoveryCache();
     DeleteDeviceInfo();
     DeletePlatformInfo();
+    OCStackUnlock();
+    // The connectivity threads may be waiting for the lock, it is not held while they stop
     CATerminate();
+    OCStackLock();
     // Remove all observers
     DeleteObserverList();
     // Remove all the client callbacks
     DeleteClientCBList();
+    // Remove the requests no response was sent for
+    DeleteServerRequestList();
+    OCStackUnlock();
 
     // De-init the SRM Policy Engine
     // TODO after BeachHead delivery: consolidate into single SRMDeInit()
@@ -2188,17 +2370,17 @@ OCStackResult verifyUriQueryLength(const char *inputUri, uint16_t uriLen)
 
     if (query != NULL)
     {
-        if((query - inputUri) > MAX_URI_LENGTH)
+        if((query - inputUri) > requestLimits.maxUriLength)
         {
             return OC_STACK_INVALID_URI;
         }
 
-        if((inputUri + uriLen - 1 - query) > MAX_QUERY_LENGTH)
+        if((inputUri + uriLen - 1 - query) > requestLimits.maxQueryLength)
         {
             return OC_STACK_INVALID_QUERY;
         }
     }
-    else if(uriLen > MAX_URI_LENGTH)
+    else if(uriLen > requestLimits.maxUriLength)
     {
         return OC_STACK_INVALID_URI;
     }
@@ -2433,39 +2615,42 @@ static OCStackResult OCPreparePresence(CAEndpoint_t *endpoint,
 }
 
 /**
- * Discover or Perform requests on a specified resource
+ * Prepare a request of OCDoResource up to sending it: register its client callback and
+ * build the CA request. The payload is released.
+ *
+ * @param parseMode     Parse mode of the responses, ::OC_PAYLOAD_PARSE_DEFAULT for the one
+ *                      set with OCSetResponsePayloadParseMode.
+ * @param endpoint      Set to the endpoint the request is sent to.
+ * @param requestInfo   Set to the request. Its payload and options are released by the
+ *                      caller, the rest belongs to the client callback.
+ * @param clientCB      Set to the client callback registered for the request.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-OCStackResult OCDoResource(OCDoHandle *handle,
-                            OCMethod method,
-                            const char *requestUri,
-                            const OCDevAddr *destination,
-                            OCPayload* payload,
-                            OCConnectivityType connectivityType,
-                            OCQualityOfService qos,
-                            OCCallbackData *cbData,
-                            OCHeaderOption *options,
-                            uint8_t numOptions)
+static OCStackResult PrepareRequest(OCDoHandle *handle,
+                                    OCMethod method,
+                                    const char *requestUri,
+                                    const OCDevAddr *destination,
+                                    OCPayload* payload,
+                                    OCConnectivityType connectivityType,
+                                    OCQualityOfService qos,
+                                    OCCallbackData *cbData,
+                                    OCHeaderOption *options,
+                                    uint8_t numOptions,
+                                    OCPayloadParseMode parseMode,
+                                    CAEndpoint_t *endpoint,
+                                    CARequestInfo_t *requestInfo,
+                                    ClientCB **clientCB)
 {
-    OIC_LOG(INFO, TAG, "Entering OCDoResource");
-
-    // Validate input parameters
-    VERIFY_NON_NULL(cbData, FATAL, OC_STACK_INVALID_CALLBACK);
-    VERIFY_NON_NULL(cbData->cb, FATAL, OC_STACK_INVALID_CALLBACK);
-    VERIFY_NON_NULL(requestUri , FATAL, OC_STACK_INVALID_URI);
-
     OCStackResult result = OC_STACK_ERROR;
     CAResult_t caResult;
     CAToken_t token = NULL;
     uint8_t tokenLength = CA_MAX_TOKEN_LEN;
-    ClientCB *clientCB = NULL;
     OCDoHandle resHandle = NULL;
-    CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
     OCDevAddr tmpDevAddr = { OC_DEFAULT_ADAPTER };
     uint32_t ttl = 0;
     OCTransportAdapter adapter;
     OCTransportFlags flags;
-    // the request contents are put here
-    CARequestInfo_t requestInfo = {.method = CA_GET};
     // requestUri  will be parsed into the following three variables
     OCDevAddr *devAddr = NULL;
     char *resourceUri = NULL;
@@ -2498,38 +2683,38 @@ OCStackResult OCDoResource(OCDoHandle *handle,
     case OC_REST_OBSERVE:
     case OC_REST_OBSERVE_ALL:
     case OC_REST_CANCEL_OBSERVE:
-        requestInfo.method = CA_GET;
+        requestInfo->method = CA_GET;
         break;
     case OC_REST_PUT:
-        requestInfo.method = CA_PUT;
+        requestInfo->method = CA_PUT;
         break;
     case OC_REST_POST:
-        requestInfo.method = CA_POST;
+        requestInfo->method = CA_POST;
         break;
     case OC_REST_DELETE:
-        requestInfo.method = CA_DELETE;
+        requestInfo->method = CA_DELETE;
         break;
     case OC_REST_DISCOVER:
         qos = OC_LOW_QOS;
         if (destination || devAddr)
         {
-            requestInfo.isMulticast = false;
+            requestInfo->isMulticast = false;
         }
         else
         {
             tmpDevAddr.adapter = adapter;
             tmpDevAddr.flags = flags;
             destination = &tmpDevAddr;
-            requestInfo.isMulticast = true;
+            requestInfo->isMulticast = true;
         }
         // CA_DISCOVER will become GET and isMulticast
-        requestInfo.method = CA_GET;
+        requestInfo->method = CA_GET;
         break;
 #ifdef WITH_PRESENCE
     case OC_REST_PRESENCE:
         // Replacing method type with GET because "presence"
         // is a stack layer only implementation.
-        requestInfo.method = CA_GET;
+        requestInfo->method = CA_GET;
         break;
 #endif
     default:
@@ -2572,48 +2757,58 @@ OCStackResult OCDoResource(OCDoHandle *handle,
     }
 
     // fill in request data
-    requestInfo.info.type = qualityOfServiceToMessageType(qos);
-    requestInfo.info.token = token;
-    requestInfo.info.tokenLength = tokenLength;
-    requestInfo.info.resourceUri = resourceUri;
+    requestInfo->info.type = qualityOfServiceToMessageType(qos);
+    requestInfo->info.token = token;
+    requestInfo->info.tokenLength = tokenLength;
+    requestInfo->info.resourceUri = resourceUri;
 
     if ((method == OC_REST_OBSERVE) || (method == OC_REST_OBSERVE_ALL))
     {
-        result = CreateObserveHeaderOption (&(requestInfo.info.options),
+        result = CreateObserveHeaderOption (&(requestInfo->info.options),
                                     options, numOptions, OC_OBSERVE_REGISTER);
         if (result != OC_STACK_OK)
         {
             goto exit;
         }
-        requestInfo.info.numOptions = numOptions + 1;
+        requestInfo->info.numOptions = numOptions + 1;
     }
     else
     {
-        requestInfo.info.numOptions = numOptions;
-        requestInfo.info.options =
+        requestInfo->info.numOptions = numOptions;
+        requestInfo->info.options =
             (CAHeaderOption_t*) OICCalloc(numOptions, sizeof(CAHeaderOption_t));
-        memcpy(requestInfo.info.options, (CAHeaderOption_t*)options,
+        memcpy(requestInfo->info.options, (CAHeaderOption_t*)options,
                numOptions * sizeof(CAHeaderOption_t));
     }
 
-    CopyDevAddrToEndpoint(devAddr, &endpoint);
+    CopyDevAddrToEndpoint(devAddr, endpoint);
 
-    if(payload)
+    if(payload && PAYLOAD_TYPE_ENCODED == payload->type)
+    {
+        // Already encoded, the request takes over the buffer of the payload
+        OCEncodedPayload *encoded = (OCEncodedPayload *)payload;
+        requestInfo->info.payload = encoded->data;
+        requestInfo->info.payloadSize = encoded->size;
+        requestInfo->info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+        encoded->data = NULL;
+        encoded->size = 0;
+    }
+    else if(payload)
     {
         if((result =
-            OCConvertPayload(payload, &requestInfo.info.payload, &requestInfo.info.payloadSize))
+            OCConvertPayload(payload, &requestInfo->info.payload, &requestInfo->info.payloadSize))
                 != OC_STACK_OK)
         {
             OIC_LOG(ERROR, TAG, "Failed to create CBOR Payload");
             goto exit;
         }
-        requestInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+        requestInfo->info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
     }
     else
     {
-        requestInfo.info.payload = NULL;
-        requestInfo.info.payloadSize = 0;
-        requestInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
+        requestInfo->info.payload = NULL;
+        requestInfo->info.payloadSize = 0;
+        requestInfo->info.payloadFormat = CA_FORMAT_UNDEFINED;
     }
 
     if (result != OC_STACK_OK)
@@ -2627,7 +2822,7 @@ OCStackResult OCDoResource(OCDoHandle *handle,
     if (method == OC_REST_PRESENCE)
     {
         char *presenceUri = NULL;
-        result = OCPreparePresence(&endpoint, resourceUri, &presenceUri);
+        result = OCPreparePresence(endpoint, resourceUri, &presenceUri);
         if (OC_STACK_OK != result)
         {
             goto exit;
@@ -2641,24 +2836,22 @@ OCStackResult OCDoResource(OCDoHandle *handle,
 #endif
 
     ttl = GetTicks(MAX_CB_TIMEOUT_SECONDS * MILLISECONDS_PER_SECOND);
-    result = AddClientCB(&clientCB, cbData, token, tokenLength, &resHandle,
+    result = AddClientCB(clientCB, cbData, token, tokenLength, &resHandle,
                             method, devAddr, resourceUri, resourceType, ttl);
     if (OC_STACK_OK != result)
     {
         goto exit;
     }
+    // Requests sent by the stack itself, with the lock already held by the caller, get
+    // their response with the lock held too. Callbacks of the application run without it.
+    (*clientCB)->callBackLocked = stackLockDepth > 1;
+    (*clientCB)->parseMode = (OC_PAYLOAD_PARSE_DEFAULT != parseMode) ?
+                             parseMode : responsePayloadParseMode;
 
     devAddr = NULL;       // Client CB list entry now owns it
     resourceUri = NULL;   // Client CB list entry now owns it
     resourceType = NULL;  // Client CB list entry now owns it
 
-    // send request
-    result = OCSendRequest(&endpoint, &requestInfo);
-    if (OC_STACK_OK != result)
-    {
-        goto exit;
-    }
-
     if (handle)
     {
         *handle = resHandle;
@@ -2668,93 +2861,361 @@ exit:
     if (result != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "OCDoResource error");
-        FindAndDeleteClientCB(clientCB);
+        FindAndDeleteClientCB(*clientCB);
+        *clientCB = NULL;
         CADestroyToken(token);
         if (handle)
         {
             *handle = NULL;
         }
         OICFree(resHandle);
+        OICFree(requestInfo->info.payload);
+        requestInfo->info.payload = NULL;
+        OICFree(requestInfo->info.options);
+        requestInfo->info.options = NULL;
     }
 
     // This is the owner of the payload object, so we free it
     OCPayloadDestroy(payload);
-    OICFree(requestInfo.info.payload);
     OICFree(devAddr);
     OICFree(resourceUri);
     OICFree(resourceType);
-    OICFree(requestInfo.info.options);
     return result;
 }
 
-OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption * options,
-        uint8_t numOptions)
+/**
+ * Release what remains of a request prepared by PrepareRequest once it is sent.
+ */
+static void ReleasePreparedRequest(CARequestInfo_t *requestInfo)
 {
-    /*
-     * This ftn is implemented one of two ways in the case of observation:
-     *
-     * 1. qos == OC_NON_CONFIRMABLE. When observe is unobserved..
-     *      Remove the callback associated on client side.
-     *      When the next notification comes in from server,
-     *      reply with RESET message to server.
-     *      Keep in mind that the server will react to RESET only
-     *      if the last notification was sent as CON
-     *
-     * 2. qos == OC_CONFIRMABLE. When OCCancel is called,
-     *      and it is associated with an observe request
-     *      (i.e. ClientCB->method == OC_REST_OBSERVE || OC_REST_OBSERVE_ALL),
-     *      Send CON Observe request to server with
-     *      observe flag = OC_RESOURCE_OBSERVE_DEREGISTER.
-     *      Remove the callback associated on client side.
-     */
-    OCStackResult ret = OC_STACK_OK;
+    OICFree(requestInfo->info.payload);
+    requestInfo->info.payload = NULL;
+    OICFree(requestInfo->info.options);
+    requestInfo->info.options = NULL;
+}
+
+/**
+ * Discover or Perform requests on a specified resource
+ */
+static OCStackResult DoResourceUnlocked(OCDoHandle *handle,
+                                         OCMethod method,
+                                         const char *requestUri,
+                                         const OCDevAddr *destination,
+                                         OCPayload* payload,
+                                         OCConnectivityType connectivityType,
+                                         OCQualityOfService qos,
+                                         OCCallbackData *cbData,
+                                         OCHeaderOption *options,
+                                         uint8_t numOptions,
+                                         OCPayloadParseMode parseMode)
+{
+    OIC_LOG(INFO, TAG, "Entering OCDoResource");
+
+    // Validate input parameters
+    VERIFY_NON_NULL(cbData, FATAL, OC_STACK_INVALID_CALLBACK);
+    VERIFY_NON_NULL(cbData->cb, FATAL, OC_STACK_INVALID_CALLBACK);
+    VERIFY_NON_NULL(requestUri , FATAL, OC_STACK_INVALID_URI);
+
+    ClientCB *clientCB = NULL;
     CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
+    // the request contents are put here
     CARequestInfo_t requestInfo = {.method = CA_GET};
 
-    if(!handle)
+    OCStackResult result = PrepareRequest(handle, method, requestUri, destination, payload,
+                                          connectivityType, qos, cbData, options, numOptions,
+                                          parseMode, &endpoint, &requestInfo, &clientCB);
+    if (OC_STACK_OK != result)
     {
-        return OC_STACK_INVALID_PARAM;
+        return result;
     }
 
-    ClientCB *clientCB = GetClientCB(NULL, 0, handle, NULL);
-    if (!clientCB)
+    // send request
+    result = OCSendRequest(&endpoint, &requestInfo);
+    if (OC_STACK_OK != result)
     {
-        OIC_LOG(ERROR, TAG, "Callback not found. Called OCCancel on same resource twice?");
-        return OC_STACK_ERROR;
+        OIC_LOG(ERROR, TAG, "OCDoResource error");
+        FindAndDeleteClientCB(clientCB);
+        if (handle)
+        {
+            *handle = NULL;
+        }
     }
 
-    switch (clientCB->method)
+    ReleasePreparedRequest(&requestInfo);
+    return result;
+}
+
+OCStackResult OCDoResource(OCDoHandle *handle,
+                            OCMethod method,
+                            const char *requestUri,
+                            const OCDevAddr *destination,
+                            OCPayload* payload,
+                            OCConnectivityType connectivityType,
+                            OCQualityOfService qos,
+                            OCCallbackData *cbData,
+                            OCHeaderOption *options,
+                            uint8_t numOptions)
+{
+    OCStackLock();
+    OCStackResult result = DoResourceUnlocked(handle, method, requestUri, destination, payload,
+                                              connectivityType, qos, cbData, options, numOptions,
+                                              OC_PAYLOAD_PARSE_DEFAULT);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackResult OCDoResourceWithParseMode(OCDoHandle *handle,
+                                        OCMethod method,
+                                        const char *requestUri,
+                                        const OCDevAddr *destination,
+                                        OCPayload* payload,
+                                        OCConnectivityType connectivityType,
+                                        OCQualityOfService qos,
+                                        OCCallbackData *cbData,
+                                        OCHeaderOption *options,
+                                        uint8_t numOptions,
+                                        OCPayloadParseMode parseMode)
+{
+    if (OC_PAYLOAD_PARSE_DEFAULT != parseMode && OC_PAYLOAD_PARSE_ARENA != parseMode &&
+        OC_PAYLOAD_PARSE_ENCODED != parseMode)
     {
-        case OC_REST_OBSERVE:
-        case OC_REST_OBSERVE_ALL:
+        OCPayloadDestroy(payload);
+        return OC_STACK_INVALID_PARAM;
+    }
 
-            OIC_LOG_V(INFO, TAG, "Canceling observation for resource %s",
-                                        clientCB->requestUri);
-            if (qos != OC_HIGH_QOS)
-            {
-                FindAndDeleteClientCB(clientCB);
-                break;
-            }
+    OCStackLock();
+    OCStackResult result = DoResourceUnlocked(handle, method, requestUri, destination, payload,
+                                              connectivityType, qos, cbData, options, numOptions,
+                                              parseMode);
+    OCStackUnlock();
+    return result;
+}
 
-            OIC_LOG(INFO, TAG, "Cancelling observation as CONFIRMABLE");
+static OCStackResult DoResourcesUnlocked(OCDoResourceRequest *requests, size_t numRequests)
+{
+    OIC_LOG_V(INFO, TAG, "Entering OCDoResources with %u requests", (unsigned)numRequests);
 
-            requestInfo.info.type = qualityOfServiceToMessageType(qos);
-            requestInfo.info.token = clientCB->token;
-            requestInfo.info.tokenLength = clientCB->tokenLength;
+    VERIFY_NON_NULL(requests, FATAL, OC_STACK_INVALID_PARAM);
 
-            if (CreateObserveHeaderOption (&(requestInfo.info.options),
-                    options, numOptions, OC_OBSERVE_DEREGISTER) != OC_STACK_OK)
+    OCStackResult result = OC_STACK_OK;
+    CAEndpoint_t *endpoints = (CAEndpoint_t *) OICCalloc(numRequests, sizeof(CAEndpoint_t));
+    CARequestInfo_t *requestInfos =
+        (CARequestInfo_t *) OICCalloc(numRequests, sizeof(CARequestInfo_t));
+    ClientCB **clientCBs = (ClientCB **) OICCalloc(numRequests, sizeof(ClientCB *));
+    size_t *indexes = (size_t *) OICCalloc(numRequests, sizeof(size_t));
+    CAResult_t *caResults = (CAResult_t *) OICCalloc(numRequests, sizeof(CAResult_t));
+    if (numRequests && (!endpoints || !requestInfos || !clientCBs || !indexes || !caResults))
+    {
+        // The payloads and contexts are owned by the stack whatever happens
+        for (size_t i = 0; i < numRequests; i++)
+        {
+            OCPayloadDestroy(requests[i].payload);
+            requests[i].payload = NULL;
+            if (requests[i].cbData.cd)
             {
-                return OC_STACK_ERROR;
+                requests[i].cbData.cd(requests[i].cbData.context);
             }
-            requestInfo.info.numOptions = numOptions + 1;
-            requestInfo.info.resourceUri = OICStrdup (clientCB->requestUri);
-
-            CopyDevAddrToEndpoint(clientCB->devAddr, &endpoint);
+            requests[i].handle = NULL;
+            requests[i].result = OC_STACK_NO_MEMORY;
+        }
+        result = OC_STACK_NO_MEMORY;
+        goto exit;
+    }
 
-            ret = OCSendRequest(&endpoint, &requestInfo);
+    // Register the callbacks and build the requests, the ones prepared are packed at the
+    // front of the arrays
+    size_t numPrepared = 0;
+    for (size_t i = 0; i < numRequests; i++)
+    {
+        OCDoResourceRequest *request = &requests[i];
+        request->handle = NULL;
+        if (!request->cbData.cb)
+        {
+            OCPayloadDestroy(request->payload);
+            request->result = OC_STACK_INVALID_CALLBACK;
+        }
+        else if (!request->requestUri)
+        {
+            OCPayloadDestroy(request->payload);
+            request->result = OC_STACK_INVALID_URI;
+        }
+        else if (OC_PAYLOAD_PARSE_DEFAULT != request->parseMode &&
+                 OC_PAYLOAD_PARSE_ARENA != request->parseMode &&
+                 OC_PAYLOAD_PARSE_ENCODED != request->parseMode)
+        {
+            OCPayloadDestroy(request->payload);
+            request->result = OC_STACK_INVALID_PARAM;
+        }
+#ifdef WITH_PRESENCE
+        else if (OC_REST_PRESENCE == request->method)
+        {
+            // Presence callbacks are shared between requests, which a batch cannot undo
+            OCPayloadDestroy(request->payload);
+            request->result = OC_STACK_INVALID_METHOD;
+        }
+#endif
+        else
+        {
+            // The slot may hold a request that failed to prepare
+            memset(&endpoints[numPrepared], 0, sizeof(CAEndpoint_t));
+            memset(&requestInfos[numPrepared], 0, sizeof(CARequestInfo_t));
+            endpoints[numPrepared].adapter = CA_DEFAULT_ADAPTER;
+            requestInfos[numPrepared].method = CA_GET;
+            request->result = PrepareRequest(&request->handle, request->method,
+                                             request->requestUri, request->destination,
+                                             request->payload, request->connectivityType,
+                                             request->qos, &request->cbData,
+                                             request->options, request->numOptions,
+                                             request->parseMode,
+                                             &endpoints[numPrepared],
+                                             &requestInfos[numPrepared],
+                                             &clientCBs[numPrepared]);
+        }
+        request->payload = NULL;
 
-            if (requestInfo.info.options)
+        if (OC_STACK_OK != request->result)
+        {
+            // Not registered, so the context is not deleted with the callback
+            if (request->cbData.cd)
+            {
+                request->cbData.cd(request->cbData.context);
+            }
+        }
+        else
+        {
+#if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
+            request->result = RMAddInfo(endpoints[numPrepared].routeData,
+                                        &requestInfos[numPrepared], true, NULL);
+            if (OC_STACK_OK != request->result)
+            {
+                OIC_LOG(ERROR, TAG, "Add destination option failed");
+                FindAndDeleteClientCB(clientCBs[numPrepared]);
+                ReleasePreparedRequest(&requestInfos[numPrepared]);
+                request->handle = NULL;
+            }
+            else
+#endif
+            {
+                // OC stack prefer CBOR encoded payloads.
+                requestInfos[numPrepared].info.acceptFormat = CA_FORMAT_APPLICATION_CBOR;
+                indexes[numPrepared++] = i;
+            }
+        }
+    }
+
+    // Hand all of them to the send thread at once
+    if (numPrepared)
+    {
+        CASendRequests(endpoints, requestInfos, (uint32_t)numPrepared, caResults);
+    }
+
+    for (size_t i = 0; i < numPrepared; i++)
+    {
+        OCDoResourceRequest *request = &requests[indexes[i]];
+        if (CA_STATUS_OK != caResults[i])
+        {
+            OIC_LOG_V(ERROR, TAG, "CASendRequests failed with CA error %u", caResults[i]);
+            request->result = CAResultToOCResult(caResults[i]);
+            FindAndDeleteClientCB(clientCBs[i]);
+            request->handle = NULL;
+        }
+        else
+        {
+            OIC_METRIC_INC(OIC_METRIC_REQUESTS_SENT);
+        }
+        ReleasePreparedRequest(&requestInfos[i]);
+    }
+
+    for (size_t i = 0; i < numRequests && OC_STACK_OK == result; i++)
+    {
+        result = requests[i].result;
+    }
+
+exit:
+    OICFree(endpoints);
+    OICFree(requestInfos);
+    OICFree(clientCBs);
+    OICFree(indexes);
+    OICFree(caResults);
+    return result;
+}
+
+OCStackResult OCDoResources(OCDoResourceRequest *requests, size_t numRequests)
+{
+    OCStackLock();
+    OCStackResult result = DoResourcesUnlocked(requests, numRequests);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult CancelUnlocked(OCDoHandle handle, OCQualityOfService qos,
+        OCHeaderOption * options, uint8_t numOptions)
+{
+    /*
+     * This ftn is implemented one of two ways in the case of observation:
+     *
+     * 1. qos == OC_NON_CONFIRMABLE. When observe is unobserved..
+     *      Remove the callback associated on client side.
+     *      When the next notification comes in from server,
+     *      reply with RESET message to server.
+     *      Keep in mind that the server will react to RESET only
+     *      if the last notification was sent as CON
+     *
+     * 2. qos == OC_CONFIRMABLE. When OCCancel is called,
+     *      and it is associated with an observe request
+     *      (i.e. ClientCB->method == OC_REST_OBSERVE || OC_REST_OBSERVE_ALL),
+     *      Send CON Observe request to server with
+     *      observe flag = OC_RESOURCE_OBSERVE_DEREGISTER.
+     *      Remove the callback associated on client side.
+     */
+    OCStackResult ret = OC_STACK_OK;
+    CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
+    CARequestInfo_t requestInfo = {.method = CA_GET};
+
+    if(!handle)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    ClientCB *clientCB = GetClientCB(NULL, 0, handle, NULL);
+    if (!clientCB)
+    {
+        OIC_LOG(ERROR, TAG, "Callback not found. Called OCCancel on same resource twice?");
+        return OC_STACK_ERROR;
+    }
+
+    switch (clientCB->method)
+    {
+        case OC_REST_OBSERVE:
+        case OC_REST_OBSERVE_ALL:
+
+            OIC_LOG_V(INFO, TAG, "Canceling observation for resource %s",
+                                        clientCB->requestUri);
+            if (qos != OC_HIGH_QOS)
+            {
+                FindAndDeleteClientCB(clientCB);
+                break;
+            }
+
+            OIC_LOG(INFO, TAG, "Cancelling observation as CONFIRMABLE");
+
+            requestInfo.info.type = qualityOfServiceToMessageType(qos);
+            requestInfo.info.token = clientCB->token;
+            requestInfo.info.tokenLength = clientCB->tokenLength;
+
+            if (CreateObserveHeaderOption (&(requestInfo.info.options),
+                    options, numOptions, OC_OBSERVE_DEREGISTER) != OC_STACK_OK)
+            {
+                return OC_STACK_ERROR;
+            }
+            requestInfo.info.numOptions = numOptions + 1;
+            requestInfo.info.resourceUri = OICStrdup (clientCB->requestUri);
+
+            CopyDevAddrToEndpoint(clientCB->devAddr, &endpoint);
+
+            ret = OCSendRequest(&endpoint, &requestInfo);
+
+            if (requestInfo.info.options)
             {
                 OICFree (requestInfo.info.options);
             }
@@ -2771,6 +3232,15 @@ OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption
             FindAndDeleteClientCB(clientCB);
             break;
 
+        case OC_REST_GET:
+        case OC_REST_PUT:
+        case OC_REST_POST:
+        case OC_REST_DELETE:
+            // The response, if it still comes, finds no callback and is dropped
+            OIC_LOG_V(INFO, TAG, "Cancelling request for resource %s", clientCB->requestUri);
+            FindAndDeleteClientCB(clientCB);
+            break;
+
 #ifdef WITH_PRESENCE
         case OC_REST_PRESENCE:
             FindAndDeleteClientCB(clientCB);
@@ -2785,6 +3255,15 @@ OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption
     return ret;
 }
 
+OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption * options,
+        uint8_t numOptions)
+{
+    OCStackLock();
+    OCStackResult result = CancelUnlocked(handle, qos, options, numOptions);
+    OCStackUnlock();
+    return result;
+}
+
 /**
  * @brief   Register Persistent storage callback.
  * @param   persistentStorageHandler [IN] Pointers to open, read, write, close & unlink handlers.
@@ -2817,7 +3296,7 @@ OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistent
 
 #ifdef WITH_PRESENCE
 
-OCStackResult OCProcessPresence()
+static OCStackResult ProcessPresenceUnlocked()
 {
     OCStackResult result = OC_STACK_OK;
 
@@ -2825,11 +3304,13 @@ OCStackResult OCProcessPresence()
     // to most purposes.  Uncomment as needed.
     //OIC_LOG(INFO, TAG, "Entering RequestPresence");
     ClientCB* cbNode = NULL;
+    ClientCB* next = NULL;
     OCClientResponse clientResponse;
     OCStackApplicationResult cbResult = OC_STACK_DELETE_TRANSACTION;
 
-    LL_FOREACH(cbList, cbNode)
+    for (cbNode = cbList; cbNode; cbNode = next)
     {
+        next = cbNode->next;
         if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence)
         {
             continue;
@@ -2866,10 +3347,17 @@ OCStackResult OCProcessPresence()
             OIC_LOG_V(DEBUG, TAG, "moving to TTL level %d",
                                         cbNode->presence->TTLlevel);
 
-            cbResult = cbNode->callBack(cbNode->context, cbNode->handle, &clientResponse);
+            if (!InvokeClientCB(cbNode, &clientResponse, &cbResult))
+            {
+                // Deleted while the callback ran without the lock of the stack, the list
+                // may have changed too, the other nodes are handled by the next call.
+                break;
+            }
+            next = cbNode->next;
             if (cbResult == OC_STACK_DELETE_TRANSACTION)
             {
                 FindAndDeleteClientCB(cbNode);
+                continue;
             }
         }
 
@@ -2910,27 +3398,46 @@ exit:
 
     return result;
 }
+
+OCStackResult OCProcessPresence()
+{
+    OCStackLock();
+    OCStackResult result = ProcessPresenceUnlocked();
+    OCStackUnlock();
+    return result;
+}
 #endif // WITH_PRESENCE
 
 OCStackResult OCProcess()
 {
+    // Each step takes the lock of the stack on its own, so that the application can use the
+    // stack from other threads in between. Received messages are locked as they are handled.
 #ifdef WITH_PRESENCE
     OCProcessPresence();
 #endif
     CAHandleRequestResponse();
 
 #ifdef ROUTING_GATEWAY
+    OCStackLock();
     RMProcess();
+    OCStackUnlock();
 #endif
 
 #ifdef TCP_ADAPTER
+    OCStackLock();
     ProcessKeepAlive();
+    OCStackUnlock();
 #endif
+
+    OCStackLock();
+    ProcessActionSetTimeouts();
+    ProcessServerRequestTimeouts();
+    OCStackUnlock();
     return OC_STACK_OK;
 }
 
 #ifdef WITH_PRESENCE
-OCStackResult OCStartPresence(const uint32_t ttl)
+static OCStackResult StartPresenceUnlocked(const uint32_t ttl)
 {
     uint8_t tokenLength = CA_MAX_TOKEN_LEN;
     OCChangeResourceProperty(
@@ -2981,7 +3488,15 @@ OCStackResult OCStartPresence(const uint32_t ttl)
             OC_PRESENCE_TRIGGER_CREATE);
 }
 
-OCStackResult OCStopPresence()
+OCStackResult OCStartPresence(const uint32_t ttl)
+{
+    OCStackLock();
+    OCStackResult result = StartPresenceUnlocked(ttl);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult StopPresenceUnlocked()
 {
     OCStackResult result = OC_STACK_ERROR;
 
@@ -3004,18 +3519,249 @@ OCStackResult OCStopPresence()
 
     return SendStopNotification();
 }
+
+OCStackResult OCStopPresence()
+{
+    OCStackLock();
+    OCStackResult result = StopPresenceUnlocked();
+    OCStackUnlock();
+    return result;
+}
 #endif
 
+static OCStackResult SetDefaultDeviceEntityHandlerUnlocked(OCDeviceEntityHandler entityHandler,
+                                                           void* callbackParameter)
+{
+    OCStackContext *context = getCurrentContext();
+    context->defaultDeviceHandler = entityHandler;
+    context->defaultDeviceHandlerCallbackParameter = callbackParameter;
+
+    return OC_STACK_OK;
+}
+
 OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandler,
                                             void* callbackParameter)
 {
-    defaultDeviceHandler = entityHandler;
-    defaultDeviceHandlerCallbackParameter = callbackParameter;
+    OCStackLock();
+    OCStackResult result = SetDefaultDeviceEntityHandlerUnlocked(entityHandler, callbackParameter);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult CreateContextUnlocked(const char *uriPrefix, OCStackContext **context)
+{
+    OIC_LOG(INFO, TAG, "Entering OCCreateContext");
+
+    VERIFY_NON_NULL(uriPrefix, ERROR, OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL(context, ERROR, OC_STACK_INVALID_PARAM);
+
+    if (stackState != OC_STACK_INITIALIZED || myStackMode == OC_CLIENT)
+    {
+        OIC_LOG(ERROR, TAG, "Stack not initialized as a server");
+        return OC_STACK_ERROR;
+    }
 
+    size_t prefixLength = strlen(uriPrefix);
+    if (prefixLength < 2 || uriPrefix[0] != '/' || uriPrefix[prefixLength - 1] == '/' ||
+        strchr(uriPrefix, '?') || prefixLength >= requestLimits.maxUriLength ||
+        isUriInPrefix("/oic", uriPrefix))
+    {
+        OIC_LOG_V(ERROR, TAG, "Invalid context URI prefix %s", uriPrefix);
+        return OC_STACK_INVALID_URI;
+    }
+
+    for (OCStackContext *pointer = stackContexts; pointer; pointer = pointer->next)
+    {
+        if (pointer->uriPrefix && (isUriInPrefix(pointer->uriPrefix, uriPrefix) ||
+                                   isUriInPrefix(uriPrefix, pointer->uriPrefix)))
+        {
+            OIC_LOG_V(ERROR, TAG, "%s overlaps context %s", uriPrefix, pointer->uriPrefix);
+            return OC_STACK_INVALID_PARAM;
+        }
+    }
+    for (OCResource *resource = defaultContext.headResource; resource; resource = resource->next)
+    {
+        if (isUriInPrefix(uriPrefix, resource->uri))
+        {
+            OIC_LOG_V(ERROR, TAG, "%s overlaps resource %s", uriPrefix, resource->uri);
+            return OC_STACK_INVALID_PARAM;
+        }
+    }
+
+    OCStackContext *newContext = (OCStackContext *) OICCalloc(1, sizeof(OCStackContext));
+    if (!newContext)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    newContext->uriPrefix = OICStrdup(uriPrefix);
+    if (!newContext->uriPrefix)
+    {
+        OICFree(newContext);
+        return OC_STACK_NO_MEMORY;
+    }
+    newContext->uriPrefixLength = prefixLength;
+    if (RAND_UUID_OK != OCGenerateUuid(newContext->deviceId.id))
+    {
+        OIC_LOG(ERROR, TAG, "Generate UUID for context failed");
+        OICFree(newContext->uriPrefix);
+        OICFree(newContext);
+        return OC_STACK_ERROR;
+    }
+    LL_APPEND(stackContexts, newContext);
+
+    OCStackResult result = initContextResources(newContext);
+    if (result != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Create resources for context failed[%d]", result);
+        deleteContext(newContext);
+        return result;
+    }
+
+    *context = newContext;
     return OC_STACK_OK;
 }
 
-OCStackResult OCSetPlatformInfo(OCPlatformInfo platformInfo)
+OCStackResult OCCreateContext(const char *uriPrefix, OCStackContext **context)
+{
+    OCStackLock();
+    OCStackResult result = CreateContextUnlocked(uriPrefix, context);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult DeleteContextUnlocked(OCStackContext *context)
+{
+    OIC_LOG(INFO, TAG, "Entering OCDeleteContext");
+
+    if (!context || context == &defaultContext || !isContext(context))
+    {
+        OIC_LOG(ERROR, TAG, "Invalid context for deletion");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    deleteContext(context);
+    return OC_STACK_OK;
+}
+
+OCStackResult OCDeleteContext(OCStackContext *context)
+{
+    OCStackLock();
+    OCStackResult result = DeleteContextUnlocked(context);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult SetCurrentContextUnlocked(OCStackContext *context)
+{
+    if (!context)
+    {
+        context = &defaultContext;
+    }
+    if (!isContext(context))
+    {
+        OIC_LOG(ERROR, TAG, "Unknown context");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    currentContext = context;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCSetCurrentContext(OCStackContext *context)
+{
+    OCStackLock();
+    OCStackResult result = SetCurrentContextUnlocked(context);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackContext *OCGetCurrentContext()
+{
+    OCStackLock();
+    OCStackContext *context = getCurrentContext();
+    OCStackUnlock();
+    return context;
+}
+
+/**
+ * Select a context for the calling thread while a call is made on behalf of another one.
+ *
+ * @param context           Context to select, NULL for the default context.
+ * @param previousContext   Set to the selection to restore with LeaveContext().
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_PARAM for an unknown context.
+ */
+static OCStackResult EnterContext(OCStackContext *context, OCStackContext **previousContext)
+{
+    *previousContext = currentContext;
+    return SetCurrentContextUnlocked(context);
+}
+
+static void LeaveContext(OCStackContext *previousContext)
+{
+    currentContext = previousContext;
+}
+
+OCStackResult OCSetDefaultDeviceEntityHandlerInContext(OCStackContext *context,
+                                                       OCDeviceEntityHandler entityHandler,
+                                                       void* callbackParameter)
+{
+    OCStackContext *previousContext = NULL;
+    OCStackLock();
+    OCStackResult result = EnterContext(context, &previousContext);
+    if (OC_STACK_OK == result)
+    {
+        result = SetDefaultDeviceEntityHandlerUnlocked(entityHandler, callbackParameter);
+    }
+    LeaveContext(previousContext);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackResult OCSetCollectionBatchWorkers(uint32_t numWorkers)
+{
+    return SetCollectionBatchWorkers(numWorkers);
+}
+
+OCStackResult OCSetResponsePayloadParseMode(OCPayloadParseMode mode)
+{
+    if (OC_PAYLOAD_PARSE_DEFAULT != mode && OC_PAYLOAD_PARSE_ARENA != mode)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    responsePayloadParseMode = mode;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCSetRequestPayloadParseMode(OCPayloadParseMode mode)
+{
+    OCStackLock();
+    OCStackResult result = SetRequestPayloadParseMode(mode);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackResult OCSetRequestLimits(uint16_t maxUriLength, uint16_t maxQueryLength,
+                                 uint8_t maxHeaderOptions)
+{
+    if (OC_STACK_UNINITIALIZED != stackState)
+    {
+        OIC_LOG(ERROR, TAG, "Request limits must be set before OCInit");
+        return OC_STACK_ERROR;
+    }
+    if (!maxUriLength || !maxQueryLength)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    requestLimits.maxUriLength = maxUriLength;
+    requestLimits.maxQueryLength = maxQueryLength;
+    requestLimits.maxHeaderOptions = maxHeaderOptions;
+    return OC_STACK_OK;
+}
+
+static OCStackResult SetPlatformInfoUnlocked(OCPlatformInfo platformInfo)
 {
     OIC_LOG(INFO, TAG, "Entering OCSetPlatformInfo");
 
@@ -3036,7 +3782,29 @@ OCStackResult OCSetPlatformInfo(OCPlatformInfo platformInfo)
     }
 }
 
-OCStackResult OCSetDeviceInfo(OCDeviceInfo deviceInfo)
+OCStackResult OCSetPlatformInfo(OCPlatformInfo platformInfo)
+{
+    OCStackLock();
+    OCStackResult result = SetPlatformInfoUnlocked(platformInfo);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackResult OCSetPlatformInfoInContext(OCStackContext *context, OCPlatformInfo platformInfo)
+{
+    OCStackContext *previousContext = NULL;
+    OCStackLock();
+    OCStackResult result = EnterContext(context, &previousContext);
+    if (OC_STACK_OK == result)
+    {
+        result = SetPlatformInfoUnlocked(platformInfo);
+    }
+    LeaveContext(previousContext);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult SetDeviceInfoUnlocked(OCDeviceInfo deviceInfo)
 {
     OIC_LOG(INFO, TAG, "Entering OCSetDeviceInfo");
 
@@ -3049,7 +3817,29 @@ OCStackResult OCSetDeviceInfo(OCDeviceInfo deviceInfo)
     return SaveDeviceInfo(deviceInfo);
 }
 
-OCStackResult OCCreateResource(OCResourceHandle *handle,
+OCStackResult OCSetDeviceInfo(OCDeviceInfo deviceInfo)
+{
+    OCStackLock();
+    OCStackResult result = SetDeviceInfoUnlocked(deviceInfo);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackResult OCSetDeviceInfoInContext(OCStackContext *context, OCDeviceInfo deviceInfo)
+{
+    OCStackContext *previousContext = NULL;
+    OCStackLock();
+    OCStackResult result = EnterContext(context, &previousContext);
+    if (OC_STACK_OK == result)
+    {
+        result = SetDeviceInfoUnlocked(deviceInfo);
+    }
+    LeaveContext(previousContext);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult CreateResourceUnlocked(OCResourceHandle *handle,
         const char *resourceTypeName,
         const char *resourceInterfaceName,
         const char *uri, OCEntityHandler entityHandler,
@@ -3059,6 +3849,9 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
 
     OCResource *pointer = NULL;
     OCStackResult result = OC_STACK_ERROR;
+    char *contextUri = NULL;
+
+    OCStackContext *resourceContext = getCurrentContext();
 
     OIC_LOG(INFO, TAG, "Entering OCCreateResource");
 
@@ -3066,8 +3859,9 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
     {
         return OC_STACK_INVALID_PARAM;
     }
-    // Validate parameters
-    if(!uri || uri[0]=='\0' || strlen(uri)>=MAX_URI_LENGTH )
+    // Validate parameters, the URI is stored behind the prefix of the current context
+    if(!uri || uri[0]=='\0' ||
+       resourceContext->uriPrefixLength + strlen(uri) >= requestLimits.maxUriLength)
     {
         OIC_LOG(ERROR, TAG, "URI is empty or too long");
         return OC_STACK_INVALID_URI;
@@ -3093,17 +3887,45 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
+    if (resourceContext->uriPrefix)
+    {
+        size_t contextUriLength = resourceContext->uriPrefixLength + strlen(uri) + 1;
+        contextUri = (char *) OICMalloc(contextUriLength);
+        if (contextUri)
+        {
+            snprintf(contextUri, contextUriLength, "%s%s", resourceContext->uriPrefix, uri);
+        }
+    }
+    else
+    {
+        // Requests for URIs below the prefix of a context are served by the context
+        for (OCStackContext *context = defaultContext.next; context; context = context->next)
+        {
+            if (isUriInPrefix(context->uriPrefix, uri))
+            {
+                OIC_LOG_V(ERROR, TAG, "%s is in the prefix of a context", uri);
+                return OC_STACK_INVALID_URI;
+            }
+        }
+        contextUri = OICStrdup(uri);
+    }
+    if (!contextUri)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
     // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
+    pointer = resourceContext->headResource;
     if (pointer)
     {
         // At least one resources is in the resource list, so we need to search for
         // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
         while (pointer)
         {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
+            if (strcmp(contextUri, pointer->uri) == 0)
             {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", contextUri);
+                OICFree(contextUri);
                 return OC_STACK_INVALID_PARAM;
             }
             pointer = pointer->next;
@@ -3113,6 +3935,7 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
     if (!pointer)
     {
+        OICFree(contextUri);
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
@@ -3120,13 +3943,8 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
 
     insertResource(pointer);
 
-    // Set the uri
-    pointer->uri = OICStrdup(uri);
-    if (!pointer->uri)
-    {
-        result = OC_STACK_NO_MEMORY;
-        goto exit;
-    }
+    // Set the uri, the resource owns it from now on
+    pointer->uri = contextUri;
 
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
@@ -3150,15 +3968,19 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
 
     // If an entity handler has been passed, attach it to the newly created
     // resource.  Otherwise, set the default entity handler.
+    // Resources created by the stack itself, with the lock already held by the caller,
+    // keep it while their entity handler runs.
     if (entityHandler)
     {
         pointer->entityHandler = entityHandler;
         pointer->entityHandlerCallbackParam = callbackParam;
+        pointer->entityHandlerLocked = stackLockDepth > 1;
     }
     else
     {
         pointer->entityHandler = defaultResourceEHandler;
         pointer->entityHandlerCallbackParam = NULL;
+        pointer->entityHandlerLocked = true;
     }
 
     // Initialize a pointer indicating child resources in case of collection
@@ -3183,7 +4005,44 @@ exit:
     return result;
 }
 
-OCStackResult OCBindResource(
+OCStackResult OCCreateResource(OCResourceHandle *handle,
+        const char *resourceTypeName,
+        const char *resourceInterfaceName,
+        const char *uri, OCEntityHandler entityHandler,
+        void* callbackParam,
+        uint8_t resourceProperties)
+{
+    OCStackLock();
+    OCStackResult result = CreateResourceUnlocked(handle, resourceTypeName, resourceInterfaceName,
+                                                  uri, entityHandler, callbackParam,
+                                                  resourceProperties);
+    OCStackUnlock();
+    return result;
+}
+
+OCStackResult OCCreateResourceInContext(OCStackContext *context,
+        OCResourceHandle *handle,
+        const char *resourceTypeName,
+        const char *resourceInterfaceName,
+        const char *uri, OCEntityHandler entityHandler,
+        void* callbackParam,
+        uint8_t resourceProperties)
+{
+    OCStackContext *previousContext = NULL;
+    OCStackLock();
+    OCStackResult result = EnterContext(context, &previousContext);
+    if (OC_STACK_OK == result)
+    {
+        result = CreateResourceUnlocked(handle, resourceTypeName, resourceInterfaceName,
+                                        uri, entityHandler, callbackParam,
+                                        resourceProperties);
+    }
+    LeaveContext(previousContext);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceUnlocked(
         OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
 {
     OCResource *resource = NULL;
@@ -3241,6 +4100,7 @@ OCStackResult OCBindResource(
     }
 
     OIC_LOG(INFO, TAG, "resource bound");
+    InvalidateDiscoveryCache();
 
 #ifdef WITH_PRESENCE
     if (presenceResource.handle)
@@ -3254,7 +4114,16 @@ OCStackResult OCBindResource(
     return OC_STACK_OK;
 }
 
-OCStackResult OCUnBindResource(
+OCStackResult OCBindResource(
+        OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
+{
+    OCStackLock();
+    OCStackResult result = BindResourceUnlocked(collectionHandle, resourceHandle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult UnBindResourceUnlocked(
         OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
 {
     OCResource *resource = NULL;
@@ -3315,6 +4184,7 @@ OCStackResult OCUnBindResource(
             }
 
             OIC_LOG(INFO, TAG, "resource unbound");
+            InvalidateDiscoveryCache();
 
             // Send notification when resource is unbounded successfully.
 #ifdef WITH_PRESENCE
@@ -3345,6 +4215,15 @@ OCStackResult OCUnBindResource(
     return OC_STACK_ERROR;
 }
 
+OCStackResult OCUnBindResource(
+        OCResourceHandle collectionHandle, OCResourceHandle resourceHandle)
+{
+    OCStackLock();
+    OCStackResult result = UnBindResourceUnlocked(collectionHandle, resourceHandle);
+    OCStackUnlock();
+    return result;
+}
+
 // Precondition is that the parameter has been checked to not equal NULL.
 static bool ValidateResourceTypeInterface(const char *resourceItemName)
 {
@@ -3458,7 +4337,7 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
     return result;
 }
 
-OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
+static OCStackResult BindResourceTypeToResourceUnlocked(OCResourceHandle handle,
         const char *resourceTypeName)
 {
 
@@ -3485,7 +4364,16 @@ OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
     return result;
 }
 
-OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
+OCStackResult OCBindResourceTypeToResource(OCResourceHandle handle,
+        const char *resourceTypeName)
+{
+    OCStackLock();
+    OCStackResult result = BindResourceTypeToResourceUnlocked(handle, resourceTypeName);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceInterfaceToResourceUnlocked(OCResourceHandle handle,
         const char *resourceInterfaceName)
 {
 
@@ -3512,9 +4400,18 @@ OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
     return result;
 }
 
-OCStackResult OCGetNumberOfResources(uint8_t *numResources)
+OCStackResult OCBindResourceInterfaceToResource(OCResourceHandle handle,
+        const char *resourceInterfaceName)
+{
+    OCStackLock();
+    OCStackResult result = BindResourceInterfaceToResourceUnlocked(handle, resourceInterfaceName);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult GetNumberOfResourcesUnlocked(uint8_t *numResources)
 {
-    OCResource *pointer = headResource;
+    OCResource *pointer = getCurrentContext()->headResource;
 
     VERIFY_NON_NULL(numResources, ERROR, OC_STACK_INVALID_PARAM);
     *numResources = 0;
@@ -3526,9 +4423,17 @@ OCStackResult OCGetNumberOfResources(uint8_t *numResources)
     return OC_STACK_OK;
 }
 
-OCResourceHandle OCGetResourceHandle(uint8_t index)
+OCStackResult OCGetNumberOfResources(uint8_t *numResources)
+{
+    OCStackLock();
+    OCStackResult result = GetNumberOfResourcesUnlocked(numResources);
+    OCStackUnlock();
+    return result;
+}
+
+static OCResourceHandle GetResourceHandleUnlocked(uint8_t index)
 {
-    OCResource *pointer = headResource;
+    OCResource *pointer = getCurrentContext()->headResource;
 
     for( uint8_t i = 0; i < index && pointer; ++i)
     {
@@ -3537,7 +4442,15 @@ OCResourceHandle OCGetResourceHandle(uint8_t index)
     return (OCResourceHandle) pointer;
 }
 
-OCStackResult OCDeleteResource(OCResourceHandle handle)
+OCResourceHandle OCGetResourceHandle(uint8_t index)
+{
+    OCStackLock();
+    OCResourceHandle result = GetResourceHandleUnlocked(index);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult DeleteResourceUnlocked(OCResourceHandle handle)
 {
     if (!handle)
     {
@@ -3561,7 +4474,15 @@ OCStackResult OCDeleteResource(OCResourceHandle handle)
     return OC_STACK_OK;
 }
 
-const char *OCGetResourceUri(OCResourceHandle handle)
+OCStackResult OCDeleteResource(OCResourceHandle handle)
+{
+    OCStackLock();
+    OCStackResult result = DeleteResourceUnlocked(handle);
+    OCStackUnlock();
+    return result;
+}
+
+static const char *GetResourceUriUnlocked(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
 
@@ -3573,7 +4494,15 @@ const char *OCGetResourceUri(OCResourceHandle handle)
     return (const char *) NULL;
 }
 
-OCResourceProperty OCGetResourceProperties(OCResourceHandle handle)
+const char *OCGetResourceUri(OCResourceHandle handle)
+{
+    OCStackLock();
+    const char *result = GetResourceUriUnlocked(handle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCResourceProperty GetResourcePropertiesUnlocked(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
 
@@ -3585,7 +4514,15 @@ OCResourceProperty OCGetResourceProperties(OCResourceHandle handle)
     return (OCResourceProperty)-1;
 }
 
-OCStackResult OCGetNumberOfResourceTypes(OCResourceHandle handle,
+OCResourceProperty OCGetResourceProperties(OCResourceHandle handle)
+{
+    OCStackLock();
+    OCResourceProperty result = GetResourcePropertiesUnlocked(handle);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult GetNumberOfResourceTypesUnlocked(OCResourceHandle handle,
         uint8_t *numResourceTypes)
 {
     OCResource *resource = NULL;
@@ -3609,7 +4546,16 @@ OCStackResult OCGetNumberOfResourceTypes(OCResourceHandle handle,
     return OC_STACK_OK;
 }
 
-const char *OCGetResourceTypeName(OCResourceHandle handle, uint8_t index)
+OCStackResult OCGetNumberOfResourceTypes(OCResourceHandle handle,
+        uint8_t *numResourceTypes)
+{
+    OCStackLock();
+    OCStackResult result = GetNumberOfResourceTypesUnlocked(handle, numResourceTypes);
+    OCStackUnlock();
+    return result;
+}
+
+static const char *GetResourceTypeNameUnlocked(OCResourceHandle handle, uint8_t index)
 {
     OCResourceType *resourceType = NULL;
 
@@ -3621,7 +4567,15 @@ const char *OCGetResourceTypeName(OCResourceHandle handle, uint8_t index)
     return (const char *) NULL;
 }
 
-OCStackResult OCGetNumberOfResourceInterfaces(OCResourceHandle handle,
+const char *OCGetResourceTypeName(OCResourceHandle handle, uint8_t index)
+{
+    OCStackLock();
+    const char *result = GetResourceTypeNameUnlocked(handle, index);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult GetNumberOfResourceInterfacesUnlocked(OCResourceHandle handle,
         uint8_t *numResourceInterfaces)
 {
     OCResourceInterface *pointer = NULL;
@@ -3644,7 +4598,16 @@ OCStackResult OCGetNumberOfResourceInterfaces(OCResourceHandle handle,
     return OC_STACK_OK;
 }
 
-const char *OCGetResourceInterfaceName(OCResourceHandle handle, uint8_t index)
+OCStackResult OCGetNumberOfResourceInterfaces(OCResourceHandle handle,
+        uint8_t *numResourceInterfaces)
+{
+    OCStackLock();
+    OCStackResult result = GetNumberOfResourceInterfacesUnlocked(handle, numResourceInterfaces);
+    OCStackUnlock();
+    return result;
+}
+
+static const char *GetResourceInterfaceNameUnlocked(OCResourceHandle handle, uint8_t index)
 {
     OCResourceInterface *resourceInterface = NULL;
 
@@ -3656,7 +4619,15 @@ const char *OCGetResourceInterfaceName(OCResourceHandle handle, uint8_t index)
     return (const char *) NULL;
 }
 
-OCResourceHandle OCGetResourceHandleFromCollection(OCResourceHandle collectionHandle,
+const char *OCGetResourceInterfaceName(OCResourceHandle handle, uint8_t index)
+{
+    OCStackLock();
+    const char *result = GetResourceInterfaceNameUnlocked(handle, index);
+    OCStackUnlock();
+    return result;
+}
+
+static OCResourceHandle GetResourceHandleFromCollectionUnlocked(OCResourceHandle collectionHandle,
         uint8_t index)
 {
     OCResource *resource = NULL;
@@ -3686,7 +4657,16 @@ OCResourceHandle OCGetResourceHandleFromCollection(OCResourceHandle collectionHa
     return NULL;
 }
 
-OCStackResult OCBindResourceHandler(OCResourceHandle handle,
+OCResourceHandle OCGetResourceHandleFromCollection(OCResourceHandle collectionHandle,
+        uint8_t index)
+{
+    OCStackLock();
+    OCResourceHandle result = GetResourceHandleFromCollectionUnlocked(collectionHandle, index);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult BindResourceHandlerUnlocked(OCResourceHandle handle,
         OCEntityHandler entityHandler,
         void* callbackParam)
 {
@@ -3706,6 +4686,7 @@ OCStackResult OCBindResourceHandler(OCResourceHandle handle,
     // Bind the handler
     resource->entityHandler = entityHandler;
     resource->entityHandlerCallbackParam = callbackParam;
+    resource->entityHandlerLocked = stackLockDepth > 1;
 
 #ifdef WITH_PRESENCE
     if (presenceResource.handle)
@@ -3718,7 +4699,17 @@ OCStackResult OCBindResourceHandler(OCResourceHandle handle,
     return OC_STACK_OK;
 }
 
-OCEntityHandler OCGetResourceHandler(OCResourceHandle handle)
+OCStackResult OCBindResourceHandler(OCResourceHandle handle,
+        OCEntityHandler entityHandler,
+        void* callbackParam)
+{
+    OCStackLock();
+    OCStackResult result = BindResourceHandlerUnlocked(handle, entityHandler, callbackParam);
+    OCStackUnlock();
+    return result;
+}
+
+static OCEntityHandler GetResourceHandlerUnlocked(OCResourceHandle handle)
 {
     OCResource *resource = NULL;
 
@@ -3733,6 +4724,14 @@ OCEntityHandler OCGetResourceHandler(OCResourceHandle handle)
     return resource->entityHandler;
 }
 
+OCEntityHandler OCGetResourceHandler(OCResourceHandle handle)
+{
+    OCStackLock();
+    OCEntityHandler result = GetResourceHandlerUnlocked(handle);
+    OCStackUnlock();
+    return result;
+}
+
 void incrementSequenceNumber(OCResource * resPtr)
 {
     // Increment the sequence number
@@ -3788,7 +4787,7 @@ OCStackResult SendStopNotification()
 }
 
 #endif // WITH_PRESENCE
-OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService qos)
+static OCStackResult NotifyAllObserversUnlocked(OCResourceHandle handle, OCQualityOfService qos)
 {
     OCResource *resPtr = NULL;
     OCStackResult result = OC_STACK_ERROR;
@@ -3826,12 +4825,19 @@ OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService q
     }
 }
 
-OCStackResult
-OCNotifyListOfObservers (OCResourceHandle handle,
-                         OCObservationId  *obsIdList,
-                         uint8_t          numberOfIds,
-                         const OCRepPayload       *payload,
-                         OCQualityOfService qos)
+OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService qos)
+{
+    OCStackLock();
+    OCStackResult result = NotifyAllObserversUnlocked(handle, qos);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult NotifyListOfObserversUnlocked(OCResourceHandle handle,
+                                                   OCObservationId  *obsIdList,
+                                                   uint8_t          numberOfIds,
+                                                   const OCRepPayload       *payload,
+                                                   OCQualityOfService qos)
 {
     OIC_LOG(INFO, TAG, "Entering OCNotifyListOfObservers");
 
@@ -3856,7 +4862,59 @@ OCNotifyListOfObservers (OCResourceHandle handle,
             payload, maxAge, qos));
 }
 
-OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
+OCStackResult
+OCNotifyListOfObservers (OCResourceHandle handle,
+                         OCObservationId  *obsIdList,
+                         uint8_t          numberOfIds,
+                         const OCRepPayload       *payload,
+                         OCQualityOfService qos)
+{
+    OCStackLock();
+    OCStackResult result = NotifyListOfObserversUnlocked(handle, obsIdList, numberOfIds, payload,
+                                                         qos);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult NotifyListOfObserversWithPayloadsUnlocked(OCResourceHandle handle,
+                                                               OCObservationId *obsIdList,
+                                                               const OCPayload **payloadList,
+                                                               uint8_t numberOfIds,
+                                                               OCQualityOfService qos)
+{
+    OIC_LOG(INFO, TAG, "Entering OCNotifyListOfObserversWithPayloads");
+
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL(obsIdList, ERROR, OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL(payloadList, ERROR, OC_STACK_INVALID_PARAM);
+
+    OCResource *resPtr = findResource((OCResource *) handle);
+    if (NULL == resPtr || myStackMode == OC_CLIENT)
+    {
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    // One change of the resource, whatever each observer is sent of it
+    incrementSequenceNumber(resPtr);
+    return SendObserverNotificationList(resPtr, obsIdList, payloadList, numberOfIds, qos);
+}
+
+OCStackResult
+OCNotifyListOfObserversWithPayloads (OCResourceHandle handle,
+                                     OCObservationId *obsIdList,
+                                     const OCPayload **payloadList,
+                                     uint8_t numberOfIds,
+                                     OCQualityOfService qos)
+{
+    OCStackLock();
+    OCStackResult result = NotifyListOfObserversWithPayloadsUnlocked(handle, obsIdList,
+                                                                     payloadList, numberOfIds,
+                                                                     qos);
+    OCStackUnlock();
+    return result;
+}
+
+static OCStackResult DoResponseUnlocked(OCEntityHandlerResponse *ehResponse)
 {
     OCStackResult result = OC_STACK_ERROR;
     OCServerRequest *serverRequest = NULL;
@@ -3872,6 +4930,7 @@ OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
     serverRequest = GetServerRequestUsingHandle((OCServerRequest *)ehResponse->requestHandle);
     if(serverRequest)
     {
+        OIC_TRACE(OIC_TRACE_DO_RESPONSE, serverRequest->requestToken, serverRequest->tokenLength);
         // response handler in ocserverrequest.c. Usually HandleSingleResponse.
         result = serverRequest->ehResponseHandler(ehResponse);
     }
@@ -3879,6 +4938,14 @@ OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
     return result;
 }
 
+OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
+{
+    OCStackLock();
+    OCStackResult result = DoResponseUnlocked(ehResponse);
+    OCStackUnlock();
+    return result;
+}
+
 //#ifdef DIRECT_PAIRING
 const OCDPDev_t* OCDiscoverDirectPairingDevices(unsigned short waittime)
 {
@@ -3930,6 +4997,79 @@ OCStackResult OCDoDirectPairing(OCDPDev_t* peer, OCPrm_t pmSel, char *pinNumber,
 //-----------------------------------------------------------------------------
 // Private internal function definitions
 //-----------------------------------------------------------------------------
+void OCStackLock()
+{
+    if (stackMutex)
+    {
+        ca_mutex_lock(stackMutex);
+        stackLockDepth++;
+    }
+}
+
+void OCStackUnlock()
+{
+    if (stackMutex && stackLockDepth)
+    {
+        stackLockDepth--;
+        ca_mutex_unlock(stackMutex);
+    }
+}
+
+bool OCStackReleaseLock()
+{
+    if (1 != stackLockDepth)
+    {
+        return false;
+    }
+    OCStackUnlock();
+    return true;
+}
+
+void OCStackReacquireLock(bool released)
+{
+    if (released)
+    {
+        OCStackLock();
+    }
+}
+
+OCEntityHandlerResult OCStackCallEntityHandler(OCEntityHandler entityHandler,
+                                               void *callbackParam, bool locked,
+                                               OCEntityHandlerFlag flag,
+                                               OCEntityHandlerRequest *ehRequest)
+{
+    OCEntityHandlerResult ehResult = OC_EH_ERROR;
+    if (!entityHandler)
+    {
+        return ehResult;
+    }
+
+    if (locked)
+    {
+        // Batch workers call the handlers of contained resources without the lock
+        OCStackLock();
+        ehResult = entityHandler(flag, ehRequest, callbackParam);
+        OCStackUnlock();
+    }
+    else
+    {
+        bool released = OCStackReleaseLock();
+        ehResult = entityHandler(flag, ehRequest, callbackParam);
+        OCStackReacquireLock(released);
+    }
+    return ehResult;
+}
+
+static bool InvokeClientCB(ClientCB *cbNode, OCClientResponse *response,
+                           OCStackApplicationResult *result)
+{
+    HoldClientCB(cbNode);
+    bool released = cbNode->callBackLocked ? false : OCStackReleaseLock();
+    *result = cbNode->callBack(cbNode->context, cbNode->handle, response);
+    OCStackReacquireLock(released);
+    return ReleaseClientCB(cbNode);
+}
+
 static OCDoHandle GenerateInvocationHandle()
 {
     OCDoHandle handle = NULL;
@@ -3965,6 +5105,7 @@ OCStackResult OCChangeResourceProperty(OCResourceProperty * inputProperty,
     {
         *inputProperty = (OCResourceProperty) (*inputProperty | resourceProperties);
     }
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 #endif
@@ -3973,8 +5114,8 @@ OCStackResult initResources()
 {
     OCStackResult result = OC_STACK_OK;
 
-    headResource = NULL;
-    tailResource = NULL;
+    defaultContext.headResource = NULL;
+    defaultContext.tailResource = NULL;
     // Init Virtual Resources
 #ifdef WITH_PRESENCE
     presenceResource.presenceTTL = OC_DEFAULT_PRESENCE_TTL_SECONDS;
@@ -4000,23 +5141,33 @@ OCStackResult initResources()
 
     if(result == OC_STACK_OK)
     {
-        result = OCCreateResource(&deviceResource,
-                                  OC_RSRVD_RESOURCE_TYPE_DEVICE,
-                                  OC_RSRVD_INTERFACE_DEFAULT,
-                                  OC_RSRVD_DEVICE_URI,
-                                  NULL,
-                                  NULL,
-                                  OC_DISCOVERABLE);
-        if(result == OC_STACK_OK)
-        {
-            result = BindResourceInterfaceToResource((OCResource *)deviceResource,
-                                                     OC_RSRVD_INTERFACE_READ);
-        }
+        result = initContextResources(&defaultContext);
+    }
+
+    return result;
+}
+
+OCStackResult initContextResources(OCStackContext *context)
+{
+    OCStackContext *previousContext = currentContext;
+    currentContext = context;
+
+    OCStackResult result = OCCreateResource(&context->deviceResource,
+                                            OC_RSRVD_RESOURCE_TYPE_DEVICE,
+                                            OC_RSRVD_INTERFACE_DEFAULT,
+                                            OC_RSRVD_DEVICE_URI,
+                                            NULL,
+                                            NULL,
+                                            OC_DISCOVERABLE);
+    if(result == OC_STACK_OK)
+    {
+        result = BindResourceInterfaceToResource((OCResource *)context->deviceResource,
+                                                 OC_RSRVD_INTERFACE_READ);
     }
 
     if(result == OC_STACK_OK)
     {
-        result = OCCreateResource(&platformResource,
+        result = OCCreateResource(&context->platformResource,
                                   OC_RSRVD_RESOURCE_TYPE_PLATFORM,
                                   OC_RSRVD_INTERFACE_DEFAULT,
                                   OC_RSRVD_PLATFORM_URI,
@@ -4025,61 +5176,140 @@ OCStackResult initResources()
                                   OC_DISCOVERABLE);
         if(result == OC_STACK_OK)
         {
-            result = BindResourceInterfaceToResource((OCResource *)platformResource,
+            result = BindResourceInterfaceToResource((OCResource *)context->platformResource,
                                                      OC_RSRVD_INTERFACE_READ);
         }
     }
 
+    currentContext = previousContext;
     return result;
 }
 
+void deleteContext(OCStackContext *context)
+{
+    OIC_LOG_V(INFO, TAG, "Deleting context %s", context->uriPrefix);
+
+    while (context->headResource)
+    {
+        deleteResource(context->headResource);
+    }
+
+    OCStackContext *previousContext = currentContext;
+    currentContext = context;
+    DeleteDeviceInfo();
+    DeletePlatformInfo();
+    InvalidateDiscoveryCache();
+    currentContext = previousContext;
+
+    LL_DELETE(stackContexts, context);
+    OICFree(context->uriPrefix);
+    OICFree(context);
+}
+
+OCStackContext *findContextForUri(const char *uri)
+{
+    for (OCStackContext *context = defaultContext.next; context; context = context->next)
+    {
+        if (isUriInPrefix(context->uriPrefix, uri))
+        {
+            return context;
+        }
+    }
+    return &defaultContext;
+}
+
+bool isContext(const OCStackContext *context)
+{
+    for (OCStackContext *pointer = stackContexts; pointer; pointer = pointer->next)
+    {
+        if (pointer == context)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+OCStackContext *getCurrentContext()
+{
+    // Another thread may have deleted the context since this one selected it
+    if (!currentContext || !isContext(currentContext))
+    {
+        currentContext = NULL;
+        return &defaultContext;
+    }
+    return currentContext;
+}
+
+bool isUriInPrefix(const char *prefix, const char *uri)
+{
+    size_t prefixLength = strlen(prefix);
+    return strncmp(prefix, uri, prefixLength) == 0 &&
+           (uri[prefixLength] == '\0' || uri[prefixLength] == '/');
+}
+
 void insertResource(OCResource *resource)
 {
-    if (!headResource)
+    InvalidateDiscoveryCache();
+
+    OCStackContext *context = getCurrentContext();
+    if (!context->headResource)
     {
-        headResource = resource;
-        tailResource = resource;
+        context->headResource = resource;
+        context->tailResource = resource;
     }
     else
     {
-        tailResource->next = resource;
-        tailResource = resource;
+        context->tailResource->next = resource;
+        context->tailResource = resource;
     }
     resource->next = NULL;
+    resource->context = context;
 }
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
-
-    while (pointer)
+    for (OCStackContext *context = stackContexts; context; context = context->next)
     {
-        if (pointer == resource)
+        for (OCResource *pointer = context->headResource; pointer; pointer = pointer->next)
         {
-            return resource;
+            if (pointer == resource)
+            {
+                return resource;
+            }
         }
-        pointer = pointer->next;
     }
     return NULL;
 }
 
+bool IsResourceInStack(OCResourceHandle handle)
+{
+    return findResource((OCResource *) handle) != NULL;
+}
+
 void deleteAllResources()
 {
-    OCResource *pointer = headResource;
-    OCResource *temp = NULL;
+    // Contexts created by the application go first, the default one holds the presence
+    // and security resources.
+    while (defaultContext.next)
+    {
+        deleteContext(defaultContext.next);
+    }
+    currentContext = NULL;
 
+    OCResource *pointer = defaultContext.headResource;
     while (pointer)
     {
-        temp = pointer->next;
 #ifdef WITH_PRESENCE
-        if (pointer != (OCResource *) presenceResource.handle)
+        if (pointer == (OCResource *) presenceResource.handle)
         {
-#endif // WITH_PRESENCE
-            deleteResource(pointer);
-#ifdef WITH_PRESENCE
+            pointer = pointer->next;
+            continue;
         }
 #endif // WITH_PRESENCE
-        pointer = temp;
+        deleteResource(pointer);
+        // Observers are notified without the lock of the stack, the list may have changed
+        pointer = defaultContext.headResource;
     }
 
     SRMDeInitSecureResources();
@@ -4100,46 +5330,60 @@ OCStackResult deleteResource(OCResource *resource)
         OIC_LOG(DEBUG,TAG,"resource is NULL");
         return OC_STACK_INVALID_PARAM;
     }
+    if (!findResource(resource))
+    {
+        return OC_STACK_ERROR;
+    }
 
     OIC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
 
-    temp = headResource;
-    while (temp)
-    {
-        if (temp == resource)
-        {
-            // Invalidate all Resource Properties.
-            resource->resourceProperties = (OCResourceProperty) 0;
+    // Invalidate all Resource Properties.
+    resource->resourceProperties = (OCResourceProperty) 0;
+    InvalidateDiscoveryCache();
 #ifdef WITH_PRESENCE
-            if(resource != (OCResource *) presenceResource.handle)
-            {
+    if(resource != (OCResource *) presenceResource.handle)
+    {
 #endif // WITH_PRESENCE
-                OCNotifyAllObservers((OCResourceHandle)resource, OC_HIGH_QOS);
+        NotifyAllObserversUnlocked((OCResourceHandle)resource, OC_HIGH_QOS);
 #ifdef WITH_PRESENCE
-            }
+    }
 
-            if(presenceResource.handle)
-            {
-                ((OCResource *)presenceResource.handle)->sequenceNum = OCGetRandom();
-                SendPresenceNotification(resource->rsrcType, OC_PRESENCE_TRIGGER_DELETE);
-            }
+    if(presenceResource.handle)
+    {
+        ((OCResource *)presenceResource.handle)->sequenceNum = OCGetRandom();
+        SendPresenceNotification(resource->rsrcType, OC_PRESENCE_TRIGGER_DELETE);
+    }
 #endif
+
+    // The entity handlers of the observers run without the lock of the stack, another
+    // thread may have deleted the resource meanwhile.
+    if (!findResource(resource))
+    {
+        return OC_STACK_ERROR;
+    }
+
+    OCStackContext *context = resource->context;
+    temp = context->headResource;
+    while (temp)
+    {
+        if (temp == resource)
+        {
             // Only resource in list.
-            if (temp == headResource && temp == tailResource)
+            if (temp == context->headResource && temp == context->tailResource)
             {
-                headResource = NULL;
-                tailResource = NULL;
+                context->headResource = NULL;
+                context->tailResource = NULL;
             }
             // Deleting head.
-            else if (temp == headResource)
+            else if (temp == context->headResource)
             {
-                headResource = temp->next;
+                context->headResource = temp->next;
             }
             // Deleting tail.
-            else if (temp == tailResource)
+            else if (temp == context->tailResource)
             {
-                tailResource = prev;
-                tailResource->next = NULL;
+                context->tailResource = prev;
+                context->tailResource->next = NULL;
             }
             else
             {
@@ -4232,6 +5476,7 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
         previous->next = resourceType;
     }
     resourceType->next = NULL;
+    InvalidateDiscoveryCache();
 
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
 }
@@ -4294,6 +5539,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
     OCResourceInterface *previous = NULL;
 
     newInterface->next = NULL;
+    InvalidateDiscoveryCache();
 
     OCResourceInterface **firstInterface = &(resource->rsrcInterface);
 
@@ -4427,42 +5673,47 @@ OCStackResult getQueryFromUri(const char * uri, char** query, char ** uriWithout
 
 const OicUuid_t* OCGetServerInstanceID(void)
 {
-    static bool generated = false;
-    static OicUuid_t sid;
-    if (generated)
+    if (serverInstanceIdValid)
     {
-        return &sid;
+        return &serverInstanceId;
     }
 
-    if (GetDoxmDeviceID(&sid) != OC_STACK_OK)
+    if (GetDoxmDeviceID(&serverInstanceId) != OC_STACK_OK)
     {
         OIC_LOG(FATAL, TAG, "Generate UUID for Server Instance failed!");
         return NULL;
     }
-    generated = true;
-    return &sid;
+    serverInstanceIdValid = true;
+    return &serverInstanceId;
 }
 
 const char* OCGetServerInstanceIDString(void)
 {
-    static bool generated = false;
-    static char sidStr[UUID_STRING_SIZE];
-
-    if(generated)
+    if (serverInstanceIdStrValid)
     {
-        return sidStr;
+        return serverInstanceIdStr;
     }
 
     const OicUuid_t* sid = OCGetServerInstanceID();
 
-    if(OCConvertUuidToString(sid->id, sidStr) != RAND_UUID_OK)
+    if (!sid || OCConvertUuidToString(sid->id, serverInstanceIdStr) != RAND_UUID_OK)
     {
         OIC_LOG(FATAL, TAG, "Generate UUID String for Server Instance failed!");
         return NULL;
     }
 
-    generated = true;
-    return sidStr;
+    serverInstanceIdStrValid = true;
+    return serverInstanceIdStr;
+}
+
+void OCServerInstanceIDChanged(void)
+{
+    OCStackLock();
+    serverInstanceIdValid = false;
+    serverInstanceIdStrValid = false;
+    // The sid is part of every cached /oic/res response
+    InvalidateDiscoveryCache();
+    OCStackUnlock();
 }
 
 CAResult_t OCSelectNetwork()
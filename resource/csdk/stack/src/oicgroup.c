@@ -21,6 +21,8 @@
 #define _POSIX_C_SOURCE 200112L
 
 #include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #include "oicgroup.h"
 #include "cJSON.h"
@@ -28,9 +30,11 @@
 #include "ocpayload.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
 #include "occollection.h"
 #include "logger.h"
 #include "timer.h"
+#include "utlist.h"
 
 #ifndef WITH_ARDUINO
 #include <pthread.h>
@@ -50,7 +54,10 @@
 #define CANCEL_ACTIONSET        "CancelAction"
 #define DELETE_ACTIONSET        "DelActionSet"
 
-#define DEFAULT_CONTEXT_VALUE 0x99
+// Keys of the aggregated ActionSet result
+#define ACTION_RESULTS          "actionResults"
+#define ACTION_RESULT           "result"
+#define ACTION_LATENCY          "latency"
 
 #define VARIFY_POINTER_NULL(pointer, result, toExit) \
     if(pointer == NULL) \
@@ -71,261 +78,740 @@
         pointer = NULL; \
     }
 
-#ifndef WITH_ARDUINO
-pthread_mutex_t lock;
-#endif
-
 enum ACTION_TYPE
 {
     NONE = 0, SCHEDULED, RECURSIVE
 };
 
+/** Heap position of a scheduled entry that has been taken out for execution. */
+#define SCHEDULE_RUNNING        SIZE_MAX
+
+/** Initial capacity of the scheduler deadline heap. */
+#define SCHEDULE_HEAP_INITIAL   (8)
+
 typedef struct scheduledresourceinfo
 {
     OCResource *resource;
     OCActionSet *actionset;
 
-    int timer_id;
-
     OCServerRequest *ehRequest;
 
+    /** Absolute time at which the action set is due.*/
     time_t time;
+
+    /** Position in the deadline heap, or SCHEDULE_RUNNING while it executes.*/
+    size_t heapIndex;
+
+    /** Set when the entry is cancelled while it executes.*/
+    bool cancelled;
+
+    /** Set when the action set is deleted while the entry executes.  The entry
+     *  is then unlinked from it and deletes it once its run finishes.*/
+    bool deleteActionSet;
+
+    /** Next pending schedule of the same action set.*/
     struct scheduledresourceinfo* next;
 } ScheduledResourceInfo;
 
-ScheduledResourceInfo *scheduleResourceList = NULL;
-
-void AddScheduledResource(ScheduledResourceInfo **head,
-        ScheduledResourceInfo* add)
-{
-    OIC_LOG(INFO, TAG, "AddScheduledResource Entering...");
+/**
+ * Pending schedules ordered by deadline.  A binary min-heap keeps the next
+ * due entry at the root; every entry remembers its own position so that a
+ * cancellation is a single O(log n) removal.
+ */
+static ScheduledResourceInfo **scheduleHeap = NULL;
+static size_t scheduleHeapSize = 0;
+static size_t scheduleHeapCapacity = 0;
 
 #ifndef WITH_ARDUINO
-    pthread_mutex_lock(&lock);
+static pthread_mutex_t scheduleMutex = PTHREAD_MUTEX_INITIALIZER;
+/** Signalled when the heap root changes or the timing thread must exit.*/
+static pthread_cond_t scheduleCond = PTHREAD_COND_INITIALIZER;
+static pthread_t scheduleThread;
+static bool scheduleThreadStarted = false;
+static bool scheduleThreadStop = false;
+#else
+/** Single timer armed for the heap root.*/
+static int scheduleTimerId = -1;
 #endif
-    ScheduledResourceInfo *tmp = NULL;
 
-    if (*head != NULL)
-    {
-        tmp = *head;
+void DoScheduledGroupAction();
 
-        while (tmp->next)
-        {
-            tmp = tmp->next;
-        }
-        tmp->next = add;
-    }
-    else
-    {
-        *head = add;
-    }
+static void LockSchedule()
+{
 #ifndef WITH_ARDUINO
-    pthread_mutex_unlock(&lock);
+    pthread_mutex_lock(&scheduleMutex);
 #endif
 }
 
-ScheduledResourceInfo* GetScheduledResource(ScheduledResourceInfo *head)
+static void UnlockSchedule()
 {
-    OIC_LOG(INFO, TAG, "GetScheduledResource Entering...");
-
 #ifndef WITH_ARDUINO
-    pthread_mutex_lock(&lock);
+    pthread_mutex_unlock(&scheduleMutex);
 #endif
+}
 
+static time_t GetScheduleTime()
+{
     time_t t_now;
-
-    ScheduledResourceInfo *tmp = NULL;
-    tmp = head;
-
 #ifndef WITH_ARDUINO
     time(&t_now);
 #else
     t_now = now();
 #endif
+    return t_now;
+}
+
+static void SwapScheduleHeap(size_t a, size_t b)
+{
+    ScheduledResourceInfo *tmp = scheduleHeap[a];
+    scheduleHeap[a] = scheduleHeap[b];
+    scheduleHeap[b] = tmp;
+    scheduleHeap[a]->heapIndex = a;
+    scheduleHeap[b]->heapIndex = b;
+}
+
+static bool IsScheduledBefore(size_t a, size_t b)
+{
+    return timespec_diff(scheduleHeap[a]->time, scheduleHeap[b]->time) < (time_t) 0;
+}
 
-    if (tmp)
+static size_t SiftUpSchedule(size_t idx)
+{
+    while (idx > 0)
     {
-        while (tmp)
+        size_t parent = (idx - 1) / 2;
+        if (!IsScheduledBefore(idx, parent))
         {
-            time_t diffTm = 0;
-#ifndef WITH_ARDUINO
-            diffTm = timespec_diff(tmp->time, t_now);
-#else
-            diffTm = timespec_diff(tmp->time, t_now);
-#endif
+            break;
+        }
+        SwapScheduleHeap(idx, parent);
+        idx = parent;
+    }
+    return idx;
+}
 
-            if (diffTm <= (time_t) 0)
-            {
-                OIC_LOG(INFO, TAG, "return Call INFO.");
-                goto exit;
-            }
+static void SiftDownSchedule(size_t idx)
+{
+    for (;;)
+    {
+        size_t left = 2 * idx + 1;
+        size_t right = left + 1;
+        size_t smallest = idx;
 
-            tmp = tmp->next;
+        if (left < scheduleHeapSize && IsScheduledBefore(left, smallest))
+        {
+            smallest = left;
         }
+        if (right < scheduleHeapSize && IsScheduledBefore(right, smallest))
+        {
+            smallest = right;
+        }
+        if (smallest == idx)
+        {
+            break;
+        }
+        SwapScheduleHeap(idx, smallest);
+        idx = smallest;
     }
+}
 
-    exit:
-#ifndef WITH_ARDUINO
-    pthread_mutex_unlock(&lock);
-#endif
-    if (tmp == NULL)
+/**
+ * Inserts an entry into the deadline heap.  Must be called with the
+ * scheduler locked.
+ */
+static OCStackResult PushScheduledResource(ScheduledResourceInfo *info)
+{
+    if (scheduleHeapSize == scheduleHeapCapacity)
+    {
+        size_t capacity = scheduleHeapCapacity ?
+                scheduleHeapCapacity * 2 : SCHEDULE_HEAP_INITIAL;
+        ScheduledResourceInfo **heap = (ScheduledResourceInfo **) OICRealloc(
+                scheduleHeap, capacity * sizeof(ScheduledResourceInfo *));
+        if (!heap)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        scheduleHeap = heap;
+        scheduleHeapCapacity = capacity;
+    }
+
+    info->heapIndex = scheduleHeapSize;
+    scheduleHeap[scheduleHeapSize++] = info;
+    SiftUpSchedule(info->heapIndex);
+    return OC_STACK_OK;
+}
+
+/**
+ * Removes a queued entry from the deadline heap.  Must be called with the
+ * scheduler locked.
+ */
+static void PopScheduledResource(ScheduledResourceInfo *info)
+{
+    size_t idx = info->heapIndex;
+    size_t last = scheduleHeapSize - 1;
+
+    info->heapIndex = SCHEDULE_RUNNING;
+    if (idx != last)
+    {
+        scheduleHeap[idx] = scheduleHeap[last];
+        scheduleHeap[idx]->heapIndex = idx;
+    }
+    scheduleHeapSize--;
+
+    if (idx < scheduleHeapSize && SiftUpSchedule(idx) == idx)
+    {
+        SiftDownSchedule(idx);
+    }
+}
+
+/**
+ * Unlinks an entry from its action set.  Must be called with the scheduler
+ * locked.
+ */
+static void UnlinkScheduledResource(ScheduledResourceInfo *del)
+{
+    ScheduledResourceInfo **link = &del->actionset->schedule;
+
+    while (*link && *link != del)
+    {
+        link = &(*link)->next;
+    }
+    if (*link)
     {
-        OIC_LOG(INFO, TAG, "Cannot Find Call Info.");
+        *link = del->next;
     }
-    return tmp;
 }
 
-ScheduledResourceInfo* GetScheduledResourceByActionSetName(ScheduledResourceInfo *head, char *setName)
+/**
+ * Unlinks an entry from its action set, if it was not detached already, and
+ * frees it.  Must be called with the scheduler locked and the entry out of
+ * the heap.
+ */
+static void RemoveScheduledResource(ScheduledResourceInfo *del)
 {
-    OIC_LOG(INFO, TAG, "GetScheduledResourceByActionSetName Entering...");
+    if (!del->deleteActionSet)
+    {
+        UnlinkScheduledResource(del);
+    }
+
+    OCFREE(del)
+}
 
+/**
+ * Lets the timing source know the heap root may have changed.  Must be
+ * called with the scheduler locked.
+ */
+static void WakeScheduler()
+{
 #ifndef WITH_ARDUINO
-    pthread_mutex_lock(&lock);
+    pthread_cond_signal(&scheduleCond);
+#else
+    unregisterTimer(scheduleTimerId);
+    scheduleTimerId = -1;
+
+    if (scheduleHeapSize > 0)
+    {
+        time_t delay = timespec_diff(scheduleHeap[0]->time, GetScheduleTime());
+        registerTimer(delay > 0 ? delay : 1, &scheduleTimerId, &DoScheduledGroupAction);
+    }
 #endif
-    ScheduledResourceInfo *tmp = NULL;
-    tmp = head;
+}
 
-    if (tmp)
+#ifndef WITH_ARDUINO
+static void *ScheduleTimingThread(void *context)
+{
+    (void) context;
+
+    pthread_mutex_lock(&scheduleMutex);
+    while (!scheduleThreadStop)
     {
-        while (tmp)
+        if (0 == scheduleHeapSize)
         {
-            if (strcmp(tmp->actionset->actionsetName, setName) == 0)
-            {
-                OIC_LOG(INFO, TAG, "return Call INFO.");
-                goto exit;
-            }
-            tmp = tmp->next;
+            pthread_cond_wait(&scheduleCond, &scheduleMutex);
+        }
+        else if (timespec_diff(scheduleHeap[0]->time, GetScheduleTime()) > (time_t) 0)
+        {
+            struct timespec deadline = { .tv_sec = scheduleHeap[0]->time, .tv_nsec = 0 };
+            pthread_cond_timedwait(&scheduleCond, &scheduleMutex, &deadline);
+        }
+        else
+        {
+            pthread_mutex_unlock(&scheduleMutex);
+            DoScheduledGroupAction();
+            pthread_mutex_lock(&scheduleMutex);
         }
     }
+    pthread_mutex_unlock(&scheduleMutex);
 
-exit:
-#ifndef WITH_ARDUINO
-    pthread_mutex_unlock(&lock);
+    return NULL;
+}
 #endif
-    if (tmp == NULL)
+
+/**
+ * Schedules an action set to run after the given delay.
+ *
+ * @param resource      Collection resource owning the action set.
+ * @param actionset     Action set to execute.
+ * @param ehRequest     Request the action set was triggered by.
+ * @param delay         Seconds from now at which the action set is due.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult AddScheduledResource(OCResource *resource, OCActionSet *actionset,
+        OCServerRequest *ehRequest, long int delay)
+{
+    OIC_LOG(INFO, TAG, "AddScheduledResource Entering...");
+
+    ScheduledResourceInfo *schedule = (ScheduledResourceInfo *) OICCalloc(1,
+            sizeof(ScheduledResourceInfo));
+    if (!schedule)
     {
-        OIC_LOG(INFO, TAG, "Cannot Find Call Info.");
+        return OC_STACK_NO_MEMORY;
     }
-    return tmp;
-}
 
-void RemoveScheduledResource(ScheduledResourceInfo **head,
-        ScheduledResourceInfo* del)
-{
+    schedule->resource = resource;
+    schedule->actionset = actionset;
+    schedule->ehRequest = ehRequest;
+    schedule->time = GetScheduleTime();
+    timespec_add(&schedule->time, delay);
+
+    LockSchedule();
 #ifndef WITH_ARDUINO
-    pthread_mutex_lock(&lock);
+    if (!scheduleThreadStarted)
+    {
+        scheduleThreadStop = false;
+        if (0 != pthread_create(&scheduleThread, NULL, ScheduleTimingThread, NULL))
+        {
+            UnlockSchedule();
+            OICFree(schedule);
+            return OC_STACK_ERROR;
+        }
+        scheduleThreadStarted = true;
+    }
 #endif
-    OIC_LOG(INFO, TAG, "RemoveScheduledResource Entering...");
-    ScheduledResourceInfo *tmp = NULL;
 
-    if (del == NULL)
+    OCStackResult result = PushScheduledResource(schedule);
+    if (OC_STACK_OK != result)
     {
-#ifndef WITH_ARDUINO
-    pthread_mutex_unlock(&lock);
-#endif
-        return;
+        UnlockSchedule();
+        OICFree(schedule);
+        return result;
     }
 
-    if (*head == del)
+    schedule->next = actionset->schedule;
+    actionset->schedule = schedule;
+
+    if (0 == schedule->heapIndex)
     {
-        *head = (*head)->next;
+        WakeScheduler();
     }
-    else
+    UnlockSchedule();
+
+    return OC_STACK_OK;
+}
+
+/**
+ * Cancels one pending schedule of an action set.  An entry that is
+ * currently executing finishes its run but is not re-armed.
+ */
+OCStackResult CancelScheduledResource(OCActionSet *actionset)
+{
+    OIC_LOG(INFO, TAG, "CancelScheduledResource Entering...");
+
+    OCStackResult result = OC_STACK_ERROR;
+    ScheduledResourceInfo *running = NULL;
+
+    LockSchedule();
+    for (ScheduledResourceInfo *tmp = actionset->schedule; tmp; tmp = tmp->next)
     {
-        tmp = *head;
-        while (tmp->next && (tmp->next != del))
+        if (tmp->cancelled)
         {
-            tmp = tmp->next;
+            continue;
         }
-        if (tmp->next)
+        if (SCHEDULE_RUNNING != tmp->heapIndex)
         {
-            tmp->next = del->next;
+            bool wasRoot = (0 == tmp->heapIndex);
+            PopScheduledResource(tmp);
+            RemoveScheduledResource(tmp);
+            if (wasRoot)
+            {
+                WakeScheduler();
+            }
+            running = NULL;
+            result = OC_STACK_OK;
+            break;
         }
+        running = tmp;
     }
+    if (running)
+    {
+        running->cancelled = true;
+        result = OC_STACK_OK;
+    }
+    UnlockSchedule();
 
-    OCFREE(del)
+    return result;
+}
+
+/**
+ * Cancels every schedule of an action set that is about to be deleted.  An
+ * entry that is currently executing is detached from the action set and
+ * deletes it once its run finishes, so this never waits.  Only the timing
+ * source runs entries, one at a time.
+ */
+bool CancelAllScheduledResources(OCActionSet *actionset)
+{
+    LockSchedule();
+    bool wake = false;
+    bool running = false;
+    ScheduledResourceInfo *tmp = actionset->schedule;
+    while (tmp)
+    {
+        ScheduledResourceInfo *next = tmp->next;
+        if (SCHEDULE_RUNNING != tmp->heapIndex)
+        {
+            wake = wake || (0 == tmp->heapIndex);
+            PopScheduledResource(tmp);
+            RemoveScheduledResource(tmp);
+        }
+        else
+        {
+            tmp->cancelled = true;
+            tmp->deleteActionSet = true;
+            UnlinkScheduledResource(tmp);
+            running = true;
+        }
+        tmp = next;
+    }
+    if (wake)
+    {
+        WakeScheduler();
+    }
+    UnlockSchedule();
+    return running;
+}
+
+size_t GetNumScheduledResources()
+{
+    LockSchedule();
+    size_t num = scheduleHeapSize;
+    UnlockSchedule();
+    return num;
+}
+
+OCActionSet *GetNextScheduledActionSet()
+{
+    LockSchedule();
+    OCActionSet *actionset = scheduleHeapSize > 0 ? scheduleHeap[0]->actionset : NULL;
+    UnlockSchedule();
+    return actionset;
+}
+
+void TerminateScheduledGroupActions()
+{
+#ifndef WITH_ARDUINO
+    pthread_mutex_lock(&scheduleMutex);
+    bool started = scheduleThreadStarted;
+    scheduleThreadStop = true;
+    pthread_cond_signal(&scheduleCond);
+    pthread_mutex_unlock(&scheduleMutex);
+
+    if (started)
+    {
+        pthread_join(scheduleThread, NULL);
+    }
+#endif
+
+    LockSchedule();
+    while (scheduleHeapSize > 0)
+    {
+        ScheduledResourceInfo *info = scheduleHeap[0];
+        PopScheduledResource(info);
+        RemoveScheduledResource(info);
+    }
+    OCFREE(scheduleHeap)
+    scheduleHeapCapacity = 0;
 #ifndef WITH_ARDUINO
-    pthread_mutex_unlock(&lock);
+    scheduleThreadStarted = false;
+#else
+    unregisterTimer(scheduleTimerId);
+    scheduleTimerId = -1;
 #endif
+    UnlockSchedule();
 }
 
-typedef struct aggregatehandleinfo
+/** Progress of one member request of an ActionSet fan-out.*/
+typedef enum
+{
+    FANOUT_MEMBER_SENDING = 0,
+    FANOUT_MEMBER_PENDING,
+    FANOUT_MEMBER_DONE
+} FanOutMemberState;
+
+struct actionfanout;
+
+typedef struct
+{
+    struct actionfanout *fanOut;
+    char *uri;
+    FanOutMemberState state;
+
+    /** True while a client callback refers to this member.*/
+    bool attached;
+
+    OCStackResult result;
+    uint64_t sentTime;
+    uint64_t latency;
+
+    /** Representation returned by the member, if any.*/
+    OCRepPayload *payload;
+} ActionFanOutMember;
+
+/**
+ * One execution of an ActionSet.  Every member request is addressed by its
+ * slot in members[], which is also the client callback context, so a
+ * response is matched without searching.  The aggregated result is sent once
+ * all members have answered or the deadline has passed.
+ */
+typedef struct actionfanout
 {
     OCServerRequest *ehRequest;
-    OCDoHandle required;
     OCResource *collResource;
+    uint64_t deadline;
+    uint32_t numPending;
+
+    /** Dispatcher, completion and attached client callbacks.*/
+    uint32_t refCount;
+    bool completed;
+
+    struct actionfanout *next;
 
-    struct aggregatehandleinfo *next;
-} ClientRequestInfo;
+    uint32_t numMembers;
+    ActionFanOutMember members[];
+} ActionFanOut;
 
-ClientRequestInfo *clientRequstList = NULL;
+static ActionFanOut *fanOutList = NULL;
+
+/** Seconds after which an ActionSet execution reports the members that did not answer.*/
+static uint32_t actionSetResponseTimeout = ACTIONSET_RESPONSE_TIMEOUT_SECONDS;
+
+#ifndef WITH_ARDUINO
+static pthread_mutex_t fanOutMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void LockFanOut()
+{
+#ifndef WITH_ARDUINO
+    pthread_mutex_lock(&fanOutMutex);
+#endif
+}
+
+static void UnlockFanOut()
+{
+#ifndef WITH_ARDUINO
+    pthread_mutex_unlock(&fanOutMutex);
+#endif
+}
 
-void AddClientRequestInfo(ClientRequestInfo **head, ClientRequestInfo* add)
+/**
+ * Drops a reference and frees the fan-out with the last one.  Must be
+ * called with the fan-out lock held.
+ */
+static void ReleaseFanOut(ActionFanOut *fanOut)
 {
-    ClientRequestInfo *tmp = NULL;
+    if (--fanOut->refCount > 0)
+    {
+        return;
+    }
 
-    if (*head != NULL)
+    LL_DELETE(fanOutList, fanOut);
+    for (uint32_t i = 0; i < fanOut->numMembers; i++)
     {
-        tmp = *head;
+        OICFree(fanOut->members[i].uri);
+        OCRepPayloadDestroy(fanOut->members[i].payload);
+    }
+    OICFree(fanOut);
+}
 
-        while (tmp->next)
-        {
-            tmp = tmp->next;
-        }
-        tmp->next = add;
+/**
+ * Claims the aggregated response once no member is outstanding.  Must be
+ * called with the fan-out lock held.
+ *
+ * @return true if the caller has to call CompleteFanOut().
+ */
+static bool ClaimFanOut(ActionFanOut *fanOut)
+{
+    if (fanOut->completed || fanOut->numPending > 0)
+    {
+        return false;
     }
-    else
+    fanOut->completed = true;
+    fanOut->refCount++;
+    return true;
+}
+
+/**
+ * Records the outcome of a member request.  Must be called with the fan-out
+ * lock held.  Ownership of payload passes to the fan-out.
+ *
+ * @return true if the caller has to call CompleteFanOut().
+ */
+static bool FinishFanOutMember(ActionFanOutMember *member, OCStackResult result,
+        OCRepPayload *payload)
+{
+    if (FANOUT_MEMBER_DONE == member->state)
+    {
+        OCRepPayloadDestroy(payload);
+        return false;
+    }
+
+    member->state = FANOUT_MEMBER_DONE;
+    member->result = result;
+    member->payload = payload;
+    if (member->sentTime)
     {
-        *head = add;
+        member->latency = OICGetCurrentTime(TIME_IN_MS) - member->sentTime;
     }
+    member->fanOut->numPending--;
+
+    return ClaimFanOut(member->fanOut);
 }
 
-ClientRequestInfo* GetClientRequestInfo(ClientRequestInfo *head,
-        OCDoHandle handle)
+/**
+ * Sends the aggregated result of a fan-out and drops the completion
+ * reference taken by ClaimFanOut().
+ */
+static void CompleteFanOut(ActionFanOut *fanOut)
 {
-    ClientRequestInfo *tmp = NULL;
+    uint32_t failed = 0;
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayload **results = (OCRepPayload **) OICCalloc(fanOut->numMembers,
+            sizeof(OCRepPayload *));
 
-    tmp = head;
+    for (uint32_t i = 0; i < fanOut->numMembers; i++)
+    {
+        ActionFanOutMember *member = &fanOut->members[i];
+        // OC_STACK_OK through OC_STACK_CONTINUE are success codes.
+        if (member->result > OC_STACK_CONTINUE)
+        {
+            failed++;
+        }
+        if (!payload || !results)
+        {
+            continue;
+        }
 
-    if (tmp)
+        results[i] = member->payload ? member->payload : OCRepPayloadCreate();
+        member->payload = NULL;
+        if (results[i])
+        {
+            OCRepPayloadSetUri(results[i], member->uri);
+            OCRepPayloadSetPropInt(results[i], ACTION_RESULT, member->result);
+            OCRepPayloadSetPropInt(results[i], ACTION_LATENCY, (int64_t) member->latency);
+        }
+    }
+
+    OIC_LOG_V(INFO, TAG, "ActionSet fan-out done, %u of %u members failed",
+            failed, fanOut->numMembers);
+
+    if (payload && results)
     {
-        while (tmp)
+        size_t dimensions[MAX_REP_ARRAY_DEPTH] = { fanOut->numMembers, 0, 0 };
+        if (!OCRepPayloadSetPropObjectArrayAsOwner(payload, ACTION_RESULTS, results,
+                dimensions))
         {
-            if (tmp->required == handle)
+            for (uint32_t i = 0; i < fanOut->numMembers; i++)
             {
-                break;
+                OCRepPayloadDestroy(results[i]);
             }
-
-            tmp = tmp->next;
+            OICFree(results);
         }
+        results = NULL;
+    }
+
+    // A scheduled run may outlive the request that triggered it.
+    if (payload && fanOut->ehRequest && GetServerRequestUsingHandle(fanOut->ehRequest))
+    {
+        OCEntityHandlerResponse response = { 0 };
+
+        response.ehResult = failed ? OC_EH_ERROR : OC_EH_OK;
+        response.requestHandle = fanOut->ehRequest;
+        response.resourceHandle = fanOut->collResource;
+        response.payload = (OCPayload *) payload;
+        // Indicate that response is NOT in a persistent buffer
+        response.persistentBufferFlag = 0;
 
-        return tmp;
+        if (OCDoResponse(&response) != OC_STACK_OK)
+        {
+            OIC_LOG(ERROR, TAG, "Error sending response");
+        }
     }
-    return NULL;
+    OCRepPayloadDestroy(payload);
+    OICFree(results);
+
+    LockFanOut();
+    ReleaseFanOut(fanOut);
+    UnlockFanOut();
 }
 
-void RemoveClientRequestInfo(ClientRequestInfo **head, ClientRequestInfo* del)
+void SetActionSetResponseTimeout(uint32_t seconds)
 {
-    ClientRequestInfo *tmp = NULL;
+    LockFanOut();
+    actionSetResponseTimeout = seconds;
+    UnlockFanOut();
+}
 
-    if (del == NULL)
-        return;
+size_t GetNumActionSetFanOuts()
+{
+    size_t num = 0;
+    ActionFanOut *fanOut = NULL;
 
-    if (*head == del)
+    LockFanOut();
+    LL_FOREACH(fanOutList, fanOut)
     {
-        *head = (*head)->next;
+        num++;
     }
-    else
+    UnlockFanOut();
+    return num;
+}
+
+void ProcessActionSetTimeouts()
+{
+    for (;;)
     {
-        tmp = *head;
-        while (tmp->next && (tmp->next != del))
+        ActionFanOut *expired = NULL;
+        uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+
+        LockFanOut();
+        ActionFanOut *fanOut = NULL;
+        LL_FOREACH(fanOutList, fanOut)
         {
-            tmp = tmp->next;
+            if (!fanOut->completed && fanOut->deadline <= now)
+            {
+                break;
+            }
         }
-        if (tmp->next)
+        if (fanOut)
         {
-            tmp->next = del->next;
+            OIC_LOG(INFO, TAG, "ActionSet fan-out deadline passed");
+            bool claimed = false;
+            for (uint32_t i = 0; i < fanOut->numMembers; i++)
+            {
+                claimed = FinishFanOutMember(&fanOut->members[i], OC_STACK_TIMEOUT, NULL)
+                        || claimed;
+            }
+            if (claimed || ClaimFanOut(fanOut))
+            {
+                expired = fanOut;
+            }
         }
+        UnlockFanOut();
+
+        if (!expired)
+        {
+            break;
+        }
+        CompleteFanOut(expired);
     }
 }
 
@@ -430,6 +916,13 @@ void DeleteActionSet(OCActionSet** actionset)
     if(*actionset == NULL)
         return;
 
+    // A run in progress still uses the action set, the scheduler deletes it afterwards
+    if (CancelAllScheduledResources(*actionset))
+    {
+        *actionset = NULL;
+        return;
+    }
+
     OCAction* pointer = (*actionset)->head;
     OCAction* pDel = NULL;
 
@@ -871,52 +1364,63 @@ exit:
 OCStackApplicationResult ActionSetCB(void* context, OCDoHandle handle,
         OCClientResponse* clientResponse)
 {
-    (void)context;
-    (void)clientResponse;
+    (void)handle;
     OIC_LOG(INFO, TAG, "Entering ActionSetCB");
 
-    ClientRequestInfo *info = GetClientRequestInfo(clientRequstList, handle);
-
-    if (info)
+    ActionFanOutMember *member = (ActionFanOutMember *) context;
+    if (!member || !clientResponse)
     {
-        OCEntityHandlerResponse response = { 0 };
-
-        response.ehResult = OC_EH_OK;
-
-        if(NULL == clientResponse->payload)
-        {
-            OIC_LOG(ERROR, TAG, "Error sending response");
-            return OC_STACK_DELETE_TRANSACTION;
-        }
+        return OC_STACK_DELETE_TRANSACTION;
+    }
 
-        // Format the response.  Note this requires some info about the request
-        response.requestHandle = info->ehRequest;
-        response.resourceHandle = info->collResource;
-        response.payload = clientResponse->payload;
-        response.numSendVendorSpecificHeaderOptions = 0;
-        memset(response.sendVendorSpecificHeaderOptions, 0,
-                sizeof response.sendVendorSpecificHeaderOptions);
-        memset(response.resourceUri, 0, sizeof response.resourceUri);
-        // Indicate that response is NOT in a persistent buffer
-        response.persistentBufferFlag = 0;
+    OCRepPayload *payload = NULL;
+    OCRepPayload *received = OCPayloadGetRepresentation(clientResponse->payload, &payload);
+    if (received && !payload)
+    {
+        payload = OCRepPayloadClone(received);
+    }
 
-        // Send the response
-        if (OCDoResponse(&response) != OC_STACK_OK)
-        {
-            OIC_LOG(ERROR, TAG, "Error sending response");
-            return OC_STACK_DELETE_TRANSACTION;
-        }
+    ActionFanOut *fanOut = member->fanOut;
+    LockFanOut();
+    bool complete = FinishFanOutMember(member, clientResponse->result, payload);
+    UnlockFanOut();
 
-        RemoveClientRequestInfo(&clientRequstList, info);
-        OCFREE(info)
+    if (complete)
+    {
+        CompleteFanOut(fanOut);
     }
 
-    return OC_STACK_KEEP_TRANSACTION;
+    return OC_STACK_DELETE_TRANSACTION;
 }
 
 void ActionSetCD(void *context)
 {
-    (void)context;
+    ActionFanOutMember *member = (ActionFanOutMember *) context;
+    if (!member)
+    {
+        return;
+    }
+
+    ActionFanOut *fanOut = member->fanOut;
+    bool complete = false;
+
+    LockFanOut();
+    // The callback went away without a response, e.g. its TTL expired.
+    if (FANOUT_MEMBER_PENDING == member->state)
+    {
+        complete = FinishFanOutMember(member, OC_STACK_TIMEOUT, NULL);
+    }
+    if (member->attached)
+    {
+        member->attached = false;
+        ReleaseFanOut(fanOut);
+    }
+    UnlockFanOut();
+
+    if (complete)
+    {
+        CompleteFanOut(fanOut);
+    }
 }
 
 OCStackResult BuildActionJSON(OCAction* action, unsigned char* bufferPtr,
@@ -995,13 +1499,13 @@ unsigned int GetNumOfTargetResource(OCAction *actionset)
 }
 
 OCStackResult SendAction(OCDoHandle *handle, OCServerRequest* requestHandle, const char *targetUri,
-        OCPayload *payload)
+        OCPayload *payload, void *context)
 {
 
     OCCallbackData cbData;
     cbData.cb = &ActionSetCB;
-    cbData.context = (void*)DEFAULT_CONTEXT_VALUE;
-    cbData.cd = NULL;
+    cbData.context = context;
+    cbData.cd = &ActionSetCD;
 
     return OCDoResource(handle, OC_REST_PUT, targetUri, &requestHandle->devAddr,
                        payload, CT_ADAPTER_IP, OC_NA_QOS, &cbData, NULL, 0);
@@ -1010,131 +1514,171 @@ OCStackResult SendAction(OCDoHandle *handle, OCServerRequest* requestHandle, con
 OCStackResult DoAction(OCResource* resource, OCActionSet* actionset,
         OCServerRequest* requestHandle)
 {
-    OCStackResult result = OC_STACK_ERROR;
-
     if( NULL == actionset->head)
     {
-        return result;
+        return OC_STACK_ERROR;
+    }
+
+    uint32_t num = GetNumOfTargetResource(actionset->head);
+    ActionFanOut *fanOut = (ActionFanOut *) OICCalloc(1,
+            sizeof(ActionFanOut) + num * sizeof(ActionFanOutMember));
+    OCPayload **payloads = (OCPayload **) OICCalloc(num, sizeof(OCPayload *));
+    if (!fanOut || !payloads)
+    {
+        OICFree(fanOut);
+        OICFree(payloads);
+        return OC_STACK_NO_MEMORY;
     }
 
+    fanOut->ehRequest = requestHandle;
+    fanOut->collResource = resource;
+    fanOut->deadline = OICGetCurrentTime(TIME_IN_MS)
+            + (uint64_t) actionSetResponseTimeout * 1000;
+    fanOut->numMembers = num;
+    fanOut->numPending = num;
+    fanOut->refCount = 1;
+
+    // Prepare every request first so that they go out back to back.
     OCAction *pointerAction = actionset->head;
+    for (uint32_t i = 0; i < num; i++, pointerAction = pointerAction->next)
+    {
+        fanOut->members[i].fanOut = fanOut;
+        fanOut->members[i].uri = OICStrdup(pointerAction->resourceUri);
+        payloads[i] = BuildActionCBOR(pointerAction);
+    }
 
-    while (pointerAction != NULL)
+    LockFanOut();
+    LL_PREPEND(fanOutList, fanOut);
+    UnlockFanOut();
+
+    for (uint32_t i = 0; i < num; i++)
     {
-        OCPayload* payload;
-        payload = BuildActionCBOR(pointerAction);
+        ActionFanOutMember *member = &fanOut->members[i];
+        OCStackResult result = OC_STACK_NO_MEMORY;
 
-        if(payload == NULL)
+        LockFanOut();
+        bool skip = (FANOUT_MEMBER_DONE == member->state);
+        bool send = !skip && payloads[i] && member->uri;
+        if (send)
         {
-            return result;
+            member->attached = true;
+            member->sentTime = OICGetCurrentTime(TIME_IN_MS);
+            fanOut->refCount++;
         }
+        UnlockFanOut();
 
-        ClientRequestInfo *info = (ClientRequestInfo *) OICMalloc(
-                sizeof(ClientRequestInfo));
-
-        if( info == NULL )
+        if (send)
         {
-            OCFREE(payload);
-            return OC_STACK_NO_MEMORY;
+            result = SendAction(NULL, requestHandle, member->uri, payloads[i], member);
+        }
+        else
+        {
+            OCPayloadDestroy(payloads[i]);
         }
 
-        memset(info, 0, sizeof(ClientRequestInfo));
-
-        info->collResource = resource;
-        info->ehRequest = requestHandle;
-
-        result = SendAction(&info->required, info->ehRequest, pointerAction->resourceUri,
-                payload);
+        bool complete = false;
+        LockFanOut();
+        if (OC_STACK_OK == result)
+        {
+            if (FANOUT_MEMBER_SENDING == member->state)
+            {
+                member->state = FANOUT_MEMBER_PENDING;
+            }
+        }
+        else if (!skip)
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed to send action to %s", member->uri);
+            if (member->attached)
+            {
+                member->attached = false;
+                ReleaseFanOut(fanOut);
+            }
+            complete = FinishFanOutMember(member, result, NULL);
+        }
+        UnlockFanOut();
 
-        if (result != OC_STACK_OK)
+        if (complete)
         {
-            OICFree(info);
-            return result;
+            CompleteFanOut(fanOut);
         }
+    }
 
-        AddClientRequestInfo(&clientRequstList, info);
+    OICFree(payloads);
 
-        pointerAction = pointerAction->next;
-    }
+    LockFanOut();
+    ReleaseFanOut(fanOut);
+    UnlockFanOut();
 
-    return result;
+    return OC_STACK_OK;
 }
 
 void DoScheduledGroupAction()
 {
     OIC_LOG(INFO, TAG, "DoScheduledGroupAction Entering...");
-    ScheduledResourceInfo* info = GetScheduledResource(scheduleResourceList);
 
-    if (info == NULL)
-    {
-        OIC_LOG(INFO, TAG, "Target resource is NULL");
-        goto exit;
-    }
-    else if (info->resource == NULL)
+    // Each entry runs with the lock of the stack, which action sets are changed with, taken
+    // before the scheduler. The scheduler is released while the action set runs, so that
+    // the timing source never waits for the stack.
+    for (;;)
     {
-        OIC_LOG(INFO, TAG, "Target resource is NULL");
-        goto exit;
-    }
-    else if (info->actionset == NULL)
-    {
-        OIC_LOG(INFO, TAG, "Target ActionSet is NULL");
-        goto exit;
-    }
-    else if (info->ehRequest == NULL)
-    {
-        OIC_LOG(INFO, TAG, "Target ActionSet is NULL");
-        goto exit;
-    }
-#ifndef WITH_ARDUINO
-    pthread_mutex_lock(&lock);
-#endif
-    DoAction(info->resource, info->actionset, info->ehRequest);
-#ifndef WITH_ARDUINO
-    pthread_mutex_unlock(&lock);
-#endif
+        OCStackLock();
+        LockSchedule();
+        if (0 == scheduleHeapSize
+                || timespec_diff(scheduleHeap[0]->time, GetScheduleTime()) > (time_t) 0)
+        {
+            break;
+        }
 
-    if (info->actionset->type == RECURSIVE)
-    {
-        ScheduledResourceInfo *schedule;
-        schedule = (ScheduledResourceInfo *) OICMalloc(
-                sizeof(ScheduledResourceInfo));
+        ScheduledResourceInfo *info = scheduleHeap[0];
+        PopScheduledResource(info);
+        UnlockSchedule();
 
-        if (schedule)
+        if (info->resource == NULL)
+        {
+            OIC_LOG(INFO, TAG, "Target resource is NULL");
+        }
+        else if (info->actionset == NULL)
         {
-            OIC_LOG(INFO, TAG, "Building New Call Info.");
-            memset(schedule, 0, sizeof(ScheduledResourceInfo));
+            OIC_LOG(INFO, TAG, "Target ActionSet is NULL");
+        }
+        else if (info->ehRequest == NULL)
+        {
+            OIC_LOG(INFO, TAG, "Target ActionSet is NULL");
+        }
+        else
+        {
+            DoAction(info->resource, info->actionset, info->ehRequest);
+        }
 
-            if (info->actionset->timesteps > 0)
+        LockSchedule();
+        OCActionSet *deleted = info->deleteActionSet ? info->actionset : NULL;
+        if (!info->cancelled && info->actionset->type == RECURSIVE
+                && info->actionset->timesteps > 0)
+        {
+            info->time = GetScheduleTime();
+            timespec_add(&info->time, info->actionset->timesteps);
+            if (PushScheduledResource(info) == OC_STACK_OK)
             {
-#ifndef WITH_ARDUINO
-                pthread_mutex_lock(&lock);
-#endif
-                schedule->resource = info->resource;
-                schedule->actionset = info->actionset;
-                schedule->ehRequest = info->ehRequest;
-
-                schedule->time = registerTimer(info->actionset->timesteps,
-                        &schedule->timer_id,
-                        &DoScheduledGroupAction);
-
                 OIC_LOG(INFO, TAG, "Reregisteration.");
-#ifndef WITH_ARDUINO
-                pthread_mutex_unlock(&lock);
-#endif
-                AddScheduledResource(&scheduleResourceList, schedule);
-            }
-            else
-            {
-                OICFree(schedule);
+                info = NULL;
             }
         }
+        if (info)
+        {
+            RemoveScheduledResource(info);
+        }
+        UnlockSchedule();
+        if (deleted)
+        {
+            DeleteActionSet(&deleted);
+        }
+        OCStackUnlock();
     }
-
-    RemoveScheduledResource(&scheduleResourceList, info);
-
-    exit:
-
-    return;
+#ifdef WITH_ARDUINO
+    WakeScheduler();
+#endif
+    UnlockSchedule();
+    OCStackUnlock();
 }
 
 OCStackResult BuildCollectionGroupActionCBORResponse(
@@ -1289,17 +1833,19 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
                     {
                         OIC_LOG_V(INFO, TAG, "Execute ActionSet : %s",
                                 actionset->actionsetName);
-                        unsigned int num = GetNumOfTargetResource(
-                                actionset->head);
+                        OCServerRequest *request =
+                                (OCServerRequest *) ehRequest->requestHandle;
 
-                        ((OCServerRequest *) ehRequest->requestHandle)->ehResponseHandler =
-                                HandleAggregateResponse;
-                        ((OCServerRequest *) ehRequest->requestHandle)->numResponses =
-                                num + 1;
+                        // This response and the aggregated fan-out result.
+                        request->ehResponseHandler = HandleAggregateResponse;
+                        request->numResponses = 2;
 
-                        DoAction(resource, actionset,
-                                (OCServerRequest*) ehRequest->requestHandle);
-                        stackRet = OC_STACK_OK;
+                        stackRet = DoAction(resource, actionset, request);
+                        if (stackRet != OC_STACK_OK)
+                        {
+                            request->ehResponseHandler = HandleSingleResponse;
+                            request->numResponses = 1;
+                        }
                     }
                     else
                     {
@@ -1309,46 +1855,15 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
                         delay =
                                 (delay == -1 ? actionset->timesteps : delay);
 
-                        ScheduledResourceInfo *schedule;
-                        schedule = (ScheduledResourceInfo *) OICMalloc(
-                                sizeof(ScheduledResourceInfo));
-
-                        if (schedule)
+                        if (delay > 0)
                         {
-                            OIC_LOG(INFO, TAG, "Building New Call Info.");
-                            memset(schedule, 0,
-                                    sizeof(ScheduledResourceInfo));
-#ifndef WITH_ARDUINO
-                            pthread_mutex_lock(&lock);
-#endif
-                            schedule->resource = resource;
-                            schedule->actionset = actionset;
-                            schedule->ehRequest =
-                                    (OCServerRequest*) ehRequest->requestHandle;
-#ifndef WITH_ARDUINO
-                            pthread_mutex_unlock(&lock);
-#endif
-                            if (delay > 0)
-                            {
-                                OIC_LOG_V(INFO, TAG, "delay_time is %ld seconds.",
-                                        actionset->timesteps);
-#ifndef WITH_ARDUINO
-                                pthread_mutex_lock(&lock);
-#endif
-                                schedule->time = registerTimer(delay,
-                                        &schedule->timer_id,
-                                        &DoScheduledGroupAction);
-#ifndef WITH_ARDUINO
-                                pthread_mutex_unlock(&lock);
-#endif
-                                AddScheduledResource(&scheduleResourceList,
-                                        schedule);
-                                stackRet = OC_STACK_OK;
-                            }
-                            else
-                            {
-                                stackRet = OC_STACK_ERROR;
-                            }
+                            OIC_LOG_V(INFO, TAG, "delay_time is %ld seconds.", delay);
+                            stackRet = AddScheduledResource(resource, actionset,
+                                    (OCServerRequest*) ehRequest->requestHandle, delay);
+                        }
+                        else
+                        {
+                            stackRet = OC_STACK_ERROR;
                         }
                     }
                 }
@@ -1356,15 +1871,10 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
         }
         else if (strcmp(doWhat, "CancelAction") == 0)
         {
-            ScheduledResourceInfo *info =
-                    GetScheduledResourceByActionSetName(scheduleResourceList, details);
-
-            if(info != NULL)
+            if (GetActionSet(details, resource->actionsetHead,
+                    &actionset) == OC_STACK_OK)
             {
-                unregisterTimer(info->timer_id);
-
-                RemoveScheduledResource(&scheduleResourceList, info);
-                stackRet = OC_STACK_OK;
+                stackRet = CancelScheduledResource(actionset);
             }
             else
             {
@@ -26,7 +26,7 @@
 #include "oic_string.h"
 #include "oic_time.h"
 #include "ocrandom.h"
-#include "uarraylist.h"
+#include "utlist.h"
 #include "ocstackinternal.h"
 #include "ocpayloadcbor.h"
 #include "ocpayload.h"
@@ -77,6 +77,22 @@ static const uint64_t USECS_PER_SEC = 1000000;
  */
 #define DEFAULT_INTERVAL_COUNT  6
 
+/**
+ * Number of one second slots in the KeepAlive timer wheel. Must be a power of two.
+ * Deadlines further away than one turn simply stay in their slot for more turns.
+ */
+#define KEEPALIVE_WHEEL_SLOTS 1024
+
+/**
+ * Slot of the entries detached from the timer wheel while they are handled.
+ */
+#define KEEPALIVE_DUE_SLOT KEEPALIVE_WHEEL_SLOTS
+
+/**
+ * Initial bucket count of the KeepAlive endpoint index. Must be a power of two.
+ */
+#define KEEPALIVE_INDEX_INITIAL_SIZE 64
+
 /**
  * KeepAlive key to parser Payload Table.
  */
@@ -97,15 +113,10 @@ static bool g_isKeepAliveInitialized = false;
  */
 static OCResourceHandle g_keepAliveHandle = NULL;
 
-/**
- * KeepAlive table which holds connection interval.
- */
-static u_arraylist_t *g_keepAliveConnectionTable = NULL;
-
 /**
  * KeepAlive table entries.
  */
-typedef struct
+struct KeepAliveEntry
 {
     OCMode mode;                    /**< host Mode of Operation. */
     CAEndpoint_t remoteAddr;        /**< destination Address. */
@@ -115,7 +126,43 @@ typedef struct
     int64_t *intervalInfo;          /**< interval values for KeepAlive. */
     bool sentPingMsg;               /**< if oic client already sent ping message. */
     uint64_t timeStamp;             /**< last sent or received ping message. in microseconds. */
-} KeepAliveEntry_t;
+    uint64_t deadline;              /**< next time the entry is due. in microseconds. */
+    bool scheduled;                 /**< if the entry is linked into the timer wheel. */
+    size_t slot;                    /**< timer wheel slot of the entry. */
+    struct KeepAliveEntry *hashNext;    /**< next entry in the same endpoint index bucket. */
+    struct KeepAliveEntry *prev;        /**< previous entry in the same timer wheel slot. */
+    struct KeepAliveEntry *next;        /**< next entry in the same timer wheel slot. */
+};
+
+/**
+ * KeepAlive table which holds connection interval, indexed by remote endpoint.
+ */
+static KeepAliveEntry_t **g_keepAliveConnectionTable = NULL;
+
+/**
+ * Bucket count of the KeepAlive table.
+ */
+static size_t g_keepAliveTableSize = 0;
+
+/**
+ * Number of entries in the KeepAlive table.
+ */
+static size_t g_keepAliveEntryCount = 0;
+
+/**
+ * Timer wheel of KeepAlive entries ordered by deadline, one slot per second.
+ */
+static KeepAliveEntry_t *g_keepAliveWheel[KEEPALIVE_WHEEL_SLOTS];
+
+/**
+ * Last second processed by the timer wheel.
+ */
+static uint64_t g_keepAliveWheelTime = 0;
+
+/**
+ * Entries of the slot ProcessKeepAlive is handling, detached from the wheel.
+ */
+static KeepAliveEntry_t *g_keepAliveDue = NULL;
 
 /**
  * Send disconnect message to remove connection.
@@ -179,33 +226,17 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
                                       OCStackResult responseCode,
                                       const OCRepPayload *respPayload);
 /**
- * Gets keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference uri and transport type) to
- *                          which the ping message has to be sent.
- * @param[out]  index       index of array list.
- * @return  KeepAlive entry to send ping message.
+ * Calculate the next time a keepalive entry has to be looked at.
+ * @param[in]   entry       KeepAlive entry.
+ * @return  Deadline in microseconds.
  */
-static KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, uint32_t *index);
-
-/**
- * Add keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference uri and transport type).
- * @param[in]   mode        Whether it is OIC Server or OIC Client.
- * @param[in]   intervalArray   Received interval values from cloud server.
- * @return  The KeepAlive entry added in KeepAlive Table.
- */
-KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
-                                    int64_t *intervalArray);
+static uint64_t GetKeepAliveDeadline(const KeepAliveEntry_t *entry);
 
 /**
- * Remove keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference uri and transport type).
- * @return  The KeepAlive entry removed in KeepAlive Table.
+ * Unlink a keepalive entry from the timer wheel or the list of due entries.
+ * @param[in]   entry       KeepAlive entry.
  */
-static OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint);
+static void UnscheduleKeepAliveEntry(KeepAliveEntry_t *entry);
 
 OCStackResult InitializeKeepAlive(OCMode mode)
 {
@@ -229,15 +260,21 @@ OCStackResult InitializeKeepAlive(OCMode mode)
 
     if (!g_keepAliveConnectionTable)
     {
-        g_keepAliveConnectionTable = u_arraylist_create();
+        g_keepAliveConnectionTable = (KeepAliveEntry_t **) OICCalloc(
+                KEEPALIVE_INDEX_INITIAL_SIZE, sizeof(KeepAliveEntry_t *));
         if (NULL == g_keepAliveConnectionTable)
         {
             OIC_LOG(ERROR, TAG, "Creating KeepAlive Table failed");
             TerminateKeepAlive(mode);
             return OC_STACK_ERROR;
         }
+        g_keepAliveTableSize = KEEPALIVE_INDEX_INITIAL_SIZE;
+        g_keepAliveEntryCount = 0;
     }
 
+    memset(g_keepAliveWheel, 0, sizeof(g_keepAliveWheel));
+    g_keepAliveWheelTime = OICGetCurrentTime(TIME_IN_US) / USECS_PER_SEC;
+
     g_isKeepAliveInitialized = true;
 
     OIC_LOG(DEBUG, TAG, "InitializeKeepAlive OUT");
@@ -266,8 +303,23 @@ OCStackResult TerminateKeepAlive(OCMode mode)
 
     if (NULL != g_keepAliveConnectionTable)
     {
-        u_arraylist_destroy(g_keepAliveConnectionTable);
+        for (size_t i = 0; i < g_keepAliveTableSize; i++)
+        {
+            KeepAliveEntry_t *entry = g_keepAliveConnectionTable[i];
+            while (entry)
+            {
+                KeepAliveEntry_t *next = entry->hashNext;
+                OICFree(entry->intervalInfo);
+                OICFree(entry);
+                entry = next;
+            }
+        }
+        OICFree(g_keepAliveConnectionTable);
         g_keepAliveConnectionTable = NULL;
+        g_keepAliveTableSize = 0;
+        g_keepAliveEntryCount = 0;
+        memset(g_keepAliveWheel, 0, sizeof(g_keepAliveWheel));
+        g_keepAliveDue = NULL;
     }
 
     g_isKeepAliveInitialized = false;
@@ -368,8 +420,7 @@ OCStackResult HandleKeepAlivePUTRequest(const CAEndpoint_t* endPoint,
     VERIFY_NON_NULL(requestInfo, FATAL, OC_STACK_INVALID_PARAM);
 
     // Get entry from KeepAlive table.
-    uint32_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint);
     if (!entry)
     {
         OIC_LOG(ERROR, TAG, "Received the first keepalive message from client");
@@ -391,6 +442,7 @@ OCStackResult HandleKeepAlivePUTRequest(const CAEndpoint_t* endPoint,
     entry->interval = interval;
     OIC_LOG_V(DEBUG, TAG, "Received interval is [%d]", entry->interval);
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
+    ScheduleKeepAliveEntry(entry, GetKeepAliveDeadline(entry));
 
     // Send response message.
     SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_VALID, requestInfo->info.type,
@@ -410,8 +462,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     OIC_LOG(DEBUG, TAG, "HandleKeepAliveResponse IN");
 
     // Get entry from KeepAlive table.
-    uint32_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint);
     if (!entry)
     {
         // Receive response message about find /oic/ping request.
@@ -449,11 +500,58 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
 
     // Set sentPingMsg values with false.
     entry->sentPingMsg = false;
+    ScheduleKeepAliveEntry(entry, GetKeepAliveDeadline(entry));
 
     OIC_LOG(DEBUG, TAG, "HandleKeepAliveResponse OUT");
     return OC_STACK_OK;
 }
 
+/**
+ * Act on a keepalive entry whose deadline has passed.
+ * @param[in]   entry       KeepAlive entry.
+ * @param[in]   currentTime Current time in microseconds.
+ */
+static void HandleKeepAliveTimeout(KeepAliveEntry_t *entry, uint64_t currentTime)
+{
+    if (OC_CLIENT == entry->mode && !entry->sentPingMsg)
+    {
+        // Increase interval value.
+        IncreaseInterval(entry);
+
+        OCStackResult result = SendPingMessage(entry);
+        if (OC_STACK_OK != result)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to send ping request");
+            ScheduleKeepAliveEntry(entry, currentTime);
+        }
+        return;
+    }
+
+    if (OC_CLIENT == entry->mode)
+    {
+        /*
+         * If an OIC Client does not receive the response within 1 minutes,
+         * terminate the connection.
+         * In this case the timeStamp means last time sent ping message.
+         */
+        OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
+    }
+    else
+    {
+        /*
+         * If an OIC Server does not receive a PUT request to ping resource
+         * within the specified interval time, terminate the connection.
+         * In this case the timeStamp means last time received ping message.
+         */
+        OIC_LOG(DEBUG, TAG, "Server does not receive a PUT request.");
+    }
+
+    // Send message to disconnect session.
+    // The entry is removed by the disconnect callback; retry if that never comes.
+    SendDisconnectMessage(entry);
+    ScheduleKeepAliveEntry(entry, currentTime + KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC);
+}
+
 void ProcessKeepAlive()
 {
     if (!g_isKeepAliveInitialized)
@@ -462,66 +560,90 @@ void ProcessKeepAlive()
         return;
     }
 
-    uint32_t len = u_arraylist_length(g_keepAliveConnectionTable);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+    uint64_t currentSec = currentTime / USECS_PER_SEC;
+
+    // Only the slots passed since the last call are visited, at most one turn.
+    uint64_t sec = g_keepAliveWheelTime;
+    if (currentSec - sec >= KEEPALIVE_WHEEL_SLOTS)
+    {
+        sec = currentSec - KEEPALIVE_WHEEL_SLOTS + 1;
+    }
 
-    for (uint32_t i = 0; i < len; i++)
+    for (; sec <= currentSec; sec++)
     {
-        KeepAliveEntry_t *entry = u_arraylist_get(g_keepAliveConnectionTable, i);
-        if (NULL == entry)
+        // Handled entries are scheduled again, possibly into this very slot, so the slot
+        // is detached and every entry leaves the detached list before it is handled.
+        size_t slot = sec & (KEEPALIVE_WHEEL_SLOTS - 1);
+        KeepAliveEntry_t *entry = NULL;
+        g_keepAliveDue = g_keepAliveWheel[slot];
+        g_keepAliveWheel[slot] = NULL;
+        DL_FOREACH(g_keepAliveDue, entry)
         {
-            continue;
+            entry->slot = KEEPALIVE_DUE_SLOT;
         }
 
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
-        if (OC_CLIENT == entry->mode)
+        while (g_keepAliveDue)
         {
-            if (entry->sentPingMsg)
+            entry = g_keepAliveDue;
+            if (entry->deadline <= currentTime)
             {
-                /*
-                 * If an OIC Client does not receive the response within 1 minutes,
-                 * terminate the connection.
-                 * In this case the timeStamp means last time sent ping message.
-                 */
-                if ((KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC) <= currentTime - entry->timeStamp)
-                {
-                    OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
-
-                    // Send message to disconnect session.
-                    SendDisconnectMessage(entry);
-                }
+                UnscheduleKeepAliveEntry(entry);
+                HandleKeepAliveTimeout(entry, currentTime);
             }
             else
             {
-                if ((entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC)
-                        <= currentTime - entry->timeStamp)
-                {
-                    // Increase interval value.
-                    IncreaseInterval(entry);
-
-                    OCStackResult result = SendPingMessage(entry);
-                    if (OC_STACK_OK != result)
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed to send ping request");
-                        continue;
-                    }
-                }
-            }
-        }
-        else if (OC_SERVER == entry->mode)
-        {
-            /*
-             * If an OIC Server does not receive a PUT request to ping resource
-             * within the specified interval time, terminate the connection.
-             * In this case the timeStamp means last time received ping message.
-             */
-            if ((entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC)
-                    <= currentTime - entry->timeStamp)
-            {
-                OIC_LOG(DEBUG, TAG, "Server does not receive a PUT request.");
-                SendDisconnectMessage(entry);
+                // Due on a later turn of the wheel
+                ScheduleKeepAliveEntry(entry, entry->deadline);
             }
         }
     }
+
+    g_keepAliveWheelTime = currentSec;
+}
+
+uint64_t GetKeepAliveDeadline(const KeepAliveEntry_t *entry)
+{
+    if (OC_CLIENT == entry->mode && entry->sentPingMsg)
+    {
+        return entry->timeStamp + KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+    }
+    return entry->timeStamp
+            + (uint64_t) entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+}
+
+void UnscheduleKeepAliveEntry(KeepAliveEntry_t *entry)
+{
+    if (!entry->scheduled)
+    {
+        return;
+    }
+
+    if (KEEPALIVE_DUE_SLOT == entry->slot)
+    {
+        DL_DELETE(g_keepAliveDue, entry);
+    }
+    else
+    {
+        DL_DELETE(g_keepAliveWheel[entry->slot], entry);
+    }
+    entry->scheduled = false;
+}
+
+void ScheduleKeepAliveEntry(KeepAliveEntry_t *entry, uint64_t deadline)
+{
+    uint64_t sec = deadline / USECS_PER_SEC;
+    if (sec < g_keepAliveWheelTime)
+    {
+        sec = g_keepAliveWheelTime;
+    }
+
+    UnscheduleKeepAliveEntry(entry);
+
+    entry->deadline = deadline;
+    entry->slot = sec & (KEEPALIVE_WHEEL_SLOTS - 1);
+    entry->scheduled = true;
+    DL_APPEND(g_keepAliveWheel[entry->slot], entry);
 }
 
 void IncreaseInterval(KeepAliveEntry_t *entry)
@@ -573,6 +695,7 @@ OCStackResult SendPingMessage(KeepAliveEntry_t *entry)
     // Update timeStamp with time sent ping message for next ping message.
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
     entry->sentPingMsg = true;
+    ScheduleKeepAliveEntry(entry, GetKeepAliveDeadline(entry));
 
     OIC_LOG_V(DEBUG, TAG, "Client sent ping message, interval [%d]", entry->interval);
 
@@ -594,36 +717,80 @@ OCStackApplicationResult PingRequestCallback(void* ctx, OCDoHandle handle,
     CAEndpoint_t endpoint = { .adapter = CA_ADAPTER_TCP };
     CopyDevAddrToEndpoint(&(clientResponse->devAddr), &endpoint);
 
+    OCRepPayload *decoded = NULL;
     HandleKeepAliveResponse(&endpoint, clientResponse->result,
-                            (OCRepPayload *)clientResponse->payload);
+                            OCPayloadGetRepresentation(clientResponse->payload, &decoded));
+    OCRepPayloadDestroy(decoded);
 
     OIC_LOG(DEBUG, TAG, "PingRequestCallback OUT");
     return OC_STACK_KEEP_TRANSACTION;
 }
 
-KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, uint32_t *index)
+/**
+ * Hash a remote endpoint into the KeepAlive table.
+ * @param[in]   endpoint    Remote Endpoint information.
+ * @return  FNV-1a hash of the address and port.
+ */
+static size_t HashEndpoint(const CAEndpoint_t *endpoint)
 {
-    if (!g_keepAliveConnectionTable)
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(endpoint->addr) && endpoint->addr[i]; i++)
     {
-        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
-        return NULL;
+        hash = (hash ^ (uint8_t) endpoint->addr[i]) * 16777619u;
     }
+    hash = (hash ^ (uint8_t) (endpoint->port & 0xFF)) * 16777619u;
+    hash = (hash ^ (uint8_t) (endpoint->port >> 8)) * 16777619u;
+    return hash;
+}
 
-    uint32_t len = u_arraylist_length(g_keepAliveConnectionTable);
+/**
+ * Double the bucket count of the KeepAlive table.
+ * @return  true on success, false if the table could not be grown.
+ */
+static bool GrowKeepAliveTable()
+{
+    size_t size = g_keepAliveTableSize * 2;
+    KeepAliveEntry_t **table = (KeepAliveEntry_t **) OICCalloc(size, sizeof(KeepAliveEntry_t *));
+    if (!table)
+    {
+        return false;
+    }
 
-    for (uint32_t i = 0; i < len; i++)
+    for (size_t i = 0; i < g_keepAliveTableSize; i++)
     {
-        KeepAliveEntry_t *entry = u_arraylist_get(g_keepAliveConnectionTable, i);
-        if (NULL == entry)
+        KeepAliveEntry_t *entry = g_keepAliveConnectionTable[i];
+        while (entry)
         {
-            continue;
+            KeepAliveEntry_t *next = entry->hashNext;
+            size_t bucket = HashEndpoint(&entry->remoteAddr) & (size - 1);
+            entry->hashNext = table[bucket];
+            table[bucket] = entry;
+            entry = next;
         }
+    }
+
+    OICFree(g_keepAliveConnectionTable);
+    g_keepAliveConnectionTable = table;
+    g_keepAliveTableSize = size;
+    return true;
+}
 
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint)
+{
+    if (!g_keepAliveConnectionTable)
+    {
+        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
+        return NULL;
+    }
+
+    size_t bucket = HashEndpoint(endpoint) & (g_keepAliveTableSize - 1);
+    for (KeepAliveEntry_t *entry = g_keepAliveConnectionTable[bucket]; entry;
+         entry = entry->hashNext)
+    {
         if (!strncmp(entry->remoteAddr.addr, endpoint->addr, sizeof(entry->remoteAddr.addr))
                 && (entry->remoteAddr.port == endpoint->port))
         {
             OIC_LOG(DEBUG, TAG, "Connection Info found in KeepAlive table");
-            *index = i;
             return entry;
         }
     }
@@ -646,6 +813,12 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
         return NULL;
     }
 
+    if (g_keepAliveEntryCount >= g_keepAliveTableSize && !GrowKeepAliveTable())
+    {
+        OIC_LOG(ERROR, TAG, "Growing KeepAlive Table failed");
+        return NULL;
+    }
+
     KeepAliveEntry_t *entry = (KeepAliveEntry_t *) OICCalloc(1, sizeof(KeepAliveEntry_t));
     if (NULL == entry)
     {
@@ -666,6 +839,12 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     if (!entry->intervalInfo)
     {
         entry->intervalInfo = (int64_t*) OICMalloc(entry->intervalSize * sizeof(int64_t));
+        if (!entry->intervalInfo)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to allocate interval values");
+            OICFree(entry);
+            return NULL;
+        }
         for (size_t i = 0; i < entry->intervalSize; i++)
         {
             entry->intervalInfo[i] = KEEPALIVE_MIN_INTERVAL << i;
@@ -673,14 +852,12 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     }
     entry->interval = entry->intervalInfo[0];
 
-    bool result = u_arraylist_add(g_keepAliveConnectionTable, (void *)entry);
-    if (!result)
-    {
-        OIC_LOG(ERROR, TAG, "Adding node to head failed");
-        OICFree(entry->intervalInfo);
-        OICFree(entry);
-        return NULL;
-    }
+    size_t bucket = HashEndpoint(&entry->remoteAddr) & (g_keepAliveTableSize - 1);
+    entry->hashNext = g_keepAliveConnectionTable[bucket];
+    g_keepAliveConnectionTable[bucket] = entry;
+    g_keepAliveEntryCount++;
+
+    ScheduleKeepAliveEntry(entry, GetKeepAliveDeadline(entry));
 
     return entry;
 }
@@ -689,31 +866,52 @@ OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL(endpoint, FATAL, OC_STACK_INVALID_PARAM);
 
-    uint32_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endpoint, &index);
-    if (!entry)
+    if (!g_keepAliveConnectionTable)
     {
-        OIC_LOG(ERROR, TAG, "There is no entry in keepalive table.");
+        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
         return OC_STACK_ERROR;
     }
 
-    KeepAliveEntry_t *removedEntry = u_arraylist_remove(g_keepAliveConnectionTable, index);
-    if (NULL == removedEntry)
+    size_t bucket = HashEndpoint(endpoint) & (g_keepAliveTableSize - 1);
+    KeepAliveEntry_t **link = &g_keepAliveConnectionTable[bucket];
+    while (*link && (strncmp((*link)->remoteAddr.addr, endpoint->addr,
+                             sizeof((*link)->remoteAddr.addr))
+                     || (*link)->remoteAddr.port != endpoint->port))
+    {
+        link = &(*link)->hashNext;
+    }
+
+    KeepAliveEntry_t *removedEntry = *link;
+    if (!removedEntry)
     {
-        OIC_LOG(ERROR, TAG, "Removed Entry is NULL");
+        OIC_LOG(ERROR, TAG, "There is no entry in keepalive table.");
         return OC_STACK_ERROR;
     }
 
+    *link = removedEntry->hashNext;
+    g_keepAliveEntryCount--;
+    UnscheduleKeepAliveEntry(removedEntry);
+
     OIC_LOG_V(DEBUG, TAG, "Remove Connection Info from KeepAlive table, "
              "remote addr=%s port:%d", removedEntry->remoteAddr.addr,
              removedEntry->remoteAddr.port);
 
-    OICFree(entry->intervalInfo);
+    OICFree(removedEntry->intervalInfo);
     OICFree(removedEntry);
 
     return OC_STACK_OK;
 }
 
+size_t GetNumKeepAliveEntries()
+{
+    return g_keepAliveEntryCount;
+}
+
+uint64_t GetKeepAliveEntryDeadline(const KeepAliveEntry_t *entry)
+{
+    return entry->deadline;
+}
+
 void HandleKeepAliveConnCB(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL_NR(endpoint, FATAL);
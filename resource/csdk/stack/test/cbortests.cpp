@@ -26,6 +26,7 @@ extern "C"
     #include "ocpayloadcbor.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "ocstackconfig.h"
 }
 
 #include "gtest/gtest.h"
@@ -220,3 +221,319 @@ TEST_F(CborByteStringTest, ByteStringArrayConvertParseTest )
 
     OCPayloadDestroy((OCPayload*)payload_out);
 }
+
+TEST_F(CborByteStringTest, ConvertLargePayloadToReusedBuffer)
+{
+    OCRepPayloadSetUri(payload_in, "/a/energy_meter");
+
+    char name[16];
+    for (int i = 0; i < 150; i++)
+    {
+        snprintf(name, sizeof(name), "attribute%d", i);
+        EXPECT_EQ(true, OCRepPayloadSetPropString(payload_in, name, "a moderately long value"));
+    }
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+
+    // Encode twice into the same buffer, the second call must not need to grow it.
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
+    size_t encodedSize = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload*) payload_in, &buffer,
+                &bufferSize, &encodedSize));
+    uint8_t *firstBuffer = buffer;
+    size_t firstBufferSize = bufferSize;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload*) payload_in, &buffer,
+                &bufferSize, &encodedSize));
+    EXPECT_EQ(firstBuffer, buffer);
+    EXPECT_EQ(firstBufferSize, bufferSize);
+
+    ASSERT_EQ(payload_cbor_size, encodedSize);
+    EXPECT_EQ(0, memcmp(payload_cbor, buffer, encodedSize));
+
+    OCPayload* payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+                buffer, encodedSize));
+
+    char *value = NULL;
+    EXPECT_EQ(true, OCRepPayloadGetPropString((OCRepPayload*)payload_out, "attribute149", &value));
+    EXPECT_STREQ("a moderately long value", value);
+
+    // Cleanup
+    OICFree(value);
+    OICFree(buffer);
+    OICFree(payload_cbor);
+    OCPayloadDestroy(payload_out);
+}
+
+TEST_F(CborByteStringTest, ConvertPayloadSizeLimit)
+{
+    // Just below the limit once the map and key are added
+    const size_t valueSize = MAX_PAYLOAD_ENCODE_SIZE - 64;
+    uint8_t *value = (uint8_t *)OICCalloc(1, valueSize);
+    ASSERT_TRUE(value != NULL);
+    OCByteString byteString = { value, valueSize };
+    EXPECT_EQ(true, OCRepPayloadSetPropByteString(payload_in, "data", byteString));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+    EXPECT_LE(payload_cbor_size, (size_t) MAX_PAYLOAD_ENCODE_SIZE);
+    OICFree(payload_cbor);
+    payload_cbor = NULL;
+
+    // The buffer never grows past the limit
+    EXPECT_EQ(true, OCRepPayloadSetPropByteString(payload_in, "more", byteString));
+    EXPECT_EQ(OC_STACK_NO_MEMORY, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                &payload_cbor_size));
+
+    // Cleanup
+    OICFree(payload_cbor);
+    OICFree(value);
+}
+
+TEST_F(CborByteStringTest, ArenaParseMatchesDefaultParse)
+{
+    OCRepPayloadSetUri(payload_in, "/a/light");
+    OCRepPayloadAddResourceType(payload_in, "core.light");
+    EXPECT_EQ(true, OCRepPayloadSetPropInt(payload_in, "power", 42));
+    EXPECT_EQ(true, OCRepPayloadSetPropString(payload_in, "name", "kitchen"));
+
+    OCRepPayload *child = OCRepPayloadCreate();
+    EXPECT_EQ(true, OCRepPayloadSetPropBool(child, "on", true));
+    EXPECT_EQ(true, OCRepPayloadSetPropObjectAsOwner(payload_in, "state", child));
+
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {3, 0, 0};
+    const char *strArray[] = {"red", "green", "blue"};
+    EXPECT_EQ(true, OCRepPayloadSetStringArray(payload_in, "colors", strArray, dimensions));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+
+    OCPayload* payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayloadWithMode(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+                payload_cbor, payload_cbor_size, OC_PAYLOAD_PARSE_ARENA));
+    OCRepPayload *rep = (OCRepPayload*)payload_out;
+    ASSERT_TRUE(rep != NULL);
+    EXPECT_TRUE(rep->arena != NULL);
+    EXPECT_STREQ("/a/light", rep->uri);
+    ASSERT_TRUE(rep->types != NULL);
+    EXPECT_STREQ("core.light", rep->types->value);
+
+    int64_t power = 0;
+    EXPECT_EQ(true, OCRepPayloadGetPropInt(rep, "power", &power));
+    EXPECT_EQ(42, power);
+
+    char *name = NULL;
+    EXPECT_EQ(true, OCRepPayloadGetPropString(rep, "name", &name));
+    EXPECT_STREQ("kitchen", name);
+
+    // Objects taken out of an arena payload are copies the caller owns
+    OCRepPayload *state = NULL;
+    bool on = false;
+    EXPECT_EQ(true, OCRepPayloadGetPropObject(rep, "state", &state));
+    EXPECT_EQ(true, OCRepPayloadGetPropBool(state, "on", &on));
+    EXPECT_TRUE(on);
+
+    char **colors = NULL;
+    size_t colorDimensions[MAX_REP_ARRAY_DEPTH] = {0};
+    EXPECT_EQ(true, OCRepPayloadGetStringArray(rep, "colors", &colors, colorDimensions));
+    EXPECT_EQ(3u, colorDimensions[0]);
+    EXPECT_STREQ("blue", colors[2]);
+
+    // Re-encoding the arena payload gives the original encoding
+    uint8_t *reencoded = NULL;
+    size_t reencoded_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload(payload_out, &reencoded, &reencoded_size));
+    ASSERT_EQ(payload_cbor_size, reencoded_size);
+    EXPECT_EQ(0, memcmp(payload_cbor, reencoded, reencoded_size));
+
+    // Cleanup
+    for (size_t i = 0; i < colorDimensions[0]; i++)
+    {
+        OICFree(colors[i]);
+    }
+    OICFree(colors);
+    OCRepPayloadDestroy(state);
+    OICFree(name);
+    OICFree(reencoded);
+    OICFree(payload_cbor);
+    OCPayloadDestroy(payload_out);
+}
+
+TEST_F(CborByteStringTest, ArenaPayloadRejectsChanges)
+{
+    OCRepPayloadSetUri(payload_in, "/a/light");
+    EXPECT_EQ(true, OCRepPayloadSetPropInt(payload_in, "power", 42));
+    OCRepPayload *child = OCRepPayloadCreate();
+    EXPECT_EQ(true, OCRepPayloadSetPropBool(child, "on", true));
+    EXPECT_EQ(true, OCRepPayloadSetPropObjectAsOwner(payload_in, "state", child));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+
+    OCPayload* payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayloadWithMode(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+                payload_cbor, payload_cbor_size, OC_PAYLOAD_PARSE_ARENA));
+    OCRepPayload *rep = (OCRepPayload*)payload_out;
+    ASSERT_TRUE(rep != NULL);
+
+    // Neither existing nor new values of an arena payload can be set
+    EXPECT_EQ(false, OCRepPayloadSetPropInt(rep, "power", 7));
+    EXPECT_EQ(false, OCRepPayloadSetPropString(rep, "name", "hall"));
+    EXPECT_EQ(false, OCRepPayloadSetNull(rep, "power"));
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {2, 0, 0};
+    int64_t intArray[] = {1, 2};
+    EXPECT_EQ(false, OCRepPayloadSetIntArray(rep, "levels", intArray, dimensions));
+    EXPECT_EQ(false, OCRepPayloadSetUri(rep, "/a/other"));
+    EXPECT_EQ(false, OCRepPayloadAddResourceType(rep, "core.light"));
+    EXPECT_EQ(false, OCRepPayloadAddInterface(rep, "oic.if.baseline"));
+
+    // Nested objects belong to the arena as well
+    OCRepPayload *state = NULL;
+    for (OCRepPayloadValue *val = rep->values; val; val = val->next)
+    {
+        if (0 == strcmp("state", val->name))
+        {
+            state = val->obj;
+        }
+    }
+    ASSERT_TRUE(state != NULL);
+    EXPECT_EQ(false, OCRepPayloadSetPropBool(state, "on", false));
+
+    int64_t power = 0;
+    EXPECT_EQ(true, OCRepPayloadGetPropInt(rep, "power", &power));
+    EXPECT_EQ(42, power);
+    EXPECT_STREQ("/a/light", rep->uri);
+
+    // A clone can be changed
+    OCRepPayload *clone = OCRepPayloadClone(rep);
+    ASSERT_TRUE(clone != NULL);
+    EXPECT_TRUE(clone->arena == NULL);
+    EXPECT_EQ(true, OCRepPayloadSetPropInt(clone, "power", 7));
+    EXPECT_EQ(true, OCRepPayloadGetPropInt(clone, "power", &power));
+    EXPECT_EQ(7, power);
+
+    // Cleanup
+    OCRepPayloadDestroy(clone);
+    OICFree(payload_cbor);
+    OCPayloadDestroy(payload_out);
+}
+
+TEST_F(CborByteStringTest, LargePayloadKeepsInsertionOrder)
+{
+    char name[16];
+    for (int i = 0; i < 150; i++)
+    {
+        snprintf(name, sizeof(name), "attribute%d", i);
+        EXPECT_EQ(true, OCRepPayloadSetPropInt(payload_in, name, i));
+    }
+
+    // Overwriting a property must not move it
+    EXPECT_EQ(true, OCRepPayloadSetPropString(payload_in, "attribute7", "seven"));
+
+    OCRepPayload *clone = OCRepPayloadClone(payload_in);
+    ASSERT_TRUE(clone != NULL);
+
+    for (int i = 0; i < 150; i++)
+    {
+        if (i == 7)
+        {
+            continue;
+        }
+        int64_t value = -1;
+        snprintf(name, sizeof(name), "attribute%d", i);
+        EXPECT_EQ(true, OCRepPayloadGetPropInt(payload_in, name, &value));
+        EXPECT_EQ(i, value);
+        EXPECT_EQ(true, OCRepPayloadGetPropInt(clone, name, &value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(false, OCRepPayloadIsNull(payload_in, "missing"));
+
+    int i = 0;
+    for (OCRepPayloadValue *val = payload_in->values; val; val = val->next, i++)
+    {
+        snprintf(name, sizeof(name), "attribute%d", i);
+        EXPECT_STREQ(name, val->name);
+    }
+    EXPECT_EQ(150, i);
+
+    char *value = NULL;
+    EXPECT_EQ(true, OCRepPayloadGetPropString(clone, "attribute7", &value));
+    EXPECT_STREQ("seven", value);
+
+    // Cleanup
+    OICFree(value);
+    OCRepPayloadDestroy(clone);
+}
+
+TEST_F(CborByteStringTest, ConvertPayloadToFixedBuffer)
+{
+    EXPECT_EQ(true, OCRepPayloadSetPropInt(payload_in, "power", 42));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+
+    uint8_t buffer[512];
+    size_t size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToFixedBuffer((OCPayload*) payload_in, buffer,
+                sizeof(buffer), &size));
+    ASSERT_EQ(payload_cbor_size, size);
+    EXPECT_EQ(0, memcmp(payload_cbor, buffer, size));
+
+    // Payloads that may not fit are left to OCConvertPayload
+    char name[16];
+    for (int i = 0; i < 150; i++)
+    {
+        snprintf(name, sizeof(name), "attribute%d", i);
+        EXPECT_EQ(true, OCRepPayloadSetPropString(payload_in, name, "a moderately long value"));
+    }
+    EXPECT_EQ(OC_STACK_NO_MEMORY, OCConvertPayloadToFixedBuffer((OCPayload*) payload_in, buffer,
+                sizeof(buffer), &size));
+
+    // Cleanup
+    OICFree(payload_cbor);
+}
+
+TEST_F(CborByteStringTest, EncodedParseKeepsCbor)
+{
+    EXPECT_EQ(true, OCRepPayloadSetPropInt(payload_in, "power", 42));
+    EXPECT_EQ(true, OCRepPayloadSetPropString(payload_in, "name", "light"));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+
+    OCPayload *encoded = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayloadWithMode(&encoded, PAYLOAD_TYPE_REPRESENTATION,
+                payload_cbor, payload_cbor_size, OC_PAYLOAD_PARSE_ENCODED));
+    ASSERT_TRUE(encoded != NULL);
+    ASSERT_EQ(PAYLOAD_TYPE_ENCODED, encoded->type);
+
+    // Sent as received
+    uint8_t *reencoded = NULL;
+    size_t reencoded_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload(encoded, &reencoded, &reencoded_size));
+    ASSERT_EQ(payload_cbor_size, reencoded_size);
+    EXPECT_EQ(0, memcmp(payload_cbor, reencoded, reencoded_size));
+
+    // Parsed on demand
+    OCRepPayload *decoded = NULL;
+    OCRepPayload *rep = OCPayloadGetRepresentation(encoded, &decoded);
+    ASSERT_TRUE(rep != NULL);
+    EXPECT_EQ(decoded, rep);
+    int64_t power = 0;
+    EXPECT_EQ(true, OCRepPayloadGetPropInt(rep, "power", &power));
+    EXPECT_EQ(42, power);
+
+    // Cleanup
+    OCRepPayloadDestroy(decoded);
+    OCPayloadDestroy(encoded);
+    OICFree(reencoded);
+    OICFree(payload_cbor);
+}
@@ -23,8 +23,22 @@ extern "C"
 {
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocserverrequest.h"
+    #include "ocresourcehandler.h"
+    #include "oicgroup.h"
+    #include "ocobserve.h"
+    #include "ocpayload.h"
+    #include "ocpayloadcbor.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "oic_string.h"
+    #include "oic_metrics.h"
+    #include "oic_trace.h"
+    #include "cacommon.h"
+#ifdef TCP_ADAPTER
+    #include "oickeepalive.h"
+    #include "oic_time.h"
+#endif
 }
 
 #include "gtest/gtest.h"
@@ -43,6 +57,9 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include "gtest_helper.h"
 
@@ -335,6 +352,304 @@ TEST(StackDiscovery, DISABLED_DoResourceDeviceDiscovery)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackDiscovery, DoResourceResponseParseModePerRequest)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DoResourceResponseParseModePerRequest test");
+    InitStack(OC_CLIENT);
+
+    OCCallbackData cbData;
+    cbData.cb = asyncDoResourcesCallback;
+    cbData.context = (void*)DEFAULT_CONTEXT_VALUE;
+    cbData.cd = NULL;
+    char szQueryUri[64] = { 0 };
+    strcpy(szQueryUri, OC_RSRVD_WELL_KNOWN_URI);
+
+    // Encoded payloads cannot be selected for every callback of the process
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetResponsePayloadParseMode(OC_PAYLOAD_PARSE_ENCODED));
+    EXPECT_EQ(OC_STACK_OK, OCSetResponsePayloadParseMode(OC_PAYLOAD_PARSE_ARENA));
+
+    OCDoHandle plainHandle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(&plainHandle, OC_REST_GET, szQueryUri, 0, 0,
+                                        CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0));
+    OCDoHandle encodedHandle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoResourceWithParseMode(&encodedHandle, OC_REST_GET, szQueryUri,
+                                                     0, 0, CT_ADAPTER_IP, OC_LOW_QOS, &cbData,
+                                                     NULL, 0, OC_PAYLOAD_PARSE_ENCODED));
+
+    ClientCB *plainCB = GetClientCB(NULL, 0, plainHandle, NULL);
+    ClientCB *encodedCB = GetClientCB(NULL, 0, encodedHandle, NULL);
+    ASSERT_TRUE(NULL != plainCB);
+    ASSERT_TRUE(NULL != encodedCB);
+    EXPECT_EQ(OC_PAYLOAD_PARSE_ARENA, plainCB->parseMode);
+    EXPECT_EQ(OC_PAYLOAD_PARSE_ENCODED, encodedCB->parseMode);
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM,
+              OCDoResourceWithParseMode(NULL, OC_REST_GET, szQueryUri, 0, 0, CT_ADAPTER_IP,
+                                        OC_LOW_QOS, &cbData, NULL, 0,
+                                        (OCPayloadParseMode)42));
+
+    EXPECT_EQ(OC_STACK_OK, OCSetResponsePayloadParseMode(OC_PAYLOAD_PARSE_DEFAULT));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static int g_numDeletedContexts = 0;
+
+extern "C" void countDeletedContext(void* /*context*/)
+{
+    g_numDeletedContexts++;
+}
+
+TEST(StackDiscovery, DoResourcesInvalidRequests)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DoResourcesInvalidRequests test");
+    InitStack(OC_CLIENT);
+
+    OCDoResourceRequest requests[3];
+    memset(requests, 0, sizeof(requests));
+    for (int i = 0; i < 3; i++)
+    {
+        requests[i].method = OC_REST_GET;
+        requests[i].requestUri = OC_RSRVD_WELL_KNOWN_URI;
+        requests[i].connectivityType = CT_ADAPTER_IP;
+        requests[i].qos = OC_LOW_QOS;
+        requests[i].cbData.cb = asyncDoResourcesCallback;
+        requests[i].cbData.cd = countDeletedContext;
+        requests[i].handle = (OCDoHandle)&requests[i];
+    }
+    requests[0].cbData.cb = NULL;
+    requests[1].requestUri = NULL;
+    requests[2].method = OC_REST_NOMETHOD;
+
+    // Every request fails, their contexts are deleted and no handle is given out
+    g_numDeletedContexts = 0;
+    EXPECT_EQ(OC_STACK_INVALID_CALLBACK, OCDoResources(requests, 3));
+    EXPECT_EQ(OC_STACK_INVALID_CALLBACK, requests[0].result);
+    EXPECT_EQ(OC_STACK_INVALID_URI, requests[1].result);
+    EXPECT_EQ(OC_STACK_INVALID_METHOD, requests[2].result);
+    EXPECT_EQ(3, g_numDeletedContexts);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(NULL == requests[i].handle);
+    }
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoResources(NULL, 1));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Secured builds deny the anonymous requests of these tests without an ACL
+#ifndef __WITH_DTLS__
+static std::atomic<int> loopbackRequests(0);
+static std::atomic<int> loopbackResponses(0);
+
+static OCEntityHandlerResult loopbackEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void * /*callbackParam*/)
+{
+    loopbackRequests++;
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "power", 7);
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+    return OC_EH_OK;
+}
+
+extern "C" OCStackApplicationResult loopbackResponseCallback(void* /*ctx*/,
+        OCDoHandle /*handle*/, OCClientResponse * clientResponse)
+{
+    EXPECT_EQ(OC_STACK_OK, clientResponse->result);
+    int64_t power = 0;
+    EXPECT_TRUE(clientResponse->payload &&
+                OCRepPayloadGetPropInt((OCRepPayload *)clientResponse->payload, "power",
+                                       &power));
+    EXPECT_EQ(7, power);
+    loopbackResponses++;
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static void SetLoopbackDestination(OCDevAddr *destination)
+{
+    memset(destination, 0, sizeof(*destination));
+    destination->adapter = OC_ADAPTER_IP;
+    if (caglobals.ip.ipv4enabled)
+    {
+        destination->flags = OC_IP_USE_V4;
+        strcpy(destination->addr, "127.0.0.1");
+        destination->port = caglobals.ip.u4.port;
+    }
+    else
+    {
+        destination->flags = OC_IP_USE_V6;
+        strcpy(destination->addr, "::1");
+        destination->port = caglobals.ip.u6.port;
+    }
+}
+
+TEST(StackDiscovery, DoResourcesLoopback)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DoResourcesLoopback test");
+    InitStack(OC_CLIENT_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/loop",
+                                            loopbackEntityHandler, NULL, OC_DISCOVERABLE));
+
+    // Requests go to the unicast socket of this process
+    OCDevAddr destination;
+    SetLoopbackDestination(&destination);
+    ASSERT_NE(0, destination.port);
+
+    const int numRequests = 3;
+    OCDoResourceRequest requests[numRequests];
+    memset(requests, 0, sizeof(requests));
+    for (int i = 0; i < numRequests; i++)
+    {
+        requests[i].method = OC_REST_GET;
+        requests[i].requestUri = "/a/loop";
+        requests[i].destination = &destination;
+        requests[i].connectivityType = CT_DEFAULT;
+        requests[i].qos = OC_LOW_QOS;
+        requests[i].cbData.cb = loopbackResponseCallback;
+    }
+
+    loopbackRequests = 0;
+    loopbackResponses = 0;
+    EXPECT_EQ(OC_STACK_OK, OCDoResources(requests, numRequests));
+    for (int i = 0; i < numRequests; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, requests[i].result);
+        EXPECT_TRUE(NULL != requests[i].handle);
+    }
+
+    for (int i = 0; i < 300 && loopbackResponses < numRequests; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(numRequests, loopbackRequests);
+    EXPECT_EQ(numRequests, loopbackResponses);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static OCEntityHandlerResult slowEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest * /*entityHandlerRequest*/, void * /*callbackParam*/)
+{
+    // Never answers, the request is released when the stack stops
+    return OC_EH_SLOW;
+}
+
+static OCActionSet *CreateLoopbackActionSet(const char *uri, int numActions)
+{
+    OCActionSet *actionset = (OCActionSet *) OICCalloc(1, sizeof(OCActionSet));
+    if (!actionset)
+    {
+        return NULL;
+    }
+    actionset->actionsetName = OICStrdup("loopback");
+    for (int i = 0; i < numActions; i++)
+    {
+        OCAction *action = (OCAction *) OICCalloc(1, sizeof(OCAction));
+        OCCapability *capability = (OCCapability *) OICCalloc(1, sizeof(OCCapability));
+        if (!action || !capability)
+        {
+            OICFree(action);
+            OICFree(capability);
+            break;
+        }
+        action->resourceUri = OICStrdup(uri);
+        capability->capability = OICStrdup("power");
+        capability->status = OICStrdup("on");
+        action->head = capability;
+        action->next = actionset->head;
+        actionset->head = action;
+    }
+    return actionset;
+}
+
+TEST(StackGroup, ActionSetFanOutReleasedOnResponses)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ActionSetFanOutReleasedOnResponses test");
+    InitStack(OC_CLIENT_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/action",
+                                            loopbackEntityHandler, NULL, OC_DISCOVERABLE));
+
+    // The triggering request is not known to the stack, so no aggregate response is sent
+    OCServerRequest request;
+    memset(&request, 0, sizeof(request));
+    SetLoopbackDestination(&request.devAddr);
+    ASSERT_NE(0, request.devAddr.port);
+
+    const int numActions = 3;
+    OCActionSet *actionset = CreateLoopbackActionSet("/a/action", numActions);
+    ASSERT_TRUE(NULL != actionset);
+
+    // The client callbacks of the member requests keep the fan-out alive
+    loopbackRequests = 0;
+    EXPECT_EQ(OC_STACK_OK, DoAction(NULL, actionset, &request));
+    EXPECT_EQ(1u, GetNumActionSetFanOuts());
+
+    // The last response completes the fan-out and its callback drops the last reference
+    for (int i = 0; i < 300 && GetNumActionSetFanOuts() > 0; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(numActions, loopbackRequests);
+    EXPECT_EQ(0u, GetNumActionSetFanOuts());
+
+    DeleteActionSet(&actionset);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackGroup, ActionSetFanOutTimeout)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ActionSetFanOutTimeout test");
+    InitStack(OC_CLIENT_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/slow",
+                                            slowEntityHandler, NULL, OC_DISCOVERABLE));
+
+    OCServerRequest request;
+    memset(&request, 0, sizeof(request));
+    SetLoopbackDestination(&request.devAddr);
+    ASSERT_NE(0, request.devAddr.port);
+
+    OCActionSet *actionset = CreateLoopbackActionSet("/a/slow", 2);
+    ASSERT_TRUE(NULL != actionset);
+
+    // Due as soon as it is sent
+    SetActionSetResponseTimeout(0);
+    EXPECT_EQ(OC_STACK_OK, DoAction(NULL, actionset, &request));
+    EXPECT_EQ(1u, GetNumActionSetFanOuts());
+
+    // The members are reported as timed out, their callbacks still refer to the fan-out
+    ProcessActionSetTimeouts();
+    EXPECT_EQ(1u, GetNumActionSetFanOuts());
+    ProcessActionSetTimeouts();
+    EXPECT_EQ(1u, GetNumActionSetFanOuts());
+
+    // Deleting the callbacks releases it
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(0u, GetNumActionSetFanOuts());
+
+    SetActionSetResponseTimeout(ACTIONSET_RESPONSE_TIMEOUT_SECONDS);
+    DeleteActionSet(&actionset);
+}
+#endif // __WITH_DTLS__
+
 TEST(StackStop, StackStopWithoutInit)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -963,6 +1278,91 @@ TEST(StackResource, StackTestResourceDiscoverManyResources)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+static OCStackResult HandleDiscoveryRequest(char tokenByte, const char *query)
+{
+    char token[CA_MAX_TOKEN_LEN] = { tokenByte };
+    char queryBuf[MAX_QUERY_LENGTH] = { 0 };
+    strncpy(queryBuf, query, sizeof(queryBuf) - 1);
+
+    OCServerProtocolRequest request;
+    memset(&request, 0, sizeof(request));
+    request.method = OC_REST_GET;
+    request.acceptFormat = OC_FORMAT_CBOR;
+    request.resourceUrl = (char *)OC_RSRVD_WELL_KNOWN_URI;
+    request.query = queryBuf;
+    request.qos = OC_LOW_QOS;
+    request.requestToken = token;
+    request.tokenLength = sizeof(token);
+    request.devAddr.adapter = OC_ADAPTER_IP;
+    strcpy(request.devAddr.addr, "127.0.0.1");
+    request.devAddr.port = 5683;
+
+    OCStackLock();
+    OCStackResult result = HandleStackRequests(&request);
+    OCStackUnlock();
+    return result;
+}
+
+TEST(StackResource, DiscoveryCacheHitAndMiss)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryCacheHitAndMiss test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(0u, GetDiscoveryCacheSize());
+
+    // The first request encodes and caches the response, the same filter is served from it
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x10, ""));
+    EXPECT_EQ(1u, GetDiscoveryCacheSize());
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x11, ""));
+    EXPECT_EQ(1u, GetDiscoveryCacheSize());
+
+    // Each combination of filters gets its own entry
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x12, "rt=core.led"));
+    EXPECT_EQ(2u, GetDiscoveryCacheSize());
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x13, "rt=core.led"));
+    EXPECT_EQ(2u, GetDiscoveryCacheSize());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, DiscoveryCacheInvalidation)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryCacheInvalidation test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.led", "core.rw", "/a/led1",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x20, ""));
+    EXPECT_EQ(1u, GetDiscoveryCacheSize());
+
+    // New resources must show up in the next response
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2, "core.led", "core.rw", "/a/led2",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(0u, GetDiscoveryCacheSize());
+
+    // So must the sid, e.g. once the doxm is owned
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x21, ""));
+    EXPECT_EQ(1u, GetDiscoveryCacheSize());
+    OCServerInstanceIDChanged();
+    EXPECT_EQ(0u, GetDiscoveryCacheSize());
+    EXPECT_TRUE(NULL != OCGetServerInstanceID());
+    EXPECT_TRUE(NULL != OCGetServerInstanceIDString());
+
+    EXPECT_EQ(OC_STACK_OK, HandleDiscoveryRequest(0x22, ""));
+    EXPECT_EQ(1u, GetDiscoveryCacheSize());
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle1));
+    EXPECT_EQ(0u, GetDiscoveryCacheSize());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackBind, BindResourceTypeNameBad)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -1301,6 +1701,859 @@ TEST(StackBind, BindContainedResourceGood)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackBind, CollectionBatchWorkers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CollectionBatchWorkers test");
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchWorkers(4));
+    InitStack(OC_SERVER);
+
+    // Replacing and disabling the workers is allowed while no batch request is outstanding
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchWorkers(2));
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchWorkers(0));
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchWorkers(2));
+
+    // OCStop stops the workers
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static std::atomic<int> batchChildCalls(0);
+static std::atomic<int> batchChildrenOnTestThread(0);
+static std::thread::id batchTestThread;
+
+static OCEntityHandlerResult batchChildEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void * /*callbackParam*/)
+{
+    // The first children wait for each other, which only ends if they run concurrently
+    int arrival = ++batchChildCalls;
+    for (int i = 0; i < 200 && batchChildCalls < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_LE(2, batchChildCalls) << "child " << arrival << " ran alone";
+    if (std::this_thread::get_id() == batchTestThread)
+    {
+        batchChildrenOnTestThread++;
+    }
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload,
+                       OCGetResourceUri((OCResourceHandle)entityHandlerRequest->resource));
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+    return OC_EH_OK;
+}
+
+TEST(StackBind, CollectionBatchRequestOnWorkers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CollectionBatchRequestOnWorkers test");
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchWorkers(2));
+    InitStack(OC_SERVER);
+
+    OCResourceHandle collectionHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&collectionHandle, "core.coll", "core.rw",
+                                            "/coll", NULL, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(collectionHandle,
+                                                             OC_RSRVD_INTERFACE_BATCH));
+    const int numChildren = 4;
+    for (int i = 0; i < numChildren; i++)
+    {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/coll/child%d", i);
+        OCResourceHandle childHandle;
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&childHandle, "core.led", "core.rw", uri,
+                                                batchChildEntityHandler, NULL,
+                                                OC_DISCOVERABLE));
+        EXPECT_EQ(OC_STACK_OK, OCBindResource(collectionHandle, childHandle));
+    }
+
+    char token[CA_MAX_TOKEN_LEN] = { 0x42 };
+    char query[] = "if=" OC_RSRVD_INTERFACE_BATCH;
+    OCServerProtocolRequest request;
+    memset(&request, 0, sizeof(request));
+    request.method = OC_REST_GET;
+    request.acceptFormat = OC_FORMAT_CBOR;
+    request.resourceUrl = (char *)"/coll";
+    request.query = query;
+    request.qos = OC_LOW_QOS;
+    request.requestToken = token;
+    request.tokenLength = sizeof(token);
+    request.devAddr.adapter = OC_ADAPTER_IP;
+    strcpy(request.devAddr.addr, "127.0.0.1");
+    request.devAddr.port = 5683;
+
+    // The children are queued on the workers and the request answered as a slow response
+    batchChildCalls = 0;
+    batchChildrenOnTestThread = 0;
+    batchTestThread = std::this_thread::get_id();
+    OCStackLock();
+    EXPECT_EQ(OC_STACK_SLOW_RESOURCE, HandleStackRequests(&request));
+    OCStackUnlock();
+
+    // Stopping the workers runs the queued children first
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchWorkers(0));
+    EXPECT_EQ(numChildren, batchChildCalls);
+    EXPECT_EQ(0, batchChildrenOnTestThread);
+    // The last child response sent the aggregate response and deleted the request
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken(token, sizeof(token)));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static OCActionSet *CreateTestActionSet(const char *name)
+{
+    OCActionSet *actionset = (OCActionSet *) OICCalloc(1, sizeof(OCActionSet));
+    if (actionset)
+    {
+        actionset->actionsetName = OICStrdup(name);
+    }
+    return actionset;
+}
+
+TEST(StackGroup, ScheduleDeadlineOrder)
+{
+    // Schedules far in the future never fire while the test runs
+    const long int delays[] = { 500, 100, 400, 200, 300 };
+    const size_t numSets = sizeof(delays) / sizeof(delays[0]);
+    OCActionSet *sets[numSets];
+    for (size_t i = 0; i < numSets; i++)
+    {
+        sets[i] = CreateTestActionSet("schedule");
+        ASSERT_TRUE(NULL != sets[i]);
+        EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, sets[i], NULL, delays[i]));
+    }
+    EXPECT_EQ(numSets, GetNumScheduledResources());
+
+    // Removing the root each time yields the schedules by increasing deadline
+    const size_t byDeadline[] = { 1, 3, 4, 2, 0 };
+    for (size_t i = 0; i < numSets; i++)
+    {
+        EXPECT_EQ(sets[byDeadline[i]], GetNextScheduledActionSet());
+        EXPECT_EQ(OC_STACK_OK, CancelScheduledResource(sets[byDeadline[i]]));
+        EXPECT_EQ(numSets - i - 1, GetNumScheduledResources());
+    }
+    EXPECT_TRUE(NULL == GetNextScheduledActionSet());
+
+    for (size_t i = 0; i < numSets; i++)
+    {
+        DeleteActionSet(&sets[i]);
+    }
+    TerminateScheduledGroupActions();
+}
+
+TEST(StackGroup, CancelSchedule)
+{
+    OCActionSet *early = CreateTestActionSet("early");
+    OCActionSet *late = CreateTestActionSet("late");
+    ASSERT_TRUE(NULL != early && NULL != late);
+
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, late, NULL, 300));
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, early, NULL, 100));
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, early, NULL, 200));
+    EXPECT_EQ(early, GetNextScheduledActionSet());
+
+    // A cancellation removes a single schedule of the action set
+    EXPECT_EQ(OC_STACK_OK, CancelScheduledResource(early));
+    EXPECT_EQ(2u, GetNumScheduledResources());
+    EXPECT_EQ(OC_STACK_OK, CancelScheduledResource(early));
+    EXPECT_EQ(1u, GetNumScheduledResources());
+    EXPECT_EQ(late, GetNextScheduledActionSet());
+
+    // Nothing left to cancel
+    EXPECT_EQ(OC_STACK_ERROR, CancelScheduledResource(early));
+    EXPECT_TRUE(NULL == early->schedule);
+
+    DeleteActionSet(&early);
+    DeleteActionSet(&late);
+    TerminateScheduledGroupActions();
+}
+
+TEST(StackGroup, CancelAllSchedules)
+{
+    OCActionSet *kept = CreateTestActionSet("kept");
+    OCActionSet *dropped = CreateTestActionSet("dropped");
+    ASSERT_TRUE(NULL != kept && NULL != dropped);
+
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, dropped, NULL, 100));
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, kept, NULL, 250));
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, dropped, NULL, 200));
+    EXPECT_EQ(OC_STACK_OK, AddScheduledResource(NULL, dropped, NULL, 300));
+    EXPECT_EQ(4u, GetNumScheduledResources());
+    EXPECT_EQ(dropped, GetNextScheduledActionSet());
+
+    // The other action set keeps its schedule and becomes the root
+    CancelAllScheduledResources(dropped);
+    EXPECT_TRUE(NULL == dropped->schedule);
+    EXPECT_EQ(1u, GetNumScheduledResources());
+    EXPECT_EQ(kept, GetNextScheduledActionSet());
+
+    // Deleting an action set cancels what it has left
+    DeleteActionSet(&kept);
+    EXPECT_EQ(0u, GetNumScheduledResources());
+
+    DeleteActionSet(&dropped);
+    TerminateScheduledGroupActions();
+}
+
+TEST(StackServerRequest, RequestPayloadParseMode)
+{
+    OCRepPayload *rep = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(rep, "power", 5);
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)rep, &cbor, &cborSize));
+    OCRepPayloadDestroy(rep);
+
+    OCDevAddr endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    char query[] = "";
+    OCEntityHandlerRequest ehRequest;
+
+    // Entity handlers get a payload they may modify unless arena parsing is selected
+    EXPECT_EQ(OC_STACK_OK, FormOCEntityHandlerRequest(&ehRequest, NULL, OC_REST_POST, &endpoint,
+                                                      NULL, query, PAYLOAD_TYPE_REPRESENTATION,
+                                                      cbor, cborSize, 0, NULL,
+                                                      OC_OBSERVE_NO_OPTION, 0));
+    ASSERT_TRUE(NULL != ehRequest.payload);
+    EXPECT_TRUE(NULL == ((OCRepPayload *)ehRequest.payload)->arena);
+    EXPECT_TRUE(OCRepPayloadSetPropInt((OCRepPayload *)ehRequest.payload, "power", 6));
+    OCPayloadDestroy(ehRequest.payload);
+
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestPayloadParseMode(OC_PAYLOAD_PARSE_ARENA));
+    EXPECT_EQ(OC_STACK_OK, FormOCEntityHandlerRequest(&ehRequest, NULL, OC_REST_POST, &endpoint,
+                                                      NULL, query, PAYLOAD_TYPE_REPRESENTATION,
+                                                      cbor, cborSize, 0, NULL,
+                                                      OC_OBSERVE_NO_OPTION, 0));
+    ASSERT_TRUE(NULL != ehRequest.payload);
+    EXPECT_TRUE(NULL != ((OCRepPayload *)ehRequest.payload)->arena);
+    int64_t power = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt((OCRepPayload *)ehRequest.payload, "power", &power));
+    EXPECT_EQ(5, power);
+    OCPayloadDestroy(ehRequest.payload);
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRequestPayloadParseMode(OC_PAYLOAD_PARSE_ENCODED));
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestPayloadParseMode(OC_PAYLOAD_PARSE_DEFAULT));
+    OICFree(cbor);
+}
+
+TEST(StackServerRequest, LookupByTokenAndHandle)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting LookupByTokenAndHandle test");
+    InitStack(OC_SERVER);
+
+    const int numRequests = 100;
+    OCServerRequest *requests[numRequests];
+    OCDevAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = OC_ADAPTER_IP;
+    char token[CA_MAX_TOKEN_LEN] = { 0 };
+
+    for (int i = 0; i < numRequests; i++)
+    {
+        token[0] = (char)i;
+        EXPECT_EQ(OC_STACK_OK, AddServerRequest(&requests[i], i, 0, 0, OC_REST_GET, 0, 0,
+                  OC_NA_QOS, NULL, NULL, NULL, token, sizeof(token), (char *)"/a/led", 0,
+                  OC_FORMAT_CBOR, &addr));
+    }
+
+    for (int i = 0; i < numRequests; i += 2)
+    {
+        FindAndDeleteServerRequest(requests[i]);
+    }
+
+    for (int i = 0; i < numRequests; i++)
+    {
+        token[0] = (char)i;
+        OCServerRequest *expected = (i % 2) ? requests[i] : NULL;
+        EXPECT_EQ(expected, GetServerRequestUsingToken(token, sizeof(token)));
+        EXPECT_EQ(expected, GetServerRequestUsingHandle(requests[i]));
+    }
+
+    // A token only matches with its full length
+    token[0] = 1;
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken(token, sizeof(token) - 1));
+
+    for (int i = 1; i < numRequests; i += 2)
+    {
+        FindAndDeleteServerRequest(requests[i]);
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackServerRequest, TimeoutKeepsRequestsHandedOut)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting TimeoutKeepsRequestsHandedOut test");
+    InitStack(OC_SERVER);
+
+    OCServerRequest *requests[4];
+    OCDevAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = OC_ADAPTER_IP;
+    char token[CA_MAX_TOKEN_LEN] = { 0 };
+    for (int i = 0; i < 4; i++)
+    {
+        token[0] = (char)i;
+        EXPECT_EQ(OC_STACK_OK, AddServerRequest(&requests[i], i, 0, 0, OC_REST_GET, 0, 0,
+                  OC_NA_QOS, NULL, NULL, NULL, token, sizeof(token), (char *)"/a/led", 0,
+                  OC_FORMAT_CBOR, &addr));
+        // All of them are old enough to expire
+        requests[i]->timeStamp = 0;
+    }
+    // The application answers slow requests later, and a running handler may answer too
+    requests[1]->slowFlag = 1;
+    PinServerRequest(requests[2]);
+
+    ProcessServerRequestTimeouts();
+    EXPECT_TRUE(NULL == GetServerRequestUsingHandle(requests[0]));
+    EXPECT_EQ(requests[1], GetServerRequestUsingHandle(requests[1]));
+    EXPECT_EQ(requests[2], GetServerRequestUsingHandle(requests[2]));
+    EXPECT_TRUE(NULL == GetServerRequestUsingHandle(requests[3]));
+
+    EXPECT_TRUE(UnpinServerRequest(requests[2]));
+    FindAndDeleteServerRequest(requests[2]);
+
+    // Requests left unanswered are released with the stack
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    token[0] = 1;
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken(token, sizeof(token)));
+
+    // The indexes are rebuilt by the next run of the stack
+    InitStack(OC_SERVER);
+    OCServerRequest *request = NULL;
+    EXPECT_EQ(OC_STACK_OK, AddServerRequest(&request, 1, 0, 0, OC_REST_GET, 0, 0,
+              OC_NA_QOS, NULL, NULL, NULL, token, sizeof(token), (char *)"/a/led", 0,
+              OC_FORMAT_CBOR, &addr));
+    EXPECT_EQ(request, GetServerRequestUsingToken(token, sizeof(token)));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackServerRequest, RequestLimits)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting RequestLimits test");
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRequestLimits(0, MAX_QUERY_LENGTH, MAX_HEADER_OPTIONS));
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestLimits(256, 256, MAX_HEADER_OPTIONS + 2));
+    InitStack(OC_SERVER);
+
+    // Limits are fixed while the stack runs
+    EXPECT_EQ(OC_STACK_ERROR, OCSetRequestLimits(MAX_URI_LENGTH, MAX_QUERY_LENGTH,
+                                                 MAX_HEADER_OPTIONS));
+
+    std::string longUri = "/a/" + std::string(2 * MAX_URI_LENGTH, 'l');
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", longUri.c_str(),
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    // The URL, query and options of a server request are kept whatever their size
+    std::string longQuery = "if=" + std::string(2 * MAX_QUERY_LENGTH, 'q');
+    OCHeaderOption options[MAX_HEADER_OPTIONS + 2];
+    memset(options, 0, sizeof(options));
+    for (int i = 0; i < MAX_HEADER_OPTIONS + 2; i++)
+    {
+        options[i].optionID = 2048 + i;
+        options[i].optionLength = 1;
+        options[i].optionData[0] = (uint8_t)i;
+    }
+    OCDevAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = OC_ADAPTER_IP;
+    char token[CA_MAX_TOKEN_LEN] = { 0 };
+    OCServerRequest *request = NULL;
+    EXPECT_EQ(OC_STACK_OK, AddServerRequest(&request, 1, 0, 0, OC_REST_GET,
+              MAX_HEADER_OPTIONS + 2, 0, OC_NA_QOS, (char *)longQuery.c_str(), options, NULL,
+              token, sizeof(token), (char *)longUri.c_str(), 0, OC_FORMAT_CBOR, &addr));
+    ASSERT_TRUE(NULL != request);
+    EXPECT_EQ(longUri, request->resourceUrl);
+    EXPECT_EQ(longQuery, request->query);
+    EXPECT_EQ(MAX_HEADER_OPTIONS + 2, request->numRcvdVendorSpecificHeaderOptions);
+    EXPECT_EQ(0, memcmp(options, request->rcvdVendorSpecificHeaderOptions, sizeof(options)));
+    FindAndDeleteServerRequest(request);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestLimits(MAX_URI_LENGTH, MAX_QUERY_LENGTH,
+                                              MAX_HEADER_OPTIONS));
+}
+
+#ifdef TCP_ADAPTER
+static void SetKeepAliveEndpoint(CAEndpoint_t *endpoint, int i)
+{
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->adapter = CA_ADAPTER_TCP;
+    snprintf(endpoint->addr, sizeof(endpoint->addr), "10.0.%d.%d", i / 250, i % 250);
+    endpoint->port = (uint16_t)(5683 + i);
+}
+
+TEST(StackKeepAlive, EndpointIndex)
+{
+    EXPECT_EQ(OC_STACK_OK, InitializeKeepAlive(OC_CLIENT));
+
+    // More entries than initial buckets, the index grows on the way
+    const int numEntries = 200;
+    KeepAliveEntry_t *entries[numEntries];
+    CAEndpoint_t endpoint;
+    for (int i = 0; i < numEntries; i++)
+    {
+        SetKeepAliveEndpoint(&endpoint, i);
+        entries[i] = AddKeepAliveEntry(&endpoint, OC_SERVER, NULL);
+        ASSERT_TRUE(NULL != entries[i]);
+    }
+    EXPECT_EQ((size_t) numEntries, GetNumKeepAliveEntries());
+    for (int i = 0; i < numEntries; i++)
+    {
+        SetKeepAliveEndpoint(&endpoint, i);
+        EXPECT_EQ(entries[i], GetEntryFromEndpoint(&endpoint));
+    }
+    SetKeepAliveEndpoint(&endpoint, numEntries);
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&endpoint));
+
+    for (int i = 0; i < numEntries; i += 2)
+    {
+        SetKeepAliveEndpoint(&endpoint, i);
+        EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&endpoint));
+    }
+    EXPECT_EQ((size_t) numEntries / 2, GetNumKeepAliveEntries());
+    for (int i = 0; i < numEntries; i++)
+    {
+        SetKeepAliveEndpoint(&endpoint, i);
+        EXPECT_EQ((i % 2) ? entries[i] : NULL, GetEntryFromEndpoint(&endpoint));
+    }
+    SetKeepAliveEndpoint(&endpoint, 0);
+    EXPECT_NE(OC_STACK_OK, RemoveKeepAliveEntry(&endpoint));
+
+    EXPECT_EQ(OC_STACK_OK, TerminateKeepAlive(OC_CLIENT));
+}
+
+TEST(StackKeepAlive, TimerWheel)
+{
+    EXPECT_EQ(OC_STACK_OK, InitializeKeepAlive(OC_CLIENT));
+
+    const uint64_t usecsPerSec = 1000000;
+    uint64_t now = OICGetCurrentTime(TIME_IN_US);
+    CAEndpoint_t endpoint;
+
+    // Server entries that timed out send a disconnect and retry a response timeout later
+    const int numDue = 3;
+    KeepAliveEntry_t *due[numDue];
+    for (int i = 0; i < numDue; i++)
+    {
+        SetKeepAliveEndpoint(&endpoint, i);
+        due[i] = AddKeepAliveEntry(&endpoint, OC_SERVER, NULL);
+        ASSERT_TRUE(NULL != due[i]);
+        ScheduleKeepAliveEntry(due[i], now - usecsPerSec);
+    }
+
+    // One turn of the wheel later, in the slot being processed
+    SetKeepAliveEndpoint(&endpoint, numDue);
+    KeepAliveEntry_t *nextTurn = AddKeepAliveEntry(&endpoint, OC_SERVER, NULL);
+    ASSERT_TRUE(NULL != nextTurn);
+    uint64_t nextTurnDeadline = (now / usecsPerSec + 1024) * usecsPerSec;
+    ScheduleKeepAliveEntry(nextTurn, nextTurnDeadline);
+
+    SetKeepAliveEndpoint(&endpoint, numDue + 1);
+    KeepAliveEntry_t *later = AddKeepAliveEntry(&endpoint, OC_SERVER, NULL);
+    ASSERT_TRUE(NULL != later);
+    uint64_t laterDeadline = now + 1500 * usecsPerSec;
+    ScheduleKeepAliveEntry(later, laterDeadline);
+
+    ProcessKeepAlive();
+    for (int i = 0; i < numDue; i++)
+    {
+        EXPECT_LE(now + 60 * usecsPerSec, GetKeepAliveEntryDeadline(due[i]));
+    }
+    EXPECT_EQ(nextTurnDeadline, GetKeepAliveEntryDeadline(nextTurn));
+    EXPECT_EQ(laterDeadline, GetKeepAliveEntryDeadline(later));
+
+    // Each entry is handled once
+    uint64_t retryDeadline = GetKeepAliveEntryDeadline(due[0]);
+    ProcessKeepAlive();
+    EXPECT_EQ(retryDeadline, GetKeepAliveEntryDeadline(due[0]));
+
+    // Removal unlinks the entry from its slot
+    SetKeepAliveEndpoint(&endpoint, numDue);
+    EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&endpoint));
+    EXPECT_EQ((size_t) numDue + 1, GetNumKeepAliveEntries());
+    ProcessKeepAlive();
+
+    EXPECT_EQ(OC_STACK_OK, TerminateKeepAlive(OC_CLIENT));
+}
+#endif // TCP_ADAPTER
+
+TEST(StackNotify, NotifyListOfObserversWithPayloads)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting NotifyListOfObserversWithPayloads test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    OCDevAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = OC_ADAPTER_IP;
+    strcpy(addr.addr, "127.0.0.1");
+    addr.port = 5683;
+    char token[CA_MAX_TOKEN_LEN] = { 0 };
+    OCObservationId ids[] = { 1, 2, 3 };
+    for (int i = 0; i < 3; i++)
+    {
+        token[0] = (char)ids[i];
+        EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led", NULL, ids[i], token, sizeof(token),
+                  (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR, &addr));
+    }
+
+    OCRepPayload *on = OCRepPayloadCreate();
+    OCRepPayloadSetPropBool(on, "state", true);
+    OCRepPayload *off = OCRepPayloadCreate();
+    OCRepPayloadSetPropBool(off, "state", false);
+    const OCPayload *payloads[] = { (OCPayload *)on, (OCPayload *)off, (OCPayload *)on };
+
+    EXPECT_EQ(OC_STACK_OK, OCNotifyListOfObserversWithPayloads(handle, ids, payloads, 3,
+                                                               OC_LOW_QOS));
+
+    // Observers the resource does not have are not notified
+    OCObservationId unknown[] = { 1, 42 };
+    EXPECT_EQ(OC_STACK_ERROR, OCNotifyListOfObserversWithPayloads(handle, unknown, payloads, 2,
+                                                                  OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyListOfObserversWithPayloads(handle, &unknown[1],
+                                                                         payloads, 1,
+                                                                         OC_LOW_QOS));
+
+    const OCPayload *missing[] = { (OCPayload *)on, NULL, (OCPayload *)off };
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCNotifyListOfObserversWithPayloads(handle, ids, missing,
+                                                                          3, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCNotifyListOfObserversWithPayloads(handle, ids, NULL, 3,
+                                                                          OC_LOW_QOS));
+
+    OCRepPayloadDestroy(on);
+    OCRepPayloadDestroy(off);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackMetrics, CountersAndHistograms)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CountersAndHistograms test");
+
+    OICMetricsReset();
+    EXPECT_EQ(0u, OICMetricGet(OIC_METRIC_OBSERVERS));
+    OICMetricAdd(OIC_METRIC_OBSERVERS, 3);
+    OICMetricAdd(OIC_METRIC_OBSERVERS, -1);
+    EXPECT_EQ(2u, OICMetricGet(OIC_METRIC_OBSERVERS));
+    OICMetricSet(OIC_METRIC_SEND_QUEUE_DEPTH, 7);
+    EXPECT_EQ(7u, OICMetricGet(OIC_METRIC_SEND_QUEUE_DEPTH));
+    EXPECT_STREQ("observers", OICMetricName(OIC_METRIC_OBSERVERS));
+
+    // Unknown metrics are ignored
+    OICMetricAdd(OIC_METRIC_COUNT, 1);
+    EXPECT_EQ(0u, OICMetricGet(OIC_METRIC_COUNT));
+    EXPECT_EQ(NULL, OICMetricName(OIC_METRIC_COUNT));
+
+    OICHistogramRecord(OIC_HISTOGRAM_MESSAGE_SIZE, 0);
+    OICHistogramRecord(OIC_HISTOGRAM_MESSAGE_SIZE, 1);
+    OICHistogramRecord(OIC_HISTOGRAM_MESSAGE_SIZE, 5);
+    OICHistogramRecord(OIC_HISTOGRAM_MESSAGE_SIZE, 7);
+    OICHistogramRecord(OIC_HISTOGRAM_MESSAGE_SIZE, UINT64_MAX);
+    uint32_t buckets[OIC_HISTOGRAM_BUCKETS];
+    EXPECT_TRUE(OICHistogramGet(OIC_HISTOGRAM_MESSAGE_SIZE, buckets));
+    EXPECT_EQ(1u, buckets[0]);
+    EXPECT_EQ(1u, buckets[1]);
+    EXPECT_EQ(2u, buckets[3]);
+    EXPECT_EQ(1u, buckets[OIC_HISTOGRAM_BUCKETS - 1]);
+    EXPECT_FALSE(OICHistogramGet(OIC_HISTOGRAM_COUNT, buckets));
+
+    OICMetricsReset();
+    EXPECT_EQ(0u, OICMetricGet(OIC_METRIC_OBSERVERS));
+    EXPECT_TRUE(OICHistogramGet(OIC_HISTOGRAM_MESSAGE_SIZE, buckets));
+    EXPECT_EQ(0u, buckets[3]);
+}
+
+TEST(StackTrace, RingBuffer)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting RingBuffer test");
+
+    const char token[] = "tok";
+    uint32_t key = OICTraceKey(token, sizeof(token));
+    EXPECT_NE(0u, key);
+    EXPECT_EQ(0u, OICTraceKey(NULL, 0));
+
+    OICTraceReset();
+    OICTraceRecord(OIC_TRACE_HANDLE_REQUEST, key);
+    OICTraceRecord(OIC_TRACE_DO_RESPONSE, key);
+
+    OICTraceEvent events[4];
+    ASSERT_EQ(2u, OICTraceGetEvents(events, 4));
+    EXPECT_EQ(OIC_TRACE_HANDLE_REQUEST, events[0].point);
+    EXPECT_EQ(OIC_TRACE_DO_RESPONSE, events[1].point);
+    EXPECT_EQ(key, events[1].key);
+    EXPECT_LE(events[0].timestamp, events[1].timestamp);
+    EXPECT_STREQ("doResponse", OICTracePointName(OIC_TRACE_DO_RESPONSE));
+
+    // Only the newest events are kept
+    for (size_t i = 0; i < OIC_TRACE_BUFFER_SIZE; i++)
+    {
+        OICTraceRecord(OIC_TRACE_ADAPTER_SEND, key);
+    }
+    ASSERT_EQ(1u, OICTraceGetEvents(events, 1));
+    EXPECT_EQ(OIC_TRACE_ADAPTER_SEND, events[0].point);
+
+    char path[] = "/tmp/stacktests_traceXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    EXPECT_TRUE(OICTraceDumpChromeJson(path));
+    unlink(path);
+
+    OICTraceReset();
+    EXPECT_EQ(0u, OICTraceGetEvents(events, 4));
+}
+
+#ifdef WITH_METRICS
+TEST(StackMetrics, MonitoringResource)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting MonitoringResource test");
+    InitStack(OC_SERVER);
+
+    uint8_t numResources = 0;
+    uint8_t numExpectedResources = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numExpectedResources));
+
+    EXPECT_EQ(OC_STACK_OK, OCStartMonitoringResource());
+    EXPECT_EQ(OC_STACK_OK, OCStartMonitoringResource());
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(++numExpectedResources, numResources);
+
+    EXPECT_EQ(OC_STACK_OK, OCStopMonitoringResource());
+    EXPECT_EQ(OC_STACK_ERROR, OCStopMonitoringResource());
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(--numExpectedResources, numResources);
+
+    // The stack deletes the resource when it stops
+    EXPECT_EQ(OC_STACK_OK, OCStartMonitoringResource());
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(OC_STACK_ERROR, OCStopMonitoringResource());
+}
+#endif
+
+TEST(StackContext, CreateSelectDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CreateSelectDelete test");
+    InitStack(OC_SERVER);
+
+    OCStackContext *defaultContext = OCGetCurrentContext();
+    ASSERT_TRUE(defaultContext != NULL);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led", 0, NULL,
+                                            OC_DISCOVERABLE));
+    uint8_t numDefaultResources = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numDefaultResources));
+
+    OCStackContext *context = NULL;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateContext(NULL, &context));
+    EXPECT_EQ(OC_STACK_INVALID_URI, OCCreateContext("dev1", &context));
+    EXPECT_EQ(OC_STACK_INVALID_URI, OCCreateContext("/dev1/", &context));
+    EXPECT_EQ(OC_STACK_INVALID_URI, OCCreateContext("/oic/dev1", &context));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateContext("/a", &context));
+    EXPECT_EQ(OC_STACK_OK, OCCreateContext("/dev1", &context));
+    ASSERT_TRUE(context != NULL);
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateContext("/dev1/sub", &context));
+
+    // Creating a context does not select it
+    EXPECT_EQ(defaultContext, OCGetCurrentContext());
+    EXPECT_EQ(OC_STACK_INVALID_URI, OCCreateResource(&handle, "core.led", "core.rw",
+                                                     "/dev1/led", 0, NULL, OC_DISCOVERABLE));
+
+    EXPECT_EQ(OC_STACK_OK, OCSetCurrentContext(context));
+    EXPECT_EQ(context, OCGetCurrentContext());
+
+    // The context has its own /oic/d and /oic/p, resources are stored behind its prefix
+    uint8_t numResources = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(2, numResources);
+    EXPECT_STREQ("/dev1/oic/d", OCGetResourceUri(OCGetResourceHandle(0)));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led", 0, NULL,
+                                            OC_DISCOVERABLE));
+    EXPECT_STREQ("/dev1/a/led", OCGetResourceUri(handle));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateResource(&handle, "core.led", "core.rw",
+                                                       "/a/led", 0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(3, numResources);
+
+    EXPECT_EQ(OC_STACK_OK, OCSetCurrentContext(NULL));
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(numDefaultResources, numResources);
+
+    // Handles stay valid whatever context is current
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceHandler(handle, entityHandler, NULL));
+
+    EXPECT_EQ(OC_STACK_OK, OCSetCurrentContext(context));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDeleteContext(defaultContext));
+    EXPECT_EQ(OC_STACK_OK, OCDeleteContext(context));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDeleteContext(context));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetCurrentContext(context));
+    EXPECT_EQ(defaultContext, OCGetCurrentContext());
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(numDefaultResources, numResources);
+
+    // The stack deletes the contexts left when it stops
+    EXPECT_EQ(OC_STACK_OK, OCCreateContext("/dev2", &context));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackContext, SelectionPerThread)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SelectionPerThread test");
+    InitStack(OC_SERVER);
+
+    OCStackContext *defaultContext = OCGetCurrentContext();
+    OCStackContext *context = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCCreateContext("/dev1", &context));
+    EXPECT_EQ(OC_STACK_OK, OCSetCurrentContext(context));
+
+    // Other threads keep their own selection
+    OCStackContext *otherThreadContext = NULL;
+    std::thread other([&otherThreadContext]()
+    {
+        otherThreadContext = OCGetCurrentContext();
+    });
+    other.join();
+    EXPECT_EQ(defaultContext, otherThreadContext);
+    EXPECT_EQ(context, OCGetCurrentContext());
+
+    // The InContext variants leave the selection alone
+    EXPECT_EQ(OC_STACK_OK, OCSetCurrentContext(NULL));
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResourceInContext(context, &handle, "core.led", "core.rw",
+                                                     "/a/led", 0, NULL, OC_DISCOVERABLE));
+    EXPECT_STREQ("/dev1/a/led", OCGetResourceUri(handle));
+    EXPECT_EQ(defaultContext, OCGetCurrentContext());
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteContext(context));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateResourceInContext(context, &handle, "core.led",
+                                                                "core.rw", "/a/led", 0, NULL,
+                                                                OC_DISCOVERABLE));
+    EXPECT_EQ(defaultContext, OCGetCurrentContext());
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackLock, ConcurrentCreateAndProcess)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ConcurrentCreateAndProcess test");
+    InitStack(OC_SERVER);
+
+    uint8_t numInitialResources = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numInitialResources));
+
+    // Application threads create and delete resources while the stack processes
+    const int numThreads = 4;
+    const int numIterations = 50;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        threads.push_back(std::thread([t]
+            {
+                char uri[32];
+                snprintf(uri, sizeof(uri), "/a/led%d", t);
+                // Each thread keeps the resource it creates last
+                for (int i = 0; i <= numIterations; i++)
+                {
+                    OCResourceHandle handle;
+                    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw",
+                                                            uri, 0, NULL, OC_DISCOVERABLE));
+                    if (i < numIterations)
+                    {
+                        EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+                    }
+                }
+            }));
+    }
+    for (int i = 0; i < numIterations; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    uint8_t numResources = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    EXPECT_EQ(numInitialResources + numThreads, numResources);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static OCEntityHandlerResult lockProbeEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void *callbackParam)
+{
+    // Another thread uses the stack while the handler waits for it
+    uint8_t numResources = 0;
+    std::thread probe([&numResources]
+        {
+            EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+        });
+    probe.join();
+    EXPECT_LT(0, numResources);
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+
+    (*(int *)callbackParam)++;
+    return OC_EH_OK;
+}
+
+TEST(StackLock, EntityHandlerRunsWithoutLock)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting EntityHandlerRunsWithoutLock test");
+    InitStack(OC_SERVER);
+
+    int calls = 0;
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            lockProbeEntityHandler, &calls,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    OCDevAddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.adapter = OC_ADAPTER_IP;
+    strcpy(addr.addr, "127.0.0.1");
+    addr.port = 5683;
+    char token[CA_MAX_TOKEN_LEN] = { 1 };
+    EXPECT_EQ(OC_STACK_OK, AddObserver("/a/led", NULL, 1, token, sizeof(token),
+              (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR, &addr));
+
+    // The handler would never see the resource count if it ran with the lock of the stack
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(1, calls);
+
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(token, sizeof(token)));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
 
 TEST(StackBind, BindEntityHandlerBad)
 {
@@ -0,0 +1,100 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the executor running the application callbacks
+ * of the client, as selected by PlatformConfig::callbackDispatch.
+ */
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        /**
+         * @param dispatch   How tasks are run.
+         * @param threads    Number of worker threads of the CallbackDispatch::Pool and
+         *                   CallbackDispatch::Strand modes, at least one is started.
+         */
+        CallbackExecutor(CallbackDispatch dispatch, unsigned int threads);
+
+        /**
+         * Runs the tasks still queued and stops the worker threads.
+         */
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+         * Runs a task according to the dispatch mode.
+         *
+         * @param strand   Identifies the tasks to run one at a time in the order they were
+         *                 posted in the CallbackDispatch::Strand mode, such as the callback
+         *                 context of an observation. nullptr if the task need not be ordered.
+         * @param task     Task to run.
+         */
+        void post(const void* strand, Task task);
+
+    private:
+        // Shared with the workers, which may outlive the executor when a task drops the
+        // last reference to it.
+        struct Queue
+        {
+            std::mutex mutex;
+            std::condition_variable cond;
+            bool stop = false;
+
+            // Work ready to run: a task, or the strand whose first task is to run next.
+            std::deque<std::pair<const void*, Task>> ready;
+
+            // Tasks of each busy strand, the first one is queued or running.
+            std::unordered_map<const void*, std::deque<Task>> strands;
+        };
+
+        static void workerFunc(std::shared_ptr<Queue> queue);
+        static void runTask(const Task& task);
+
+        CallbackDispatch m_dispatch;
+        std::shared_ptr<Queue> m_queue;
+        std::vector<std::thread> m_workers;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
@@ -0,0 +1,106 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the pool running the entity handlers of the server
+ * when PlatformConfig::entityHandlerThreads is set.
+ */
+
+#ifndef OC_ENTITY_HANDLER_POOL_H_
+#define OC_ENTITY_HANDLER_POOL_H_
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include <CallbackExecutor.h>
+
+namespace OC
+{
+    /**
+     * Runs tasks on a fixed pool of threads, with at most a limited number of the tasks of
+     * one resource running at the same time. The tasks of a resource over its limit wait,
+     * and start in the order they were posted.
+     */
+    class EntityHandlerPool
+    {
+    public:
+        typedef CallbackExecutor::Task Task;
+
+        /**
+         * @param threads        Number of worker threads, at least one is started.
+         * @param defaultLimit   Number of tasks of a resource running at the same time
+         *                       unless set with setLimit, 0 for no limit.
+         */
+        EntityHandlerPool(unsigned int threads, unsigned int defaultLimit);
+
+        /**
+         * Runs the tasks still queued and stops the worker threads.
+         */
+        ~EntityHandlerPool() = default;
+
+        EntityHandlerPool(const EntityHandlerPool&) = delete;
+        EntityHandlerPool& operator=(const EntityHandlerPool&) = delete;
+
+        /**
+         * Sets the number of tasks of a resource running at the same time, 0 for no limit.
+         * Running tasks are not interrupted when the limit is lowered.
+         */
+        void setLimit(OCResourceHandle resource, unsigned int limit);
+
+        /**
+         * Restores the default limit of a resource.
+         */
+        void resetLimit(OCResourceHandle resource);
+
+        /**
+         * Runs a task of a resource once fewer than its limit of tasks are running.
+         *
+         * @param resource   Resource handling the request, nullptr for the default device
+         *                   entity handler.
+         * @param task       Task to run.
+         */
+        void post(OCResourceHandle resource, Task task);
+
+    private:
+        // Resources with running tasks
+        struct Slot
+        {
+            unsigned int running = 0;
+            std::deque<Task> pending;
+        };
+
+        unsigned int limit(OCResourceHandle resource) const;
+        void run(OCResourceHandle resource, const Task& task);
+        void finish(OCResourceHandle resource);
+
+        unsigned int m_defaultLimit;
+        std::mutex m_mutex;
+        std::unordered_map<OCResourceHandle, unsigned int> m_limits;
+        std::unordered_map<OCResourceHandle, Slot> m_slots;
+
+        // Declared last so that its workers are stopped before the slots go away
+        CallbackExecutor m_executor;
+    };
+}
+
+#endif // OC_ENTITY_HANDLER_POOL_H_
@@ -0,0 +1,141 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of FlatMap, the associative container holding the
+ * attributes of an OCRepresentation.
+ */
+
+#ifndef OC_FLAT_MAP_H_
+#define OC_FLAT_MAP_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace OC
+{
+    /**
+     * Map keeping its entries sorted by key in one contiguous array.
+     *
+     * A representation has a handful of attributes, which a binary search of an array
+     * finds faster than a walk down the nodes of a tree, and which are copied with a
+     * single allocation instead of one per entry. Entries are iterated in key order like
+     * in std::map, but inserting or erasing an entry invalidates the iterators and the
+     * references to the other entries.
+     */
+    template <typename Key, typename Value>
+    class FlatMap
+    {
+        public:
+            typedef Key key_type;
+            typedef Value mapped_type;
+            typedef std::pair<Key, Value> value_type;
+            typedef typename std::vector<value_type>::iterator iterator;
+            typedef typename std::vector<value_type>::const_iterator const_iterator;
+            typedef typename std::vector<value_type>::size_type size_type;
+
+            iterator begin() { return m_entries.begin(); }
+            const_iterator begin() const { return m_entries.begin(); }
+            const_iterator cbegin() const { return m_entries.cbegin(); }
+            iterator end() { return m_entries.end(); }
+            const_iterator end() const { return m_entries.end(); }
+            const_iterator cend() const { return m_entries.cend(); }
+
+            size_type size() const { return m_entries.size(); }
+            bool empty() const { return m_entries.empty(); }
+            void clear() { m_entries.clear(); }
+            void reserve(size_type count) { m_entries.reserve(count); }
+
+            iterator find(const Key& key)
+            {
+                iterator it = lowerBound(key);
+                return (it != m_entries.end() && it->first == key) ? it : m_entries.end();
+            }
+
+            const_iterator find(const Key& key) const
+            {
+                const_iterator it = lowerBound(key);
+                return (it != m_entries.end() && it->first == key) ? it : m_entries.end();
+            }
+
+            /**
+             * Returns the value of the key, inserting a default constructed value if the
+             * map has none.
+             */
+            Value& operator[](const Key& key)
+            {
+                iterator it = lowerBound(key);
+                if (it == m_entries.end() || it->first != key)
+                {
+                    it = m_entries.insert(it, value_type(key, Value()));
+                }
+                return it->second;
+            }
+
+            /**
+             * Removes the entry of the key.
+             *
+             * @return The number of entries removed, 0 or 1.
+             */
+            size_type erase(const Key& key)
+            {
+                iterator it = find(key);
+                if (it == m_entries.end())
+                {
+                    return 0;
+                }
+                m_entries.erase(it);
+                return 1;
+            }
+
+            bool operator==(const FlatMap& rhs) const
+            {
+                return m_entries == rhs.m_entries;
+            }
+
+            bool operator!=(const FlatMap& rhs) const
+            {
+                return !(*this == rhs);
+            }
+
+        private:
+            static bool keyLess(const value_type& entry, const Key& key)
+            {
+                return entry.first < key;
+            }
+
+            iterator lowerBound(const Key& key)
+            {
+                return std::lower_bound(m_entries.begin(), m_entries.end(), key, keyLess);
+            }
+
+            const_iterator lowerBound(const Key& key) const
+            {
+                return std::lower_bound(m_entries.begin(), m_entries.end(), key, keyLess);
+            }
+
+            std::vector<value_type> m_entries;
+    };
+}
+
+#endif // OC_FLAT_MAP_H_
@@ -57,21 +57,21 @@ namespace OC
                         const std::string& uri,
                         const QueryParamsMap& queryParams,
                         const HeaderOptions& headerOptions,
-                        GetCallback& callback, QualityOfService QoS)=0;
+                        SharedGetCallback& callback, QualityOfService QoS)=0;
 
         virtual OCStackResult PutResourceRepresentation(
                         const OCDevAddr& devAddr,
                         const std::string& uri,
                         const OCRepresentation& rep, const QueryParamsMap& queryParams,
                         const HeaderOptions& headerOptions,
-                        PutCallback& callback, QualityOfService QoS) = 0;
+                        SharedPutCallback& callback, QualityOfService QoS) = 0;
 
         virtual OCStackResult PostResourceRepresentation(
                         const OCDevAddr& devAddr,
                         const std::string& uri,
                         const OCRepresentation& rep, const QueryParamsMap& queryParams,
                         const HeaderOptions& headerOptions,
-                        PostCallback& callback, QualityOfService QoS) = 0;
+                        SharedPostCallback& callback, QualityOfService QoS) = 0;
 
         virtual OCStackResult DeleteResource(
                         const OCDevAddr& devAddr,
@@ -79,12 +79,17 @@ namespace OC
                         const HeaderOptions& headerOptions,
                         DeleteCallback& callback, QualityOfService QoS) = 0;
 
+        virtual OCStackResult DoRequests(
+                        const std::vector<BatchRequest>& requests,
+                        std::vector<OCDoHandle>& handles,
+                        QualityOfService QoS) = 0;
+
         virtual OCStackResult ObserveResource(
                         ObserveType observeType, OCDoHandle* handle,
                         const OCDevAddr& devAddr,
                         const std::string& uri,
                         const QueryParamsMap& queryParams,
-                        const HeaderOptions& headerOptions, ObserveCallback& callback,
+                        const HeaderOptions& headerOptions, SharedObserveCallback& callback,
                         QualityOfService QoS)=0;
 
         virtual OCStackResult CancelObserveResource(
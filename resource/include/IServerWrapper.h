@@ -59,6 +59,11 @@ namespace OC
 
         virtual OCStackResult unregisterResource(
                     const OCResourceHandle& resourceHandle) = 0;
+
+        virtual OCStackResult setEntityHandlerConcurrency(
+                    const OCResourceHandle& resourceHandle,
+                    unsigned int limit) = 0;
+
         virtual OCStackResult bindTypeToResource(
                     const OCResourceHandle& resourceHandle,
                     const std::string& resourceTypeName) = 0;
@@ -30,59 +30,94 @@
 #include <IClientWrapper.h>
 #include <InitializeException.h>
 #include <ResourceInitException.h>
+#include <CallbackExecutor.h>
 
 namespace OC
 {
+    class ResourceCache;
+
     namespace ClientCallbackContext
     {
         struct GetContext
         {
-            GetCallback callback;
-            GetContext(GetCallback cb) : callback(cb){}
+            SharedGetCallback callback;
+            std::shared_ptr<CallbackExecutor> executor;
+            std::shared_ptr<PendingRequest> pending;
+            GetContext(SharedGetCallback cb, std::shared_ptr<CallbackExecutor> ex,
+                       std::shared_ptr<PendingRequest> p = nullptr)
+                : callback(std::move(cb)), executor(ex), pending(std::move(p)){}
+            ~GetContext(){ if (pending) pending->completed = true; }
         };
 
         struct SetContext
         {
-            PutCallback callback;
-            SetContext(PutCallback cb) : callback(cb){}
+            SharedPutCallback callback;
+            std::shared_ptr<CallbackExecutor> executor;
+            std::shared_ptr<PendingRequest> pending;
+            SetContext(SharedPutCallback cb, std::shared_ptr<CallbackExecutor> ex,
+                       std::shared_ptr<PendingRequest> p = nullptr)
+                : callback(std::move(cb)), executor(ex), pending(std::move(p)){}
+            ~SetContext(){ if (pending) pending->completed = true; }
         };
 
         struct ListenContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::shared_ptr<CallbackExecutor> executor;
+            std::shared_ptr<ResourceCache> cache;
 
-            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw,
+                          std::shared_ptr<CallbackExecutor> ex,
+                          std::shared_ptr<ResourceCache> rc)
+                : callback(cb), clientWrapper(cw), executor(ex), cache(rc){}
         };
 
         struct DeviceListenContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
-            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw)
-                    : callback(cb), clientWrapper(cw){}
+            std::shared_ptr<CallbackExecutor> executor;
+            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw,
+                                std::shared_ptr<CallbackExecutor> ex)
+                    : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct SubscribePresenceContext
         {
             SubscribeCallback callback;
-            SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            SubscribePresenceContext(SubscribeCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct DeleteContext
         {
             DeleteCallback callback;
-            DeleteContext(DeleteCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            std::shared_ptr<PendingRequest> pending;
+            DeleteContext(DeleteCallback cb, std::shared_ptr<CallbackExecutor> ex,
+                          std::shared_ptr<PendingRequest> p = nullptr)
+                : callback(cb), executor(ex), pending(std::move(p)){}
+            ~DeleteContext(){ if (pending) pending->completed = true; }
         };
 
         struct ObserveContext
         {
-            ObserveCallback callback;
-            ObserveContext(ObserveCallback cb) : callback(cb){}
+            SharedObserveCallback callback;
+            std::shared_ptr<CallbackExecutor> executor;
+            ObserveContext(SharedObserveCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(std::move(cb)), executor(ex){}
         };
     }
 
+    /**
+     * Response handler of GET requests, ctx is a ClientCallbackContext::GetContext. The
+     * callback is posted to its executor with the parsed representation.
+     */
+    OCStackApplicationResult getResourceCallback(void* ctx, OCDoHandle handle,
+                                                 OCClientResponse* clientResponse);
+
     class InProcClientWrapper : public IClientWrapper
     {
 
@@ -104,19 +139,19 @@ namespace OC
             const OCDevAddr& devAddr,
             const std::string& uri,
             const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
-            GetCallback& callback, QualityOfService QoS);
+            SharedGetCallback& callback, QualityOfService QoS);
 
         virtual OCStackResult PutResourceRepresentation(
             const OCDevAddr& devAddr,
             const std::string& uri,
             const OCRepresentation& attributes, const QueryParamsMap& queryParams,
-            const HeaderOptions& headerOptions, PutCallback& callback, QualityOfService QoS);
+            const HeaderOptions& headerOptions, SharedPutCallback& callback, QualityOfService QoS);
 
         virtual OCStackResult PostResourceRepresentation(
             const OCDevAddr& devAddr,
             const std::string& uri,
             const OCRepresentation& attributes, const QueryParamsMap& queryParams,
-            const HeaderOptions& headerOptions, PostCallback& callback, QualityOfService QoS);
+            const HeaderOptions& headerOptions, SharedPostCallback& callback, QualityOfService QoS);
 
         virtual OCStackResult DeleteResource(
             const OCDevAddr& devAddr,
@@ -124,12 +159,17 @@ namespace OC
             const HeaderOptions& headerOptions,
             DeleteCallback& callback, QualityOfService QoS);
 
+        virtual OCStackResult DoRequests(
+            const std::vector<BatchRequest>& requests,
+            std::vector<OCDoHandle>& handles,
+            QualityOfService QoS);
+
         virtual OCStackResult ObserveResource(
             ObserveType observeType, OCDoHandle* handle,
             const OCDevAddr& devAddr,
             const std::string& uri,
             const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
-            ObserveCallback& callback, QualityOfService QoS);
+            SharedObserveCallback& callback, QualityOfService QoS);
 
         virtual OCStackResult CancelObserveResource(
             OCDoHandle handle,
@@ -152,12 +192,15 @@ namespace OC
         OCPayload* assembleSetResourcePayload(const OCRepresentation& attributes);
         OCHeaderOption* assembleHeaderOptions(OCHeaderOption options[],
            const HeaderOptions& headerOptions);
+        OCPayloadParseMode responseParseMode() const;
         std::thread m_listeningThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
 
     private:
         PlatformConfig  m_cfg;
+        std::shared_ptr<CallbackExecutor> m_executor;
+        std::shared_ptr<ResourceCache> m_resourceCache;
     };
 }
 
@@ -23,11 +23,14 @@
 
 #include <thread>
 #include <mutex>
+#include <memory>
 
 #include <IServerWrapper.h>
 
 namespace OC
 {
+    class EntityHandlerPool;
+
     class InProcServerWrapper : public IServerWrapper
     {
     public:
@@ -53,6 +56,10 @@ namespace OC
         virtual OCStackResult unregisterResource(
                     const OCResourceHandle& resourceHandle);
 
+        virtual OCStackResult setEntityHandlerConcurrency(
+                    const OCResourceHandle& resourceHandle,
+                    unsigned int limit);
+
         virtual OCStackResult bindTypeToResource(
                     const OCResourceHandle& resourceHandle,
                     const std::string& resourceTypeName);
@@ -73,6 +80,7 @@ namespace OC
         std::thread m_processThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        std::unique_ptr<EntityHandlerPool> m_handlerPool;
     };
 }
 
@@ -27,6 +27,8 @@
 #include <map>
 #include <memory>
 #include <iterator>
+#include <mutex>
+#include <atomic>
 
 #include "octypes.h"
 #include "OCHeaderOption.h"
@@ -101,6 +103,29 @@ namespace OC
         Gateway  /**< Client server mode along with routing capabilities.*/
     };
 
+    /**
+     * How the client runs the application callbacks of responses, discovery results,
+     * observe notifications and presence events.
+     */
+    enum class CallbackDispatch
+    {
+        /** A new detached thread per callback. Callbacks may run in any order. */
+        Thread,
+
+        /** On the thread processing the stack, holding the stack lock. Callbacks must not
+         *  block. */
+        Inline,
+
+        /** A fixed pool of PlatformConfig::callbackThreads threads. Callbacks may run in
+         *  any order. */
+        Pool,
+
+        /** A fixed pool of PlatformConfig::callbackThreads threads, the callbacks of a
+         *  request (such as the notifications of an observation) run one at a time in the
+         *  order they were received. */
+        Strand
+    };
+
     /**
      * Quality of Service attempts to abstract the guarantees provided by the underlying transport
      * protocol. The precise definitions of each quality of service level depend on the
@@ -151,6 +176,36 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /** how the client callbacks are run. */
+        CallbackDispatch           callbackDispatch;
+
+        /** number of threads running client callbacks with CallbackDispatch::Pool and
+         *  CallbackDispatch::Strand. */
+        unsigned int               callbackThreads;
+
+        /** decode received representations straight from their CBOR encoding instead of
+         *  through an OCRepPayload, see OC_PAYLOAD_PARSE_ENCODED. Only the requests of this
+         *  API are affected, C callbacks of the process still receive an OCRepPayload. */
+        bool                       encodedResponses;
+
+        /** number of threads running the entity handlers of the server, 0 to run them on the
+         *  thread processing the stack. With threads, the stack only sees ::OC_EH_SLOW, so
+         *  a handler must answer through sendResponse and delete its resource itself with
+         *  unregisterResource instead of returning ::OC_EH_RESOURCE_DELETED. Only
+         *  ::OC_EH_ERROR, ::OC_EH_FORBIDDEN and ::OC_EH_RESOURCE_NOT_FOUND are forwarded,
+         *  as the response. */
+        unsigned int               entityHandlerThreads;
+
+        /** number of requests of one resource handled at the same time with
+         *  entityHandlerThreads, 0 for no limit. See OCPlatform::setEntityHandlerConcurrency
+         *  to set it per resource. */
+        unsigned int               entityHandlerConcurrency;
+
+        /** pass the resource discovered before to the FindCallback when a resource is
+         *  discovered again unchanged at the same host and URI, instead of a new OCResource.
+         *  Only the resources the application still holds are kept. */
+        bool                       cacheDiscoveredResources;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -160,7 +215,13 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                callbackDispatch(CallbackDispatch::Thread),
+                callbackThreads(4),
+                encodedResponses(false),
+                entityHandlerThreads(0),
+                entityHandlerConcurrency(1),
+                cacheDiscoveredResources(false)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -175,7 +236,13 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackDispatch(CallbackDispatch::Thread),
+                callbackThreads(4),
+                encodedResponses(false),
+                entityHandlerThreads(0),
+                entityHandlerConcurrency(1),
+                cacheDiscoveredResources(false)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -191,7 +258,13 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackDispatch(CallbackDispatch::Thread),
+                callbackThreads(4),
+                encodedResponses(false),
+                entityHandlerThreads(0),
+                entityHandlerConcurrency(1),
+                cacheDiscoveredResources(false)
         {}
     };
 
@@ -217,6 +290,10 @@ namespace OC
     // Typedef for list of observation IDs
     typedef std::vector<OCObservationId> ObservationIds;
 
+    // Typedef for list of observers, each with the representation it is notified of
+    typedef std::vector<std::pair<OCObservationId, std::shared_ptr<const OCRepresentation>>>
+            ObserverNotifications;
+
     enum class ObserveAction
     {
         ObserveRegister,
@@ -275,6 +352,96 @@ namespace OC
 
     typedef std::function<void(const HeaderOptions&,
                                 const OCRepresentation&, const int, const int)> ObserveCallback;
+
+    /**
+     * Variants of GetCallback, PutCallback, PostCallback and ObserveCallback receiving the
+     * representation of the response as it was parsed. It is shared instead of copied, so the
+     * callback may keep it. The pointer is never null.
+     */
+    typedef std::function<void(const HeaderOptions&,
+                                std::shared_ptr<const OCRepresentation>, const int)>
+                                SharedGetCallback;
+
+    typedef SharedGetCallback SharedPutCallback;
+
+    typedef SharedGetCallback SharedPostCallback;
+
+    typedef std::function<void(const HeaderOptions&,
+                                std::shared_ptr<const OCRepresentation>, const int, const int)>
+                                SharedObserveCallback;
+
+    /**
+     * Adapts a callback taking the representation by reference to its shared variant, the
+     * representation is not copied. A null callback gives a null callback.
+     */
+    SharedGetCallback shareRepresentation(GetCallback callback);
+
+    SharedObserveCallback shareRepresentation(ObserveCallback callback);
+
+    /**
+     * Completion state of a request sent with OCPlatform::sendRequests, for cancelling it
+     * with OCCancel. The stack frees the handle of a request once its response is in, so the
+     * response marks the request completed under the mutex first, and the handle is only
+     * passed to OCCancel under the mutex while the request is not completed.
+     */
+    struct PendingRequest
+    {
+        std::mutex mutex;
+
+        /** Handle of the request, set once it is sent. */
+        OCDoHandle handle = nullptr;
+
+        /** Set by the response under the mutex, and without it when the stack drops the
+         *  request, as it may then hold the stack lock the canceller waits for. */
+        std::atomic<bool> completed{false};
+    };
+
+    /**
+     * One request of a batch sent with OCPlatform::sendRequests. Not to be confused with
+     * requests on the batch interface of a collection.
+     */
+    struct BatchRequest
+    {
+        /** Endpoint of the resource. */
+        OCDevAddr devAddr;
+
+        /** URI of the resource, without query. */
+        std::string uri;
+
+        /** OC_REST_GET, OC_REST_PUT, OC_REST_POST or OC_REST_DELETE. */
+        OCMethod method;
+
+        /** Representation sent with OC_REST_PUT and OC_REST_POST. */
+        OCRepresentation rep;
+
+        QueryParamsMap queryParams;
+
+        HeaderOptions headerOptions;
+
+        /** Called with the response, with an empty representation for OC_REST_DELETE. */
+        GetCallback callback;
+
+        /** Called instead of callback when set, with the representation shared. */
+        SharedGetCallback sharedCallback;
+
+        /** Completion state of the request, if it may be cancelled. */
+        std::shared_ptr<PendingRequest> pending;
+    };
+
+    /**
+     * Result of a request sent with OCResource::getAsync, putAsync, postAsync or
+     * deleteResourceAsync.
+     */
+    struct RequestResult
+    {
+        HeaderOptions headerOptions;
+
+        /** Representation of the response, empty for a DELETE or a failure. Never null. */
+        std::shared_ptr<const OCRepresentation> representation;
+
+        /** Result of the request, ::OC_STACK_REQUEST_CANCELLED if it was cancelled. */
+        int result = OC_STACK_ERROR;
+    };
 } // namespace OC
 
 #endif
@@ -0,0 +1,280 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of OCFuture, the handle returned by the requests of
+ * OCResource that take no callback, and of when_all.
+ */
+
+#ifndef OC_FUTURE_H_
+#define OC_FUTURE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace OC
+{
+    template <typename T>
+    class OCPromise;
+
+    /**
+     * Result of an asynchronous operation, set once.
+     *
+     * Unlike std::future the result can be read any number of times, continuations can be
+     * attached with then() and the operation can be cancelled. No thread waits for the
+     * result unless get() or waitFor() is called: the result is set by the callback executor
+     * of the client, which also runs the continuations attached before.
+     */
+    template <typename T>
+    class OCFuture
+    {
+        friend class OCPromise<T>;
+        public:
+            typedef std::function<void(const T&)> Continuation;
+
+            /**
+             * Creates a future with no shared state, valid() returns false.
+             */
+            OCFuture() = default;
+
+            bool valid() const
+            {
+                return static_cast<bool>(m_state);
+            }
+
+            bool ready() const
+            {
+                std::lock_guard<std::mutex> lock(state().mutex);
+                return state().ready;
+            }
+
+            /**
+             * Waits until the result is set.
+             *
+             * Calling it from a continuation or a client callback blocks the executor which
+             * sets the results, and may deadlock with the CallbackDispatch::Inline mode.
+             */
+            const T& get() const
+            {
+                std::unique_lock<std::mutex> lock(state().mutex);
+                state().cond.wait(lock, [this]{ return state().ready; });
+                return state().value;
+            }
+
+            /**
+             * Waits until the result is set or the timeout expires.
+             *
+             * @return true if the result is set.
+             */
+            template <typename Rep, typename Period>
+            bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const
+            {
+                std::unique_lock<std::mutex> lock(state().mutex);
+                return state().cond.wait_for(lock, timeout, [this]{ return state().ready; });
+            }
+
+            /**
+             * Runs a continuation with the result. It runs where the result is set, or right
+             * away in the caller if the result is already set.
+             */
+            void then(Continuation continuation) const
+            {
+                std::unique_lock<std::mutex> lock(state().mutex);
+                if (!state().ready)
+                {
+                    state().continuations.push_back(std::move(continuation));
+                    return;
+                }
+                lock.unlock();
+                continuation(state().value);
+            }
+
+            /**
+             * Cancels the operation unless its result is already set. The result is then set
+             * by the operation, for instance to ::OC_STACK_REQUEST_CANCELLED for a request.
+             */
+            void cancel() const
+            {
+                std::function<void()> canceller;
+                {
+                    std::lock_guard<std::mutex> lock(state().mutex);
+                    if (state().ready)
+                    {
+                        return;
+                    }
+                    canceller.swap(state().canceller);
+                }
+                if (canceller)
+                {
+                    canceller();
+                }
+            }
+
+        private:
+            struct State
+            {
+                std::mutex mutex;
+                std::condition_variable cond;
+                bool ready = false;
+                T value;
+                std::vector<Continuation> continuations;
+                std::function<void()> canceller;
+            };
+
+            explicit OCFuture(std::shared_ptr<State> state)
+                : m_state(std::move(state))
+            {
+            }
+
+            State& state() const
+            {
+                if (!m_state)
+                {
+                    throw std::logic_error("OCFuture has no state");
+                }
+                return *m_state;
+            }
+
+            std::shared_ptr<State> m_state;
+    };
+
+    /**
+     * Producer side of an OCFuture.
+     */
+    template <typename T>
+    class OCPromise
+    {
+        public:
+            OCPromise()
+                : m_state(std::make_shared<typename OCFuture<T>::State>())
+            {
+            }
+
+            OCFuture<T> getFuture() const
+            {
+                return OCFuture<T>(m_state);
+            }
+
+            /**
+             * Sets the result and runs the continuations in the caller.
+             *
+             * @return false if the result was already set, the value is then dropped.
+             */
+            bool setValue(T value) const
+            {
+                std::vector<typename OCFuture<T>::Continuation> continuations;
+                {
+                    std::lock_guard<std::mutex> lock(m_state->mutex);
+                    if (m_state->ready)
+                    {
+                        return false;
+                    }
+                    m_state->value = std::move(value);
+                    m_state->ready = true;
+                    m_state->continuations.swap(continuations);
+                    m_state->canceller = nullptr;
+                }
+                m_state->cond.notify_all();
+
+                // The value no longer changes and may be read without the lock
+                for (auto& continuation : continuations)
+                {
+                    continuation(m_state->value);
+                }
+                return true;
+            }
+
+            /**
+             * Sets how the operation is cancelled, run at most once by OCFuture::cancel.
+             */
+            void setCanceller(std::function<void()> canceller) const
+            {
+                std::lock_guard<std::mutex> lock(m_state->mutex);
+                if (!m_state->ready)
+                {
+                    m_state->canceller = std::move(canceller);
+                }
+            }
+
+        private:
+            std::shared_ptr<typename OCFuture<T>::State> m_state;
+    };
+
+    /**
+     * Combines futures into one set when all of them are, with their results in order.
+     * Cancelling it cancels each of them.
+     */
+    template <typename T>
+    OCFuture<std::vector<T>> when_all(const std::vector<OCFuture<T>>& futures)
+    {
+        struct Join
+        {
+            std::mutex mutex;
+            std::vector<T> values;
+            size_t pending;
+        };
+
+        OCPromise<std::vector<T>> promise;
+        if (futures.empty())
+        {
+            promise.setValue(std::vector<T>());
+            return promise.getFuture();
+        }
+
+        auto join = std::make_shared<Join>();
+        join->values.resize(futures.size());
+        join->pending = futures.size();
+
+        promise.setCanceller([futures]
+            {
+                for (auto& future : futures)
+                {
+                    future.cancel();
+                }
+            });
+
+        for (size_t i = 0; i < futures.size(); ++i)
+        {
+            futures[i].then([join, promise, i](const T& value)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(join->mutex);
+                        join->values[i] = value;
+                        if (--join->pending)
+                        {
+                            return;
+                        }
+                    }
+                    promise.setValue(std::move(join->values));
+                });
+        }
+        return promise.getFuture();
+    }
+}
+
+#endif // OC_FUTURE_H_
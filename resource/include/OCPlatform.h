@@ -107,6 +107,42 @@ namespace OC
                     const std::shared_ptr<OCResourceResponse> responsePtr,
                     QualityOfService QoS);
 
+        /**
+         * API for notifying specific clients of their own representation of the resource,
+         * such as a representation filtered for each of them. All the clients are notified in
+         * one pass of the stack, and a representation given to several of them is encoded
+         * once.
+         *
+         * @param resourceHandle resource handle of the resource
+         * @param notifications observationIds of the clients to notify, each with the
+         * representation it is sent. Clients given the same representation object share its
+         * encoding.
+         *
+         * @return Returns ::OC_STACK_OK if all the clients were notified,
+         * ::OC_STACK_NO_OBSERVERS if none was.
+         * @throw OCException if notifications is empty, holds a null representation or more
+         * clients than the stack can notify at once.
+         * @note This API is for server side only.
+         * @see notifyListOfObservers(OCResourceHandle, const ObserverNotifications&, QualityOfService)
+         */
+        OCStackResult notifyListOfObservers(
+                    OCResourceHandle resourceHandle,
+                    const ObserverNotifications& notifications);
+
+        /**
+         * @overload
+         *
+         * @param resourceHandle resource handle of the resource
+         * @param notifications observationIds of the clients to notify, each with the
+         * representation it is sent.
+         * @param QoS the quality of communication
+         * @see notifyListOfObservers(OCResourceHandle, const ObserverNotifications&)
+         */
+        OCStackResult notifyListOfObservers(
+                    OCResourceHandle resourceHandle,
+                    const ObserverNotifications& notifications,
+                    QualityOfService QoS);
+
         /**
          * API for Service and Resource Discovery.
          * @note This API applies to client side only.
@@ -232,6 +268,30 @@ namespace OC
                     OCConnectivityType connectivityType, FindPlatformCallback platformInfoHandler,
                     QualityOfService QoS);
 
+        /**
+         * API for sending many requests at once. The callbacks of all requests are
+         * registered and their messages built in one pass, under one acquisition of the
+         * stack lock, and handed to the send thread together.
+         *
+         * @param requests Requests to send.
+         * @param handles Filled with the handle of each request, nullptr for a request that
+         *                could not be sent. Its callback is then not called.
+         *
+         * @return Returns ::OC_STACK_OK if every request was sent.
+         * @note OCStackResult is defined in ocstack.h.
+         */
+        OCStackResult sendRequests(const std::vector<BatchRequest>& requests,
+                    std::vector<OCDoHandle>& handles);
+        /**
+         * @overload
+         *
+         * @param requests Requests to send.
+         * @param handles Filled with the handle of each request.
+         * @param QoS the quality of communication
+         */
+        OCStackResult sendRequests(const std::vector<BatchRequest>& requests,
+                    std::vector<OCDoHandle>& handles, QualityOfService QoS);
+
         /**
         * This API registers a resource with the server
         * @note This API applies to server side only.
@@ -317,6 +377,22 @@ namespace OC
         */
         OCStackResult unregisterResource(const OCResourceHandle& resourceHandle);
 
+        /**
+        * This API sets how many requests of a resource are handled at the same time when
+        * entity handlers run on the threads of PlatformConfig::entityHandlerThreads. It
+        * overrides PlatformConfig::entityHandlerConcurrency until the resource is unregistered.
+        * @note This API applies to server side only.
+        *
+        * @param resourceHandle Handle of the resource.
+        * @param limit Number of its requests handled at the same time, 0 for no limit.
+        *
+        * @return Returns ::OC_STACK_OK if success.
+        * @throw OCException if the entity handlers of the server run on the thread
+        *        processing the stack.
+        */
+        OCStackResult setEntityHandlerConcurrency(const OCResourceHandle& resourceHandle,
+                                                  unsigned int limit);
+
         /**
         * Add a resource to a collection resource.
         *
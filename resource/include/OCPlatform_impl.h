@@ -72,6 +72,15 @@ namespace OC
                     const std::shared_ptr<OCResourceResponse> responsePtr,
                     QualityOfService QoS);
 
+        OCStackResult notifyListOfObservers(
+                    OCResourceHandle resourceHandle,
+                    const ObserverNotifications& notifications);
+
+        OCStackResult notifyListOfObservers(
+                    OCResourceHandle resourceHandle,
+                    const ObserverNotifications& notifications,
+                    QualityOfService QoS);
+
         OCStackResult findResource(const std::string& host, const std::string& resourceURI,
                     OCConnectivityType connectivityType, FindCallback resourceHandler);
 
@@ -93,6 +102,12 @@ namespace OC
                     OCConnectivityType connectivityType, FindPlatformCallback platformInfoHandler,
                     QualityOfService QoS);
 
+        OCStackResult sendRequests(const std::vector<BatchRequest>& requests,
+                    std::vector<OCDoHandle>& handles);
+
+        OCStackResult sendRequests(const std::vector<BatchRequest>& requests,
+                    std::vector<OCDoHandle>& handles, QualityOfService QoS);
+
         /**
          * API for Device Discovery
          *
@@ -186,6 +201,9 @@ namespace OC
 
         OCStackResult unregisterResource(const OCResourceHandle& resourceHandle) const;
 
+        OCStackResult setEntityHandlerConcurrency(const OCResourceHandle& resourceHandle,
+                    unsigned int limit) const;
+
         OCStackResult bindResource(const OCResourceHandle collectionHandle,
                     const OCResourceHandle resourceHandle);
 
@@ -33,8 +33,10 @@
 #include <sstream>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include <AttributeValue.h>
+#include <FlatMap.h>
 #include <StringConstants.h>
 
 #ifdef __ANDROID__
@@ -68,12 +70,33 @@ namespace OC
 
             void setPayload(const OCRepPayload* rep);
 
+            /**
+             * Decodes the representations straight from their CBOR encoding.
+             */
+            void setPayload(const OCEncodedPayload* rep);
+
             OCRepPayload* getPayload() const;
 
+            /**
+             * Encodes the representations in CBOR like OCConvertPayload encodes the
+             * payload of getPayload(), without building that payload.
+             *
+             * @return payload to release with OCPayloadDestroy, nullptr if the container
+             *         holds no representation.
+             */
+            OCEncodedPayload* getEncodedPayload() const;
+
             const std::vector<OCRepresentation>& representations() const;
 
+            /**
+             * Moves the representations out of the container, which is left empty.
+             */
+            std::vector<OCRepresentation> releaseRepresentations();
+
             void addRepresentation(const OCRepresentation& rep);
 
+            void addRepresentation(OCRepresentation&& rep);
+
             const OCRepresentation& operator[](int index) const
             {
                 return m_reps[index];
@@ -117,6 +140,8 @@ namespace OC
 
             void addChild(const OCRepresentation&);
 
+            void addChild(OCRepresentation&&);
+
             void clearChildren();
 
             const std::vector<OCRepresentation>& getChildren() const;
@@ -244,6 +269,8 @@ namespace OC
             bool isNULL(const std::string& str) const;
 
         private:
+            typedef FlatMap<std::string, AttributeValue> AttributeMap;
+
             std::string m_host;
 
             // STL Container stuff
@@ -318,10 +345,10 @@ namespace OC
 
                 private:
                     AttributeItem(const std::string& name,
-                            std::map<std::string, AttributeValue>& vals);
+                            AttributeMap& vals);
                     AttributeItem(const AttributeItem&) = default;
                     std::string m_attrName;
-                    std::map<std::string, AttributeValue>& m_values;
+                    AttributeMap& m_values;
             };
 
             // Iterator to allow iteration via STL containers/methods
@@ -348,11 +375,11 @@ namespace OC
                     reference operator*();
                     pointer operator->();
                 private:
-                    iterator(std::map<std::string, AttributeValue>::iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
+                    iterator(AttributeMap::iterator&& itr,
+                            AttributeMap& vals)
                         : m_iterator(std::move(itr)),
                         m_item(m_iterator != vals.end() ? m_iterator->first:"", vals){}
-                    std::map<std::string, AttributeValue>::iterator m_iterator;
+                    AttributeMap::iterator m_iterator;
                     AttributeItem m_item;
             };
 
@@ -381,11 +408,11 @@ namespace OC
                     const_reference operator*() const;
                     const_pointer operator->() const;
                 private:
-                    const_iterator(std::map<std::string, AttributeValue>::const_iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
+                    const_iterator(AttributeMap::const_iterator&& itr,
+                            AttributeMap& vals)
                         : m_iterator(std::move(itr)),
                         m_item(m_iterator != vals.end() ? m_iterator->first: "", vals){}
-                    std::map<std::string, AttributeValue>::const_iterator m_iterator;
+                    AttributeMap::const_iterator m_iterator;
                     AttributeItem m_item;
             };
 
@@ -403,12 +430,14 @@ namespace OC
         private:
             friend class OCResourceResponse;
             friend class MessageContainer;
+            friend class OCRepresentationCbor;
 
             template<typename T>
             void payload_array_helper(const OCRepPayloadValue* pl, size_t depth);
             template<typename T>
             T payload_array_helper_copy(size_t index, const OCRepPayloadValue* pl);
             void setPayload(const OCRepPayload* payload);
+            std::vector<OCRepresentation>& mutableChildren();
             void setPayloadArray(const OCRepPayloadValue* pl);
             void getPayloadArray(OCRepPayload* payload,
                     const OCRepresentation::AttributeItem& item) const;
@@ -441,8 +470,10 @@ namespace OC
             };
         private:
             std::string m_uri;
-            std::vector<OCRepresentation> m_children;
-            mutable std::map<std::string, AttributeValue> m_values;
+            // Shared by the copies of the representation until one of them changes its
+            // children, null while there are none.
+            std::shared_ptr<std::vector<OCRepresentation>> m_children;
+            mutable AttributeMap m_values;
             std::vector<std::string> m_resourceTypes;
             std::vector<std::string> m_interfaces;
 
@@ -0,0 +1,481 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of RepresentationSchema, which encodes and decodes the
+ * representation of a resource with a fixed shape straight from a C++ struct.
+ */
+
+#ifndef OC_REPRESENTATION_SCHEMA_H_
+#define OC_REPRESENTATION_SCHEMA_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <OCRepresentation.h>
+#include <OCResourceResponse.h>
+#include "ocpayload.h"
+
+namespace OC
+{
+    /**
+     * Writes the CBOR encoding of the values of a RepresentationSchema.
+     */
+    class SchemaWriter
+    {
+        public:
+            SchemaWriter();
+            ~SchemaWriter();
+
+            SchemaWriter(const SchemaWriter&) = delete;
+            SchemaWriter& operator=(const SchemaWriter&) = delete;
+
+            /**
+             * Starts an encoding pass.
+             */
+            void begin();
+
+            /**
+             * Ends an encoding pass.
+             *
+             * @return true if the buffer was too small, it is then grown to the size reported
+             *         by the pass, which must be repeated.
+             * @throw std::logic_error if the values could not be encoded.
+             */
+            bool retry();
+
+            /**
+             * @return payload encoded by the last pass, to release with OCPayloadDestroy.
+             */
+            OCEncodedPayload* release();
+
+            void beginMap(size_t count);
+            void beginArray(size_t count);
+            void end();
+
+            void key(const char* key, size_t length);
+
+            void value(int val);
+            void value(double val);
+            void value(bool val);
+            void value(const std::string& val);
+
+        private:
+            struct State;
+            std::unique_ptr<State> m_state;
+    };
+
+    /**
+     * Reads the values of a RepresentationSchema from their CBOR encoding.
+     *
+     * A value encoded with another type than the one of the schema throws an OCException,
+     * a null value reads as the default value of its type.
+     */
+    class SchemaReader
+    {
+        public:
+            SchemaReader(const uint8_t* data, size_t size);
+            ~SchemaReader();
+
+            SchemaReader(const SchemaReader&) = delete;
+            SchemaReader& operator=(const SchemaReader&) = delete;
+
+            /**
+             * Enters the map or array of the current value. A null value reads as an empty
+             * one.
+             */
+            void enterMap();
+            void enterArray();
+
+            /**
+             * @return true when the map or array entered last has no more values.
+             */
+            bool atEnd() const;
+
+            /**
+             * Leaves the map or array entered last, once atEnd returns true.
+             */
+            void leave();
+
+            /**
+             * Reads the key of the next entry of a map, which is then compared with keyIs.
+             */
+            void readKey();
+
+            bool keyIs(const char* key, size_t length) const
+            {
+                return length == m_key.size() && m_key.compare(0, length, key, length) == 0;
+            }
+
+            /**
+             * Skips the current value, of any type.
+             */
+            void skip();
+
+            void value(int& val);
+            void value(double& val);
+            void value(bool& val);
+            void value(std::string& val);
+
+        private:
+            struct State;
+            std::unique_ptr<State> m_state;
+
+            // Reused by readKey, which then does not allocate once the longest key is read
+            std::string m_key;
+    };
+
+    namespace detail
+    {
+        [[noreturn]] void schemaMismatch(const char* key);
+
+        template<typename V>
+        void writeSchemaValue(SchemaWriter& writer, const V& val)
+        {
+            writer.value(val);
+        }
+
+        template<typename V>
+        void writeSchemaValue(SchemaWriter& writer, const std::vector<V>& arr)
+        {
+            writer.beginArray(arr.size());
+            for (const auto& item : arr)
+            {
+                writeSchemaValue(writer, static_cast<const V&>(item));
+            }
+            writer.end();
+        }
+
+        template<typename V>
+        void readSchemaValue(SchemaReader& reader, V& val)
+        {
+            reader.value(val);
+        }
+
+        template<typename V>
+        void readSchemaValue(SchemaReader& reader, std::vector<V>& arr)
+        {
+            arr.clear();
+            reader.enterArray();
+            while (!reader.atEnd())
+            {
+                V item = V();
+                readSchemaValue(reader, item);
+                arr.push_back(std::move(item));
+            }
+            reader.leave();
+        }
+
+        /**
+         * Attribute of a RepresentationSchema, held in a member of the struct.
+         */
+        template<typename T, typename V>
+        class SchemaField
+        {
+            public:
+                SchemaField(const char* key, size_t length, V T::*member)
+                    : m_key(key), m_length(length), m_member(member)
+                {
+                }
+
+                void encode(SchemaWriter& writer, const T& value) const
+                {
+                    writer.key(m_key, m_length);
+                    writeSchemaValue(writer, value.*m_member);
+                }
+
+                bool decode(SchemaReader& reader, T& value) const
+                {
+                    if (!reader.keyIs(m_key, m_length))
+                    {
+                        return false;
+                    }
+                    readSchemaValue(reader, value.*m_member);
+                    return true;
+                }
+
+                void decode(const OCRepresentation& rep, T& value) const
+                {
+                    std::string key(m_key, m_length);
+                    if (rep.hasAttribute(key) && !rep.isNULL(key) &&
+                        !rep.getValue(key, value.*m_member))
+                    {
+                        schemaMismatch(m_key);
+                    }
+                }
+
+            private:
+                const char* m_key;
+                size_t m_length;
+                V T::*m_member;
+        };
+
+        /**
+         * Attribute of a RepresentationSchema holding a nested representation, itself
+         * described by a schema.
+         */
+        template<typename T, typename V, typename Schema>
+        class SchemaObjectField
+        {
+            public:
+                SchemaObjectField(const char* key, size_t length, V T::*member,
+                                  const Schema& schema)
+                    : m_key(key), m_length(length), m_member(member), m_schema(schema)
+                {
+                }
+
+                void encode(SchemaWriter& writer, const T& value) const
+                {
+                    writer.key(m_key, m_length);
+                    m_schema.encodeMap(writer, value.*m_member);
+                }
+
+                bool decode(SchemaReader& reader, T& value) const
+                {
+                    if (!reader.keyIs(m_key, m_length))
+                    {
+                        return false;
+                    }
+                    m_schema.decodeMap(reader, value.*m_member);
+                    return true;
+                }
+
+                void decode(const OCRepresentation& rep, T& value) const
+                {
+                    std::string key(m_key, m_length);
+                    if (!rep.hasAttribute(key) || rep.isNULL(key))
+                    {
+                        return;
+                    }
+
+                    OCRepresentation nested;
+                    if (!rep.getValue(key, nested))
+                    {
+                        schemaMismatch(m_key);
+                    }
+                    m_schema.decode(nested, value.*m_member);
+                }
+
+            private:
+                const char* m_key;
+                size_t m_length;
+                V T::*m_member;
+                Schema m_schema;
+        };
+
+        // Unrolls the loops over the fields of a schema
+        template<size_t I, size_t N>
+        struct SchemaFields
+        {
+            template<typename Fields, typename T>
+            static void encode(const Fields& fields, SchemaWriter& writer, const T& value)
+            {
+                std::get<I>(fields).encode(writer, value);
+                SchemaFields<I + 1, N>::encode(fields, writer, value);
+            }
+
+            template<typename Fields, typename T>
+            static bool decode(const Fields& fields, SchemaReader& reader, T& value)
+            {
+                return std::get<I>(fields).decode(reader, value) ||
+                       SchemaFields<I + 1, N>::decode(fields, reader, value);
+            }
+
+            template<typename Fields, typename T>
+            static void decode(const Fields& fields, const OCRepresentation& rep, T& value)
+            {
+                std::get<I>(fields).decode(rep, value);
+                SchemaFields<I + 1, N>::decode(fields, rep, value);
+            }
+        };
+
+        template<size_t N>
+        struct SchemaFields<N, N>
+        {
+            template<typename Fields, typename T>
+            static void encode(const Fields&, SchemaWriter&, const T&)
+            {
+            }
+
+            template<typename Fields, typename T>
+            static bool decode(const Fields&, SchemaReader&, T&)
+            {
+                return false;
+            }
+
+            template<typename Fields, typename T>
+            static void decode(const Fields&, const OCRepresentation&, T&)
+            {
+            }
+        };
+    } // namespace OC::detail
+
+    /**
+     * Representation of a resource with a fixed shape, declared once as a struct and the
+     * attributes held by its members:
+     *
+     * @code
+     * struct Light
+     * {
+     *     bool state;
+     *     int power;
+     * };
+     *
+     * static const auto lightSchema = makeSchema<Light>(schemaField("state", &Light::state),
+     *                                                   schemaField("power", &Light::power));
+     * @endcode
+     *
+     * The keys and types of the attributes are known at compile time: a struct is encoded
+     * to CBOR and decoded from it without going through OCRepresentation, its AttributeValue
+     * variant or a lookup of the attributes by name. The encoding is the one of an
+     * OCRepresentation holding the same attributes.
+     *
+     * Attributes are int, double, bool, std::string, std::vector of those, or structs
+     * described by their own schema. When decoding, attributes the schema does not know are
+     * skipped and members of attributes missing from the representation are left unchanged.
+     */
+    template<typename T, typename... Fields>
+    class RepresentationSchema
+    {
+        public:
+            explicit RepresentationSchema(Fields... fields)
+                : m_fields(fields...)
+            {
+            }
+
+            /**
+             * Encodes a struct to CBOR.
+             *
+             * @return payload to release with OCPayloadDestroy.
+             * @throw std::logic_error if the struct could not be encoded.
+             */
+            OCEncodedPayload* encode(const T& value) const
+            {
+                SchemaWriter writer;
+                do
+                {
+                    writer.begin();
+                    encodeMap(writer, value);
+                }
+                while (writer.retry());
+                return writer.release();
+            }
+
+            /**
+             * Sets the representation sent by a response to the encoding of a struct. It
+             * replaces the representation set with OCResourceResponse::setResourceRepresentation
+             * and is sent as is, whatever the interface of the request.
+             */
+            void encode(const T& value, OCResourceResponse& response) const
+            {
+                response.m_encodedRepresentation.reset(encode(value), OCEncodedPayloadDestroy);
+            }
+
+            /**
+             * Decodes a struct from CBOR, such as the payload of a response received with
+             * PlatformConfig::encodedResponses.
+             *
+             * @throw OCException if the payload is malformed or does not match the schema.
+             */
+            void decode(const OCEncodedPayload* payload, T& value) const
+            {
+                if (payload)
+                {
+                    decode(payload->data, payload->size, value);
+                }
+            }
+
+            void decode(const uint8_t* data, size_t size, T& value) const
+            {
+                SchemaReader reader(data, size);
+                decodeMap(reader, value);
+            }
+
+            /**
+             * Reads a struct from a decoded representation, such as the one of a request. The
+             * attributes are looked up by name, with no CBOR to decode.
+             *
+             * @throw OCException if an attribute does not have the type of the schema.
+             */
+            void decode(const OCRepresentation& rep, T& value) const
+            {
+                detail::SchemaFields<0, sizeof...(Fields)>::decode(m_fields, rep, value);
+            }
+
+            void encodeMap(SchemaWriter& writer, const T& value) const
+            {
+                writer.beginMap(sizeof...(Fields));
+                detail::SchemaFields<0, sizeof...(Fields)>::encode(m_fields, writer, value);
+                writer.end();
+            }
+
+            void decodeMap(SchemaReader& reader, T& value) const
+            {
+                reader.enterMap();
+                while (!reader.atEnd())
+                {
+                    reader.readKey();
+                    if (!detail::SchemaFields<0, sizeof...(Fields)>::decode(m_fields, reader,
+                                                                             value))
+                    {
+                        reader.skip();
+                    }
+                }
+                reader.leave();
+            }
+
+        private:
+            std::tuple<Fields...> m_fields;
+    };
+
+    template<typename T, typename... Fields>
+    RepresentationSchema<T, Fields...> makeSchema(Fields... fields)
+    {
+        return RepresentationSchema<T, Fields...>(fields...);
+    }
+
+    /**
+     * Declares an attribute of a schema, held in a member of the struct.
+     */
+    template<typename T, typename V, size_t N>
+    detail::SchemaField<T, V> schemaField(const char (&key)[N], V T::*member)
+    {
+        return detail::SchemaField<T, V>(key, N - 1, member);
+    }
+
+    /**
+     * Declares an attribute of a schema holding a nested representation, described by the
+     * schema of the struct of its member.
+     */
+    template<typename T, typename V, size_t N, typename... Fields>
+    detail::SchemaObjectField<T, V, RepresentationSchema<V, Fields...>> schemaField(
+            const char (&key)[N], V T::*member, const RepresentationSchema<V, Fields...>& schema)
+    {
+        return detail::SchemaObjectField<T, V, RepresentationSchema<V, Fields...>>(key, N - 1,
+                member, schema);
+    }
+}
+
+#endif // OC_REPRESENTATION_SCHEMA_H_
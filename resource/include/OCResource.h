@@ -37,6 +37,7 @@
 #include <IClientWrapper.h>
 #include <InProcClientWrapper.h>
 #include <OCRepresentation.h>
+#include <OCFuture.h>
 
 namespace OC
 {
@@ -53,6 +54,7 @@ namespace OC
     class OCResourceIdentifier
     {
         friend class OCResource;
+        friend class ResourceCache;
         friend std::ostream& operator <<(std::ostream& os, const OCResourceIdentifier& ri);
 
         public:
@@ -80,11 +82,12 @@ namespace OC
 
         private:
 
-            OCResourceIdentifier(const std::string& wireServerIdentifier,
+            OCResourceIdentifier(std::shared_ptr<const std::string> wireServerIdentifier,
                     const std::string& resourceUri );
 
         private:
-            std::string m_representation;
+            // Shared by the resources of a server discovered together
+            std::shared_ptr<const std::string> m_representation;
             const std::string& m_resourceUri;
     };
 
@@ -100,6 +103,7 @@ namespace OC
     {
     friend class OCPlatform_impl;
     friend class ListenOCContainer;
+    friend class ResourceCache;
     public:
         typedef std::shared_ptr<OCResource> Ptr;
 
@@ -136,6 +140,19 @@ namespace OC
         OCStackResult get(const QueryParamsMap& queryParametersMap, GetCallback attributeHandler,
                           QualityOfService QoS);
 
+        /**
+        * Function to get the attributes of a resource, handing the callback the representation
+        * of the response without copying it.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param attributeHandler handles callback, which may keep the representation
+        * @param QoS the quality of communication
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        */
+        OCStackResult get(const QueryParamsMap& queryParametersMap,
+                          SharedGetCallback attributeHandler);
+        OCStackResult get(const QueryParamsMap& queryParametersMap,
+                          SharedGetCallback attributeHandler, QualityOfService QoS);
+
         /**
         * Function to get the attributes of a resource.
         *
@@ -244,6 +261,24 @@ namespace OC
                         const QueryParamsMap& queryParametersMap, PutCallback attributeHandler,
                         QualityOfService QoS);
 
+        /**
+        * Function to set the representation of a resource, handing the callback the
+        * representation of the response without copying it.
+        * @param representation which can either have all the attribute names and values
+        *        (which will represent entire state of the resource) or a
+        *        set of attribute names and values which needs to be modified
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param attributeHandler handles callback, which may keep the representation
+        * @param QoS the quality of communication
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        */
+        OCStackResult put(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap,
+                        SharedPutCallback attributeHandler);
+        OCStackResult put(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap,
+                        SharedPutCallback attributeHandler, QualityOfService QoS);
+
         /**
         * Function to set the attributes of a resource (via PUT)
         *
@@ -324,6 +359,24 @@ namespace OC
                         const QueryParamsMap& queryParametersMap, PostCallback attributeHandler,
                         QualityOfService QoS);
 
+        /**
+        * Function to post on a resource, handing the callback the representation of the
+        * response without copying it.
+        * @param representation which can either have all the attribute names and values
+        *        (which will represent entire state of the resource) or a
+        *        set of attribute names and values which needs to be modified
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param attributeHandler handles callback, which may keep the representation
+        * @param QoS the quality of communication
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        */
+        OCStackResult post(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap,
+                        SharedPostCallback attributeHandler);
+        OCStackResult post(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap,
+                        SharedPostCallback attributeHandler, QualityOfService QoS);
+
         /**
         * Function to post on a resource
         *
@@ -383,6 +436,34 @@ namespace OC
         OCStackResult deleteResource(DeleteCallback deleteHandler);
         OCStackResult deleteResource(DeleteCallback deleteHandler, QualityOfService QoS);
 
+        /**
+        * Variants of get, put, post and deleteResource returning the result of the request
+        * instead of passing it to a callback. The future is set by the callback executor of
+        * the platform, which runs the continuations attached with OCFuture::then; no thread
+        * waits for the response unless OCFuture::get is called.
+        *
+        * Cancelling the future cancels the request with OCCancel while no response came in
+        * yet, and sets its result to ::OC_STACK_REQUEST_CANCELLED, which is also the result
+        * of a request dropped by the stack without a response. Requests are combined with
+        * when_all.
+        *
+        * @throw OCException if the request can not be sent, as get, put, post and
+        *        deleteResource do.
+        */
+        OCFuture<RequestResult> getAsync(const QueryParamsMap& queryParametersMap);
+        OCFuture<RequestResult> getAsync(const QueryParamsMap& queryParametersMap,
+                        QualityOfService QoS);
+        OCFuture<RequestResult> putAsync(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap);
+        OCFuture<RequestResult> putAsync(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap, QualityOfService QoS);
+        OCFuture<RequestResult> postAsync(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap);
+        OCFuture<RequestResult> postAsync(const OCRepresentation& representation,
+                        const QueryParamsMap& queryParametersMap, QualityOfService QoS);
+        OCFuture<RequestResult> deleteResourceAsync();
+        OCFuture<RequestResult> deleteResourceAsync(QualityOfService QoS);
+
         /**
         * Function to set observation on the resource
         *
@@ -415,6 +496,21 @@ namespace OC
         OCStackResult observe(ObserveType observeType, const QueryParamsMap& queryParametersMap,
                         ObserveCallback observeHandler, QualityOfService qos);
 
+        /**
+        * Function to set observation on the resource, handing the callback the representation
+        * of each notification without copying it.
+        *
+        * @param observeType allows the client to specify how it wants to observe.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param observeHandler handles callback, which may keep the representation
+        * @param qos the quality of communication
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        */
+        OCStackResult observe(ObserveType observeType, const QueryParamsMap& queryParametersMap,
+                        SharedObserveCallback observeHandler);
+        OCStackResult observe(ObserveType observeType, const QueryParamsMap& queryParametersMap,
+                        SharedObserveCallback observeHandler, QualityOfService qos);
+
         /**
         * Function to cancel the observation on the resource
         *
@@ -518,6 +614,8 @@ namespace OC
 
     private:
         void setHost(const std::string& host);
+        OCFuture<RequestResult> requestAsync(OCMethod method, const OCRepresentation& rep,
+                        const QueryParamsMap& queryParametersMap, QualityOfService QoS);
         std::weak_ptr<IClientWrapper> m_clientWrapper;
         std::string m_uri;
         OCResourceIdentifier m_resourceId;
@@ -525,8 +623,9 @@ namespace OC
         bool m_useHostString;
         bool m_isObservable;
         bool m_isCollection;
-        std::vector<std::string> m_resourceTypes;
-        std::vector<std::string> m_interfaces;
+        // Immutable, and shared with the resources discovered with the same lists
+        std::shared_ptr<const std::vector<std::string>> m_resourceTypes;
+        std::shared_ptr<const std::vector<std::string>> m_interfaces;
         std::vector<std::string> m_children;
         OCDoHandle m_observeHandle;
         HeaderOptions m_headerOptions;
@@ -544,6 +643,12 @@ namespace OC
                     OCConnectivityType connectivityType, bool observable,
                     const std::vector<std::string>& resourceTypes,
                     const std::vector<std::string>& interfaces);
+
+        OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
+                    const OCDevAddr& devAddr, const std::string& uri,
+                    std::shared_ptr<const std::string> serverId, bool observable,
+                    std::shared_ptr<const std::vector<std::string>> resourceTypes,
+                    std::shared_ptr<const std::vector<std::string>> interfaces);
     };
 
 } // namespace OC
@@ -51,6 +51,7 @@ namespace OC
             m_headerOptions{},
             m_interface{},
             m_representation{},
+            m_encodedRepresentation{},
             m_requestHandle{nullptr},
             m_resourceHandle{nullptr},
             m_responseResult{}
@@ -132,6 +133,7 @@ namespace OC
         void setResourceRepresentation(OCRepresentation& rep, std::string interface) {
             m_interface = interface;
             m_representation = rep;
+            m_encodedRepresentation.reset();
         }
 
         /**
@@ -151,6 +153,7 @@ namespace OC
             // Call the default
             m_interface = DEFAULT_INTERFACE;
             m_representation = rep;
+            m_encodedRepresentation.reset();
         }
 
         /**
@@ -167,6 +170,8 @@ namespace OC
         HeaderOptions m_headerOptions;
         std::string m_interface;
         OCRepresentation m_representation;
+        // Set by RepresentationSchema::encode, sent instead of m_representation
+        std::shared_ptr<const OCEncodedPayload> m_encodedRepresentation;
         OCRequestHandle m_requestHandle;
         OCResourceHandle m_resourceHandle;
         OCEntityHandlerResult m_responseResult;
@@ -174,7 +179,15 @@ namespace OC
     private:
         friend class InProcServerWrapper;
 
-        OCRepPayload* getPayload() const
+        template<typename T, typename... Fields>
+        friend class RepresentationSchema;
+
+        const OCEncodedPayload* getEncodedRepresentation() const
+        {
+            return m_encodedRepresentation.get();
+        }
+
+        OCEncodedPayload* getPayload() const
         {
             MessageContainer inf;
             OCRepresentation first(m_representation);
@@ -215,7 +228,7 @@ namespace OC
 
             }
 
-            return inf.getPayload();
+            return inf.getEncodedPayload();
         }
     public:
 
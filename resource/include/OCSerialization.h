@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <StringConstants.h>
+#include <ResourceCache.h>
 #include "ocpayload.h"
 #include "ocrandom.h"
 #include "oic_string.h"
@@ -27,21 +28,9 @@ namespace OC
 {
     class ListenOCContainer
     {
-        private:
-            static std::vector<std::string> StringLLToVector(OCStringLL* ll)
-            {
-                std::vector<std::string> strs;
-                while(ll)
-                {
-                    strs.push_back(ll->value);
-                    ll = ll->next;
-                }
-                return strs;
-            }
-
         public:
             ListenOCContainer(std::weak_ptr<IClientWrapper> cw,
-                    OCDevAddr& devAddr, OCDiscoveryPayload* payload)
+                    OCDevAddr& devAddr, OCDiscoveryPayload* payload, ResourceCache& cache)
                     : m_clientWrapper(cw), m_devAddr(devAddr)
             {
                 OCResourcePayload* res = payload->resources;
@@ -70,25 +59,13 @@ namespace OC
                             OCDevAddr rdPubAddr = m_devAddr;
                             OICStrcpy(rdPubAddr.addr, sizeof(rdPubAddr.addr), payload->baseURI);
                             rdPubAddr.port = res->port;
-                            m_resources.push_back(std::shared_ptr<OC::OCResource>(
-                                        new OC::OCResource(m_clientWrapper, rdPubAddr,
-                                            std::string(res->uri),
-                                            std::string((char*)uuidString),
-                                            (res->bitmap & OC_OBSERVABLE) == OC_OBSERVABLE,
-                                            StringLLToVector(res->types),
-                                            StringLLToVector(res->interfaces)
-                                            )));
+                            m_resources.push_back(
+                                    cache.resource(m_clientWrapper, rdPubAddr, uuidString, res));
                         }
                         else
                         {
-                            m_resources.push_back(std::shared_ptr<OC::OCResource>(
-                                    new OC::OCResource(m_clientWrapper, m_devAddr,
-                                        std::string(res->uri),
-                                        std::string(uuidString),
-                                        (res->bitmap & OC_OBSERVABLE) == OC_OBSERVABLE,
-                                        StringLLToVector(res->types),
-                                        StringLLToVector(res->interfaces)
-                                        )));
+                            m_resources.push_back(
+                                    cache.resource(m_clientWrapper, m_devAddr, uuidString, res));
                         }
                         res = res->next;
                     }
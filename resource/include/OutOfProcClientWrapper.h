@@ -57,7 +57,7 @@ namespace OC
             const std::string& /*uri*/,
             const QueryParamsMap& /*queryParams*/,
             const HeaderOptions& /*headerOptions*/,
-            GetCallback& /*callback*/, QualityOfService /*QoS*/)
+            SharedGetCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
         virtual OCStackResult PutResourceRepresentation(
@@ -66,7 +66,7 @@ namespace OC
             const OCRepresentation& /*attributes*/,
             const QueryParamsMap& /*queryParams*/,
             const HeaderOptions& /*headerOptions*/,
-            PutCallback& /*callback*/,
+            SharedPutCallback& /*callback*/,
             QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
@@ -76,7 +76,7 @@ namespace OC
             const OCRepresentation& /*attributes*/,
             const QueryParamsMap& /*queryParams*/,
             const HeaderOptions& /*headerOptions*/,
-            PostCallback& /*callback*/, QualityOfService /*QoS*/)
+            SharedPostCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
         virtual OCStackResult DeleteResource(
@@ -86,13 +86,19 @@ namespace OC
             DeleteCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
+        virtual OCStackResult DoRequests(
+            const std::vector<BatchRequest>& /*requests*/,
+            std::vector<OCDoHandle>& /*handles*/,
+            QualityOfService /*QoS*/)
+            {return OC_STACK_NOTIMPL;}
+
         virtual OCStackResult ObserveResource(
             ObserveType /*observeType*/, OCDoHandle* /*handle*/,
             const OCDevAddr& /*devAddr*/,
             const std::string& /*uri*/,
             const QueryParamsMap& /*queryParams*/,
             const HeaderOptions& /*headerOptions*/,
-            ObserveCallback& /*callback*/, QualityOfService /*QoS*/)
+            SharedObserveCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
         virtual OCStackResult CancelObserveResource(
@@ -77,6 +77,14 @@ namespace OC
             return OC_STACK_ERROR;
         }
 
+        virtual OCStackResult setEntityHandlerConcurrency(
+            const OCResourceHandle& /*resourceHandle*/,
+            unsigned int /*limit*/)
+        {
+            //Not implemented yet
+            return OC_STACK_NOTIMPL;
+        }
+
        virtual OCStackResult bindTypeToResource(
            const OCResourceHandle& /*resourceHandle*/,
            const std::string& /*resourceTypeName*/)
@@ -0,0 +1,117 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the cache of the client holding the resources it
+ * discovered and the strings they share.
+ */
+
+#ifndef OC_RESOURCE_CACHE_H_
+#define OC_RESOURCE_CACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <OCResource.h>
+#include "ocpayload.h"
+
+namespace OC
+{
+    /**
+     * Builds the resources of discovery responses.
+     *
+     * The server IDs, resource type lists and interface lists of the resources are interned,
+     * so that the resources discovered with the same ones share a single copy. With
+     * PlatformConfig::cacheDiscoveredResources, a resource discovered again at the same host
+     * and URI is the resource discovered before, as long as the application holds it and
+     * the discovery response describes it the same way.
+     *
+     * The cache only holds weak references: a string or resource no longer used by the
+     * application is dropped from it.
+     */
+    class ResourceCache
+    {
+    public:
+        typedef std::shared_ptr<const std::vector<std::string>> StringList;
+
+        /**
+         * @param reuseResources   Return the resources discovered before, see
+         *                         PlatformConfig::cacheDiscoveredResources.
+         */
+        explicit ResourceCache(bool reuseResources);
+
+        ResourceCache(const ResourceCache&) = delete;
+        ResourceCache& operator=(const ResourceCache&) = delete;
+
+        /**
+         * Returns the resource described by a discovery response.
+         *
+         * @param clientWrapper   Client of the resource.
+         * @param devAddr         Address of the resource.
+         * @param sid             Server ID of the resource, as a string.
+         * @param resource        Resource of the discovery payload.
+         *
+         * @throw ResourceInitException if the resource has no URI, type or interface.
+         */
+        std::shared_ptr<OCResource> resource(const std::weak_ptr<IClientWrapper>& clientWrapper,
+                                             const OCDevAddr& devAddr, const char* sid,
+                                             const OCResourcePayload* resource);
+
+        std::shared_ptr<const std::string> intern(const char* value);
+
+        StringList intern(const OCStringLL* values);
+
+    private:
+        template <typename T>
+        using Table = std::unordered_map<std::string, std::weak_ptr<T>>;
+
+        template <typename T>
+        static void sweep(Table<T>& table, size_t& sweepAt);
+
+        static bool equals(const std::vector<std::string>& list, const OCStringLL* values);
+        static bool equals(const OCDevAddr& lhs, const OCDevAddr& rhs);
+        static bool matches(const OCResource& cached, const OCDevAddr& devAddr,
+                            const char* sid, const OCResourcePayload* resource);
+
+        std::shared_ptr<const std::string> internLocked(const char* value);
+        StringList internLocked(const OCStringLL* values);
+
+        bool m_reuseResources;
+        std::mutex m_mutex;
+
+        // Reused for the keys of the lookups, which then do not allocate
+        std::string m_internKey;
+        std::string m_resourceKey;
+
+        Table<const std::string> m_strings;
+        Table<const std::vector<std::string>> m_lists;
+        Table<OCResource> m_resources;
+        size_t m_stringsSweepAt;
+        size_t m_listsSweepAt;
+        size_t m_resourcesSweepAt;
+    };
+}
+
+#endif // OC_RESOURCE_CACHE_H_
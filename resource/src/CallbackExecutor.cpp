@@ -0,0 +1,166 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include <exception>
+
+namespace OC
+{
+    CallbackExecutor::CallbackExecutor(CallbackDispatch dispatch, unsigned int threads)
+        : m_dispatch(dispatch), m_queue(std::make_shared<Queue>())
+    {
+        if (m_dispatch == CallbackDispatch::Pool || m_dispatch == CallbackDispatch::Strand)
+        {
+            if (threads == 0)
+            {
+                threads = 1;
+            }
+            for (unsigned int i = 0; i < threads; ++i)
+            {
+                m_workers.push_back(std::thread(&CallbackExecutor::workerFunc, m_queue));
+            }
+        }
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queue->mutex);
+            m_queue->stop = true;
+        }
+        m_queue->cond.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            // A task may drop the last reference to the executor from a worker, which
+            // then finishes on its own.
+            if (worker.get_id() == std::this_thread::get_id())
+            {
+                worker.detach();
+            }
+            else if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    void CallbackExecutor::post(const void* strand, Task task)
+    {
+        switch (m_dispatch)
+        {
+            case CallbackDispatch::Thread:
+            {
+                std::thread exec(std::move(task));
+                exec.detach();
+                return;
+            }
+            case CallbackDispatch::Inline:
+                runTask(task);
+                return;
+            case CallbackDispatch::Pool:
+                strand = nullptr;
+                break;
+            case CallbackDispatch::Strand:
+                break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_queue->mutex);
+            if (!strand)
+            {
+                m_queue->ready.push_back(std::make_pair(strand, std::move(task)));
+            }
+            else
+            {
+                std::deque<Task>& tasks = m_queue->strands[strand];
+                tasks.push_back(std::move(task));
+                if (tasks.size() > 1)
+                {
+                    // The strand is already queued or running, it picks the task up
+                    return;
+                }
+                m_queue->ready.push_back(std::make_pair(strand, Task()));
+            }
+        }
+        m_queue->cond.notify_one();
+    }
+
+    void CallbackExecutor::workerFunc(std::shared_ptr<Queue> queue)
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        while (true)
+        {
+            queue->cond.wait(lock, [&queue]{ return queue->stop || !queue->ready.empty(); });
+            if (queue->ready.empty())
+            {
+                return;
+            }
+
+            std::pair<const void*, Task> work = std::move(queue->ready.front());
+            queue->ready.pop_front();
+
+            if (!work.first)
+            {
+                lock.unlock();
+                runTask(work.second);
+                lock.lock();
+                continue;
+            }
+
+            // The task stays first of its strand while it runs so that the tasks posted
+            // meanwhile wait for it.
+            auto strand = queue->strands.find(work.first);
+            Task task = std::move(strand->second.front());
+            lock.unlock();
+            runTask(task);
+            lock.lock();
+
+            strand = queue->strands.find(work.first);
+            strand->second.pop_front();
+            if (strand->second.empty())
+            {
+                queue->strands.erase(strand);
+            }
+            else
+            {
+                queue->ready.push_back(std::make_pair(work.first, Task()));
+                queue->cond.notify_one();
+            }
+        }
+    }
+
+    void CallbackExecutor::runTask(const Task& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (std::exception& e)
+        {
+            oclog() << "Exception in callback: " << e.what() << std::flush;
+        }
+        catch (...)
+        {
+            oclog() << "Unknown exception in callback" << std::flush;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "EntityHandlerPool.h"
+
+#include <vector>
+
+namespace OC
+{
+    EntityHandlerPool::EntityHandlerPool(unsigned int threads, unsigned int defaultLimit)
+        : m_defaultLimit(defaultLimit), m_executor(CallbackDispatch::Pool, threads)
+    {
+    }
+
+    void EntityHandlerPool::setLimit(OCResourceHandle resource, unsigned int limit)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limits[resource] = limit;
+    }
+
+    void EntityHandlerPool::resetLimit(OCResourceHandle resource)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limits.erase(resource);
+    }
+
+    unsigned int EntityHandlerPool::limit(OCResourceHandle resource) const
+    {
+        auto it = m_limits.find(resource);
+        return it != m_limits.end() ? it->second : m_defaultLimit;
+    }
+
+    void EntityHandlerPool::post(OCResourceHandle resource, Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Slot& slot = m_slots[resource];
+            unsigned int max = limit(resource);
+            if (max != 0 && slot.running >= max)
+            {
+                slot.pending.push_back(std::move(task));
+                return;
+            }
+            ++slot.running;
+        }
+        m_executor.post(nullptr, [this, resource, task]{ run(resource, task); });
+    }
+
+    void EntityHandlerPool::run(OCResourceHandle resource, const Task& task)
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            finish(resource);
+            throw;
+        }
+        finish(resource);
+    }
+
+    void EntityHandlerPool::finish(OCResourceHandle resource)
+    {
+        std::vector<Task> next;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_slots.find(resource);
+            Slot& slot = it->second;
+            --slot.running;
+
+            unsigned int max = limit(resource);
+            while (!slot.pending.empty() && (max == 0 || slot.running < max))
+            {
+                next.push_back(std::move(slot.pending.front()));
+                slot.pending.pop_front();
+                ++slot.running;
+            }
+            if (slot.running == 0)
+            {
+                m_slots.erase(it);
+            }
+        }
+
+        for (auto& task : next)
+        {
+            m_executor.post(nullptr, [this, resource, task]{ run(resource, task); });
+        }
+    }
+}
@@ -25,6 +25,8 @@
 #include "OCResource.h"
 #include "ocpayload.h"
 #include <OCSerialization.h>
+#include <ResourceCache.h>
+#include <array>
 using namespace std;
 
 namespace OC
@@ -32,7 +34,10 @@ namespace OC
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
-              m_cfg { cfg }
+              m_cfg { cfg },
+              m_executor(std::make_shared<CallbackExecutor>(cfg.callbackDispatch,
+                                                            cfg.callbackThreads)),
+              m_resourceCache(std::make_shared<ResourceCache>(cfg.cacheDiscoveredResources))
     {
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
@@ -79,7 +84,6 @@ namespace OC
             auto cLock = m_csdkLock.lock();
             if(cLock)
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
                 result = OCProcess();
             }
             else
@@ -97,39 +101,40 @@ namespace OC
         }
     }
 
-    OCRepresentation parseGetSetCallback(OCClientResponse* clientResponse)
+    std::shared_ptr<OCRepresentation> parseGetSetCallback(OCClientResponse* clientResponse)
     {
         if(clientResponse->payload == nullptr ||
                 (
                     clientResponse->payload->type != PAYLOAD_TYPE_DEVICE &&
                     clientResponse->payload->type != PAYLOAD_TYPE_PLATFORM &&
-                    clientResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION
+                    clientResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION &&
+                    clientResponse->payload->type != PAYLOAD_TYPE_ENCODED
                 )
           )
         {
             //OCPayloadDestroy(clientResponse->payload);
-            return OCRepresentation();
+            return std::make_shared<OCRepresentation>();
         }
 
         MessageContainer oc;
         oc.setPayload(clientResponse->payload);
         //OCPayloadDestroy(clientResponse->payload);
 
-        std::vector<OCRepresentation>::const_iterator it = oc.representations().begin();
-        if(it == oc.representations().end())
+        // The representations are moved from here on, the response is materialized once
+        std::vector<OCRepresentation> reps = oc.releaseRepresentations();
+        if(reps.empty())
         {
-            return OCRepresentation();
+            return std::make_shared<OCRepresentation>();
         }
 
         // first one is considered the root, everything else is considered a child of this one.
-        OCRepresentation root = *it;
-        root.setDevAddr(clientResponse->devAddr);
-        root.setUri(clientResponse->resourceUri);
-        ++it;
-
-        std::for_each(it, oc.representations().end(),
-                [&root](const OCRepresentation& repItr)
-                {root.addChild(repItr);});
+        auto root = std::make_shared<OCRepresentation>(std::move(reps.front()));
+        root->setDevAddr(clientResponse->devAddr);
+        root->setUri(clientResponse->resourceUri);
+
+        std::for_each(reps.begin() + 1, reps.end(),
+                [&root](OCRepresentation& repItr)
+                {root->addChild(std::move(repItr));});
         return root;
 
     }
@@ -174,12 +179,12 @@ namespace OC
         }
 
         ListenOCContainer container(clientWrapper, clientResponse->devAddr,
-                                reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
+                                reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload),
+                                *context->cache);
         // loop to ensure valid construction of all resources
         for(auto resource : container.Resources())
         {
-            std::thread exec(context->callback, resource);
-            exec.detach();
+            context->executor->post(context, std::bind(context->callback, resource));
         }
 
 
@@ -202,7 +207,8 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenContext* context =
-            new ClientCallbackContext::ListenContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenContext(callback, shared_from_this(), m_executor,
+                                                     m_resourceCache);
         OCCallbackData cbdata(
                 static_cast<void*>(context),
                 listenCallback,
@@ -212,7 +218,6 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   resourceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -237,9 +242,9 @@ namespace OC
 
         try
         {
-            OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            std::shared_ptr<const OCRepresentation> rep = parseGetSetCallback(clientResponse);
+            FindDeviceCallback callback = context->callback;
+            context->executor->post(context, [callback, rep]{ callback(*rep); });
         }
         catch(OC::OCException& e)
         {
@@ -266,7 +271,8 @@ namespace OC
         deviceUri << serviceUrl << deviceURI;
 
         ClientCallbackContext::DeviceListenContext* context =
-            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this(),
+                                                           m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(context),
                 listenDeviceCallback,
@@ -276,7 +282,6 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   deviceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -318,14 +323,25 @@ namespace OC
         }
     }
 
+    // Marks a request completed before the stack frees its handle, see PendingRequest
+    static void completeRequest(const std::shared_ptr<PendingRequest>& pending)
+    {
+        if (pending)
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->completed = true;
+        }
+    }
+
     OCStackApplicationResult getResourceCallback(void* ctx,
                                                  OCDoHandle /*handle*/,
         OCClientResponse* clientResponse)
     {
         ClientCallbackContext::GetContext* context =
             static_cast<ClientCallbackContext::GetContext*>(ctx);
+        completeRequest(context->pending);
 
-        OCRepresentation rep;
+        std::shared_ptr<const OCRepresentation> rep;
         HeaderOptions serverHeaderOptions;
         OCStackResult result = clientResponse->result;
         if(result == OC_STACK_OK)
@@ -340,9 +356,13 @@ namespace OC
                 result = e.code();
             }
         }
+        if(!rep)
+        {
+            rep = std::make_shared<const OCRepresentation>();
+        }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        context->executor->post(context, std::bind(context->callback,
+                    std::move(serverHeaderOptions), std::move(rep), result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -350,7 +370,7 @@ namespace OC
         const OCDevAddr& devAddr,
         const std::string& resourceUri,
         const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
-        GetCallback& callback, QualityOfService QoS)
+        SharedGetCallback& callback, QualityOfService QoS)
     {
         if(!callback)
         {
@@ -358,7 +378,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
-            new ClientCallbackContext::GetContext(callback);
+            new ClientCallbackContext::GetContext(callback, m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 getResourceCallback,
@@ -371,18 +391,18 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(
-                                  nullptr, OC_REST_GET,
-                                  uri.c_str(),
-                                  &devAddr, nullptr,
-                                  CT_DEFAULT,
-                                  static_cast<OCQualityOfService>(QoS),
-                                  &cbdata,
-                                  assembleHeaderOptions(options, headerOptions),
-                                  headerOptions.size());
+            result = OCDoResourceWithParseMode(
+                                               nullptr, OC_REST_GET,
+                                               uri.c_str(),
+                                               &devAddr, nullptr,
+                                               CT_DEFAULT,
+                                               static_cast<OCQualityOfService>(QoS),
+                                               &cbdata,
+                                               assembleHeaderOptions(options, headerOptions),
+                                               headerOptions.size(),
+                                               responseParseMode());
         }
         else
         {
@@ -399,7 +419,8 @@ namespace OC
     {
         ClientCallbackContext::SetContext* context =
             static_cast<ClientCallbackContext::SetContext*>(ctx);
-        OCRepresentation attrs;
+        completeRequest(context->pending);
+        std::shared_ptr<const OCRepresentation> attrs;
         HeaderOptions serverHeaderOptions;
 
         OCStackResult result = clientResponse->result;
@@ -417,9 +438,13 @@ namespace OC
                 result = e.code();
             }
         }
+        if(!attrs)
+        {
+            attrs = std::make_shared<const OCRepresentation>();
+        }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        context->executor->post(context, std::bind(context->callback,
+                    std::move(serverHeaderOptions), std::move(attrs), result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -456,7 +481,7 @@ namespace OC
     {
         MessageContainer ocInfo;
         ocInfo.addRepresentation(rep);
-        return reinterpret_cast<OCPayload*>(ocInfo.getPayload());
+        return reinterpret_cast<OCPayload*>(ocInfo.getEncodedPayload());
     }
 
     OCStackResult InProcClientWrapper::PostResourceRepresentation(
@@ -464,14 +489,15 @@ namespace OC
         const std::string& uri,
         const OCRepresentation& rep,
         const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
-        PostCallback& callback, QualityOfService QoS)
+        SharedPostCallback& callback, QualityOfService QoS)
     {
         if(!callback)
         {
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -484,17 +510,17 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(nullptr, OC_REST_POST,
-                                  url.c_str(), &devAddr,
-                                  assembleSetResourcePayload(rep),
-                                  CT_DEFAULT,
-                                  static_cast<OCQualityOfService>(QoS),
-                                  &cbdata,
-                                  assembleHeaderOptions(options, headerOptions),
-                                  headerOptions.size());
+            result = OCDoResourceWithParseMode(nullptr, OC_REST_POST,
+                                               url.c_str(), &devAddr,
+                                               assembleSetResourcePayload(rep),
+                                               CT_DEFAULT,
+                                               static_cast<OCQualityOfService>(QoS),
+                                               &cbdata,
+                                               assembleHeaderOptions(options, headerOptions),
+                                               headerOptions.size(),
+                                               responseParseMode());
         }
         else
         {
@@ -510,14 +536,15 @@ namespace OC
         const std::string& uri,
         const OCRepresentation& rep,
         const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
-        PutCallback& callback, QualityOfService QoS)
+        SharedPutCallback& callback, QualityOfService QoS)
     {
         if(!callback)
         {
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -530,18 +557,18 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCDoHandle handle;
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(&handle, OC_REST_PUT,
-                                  url.c_str(), &devAddr,
-                                  assembleSetResourcePayload(rep),
-                                  CT_DEFAULT,
-                                  static_cast<OCQualityOfService>(QoS),
-                                  &cbdata,
-                                  assembleHeaderOptions(options, headerOptions),
-                                  headerOptions.size());
+            result = OCDoResourceWithParseMode(&handle, OC_REST_PUT,
+                                               url.c_str(), &devAddr,
+                                               assembleSetResourcePayload(rep),
+                                               CT_DEFAULT,
+                                               static_cast<OCQualityOfService>(QoS),
+                                               &cbdata,
+                                               assembleHeaderOptions(options, headerOptions),
+                                               headerOptions.size(),
+                                               responseParseMode());
         }
         else
         {
@@ -558,14 +585,15 @@ namespace OC
     {
         ClientCallbackContext::DeleteContext* context =
             static_cast<ClientCallbackContext::DeleteContext*>(ctx);
+        completeRequest(context->pending);
         HeaderOptions serverHeaderOptions;
 
         if(clientResponse->result == OC_STACK_OK)
         {
             parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         }
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        context->executor->post(context,
+                std::bind(context->callback, serverHeaderOptions, clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -582,7 +610,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
-            new ClientCallbackContext::DeleteContext(callback);
+            new ClientCallbackContext::DeleteContext(callback, m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 deleteResourceCallback,
@@ -595,16 +623,16 @@ namespace OC
         {
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
 
-            result = OCDoResource(nullptr, OC_REST_DELETE,
-                                  uri.c_str(), &devAddr,
-                                  nullptr,
-                                  CT_DEFAULT,
-                                  static_cast<OCQualityOfService>(m_cfg.QoS),
-                                  &cbdata,
-                                  assembleHeaderOptions(options, headerOptions),
-                                  headerOptions.size());
+            result = OCDoResourceWithParseMode(nullptr, OC_REST_DELETE,
+                                               uri.c_str(), &devAddr,
+                                               nullptr,
+                                               CT_DEFAULT,
+                                               static_cast<OCQualityOfService>(m_cfg.QoS),
+                                               &cbdata,
+                                               assembleHeaderOptions(options, headerOptions),
+                                               headerOptions.size(),
+                                               responseParseMode());
         }
         else
         {
@@ -615,13 +643,136 @@ namespace OC
         return result;
     }
 
+    static SharedGetCallback requestCallback(const BatchRequest& request)
+    {
+        if (request.sharedCallback)
+        {
+            return request.sharedCallback;
+        }
+        return shareRepresentation(request.callback);
+    }
+
+    OCStackResult InProcClientWrapper::DoRequests(
+        const std::vector<BatchRequest>& requests,
+        std::vector<OCDoHandle>& handles,
+        QualityOfService QoS)
+    {
+        handles.assign(requests.size(), nullptr);
+        if (requests.empty())
+        {
+            return OC_STACK_OK;
+        }
+
+        for (auto& request : requests)
+        {
+            if ((!request.callback && !request.sharedCallback) ||
+                request.headerOptions.size() > MAX_HEADER_OPTIONS)
+            {
+                return OC_STACK_INVALID_PARAM;
+            }
+            if (request.method != OC_REST_GET && request.method != OC_REST_PUT &&
+                request.method != OC_REST_POST && request.method != OC_REST_DELETE)
+            {
+                return OC_STACK_INVALID_METHOD;
+            }
+        }
+
+        // The C stack keeps no pointer into these once OCDoResources returns
+        std::vector<OCDoResourceRequest> ocRequests(requests.size());
+        std::vector<std::string> uris;
+        std::vector<std::array<OCHeaderOption, MAX_HEADER_OPTIONS>> options(requests.size());
+        uris.reserve(requests.size());
+
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            const BatchRequest& request = requests[i];
+            OCDoResourceRequest& ocRequest = ocRequests[i];
+
+            if (request.method == OC_REST_DELETE)
+            {
+                uris.push_back(request.uri);
+                SharedGetCallback callback = requestCallback(request);
+                DeleteCallback deleteCallback =
+                    [callback](const HeaderOptions& headerOptions, const int eCode)
+                    {
+                        callback(headerOptions, std::make_shared<const OCRepresentation>(),
+                                 eCode);
+                    };
+                ocRequest.cbData = OCCallbackData(
+                        new ClientCallbackContext::DeleteContext(deleteCallback, m_executor,
+                                                                 request.pending),
+                        deleteResourceCallback,
+                        [](void* c){delete static_cast<ClientCallbackContext::DeleteContext*>(c);}
+                        );
+            }
+            else if (request.method == OC_REST_GET)
+            {
+                uris.push_back(assembleSetResourceUri(request.uri, request.queryParams));
+                ocRequest.cbData = OCCallbackData(
+                        new ClientCallbackContext::GetContext(
+                            requestCallback(request), m_executor, request.pending),
+                        getResourceCallback,
+                        [](void* c){delete static_cast<ClientCallbackContext::GetContext*>(c);}
+                        );
+            }
+            else
+            {
+                uris.push_back(assembleSetResourceUri(request.uri, request.queryParams));
+                ocRequest.payload = assembleSetResourcePayload(request.rep);
+                ocRequest.cbData = OCCallbackData(
+                        new ClientCallbackContext::SetContext(
+                            requestCallback(request), m_executor, request.pending),
+                        setResourceCallback,
+                        [](void* c){delete static_cast<ClientCallbackContext::SetContext*>(c);}
+                        );
+            }
+
+            ocRequest.method = request.method;
+            ocRequest.requestUri = uris.back().c_str();
+            ocRequest.destination = &request.devAddr;
+            ocRequest.connectivityType = CT_DEFAULT;
+            ocRequest.qos = static_cast<OCQualityOfService>(QoS);
+            ocRequest.options = assembleHeaderOptions(options[i].data(), request.headerOptions);
+            ocRequest.numOptions = request.headerOptions.size();
+            ocRequest.parseMode = responseParseMode();
+        }
+
+        OCStackResult result;
+        auto cLock = m_csdkLock.lock();
+
+        if(cLock)
+        {
+            result = OCDoResources(ocRequests.data(), ocRequests.size());
+        }
+        else
+        {
+            for (auto& ocRequest : ocRequests)
+            {
+                OCPayloadDestroy(ocRequest.payload);
+                ocRequest.cbData.cd(ocRequest.cbData.context);
+            }
+            return OC_STACK_ERROR;
+        }
+
+        for (size_t i = 0; i < ocRequests.size(); ++i)
+        {
+            handles[i] = ocRequests[i].handle;
+            if (requests[i].pending)
+            {
+                std::lock_guard<std::mutex> lock(requests[i].pending->mutex);
+                requests[i].pending->handle = handles[i];
+            }
+        }
+        return result;
+    }
+
     OCStackApplicationResult observeResourceCallback(void* ctx,
                                                      OCDoHandle /*handle*/,
         OCClientResponse* clientResponse)
     {
         ClientCallbackContext::ObserveContext* context =
             static_cast<ClientCallbackContext::ObserveContext*>(ctx);
-        OCRepresentation attrs;
+        std::shared_ptr<const OCRepresentation> attrs;
         HeaderOptions serverHeaderOptions;
         uint32_t sequenceNumber = clientResponse->sequenceNumber;
         OCStackResult result = clientResponse->result;
@@ -637,9 +788,12 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        if(!attrs)
+        {
+            attrs = std::make_shared<const OCRepresentation>();
+        }
+        context->executor->post(context, std::bind(context->callback,
+                    std::move(serverHeaderOptions), std::move(attrs), result, sequenceNumber));
         if(sequenceNumber == OC_OBSERVE_DEREGISTER)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -651,7 +805,7 @@ namespace OC
         const OCDevAddr& devAddr,
         const std::string& uri,
         const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
-        ObserveCallback& callback, QualityOfService QoS)
+        SharedObserveCallback& callback, QualityOfService QoS)
     {
         if(!callback)
         {
@@ -660,7 +814,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 observeResourceCallback,
@@ -687,17 +841,17 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(handle, method,
-                                  url.c_str(), &devAddr,
-                                  nullptr,
-                                  CT_DEFAULT,
-                                  static_cast<OCQualityOfService>(QoS),
-                                  &cbdata,
-                                  assembleHeaderOptions(options, headerOptions),
-                                  headerOptions.size());
+            result = OCDoResourceWithParseMode(handle, method,
+                                               url.c_str(), &devAddr,
+                                               nullptr,
+                                               CT_DEFAULT,
+                                               static_cast<OCQualityOfService>(QoS),
+                                               &cbdata,
+                                               assembleHeaderOptions(options, headerOptions),
+                                               headerOptions.size(),
+                                               responseParseMode());
         }
         else
         {
@@ -720,7 +874,6 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
             result = OCCancel(handle,
@@ -748,10 +901,8 @@ namespace OC
          */
         std::string url = clientResponse->devAddr.addr;
 
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        context->executor->post(context, std::bind(context->callback, clientResponse->result,
+                    clientResponse->sequenceNumber, url));
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -766,7 +917,7 @@ namespace OC
         }
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
-            new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+            new ClientCallbackContext::SubscribePresenceContext(presenceHandler, m_executor);
         OCCallbackData cbdata(
                 static_cast<void*>(ctx),
                 subscribePresenceCallback,
@@ -803,7 +954,6 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCCancel(handle, OC_LOW_QOS, NULL, 0);
         }
         else
@@ -841,4 +991,9 @@ namespace OC
 
         return options;
     }
+
+    OCPayloadParseMode InProcClientWrapper::responseParseMode() const
+    {
+        return m_cfg.encodedResponses ? OC_PAYLOAD_PARSE_ENCODED : OC_PAYLOAD_PARSE_DEFAULT;
+    }
 }
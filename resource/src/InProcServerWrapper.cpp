@@ -28,10 +28,12 @@
 #include <string>
 
 #include <InProcServerWrapper.h>
+#include <EntityHandlerPool.h>
 #include <InitializeException.h>
 #include <OCResourceRequest.h>
 #include <OCResourceResponse.h>
 #include <ocstack.h>
+#include <ocpayload.h>
 #include <OCApi.h>
 #include <oic_malloc.h>
 #include <OCPlatform.h>
@@ -139,10 +141,49 @@ void formResourceRequest(OCEntityHandlerFlag flag,
     }
 }
 
+// Runs an entity handler on the pool of PlatformConfig::entityHandlerThreads instead of the
+// thread processing the stack. The stack keeps the request as slow until the handler answers
+// it with sendResponse; an error returned by the handler is sent for it. Any other result is
+// dropped, the stack only saw OC_EH_SLOW: a handler deleting its resource unregisters it.
+static OCEntityHandlerResult postEntityHandler(void* pool, OCResourceHandle resource,
+                                               EntityHandler handler,
+                                               std::shared_ptr<OCResourceRequest> pRequest)
+{
+    static_cast<EntityHandlerPool*>(pool)->post(resource, [handler, pRequest]
+        {
+            OCEntityHandlerResult result = OC_EH_ERROR;
+            try
+            {
+                result = handler(pRequest);
+            }
+            catch (std::exception& e)
+            {
+                oclog() << "Exception in entity handler: " << e.what() << std::flush;
+            }
+            catch (...)
+            {
+                oclog() << "Unknown exception in entity handler" << std::flush;
+            }
+
+            if (result != OC_EH_ERROR && result != OC_EH_FORBIDDEN &&
+                result != OC_EH_RESOURCE_NOT_FOUND)
+            {
+                return;
+            }
+
+            auto pResponse = std::make_shared<OCResourceResponse>();
+            pResponse->setRequestHandle(pRequest->getRequestHandle());
+            pResponse->setResourceHandle(pRequest->getResourceHandle());
+            pResponse->setResponseResult(result);
+            OCPlatform::sendResponse(pResponse);
+        });
+    return OC_EH_SLOW;
+}
+
 OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
                                                   OCEntityHandlerRequest * entityHandlerRequest,
                                                   char* uri,
-                                                  void * /*callbackParam*/)
+                                                  void * callbackParam)
 {
     OCEntityHandlerResult result = OC_EH_ERROR;
 
@@ -166,7 +207,11 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
         defHandler = OC::details::defaultDeviceEntityHandler;
     }
 
-    if(defHandler)
+    if(defHandler && callbackParam)
+    {
+        result = postEntityHandler(callbackParam, nullptr, defHandler, pRequest);
+    }
+    else if(defHandler)
     {
         result = defHandler(pRequest);
     }
@@ -182,7 +227,7 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
 
 OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
                                            OCEntityHandlerRequest * entityHandlerRequest,
-                                           void* /*callbackParam*/)
+                                           void* callbackParam)
 {
     OCEntityHandlerResult result = OC_EH_ERROR;
 
@@ -228,7 +273,12 @@ OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
     if(entityHandlerEntry != entityHandlerEnd)
     {
         // Call CPP Application Entity Handler
-        if(entityHandlerEntry->second)
+        if(entityHandlerEntry->second && callbackParam)
+        {
+            result = postEntityHandler(callbackParam, entityHandlerRequest->resource,
+                                       entityHandlerEntry->second, pRequest);
+        }
+        else if(entityHandlerEntry->second)
         {
             result = entityHandlerEntry->second(pRequest);
         }
@@ -284,6 +334,12 @@ namespace OC
             throw InitializeException(OC::InitException::STACK_INIT_ERROR, result);
         }
 
+        if(cfg.entityHandlerThreads > 0)
+        {
+            m_handlerPool.reset(new EntityHandlerPool(cfg.entityHandlerThreads,
+                                                      cfg.entityHandlerConcurrency));
+        }
+
         m_threadRun = true;
         m_processThread = std::thread(&InProcServerWrapper::processFunc, this);
     }
@@ -293,12 +349,9 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         while(cLock && m_threadRun)
         {
-            OCStackResult result;
-
-            {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
-                result = OCProcess();
-            }
+            // The C stack serializes its callers itself, applications keep calling it while
+            // OCProcess runs.
+            OCStackResult result = OCProcess();
 
             if(OC_STACK_ERROR == result)
             {
@@ -316,7 +369,6 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCSetDeviceInfo(deviceInfo);
         }
         return result;
@@ -328,7 +380,6 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCSetPlatformInfo(platformInfo);
         }
         return result;
@@ -349,7 +400,6 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
 
             if(NULL != eHandler)
             {
@@ -358,7 +408,7 @@ namespace OC
                             resourceInterface.c_str(), //const char * resourceInterfaceName //TODO fix this
                             resourceURI.c_str(), // const char * uri
                             EntityHandlerWrapper, // OCEntityHandler entityHandler
-                            NULL,
+                            m_handlerPool.get(),
                             resourceProperties // uint8_t resourceProperties
                             );
             }
@@ -407,7 +457,8 @@ namespace OC
 
         if(entityHandler)
         {
-            result = OCSetDefaultDeviceEntityHandler(DefaultEntityHandlerWrapper, NULL);
+            result = OCSetDefaultDeviceEntityHandler(DefaultEntityHandlerWrapper,
+                                                     m_handlerPool.get());
         }
         else
         {
@@ -425,13 +476,19 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCDeleteResource(resourceHandle);
 
             if(result == OC_STACK_OK)
             {
-                std::lock_guard<std::mutex> lock(OC::details::serverWrapperLock);
-                OC::details::resourceUriMap.erase(resourceHandle);
+                {
+                    std::lock_guard<std::mutex> lock(OC::details::serverWrapperLock);
+                    OC::details::resourceUriMap.erase(resourceHandle);
+                }
+
+                if(m_handlerPool)
+                {
+                    m_handlerPool->resetLimit(resourceHandle);
+                }
             }
             else
             {
@@ -446,6 +503,18 @@ namespace OC
         return result;
     }
 
+    OCStackResult InProcServerWrapper::setEntityHandlerConcurrency(
+                     const OCResourceHandle& resourceHandle, unsigned int limit)
+    {
+        if(!m_handlerPool || !resourceHandle)
+        {
+            return OC_STACK_INVALID_PARAM;
+        }
+
+        m_handlerPool->setLimit(resourceHandle, limit);
+        return OC_STACK_OK;
+    }
+
     OCStackResult InProcServerWrapper::bindTypeToResource(const OCResourceHandle& resourceHandle,
                      const std::string& resourceTypeName)
     {
@@ -453,7 +522,6 @@ namespace OC
         OCStackResult result;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCBindResourceTypeToResource(resourceHandle, resourceTypeName.c_str());
         }
         else
@@ -476,7 +544,6 @@ namespace OC
         OCStackResult result;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCBindResourceInterfaceToResource(resourceHandle,
                         resourceInterfaceName.c_str());
         }
@@ -498,7 +565,6 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCStartPresence(seconds);
         }
 
@@ -515,7 +581,6 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCStopPresence();
         }
 
@@ -547,7 +612,19 @@ namespace OC
             response.resourceHandle = pResponse->getResourceHandle();
             response.ehResult = pResponse->getResponseResult();
 
-            response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            // The stack copies the payload, it may replace response.payload while doing so.
+            // A representation encoded by a schema is only read, and kept by the response.
+            OCPayload* payload = nullptr;
+            if (pResponse->getEncodedRepresentation())
+            {
+                response.payload = reinterpret_cast<OCPayload*>(
+                        const_cast<OCEncodedPayload*>(pResponse->getEncodedRepresentation()));
+            }
+            else
+            {
+                payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+                response.payload = payload;
+            }
 
             response.persistentBufferFlag = 0;
 
@@ -578,14 +655,13 @@ namespace OC
 
             if(cLock)
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
                 result = OCDoResponse(&response);
             }
             else
             {
-                OICFree(response.payload);
                 result = OC_STACK_ERROR;
             }
+            OCPayloadDestroy(payload);
 
             if(result != OC_STACK_OK)
             {
@@ -603,6 +679,9 @@ namespace OC
             m_processThread.join();
         }
 
+        // The handlers still queued answer their requests before the stack stops
+        m_handlerPool.reset();
+
         OCStop();
     }
 }
@@ -105,6 +105,8 @@ std::string OC::OCException::reason(const OCStackResult sr)
             return OC::Exception::INCONSISTENT_DB;
         case OC_STACK_AUTHENTICATION_FAILURE:
             return OC::Exception::AUTHENTICATION_FAILURE;
+        case OC_STACK_REQUEST_CANCELLED:
+            return OC::Exception::REQUEST_CANCELLED;
     }
 
     return OC::Exception::UNKNOWN_ERROR;
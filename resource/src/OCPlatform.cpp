@@ -70,6 +70,21 @@ namespace OC
                                                     observationIds, pResponse, QoS);
         }
 
+        OCStackResult notifyListOfObservers(OCResourceHandle resourceHandle,
+                                                const ObserverNotifications& notifications)
+        {
+            return OCPlatform_impl::Instance().notifyListOfObservers(resourceHandle,
+                                                    notifications);
+        }
+
+        OCStackResult notifyListOfObservers(OCResourceHandle resourceHandle,
+                                                const ObserverNotifications& notifications,
+                                                QualityOfService QoS)
+        {
+            return OCPlatform_impl::Instance().notifyListOfObservers(resourceHandle,
+                                                    notifications, QoS);
+        }
+
         OCResource::Ptr constructResourceObject(const std::string& host,
                                                 const std::string& uri,
                                                 OCConnectivityType connectivityType,
@@ -140,6 +155,19 @@ namespace OC
                     platformInfoHandler, QoS);
         }
 
+        OCStackResult sendRequests(const std::vector<BatchRequest>& requests,
+                                   std::vector<OCDoHandle>& handles)
+        {
+            return OCPlatform_impl::Instance().sendRequests(requests, handles);
+        }
+
+        OCStackResult sendRequests(const std::vector<BatchRequest>& requests,
+                                   std::vector<OCDoHandle>& handles,
+                                   QualityOfService QoS)
+        {
+            return OCPlatform_impl::Instance().sendRequests(requests, handles, QoS);
+        }
+
         OCStackResult registerResource(OCResourceHandle& resourceHandle,
                                                 std::string& resourceURI,
                                                 const std::string& resourceTypeName,
@@ -173,6 +201,13 @@ namespace OC
             return OCPlatform_impl::Instance().unregisterResource(resourceHandle);
         }
 
+        OCStackResult setEntityHandlerConcurrency(const OCResourceHandle& resourceHandle,
+                                                  unsigned int limit)
+        {
+            return OCPlatform_impl::Instance().setEntityHandlerConcurrency(resourceHandle,
+                                                                           limit);
+        }
+
         OCStackResult unbindResource(OCResourceHandle collectionHandle,
                                                 OCResourceHandle resourceHandle)
         {
@@ -35,6 +35,7 @@
 #include <random>
 #include <utility>
 #include <functional>
+#include <unordered_map>
 
 #include "ocstack.h"
 
@@ -144,6 +145,55 @@ namespace OC
         return result_guard(result);
     }
 
+    OCStackResult OCPlatform_impl::notifyListOfObservers(OCResourceHandle resourceHandle,
+                                       const ObserverNotifications& notifications)
+    {
+        return notifyListOfObservers(resourceHandle, notifications, m_cfg.QoS);
+    }
+
+    OCStackResult OCPlatform_impl::notifyListOfObservers(OCResourceHandle resourceHandle,
+                                       const ObserverNotifications& notifications,
+                                       QualityOfService QoS)
+    {
+        if (notifications.empty() || notifications.size() > UINT8_MAX)
+        {
+            return result_guard(OC_STACK_INVALID_PARAM);
+        }
+
+        typedef std::unique_ptr<OCEncodedPayload, decltype(&OCEncodedPayloadDestroy)> Encoded;
+        std::vector<Encoded> encoded;
+        std::unordered_map<const OCRepresentation*, const OCPayload*> encodings;
+        ObservationIds observationIds;
+        std::vector<const OCPayload*> payloads;
+        observationIds.reserve(notifications.size());
+        payloads.reserve(notifications.size());
+
+        // Each distinct representation is encoded once, the stack sends its encoding as is
+        for (const auto& notification : notifications)
+        {
+            if (!notification.second)
+            {
+                return result_guard(OC_STACK_INVALID_PARAM);
+            }
+
+            const OCPayload*& payload = encodings[notification.second.get()];
+            if (!payload)
+            {
+                MessageContainer container;
+                container.addRepresentation(*notification.second);
+                encoded.emplace_back(container.getEncodedPayload(), OCEncodedPayloadDestroy);
+                payload = reinterpret_cast<const OCPayload*>(encoded.back().get());
+            }
+            observationIds.push_back(notification.first);
+            payloads.push_back(payload);
+        }
+
+        return result_guard(OCNotifyListOfObserversWithPayloads(resourceHandle,
+                                &observationIds[0], &payloads[0],
+                                static_cast<uint8_t>(observationIds.size()),
+                                static_cast<OCQualityOfService>(QoS)));
+    }
+
     OCResource::Ptr OCPlatform_impl::constructResourceObject(const std::string& host,
                                                 const std::string& uri,
                                                 OCConnectivityType connectivityType,
@@ -220,6 +270,19 @@ namespace OC
                              host, platformURI, connectivityType, platformInfoHandler, QoS);
     }
 
+    OCStackResult OCPlatform_impl::sendRequests(const std::vector<BatchRequest>& requests,
+                                            std::vector<OCDoHandle>& handles)
+    {
+        return result_guard(sendRequests(requests, handles, m_cfg.QoS));
+    }
+
+    OCStackResult OCPlatform_impl::sendRequests(const std::vector<BatchRequest>& requests,
+                                            std::vector<OCDoHandle>& handles,
+                                            QualityOfService QoS)
+    {
+        return checked_guard(m_client, &IClientWrapper::DoRequests, requests, handles, QoS);
+    }
+
     OCStackResult OCPlatform_impl::registerResource(OCResourceHandle& resourceHandle,
                                             std::string& resourceURI,
                                             const std::string& resourceTypeName,
@@ -260,6 +323,14 @@ namespace OC
                              resourceHandle);
     }
 
+    OCStackResult OCPlatform_impl::setEntityHandlerConcurrency(
+                                            const OCResourceHandle& resourceHandle,
+                                            unsigned int limit) const
+    {
+        return checked_guard(m_server, &IServerWrapper::setEntityHandlerConcurrency,
+                             resourceHandle, limit);
+    }
+
     OCStackResult OCPlatform_impl::unbindResource(OCResourceHandle collectionHandle,
                                             OCResourceHandle resourceHandle)
     {
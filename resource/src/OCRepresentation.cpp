@@ -59,6 +59,9 @@ namespace OC
             case PAYLOAD_TYPE_PLATFORM:
                 setPayload(reinterpret_cast<const OCPlatformPayload*>(rep));
                 break;
+            case PAYLOAD_TYPE_ENCODED:
+                setPayload(reinterpret_cast<const OCEncodedPayload*>(rep));
+                break;
             default:
                 throw OC::OCException("Invalid Payload type in setPayload");
                 break;
@@ -148,7 +151,7 @@ namespace OC
             cur.setPayload(pl);
 
             pl = pl->next;
-            this->addRepresentation(cur);
+            this->addRepresentation(std::move(cur));
         }
     }
 
@@ -175,10 +178,22 @@ namespace OC
         return m_reps;
     }
 
+    std::vector<OCRepresentation> MessageContainer::releaseRepresentations()
+    {
+        std::vector<OCRepresentation> reps;
+        reps.swap(m_reps);
+        return reps;
+    }
+
     void MessageContainer::addRepresentation(const OCRepresentation& rep)
     {
         m_reps.push_back(rep);
     }
+
+    void MessageContainer::addRepresentation(OCRepresentation&& rep)
+    {
+        m_reps.push_back(std::move(rep));
+    }
 }
 
 namespace OC
@@ -637,24 +652,50 @@ namespace OC
         }
     }
 
+    std::vector<OCRepresentation>& OCRepresentation::mutableChildren()
+    {
+        if (!m_children)
+        {
+            m_children = std::make_shared<std::vector<OCRepresentation>>();
+        }
+        else if (m_children.use_count() > 1)
+        {
+            m_children = std::make_shared<std::vector<OCRepresentation>>(*m_children);
+        }
+        return *m_children;
+    }
+
     void OCRepresentation::addChild(const OCRepresentation& rep)
     {
-        m_children.push_back(rep);
+        mutableChildren().push_back(rep);
+    }
+
+    void OCRepresentation::addChild(OCRepresentation&& rep)
+    {
+        mutableChildren().push_back(std::move(rep));
     }
 
     void OCRepresentation::clearChildren()
     {
-        m_children.clear();
+        m_children.reset();
     }
 
     const std::vector<OCRepresentation>& OCRepresentation::getChildren() const
     {
-        return m_children;
+        static const std::vector<OCRepresentation> noChildren;
+        return m_children ? *m_children : noChildren;
     }
 
     void OCRepresentation::setChildren(const std::vector<OCRepresentation>& children)
     {
-        m_children = children;
+        if (children.empty())
+        {
+            m_children.reset();
+        }
+        else
+        {
+            m_children = std::make_shared<std::vector<OCRepresentation>>(children);
+        }
     }
 
     void OCRepresentation::setDevAddr(const OCDevAddr m_devAddr)
@@ -769,7 +810,7 @@ namespace OC
             return false;
         }
 
-        if (m_children.size() > 0)
+        if (m_children && !m_children->empty())
         {
             return false;
         }
@@ -843,7 +884,7 @@ namespace OC
 namespace OC
 {
     OCRepresentation::AttributeItem::AttributeItem(const std::string& name,
-            std::map<std::string, AttributeValue>& vals):
+            AttributeMap& vals):
             m_attrName(name), m_values(vals){}
 
     OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key)
@@ -0,0 +1,825 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the CBOR encoder and decoder of OCRepresentation. They produce and
+ * read the encoding of OCConvertPayload and OCParsePayload without building an
+ * OCRepPayload in between.
+ */
+
+#include <OCRepresentation.h>
+
+#include <algorithm>
+#include <cctype>
+#include "cbor.h"
+#include "ocpayload.h"
+#include "oic_malloc.h"
+
+namespace OC
+{
+    namespace
+    {
+        // Same first guess as OCConvertPayload, larger representations are encoded a
+        // second time into a buffer of the size reported by the first pass.
+        const size_t INIT_ENCODE_SIZE = 255;
+
+        // Out of memory is not a failure while encoding, tinycbor then keeps counting the
+        // bytes needed.
+        bool cborFailed(int64_t err)
+        {
+            return err != CborNoError && err != CborErrorOutOfMemory;
+        }
+
+        void checkDecode(CborError err)
+        {
+            if (err != CborNoError)
+            {
+                throw OCException(OC::Exception::MALFORMED_STACK_RESPONSE,
+                                  OC_STACK_MALFORMED_RESPONSE);
+            }
+        }
+
+        void malformed()
+        {
+            checkDecode(CborUnknownError);
+        }
+
+        std::string joinStrings(const std::vector<std::string>& strings)
+        {
+            std::string joined;
+            for (const std::string& str : strings)
+            {
+                if (!joined.empty())
+                {
+                    joined += ' ';
+                }
+                joined += str;
+            }
+            return joined;
+        }
+
+        // Splits "rt" and "if" values like OCParseStringLL
+        template<typename Add>
+        void splitStrings(const std::string& joined, Add add)
+        {
+            size_t begin = 0;
+            while (begin < joined.size())
+            {
+                size_t end = joined.find(' ', begin);
+                if (end == std::string::npos)
+                {
+                    end = joined.size();
+                }
+
+                size_t first = begin;
+                size_t last = end;
+                while (first < last && std::isspace(static_cast<unsigned char>(joined[first])))
+                {
+                    ++first;
+                }
+                while (last > first && std::isspace(static_cast<unsigned char>(joined[last - 1])))
+                {
+                    --last;
+                }
+                if (first < last)
+                {
+                    add(joined.substr(first, last - first));
+                }
+                begin = end + 1;
+            }
+        }
+
+        void readString(CborValue* value, std::string& str)
+        {
+            size_t len = 0;
+            checkDecode(cbor_value_calculate_string_length(value, &len));
+
+            // tinycbor terminates the copy when there is room for it
+            size_t bufferLen = len + 1;
+            str.resize(bufferLen);
+            checkDecode(cbor_value_copy_text_string(value, &str[0], &bufferLen, value));
+            str.resize(len);
+        }
+
+        template<typename T>
+        void arrayDimensions(const std::vector<T>& arr, size_t* dims)
+        {
+            dims[0] = std::max(dims[0], arr.size());
+        }
+
+        template<typename T>
+        void arrayDimensions(const std::vector<std::vector<T>>& arr, size_t* dims)
+        {
+            dims[0] = std::max(dims[0], arr.size());
+            for (const auto& sub : arr)
+            {
+                arrayDimensions(sub, dims + 1);
+            }
+        }
+
+        // Elements missing from shorter sub-arrays are encoded like the zeroed elements
+        // of an OCRepPayload array.
+        int64_t encodePadding(CborEncoder* array, const int*)
+        {
+            return cbor_encode_int(array, 0);
+        }
+
+        int64_t encodePadding(CborEncoder* array, const double*)
+        {
+            return cbor_encode_double(array, 0.0);
+        }
+
+        int64_t encodePadding(CborEncoder* array, const bool*)
+        {
+            return cbor_encode_boolean(array, false);
+        }
+
+        int64_t encodePadding(CborEncoder* array, const std::string*)
+        {
+            return cbor_encode_null(array);
+        }
+
+        int64_t encodePadding(CborEncoder* array, const OCRepresentation*)
+        {
+            return cbor_encode_null(array);
+        }
+
+        template<typename T>
+        void shapeArray(std::vector<T>& arr, const size_t* dims)
+        {
+            arr.resize(dims[0]);
+        }
+
+        template<typename T>
+        void shapeArray(std::vector<std::vector<T>>& arr, const size_t* dims)
+        {
+            arr.resize(dims[0]);
+            for (auto& sub : arr)
+            {
+                shapeArray(sub, dims + 1);
+            }
+        }
+
+        /**
+         * Finds the dimensions and the element type of a received array like
+         * OCParseArrayFindDimensionsAndType. CborNullType is returned for an array
+         * holding only nulls or empty arrays.
+         */
+        CborType arrayLayout(const CborValue* array, size_t dims[MAX_REP_ARRAY_DEPTH])
+        {
+            CborType type = CborNullType;
+            dims[0] = dims[1] = dims[2] = 0;
+
+            CborValue item;
+            checkDecode(cbor_value_enter_container(array, &item));
+            while (cbor_value_is_valid(&item))
+            {
+                CborType itemType = cbor_value_get_type(&item);
+                if (itemType == CborArrayType)
+                {
+                    size_t subDims[MAX_REP_ARRAY_DEPTH];
+                    itemType = arrayLayout(&item, subDims);
+                    if (subDims[2] != 0)
+                    {
+                        malformed();
+                    }
+                    dims[1] = std::max(dims[1], subDims[0]);
+                    dims[2] = std::max(dims[2], subDims[1]);
+                }
+
+                if (itemType != CborNullType)
+                {
+                    if (type == CborNullType)
+                    {
+                        type = itemType;
+                    }
+                    else if (type != itemType)
+                    {
+                        // Mixed arrays are not allowed
+                        malformed();
+                    }
+                }
+
+                ++dims[0];
+                checkDecode(cbor_value_advance(&item));
+            }
+            return type;
+        }
+    }
+
+    class OCRepresentationCbor
+    {
+        public:
+            static int64_t encode(const std::vector<OCRepresentation>& reps, uint8_t* buffer,
+                                  size_t* size);
+
+            static void decode(const uint8_t* data, size_t size,
+                               std::vector<OCRepresentation>& reps);
+
+            static int64_t encodeMap(CborEncoder* parent, const OCRepresentation& rep);
+
+            static void decodeMap(CborValue* map, OCRepresentation& rep, bool isRoot);
+
+            static void decodeLeaf(CborValue* value, int& val);
+            static void decodeLeaf(CborValue* value, double& val);
+            static void decodeLeaf(CborValue* value, bool& val);
+            static void decodeLeaf(CborValue* value, std::string& val);
+            static void decodeLeaf(CborValue* value, OCRepresentation& val);
+
+        private:
+            static int64_t encodeRoot(CborEncoder* parent, const OCRepresentation& rep,
+                                      bool withHref);
+
+            static int64_t encodeValues(CborEncoder* map, const OCRepresentation& rep);
+
+            static void decodeValue(CborValue* value, OCRepresentation& rep,
+                                    const std::string& name);
+
+            static void decodeArrayValue(CborValue* value, OCRepresentation& rep,
+                                         const std::string& name);
+
+            template<typename T>
+            static void setArray(CborValue* value, OCRepresentation& rep,
+                                 const std::string& name, const size_t* dims);
+
+            template<typename T>
+            static void setArrayOfDepth(CborValue* value, OCRepresentation& rep,
+                                        const std::string& name, const size_t* dims);
+    };
+
+    namespace
+    {
+        struct encode_value : boost::static_visitor<int64_t>
+        {
+            explicit encode_value(CborEncoder* encoder) : m_encoder(encoder) {}
+
+            int64_t operator()(const NullType&) const
+            {
+                return cbor_encode_null(m_encoder);
+            }
+
+            int64_t operator()(int val) const
+            {
+                return cbor_encode_int(m_encoder, val);
+            }
+
+            int64_t operator()(double val) const
+            {
+                return cbor_encode_double(m_encoder, val);
+            }
+
+            int64_t operator()(bool val) const
+            {
+                return cbor_encode_boolean(m_encoder, val);
+            }
+
+            int64_t operator()(const std::string& val) const
+            {
+                return cbor_encode_text_string(m_encoder, val.c_str(), val.size());
+            }
+
+            int64_t operator()(const OCRepresentation& val) const
+            {
+                return OCRepresentationCbor::encodeMap(m_encoder, val);
+            }
+
+            template<typename T>
+            int64_t operator()(const std::vector<T>& arr) const;
+
+            CborEncoder* m_encoder;
+        };
+
+        template<typename T>
+        int64_t encodeArray(CborEncoder* parent, const std::vector<T>& arr, const size_t* dims);
+
+        template<typename T>
+        int64_t encodeArrayItem(CborEncoder* array, const std::vector<std::vector<T>>& arr,
+                                size_t index, const size_t* dims)
+        {
+            static const std::vector<T> padding;
+            return encodeArray(array, index < arr.size() ? arr[index] : padding, dims);
+        }
+
+        template<typename T>
+        int64_t encodeArrayItem(CborEncoder* array, const std::vector<T>& arr,
+                                size_t index, const size_t* /*dims*/)
+        {
+            if (index < arr.size())
+            {
+                return encode_value(array)(arr[index]);
+            }
+            return encodePadding(array, static_cast<const T*>(nullptr));
+        }
+
+        // Arrays are rectangular, every sub-array is as long as the longest one of its level
+        template<typename T>
+        int64_t encodeArray(CborEncoder* parent, const std::vector<T>& arr, const size_t* dims)
+        {
+            CborEncoder array;
+            int64_t err = cbor_encoder_create_array(parent, &array, dims[0]);
+            if (cborFailed(err))
+            {
+                return err;
+            }
+
+            for (size_t i = 0; i < dims[0]; ++i)
+            {
+                err |= encodeArrayItem(&array, arr, i, dims + 1);
+                if (cborFailed(err))
+                {
+                    return err;
+                }
+            }
+
+            return err | cbor_encoder_close_container(parent, &array);
+        }
+
+        template<typename T>
+        int64_t encode_value::operator()(const std::vector<T>& arr) const
+        {
+            size_t dims[MAX_REP_ARRAY_DEPTH] = {0};
+            arrayDimensions(arr, dims);
+            return encodeArray(m_encoder, arr, dims);
+        }
+
+        template<typename T>
+        void decodeArray(CborValue* value, std::vector<T>& arr);
+
+        template<typename T>
+        void decodeArrayItem(CborValue* item, std::vector<std::vector<T>>& arr, size_t index)
+        {
+            if (cbor_value_is_null(item))
+            {
+                checkDecode(cbor_value_advance(item));
+                return;
+            }
+            if (!cbor_value_is_array(item) || index >= arr.size())
+            {
+                malformed();
+            }
+            decodeArray(item, arr[index]);
+        }
+
+        template<typename T>
+        void decodeArrayItem(CborValue* item, std::vector<T>& arr, size_t index)
+        {
+            if (cbor_value_is_array(item) || index >= arr.size())
+            {
+                malformed();
+            }
+
+            // Null elements keep the default value, as from an OCRepPayload array
+            if (cbor_value_is_null(item))
+            {
+                checkDecode(cbor_value_advance(item));
+                return;
+            }
+
+            T val;
+            OCRepresentationCbor::decodeLeaf(item, val);
+            arr[index] = std::move(val);
+        }
+
+        // Fills an array already shaped to the dimensions found by arrayLayout
+        template<typename T>
+        void decodeArray(CborValue* value, std::vector<T>& arr)
+        {
+            CborValue item;
+            checkDecode(cbor_value_enter_container(value, &item));
+            for (size_t i = 0; cbor_value_is_valid(&item); ++i)
+            {
+                decodeArrayItem(&item, arr, i);
+            }
+            checkDecode(cbor_value_leave_container(value, &item));
+        }
+    }
+
+    int64_t OCRepresentationCbor::encode(const std::vector<OCRepresentation>& reps,
+                                         uint8_t* buffer, size_t* size)
+    {
+        CborEncoder encoder;
+        cbor_encoder_init(&encoder, buffer, *size, 0);
+
+        int64_t err = CborNoError;
+        if (reps.size() == 1)
+        {
+            err = encodeRoot(&encoder, reps[0], false);
+        }
+        else
+        {
+            CborEncoder rootArray;
+            err = cbor_encoder_create_array(&encoder, &rootArray, reps.size());
+            for (size_t i = 0; i < reps.size() && !cborFailed(err); ++i)
+            {
+                // Only in case of collection href is included.
+                err |= encodeRoot(&rootArray, reps[i], true);
+            }
+            if (!cborFailed(err))
+            {
+                err |= cbor_encoder_close_container(&encoder, &rootArray);
+            }
+        }
+
+        if (err == CborErrorOutOfMemory)
+        {
+            *size += encoder.ptr - encoder.end;
+        }
+        else if (err == CborNoError)
+        {
+            *size = encoder.ptr - buffer;
+        }
+        return err;
+    }
+
+    int64_t OCRepresentationCbor::encodeRoot(CborEncoder* parent, const OCRepresentation& rep,
+                                             bool withHref)
+    {
+        bool hasHref = withHref && !rep.m_uri.empty();
+        size_t count = rep.m_values.size() + (hasHref ? 1 : 0) +
+                       (rep.m_resourceTypes.empty() ? 0 : 1) +
+                       (rep.m_interfaces.empty() ? 0 : 1);
+
+        CborEncoder map;
+        int64_t err = cbor_encoder_create_map(parent, &map, count);
+        if (cborFailed(err))
+        {
+            return err;
+        }
+
+        if (hasHref)
+        {
+            err |= cbor_encode_text_string(&map, OC_RSRVD_HREF, sizeof(OC_RSRVD_HREF) - 1);
+            err |= cbor_encode_text_string(&map, rep.m_uri.c_str(), rep.m_uri.size());
+        }
+        if (!rep.m_resourceTypes.empty())
+        {
+            std::string types = joinStrings(rep.m_resourceTypes);
+            err |= cbor_encode_text_string(&map, OC_RSRVD_RESOURCE_TYPE,
+                                           sizeof(OC_RSRVD_RESOURCE_TYPE) - 1);
+            err |= cbor_encode_text_string(&map, types.c_str(), types.size());
+        }
+        if (!rep.m_interfaces.empty())
+        {
+            std::string interfaces = joinStrings(rep.m_interfaces);
+            err |= cbor_encode_text_string(&map, OC_RSRVD_INTERFACE,
+                                           sizeof(OC_RSRVD_INTERFACE) - 1);
+            err |= cbor_encode_text_string(&map, interfaces.c_str(), interfaces.size());
+        }
+        if (cborFailed(err))
+        {
+            return err;
+        }
+
+        err |= encodeValues(&map, rep);
+        if (cborFailed(err))
+        {
+            return err;
+        }
+        return err | cbor_encoder_close_container(parent, &map);
+    }
+
+    int64_t OCRepresentationCbor::encodeMap(CborEncoder* parent, const OCRepresentation& rep)
+    {
+        // Nested representations only carry their values
+        CborEncoder map;
+        int64_t err = cbor_encoder_create_map(parent, &map, rep.m_values.size());
+        if (cborFailed(err))
+        {
+            return err;
+        }
+
+        err |= encodeValues(&map, rep);
+        if (cborFailed(err))
+        {
+            return err;
+        }
+        return err | cbor_encoder_close_container(parent, &map);
+    }
+
+    int64_t OCRepresentationCbor::encodeValues(CborEncoder* map, const OCRepresentation& rep)
+    {
+        int64_t err = CborNoError;
+        for (const auto& value : rep.m_values)
+        {
+            err |= cbor_encode_text_string(map, value.first.c_str(), value.first.size());
+            err |= boost::apply_visitor(encode_value(map), value.second);
+            if (cborFailed(err))
+            {
+                break;
+            }
+        }
+        return err;
+    }
+
+    void OCRepresentationCbor::decode(const uint8_t* data, size_t size,
+                                      std::vector<OCRepresentation>& reps)
+    {
+        CborParser parser;
+        CborValue root;
+        checkDecode(cbor_parser_init(data, size, 0, &parser, &root));
+
+        if (cbor_value_is_map(&root))
+        {
+            OCRepresentation rep;
+            decodeMap(&root, rep, true);
+            reps.push_back(std::move(rep));
+            return;
+        }
+        if (!cbor_value_is_array(&root))
+        {
+            malformed();
+        }
+
+        CborValue item;
+        checkDecode(cbor_value_enter_container(&root, &item));
+        while (cbor_value_is_valid(&item))
+        {
+            if (!cbor_value_is_map(&item))
+            {
+                malformed();
+            }
+            OCRepresentation rep;
+            decodeMap(&item, rep, true);
+            reps.push_back(std::move(rep));
+        }
+        checkDecode(cbor_value_leave_container(&root, &item));
+    }
+
+    void OCRepresentationCbor::decodeMap(CborValue* map, OCRepresentation& rep, bool isRoot)
+    {
+        // An entry takes at least two bytes, which bounds a bogus length
+        size_t length = 0;
+        if (CborNoError == cbor_value_get_map_length(map, &length))
+        {
+            size_t available = static_cast<size_t>(map->parser->end - map->ptr) / 2;
+            rep.m_values.reserve(std::min(length, available));
+        }
+
+        CborValue item;
+        checkDecode(cbor_value_enter_container(map, &item));
+
+        std::string name;
+        std::string str;
+        while (cbor_value_is_valid(&item))
+        {
+            if (!cbor_value_is_text_string(&item))
+            {
+                malformed();
+            }
+            readString(&item, name);
+
+            if (isRoot && (name == OC_RSRVD_HREF || name == OC_RSRVD_RESOURCE_TYPE ||
+                           name == OC_RSRVD_INTERFACE))
+            {
+                if (!cbor_value_is_text_string(&item))
+                {
+                    checkDecode(cbor_value_advance(&item));
+                    continue;
+                }
+
+                readString(&item, str);
+                if (name == OC_RSRVD_HREF)
+                {
+                    rep.setUri(str);
+                }
+                else if (name == OC_RSRVD_RESOURCE_TYPE)
+                {
+                    splitStrings(str, [&rep](std::string type)
+                                      { rep.m_resourceTypes.push_back(std::move(type)); });
+                }
+                else
+                {
+                    splitStrings(str, [&rep](std::string iface)
+                                      { rep.m_interfaces.push_back(std::move(iface)); });
+                }
+                continue;
+            }
+
+            decodeValue(&item, rep, name);
+        }
+
+        checkDecode(cbor_value_leave_container(map, &item));
+    }
+
+    void OCRepresentationCbor::decodeValue(CborValue* value, OCRepresentation& rep,
+                                           const std::string& name)
+    {
+        switch (cbor_value_get_type(value))
+        {
+            case CborNullType:
+                rep.m_values[name] = NullType();
+                checkDecode(cbor_value_advance(value));
+                break;
+            case CborIntegerType:
+                {
+                    int val;
+                    decodeLeaf(value, val);
+                    rep.m_values[name] = val;
+                }
+                break;
+            case CborDoubleType:
+                {
+                    double val;
+                    decodeLeaf(value, val);
+                    rep.m_values[name] = val;
+                }
+                break;
+            case CborBooleanType:
+                {
+                    bool val;
+                    decodeLeaf(value, val);
+                    rep.m_values[name] = val;
+                }
+                break;
+            case CborTextStringType:
+                {
+                    std::string val;
+                    decodeLeaf(value, val);
+                    rep.m_values[name] = std::move(val);
+                }
+                break;
+            case CborMapType:
+                {
+                    OCRepresentation val;
+                    decodeLeaf(value, val);
+                    rep.m_values[name] = std::move(val);
+                }
+                break;
+            case CborArrayType:
+                decodeArrayValue(value, rep, name);
+                break;
+            case CborByteStringType:
+                throw std::logic_error(std::string("Not Implemented!") +
+                        std::to_string((int)OCREP_PROP_BYTE_STRING));
+            default:
+                malformed();
+                break;
+        }
+    }
+
+    void OCRepresentationCbor::decodeArrayValue(CborValue* value, OCRepresentation& rep,
+                                                const std::string& name)
+    {
+        size_t dims[MAX_REP_ARRAY_DEPTH];
+        switch (arrayLayout(value, dims))
+        {
+            case CborNullType:
+                rep.m_values[name] = NullType();
+                checkDecode(cbor_value_advance(value));
+                break;
+            case CborIntegerType:
+                setArrayOfDepth<int>(value, rep, name, dims);
+                break;
+            case CborDoubleType:
+                setArrayOfDepth<double>(value, rep, name, dims);
+                break;
+            case CborBooleanType:
+                setArrayOfDepth<bool>(value, rep, name, dims);
+                break;
+            case CborTextStringType:
+                setArrayOfDepth<std::string>(value, rep, name, dims);
+                break;
+            case CborMapType:
+                setArrayOfDepth<OCRepresentation>(value, rep, name, dims);
+                break;
+            case CborByteStringType:
+                throw std::logic_error("setPayload array invalid type");
+            default:
+                malformed();
+                break;
+        }
+    }
+
+    template<typename T>
+    void OCRepresentationCbor::setArrayOfDepth(CborValue* value, OCRepresentation& rep,
+                                               const std::string& name, const size_t* dims)
+    {
+        if (dims[2] != 0)
+        {
+            setArray<std::vector<std::vector<std::vector<T>>>>(value, rep, name, dims);
+        }
+        else if (dims[1] != 0)
+        {
+            setArray<std::vector<std::vector<T>>>(value, rep, name, dims);
+        }
+        else
+        {
+            setArray<std::vector<T>>(value, rep, name, dims);
+        }
+    }
+
+    template<typename T>
+    void OCRepresentationCbor::setArray(CborValue* value, OCRepresentation& rep,
+                                        const std::string& name, const size_t* dims)
+    {
+        T arr;
+        shapeArray(arr, dims);
+        decodeArray(value, arr);
+        rep.m_values[name] = std::move(arr);
+    }
+
+    void OCRepresentationCbor::decodeLeaf(CborValue* value, int& val)
+    {
+        int64_t i = 0;
+        checkDecode(cbor_value_get_int64(value, &i));
+        checkDecode(cbor_value_advance_fixed(value));
+        val = static_cast<int>(i);
+    }
+
+    void OCRepresentationCbor::decodeLeaf(CborValue* value, double& val)
+    {
+        checkDecode(cbor_value_get_double(value, &val));
+        checkDecode(cbor_value_advance_fixed(value));
+    }
+
+    void OCRepresentationCbor::decodeLeaf(CborValue* value, bool& val)
+    {
+        checkDecode(cbor_value_get_boolean(value, &val));
+        checkDecode(cbor_value_advance_fixed(value));
+    }
+
+    void OCRepresentationCbor::decodeLeaf(CborValue* value, std::string& val)
+    {
+        readString(value, val);
+    }
+
+    void OCRepresentationCbor::decodeLeaf(CborValue* value, OCRepresentation& val)
+    {
+        decodeMap(value, val, false);
+    }
+
+    OCEncodedPayload* MessageContainer::getEncodedPayload() const
+    {
+        if (m_reps.empty())
+        {
+            return nullptr;
+        }
+
+        size_t bufferSize = INIT_ENCODE_SIZE;
+        uint8_t* buffer = static_cast<uint8_t*>(OICMalloc(bufferSize));
+        if (!buffer)
+        {
+            throw std::bad_alloc();
+        }
+
+        size_t size = bufferSize;
+        int64_t err = OCRepresentationCbor::encode(m_reps, buffer, &size);
+        if (err == CborErrorOutOfMemory && size > bufferSize)
+        {
+            // The first pass reported the exact size needed
+            bufferSize = size;
+            uint8_t* larger = static_cast<uint8_t*>(OICRealloc(buffer, bufferSize));
+            if (!larger)
+            {
+                OICFree(buffer);
+                throw std::bad_alloc();
+            }
+            buffer = larger;
+            err = OCRepresentationCbor::encode(m_reps, buffer, &size);
+        }
+
+        if (err != CborNoError)
+        {
+            OICFree(buffer);
+            throw std::logic_error(std::string("Failed to encode representation: ") +
+                    std::to_string(err));
+        }
+
+        OCEncodedPayload* payload = OCEncodedPayloadCreate(buffer, size);
+        if (!payload)
+        {
+            OICFree(buffer);
+            throw std::bad_alloc();
+        }
+        return payload;
+    }
+
+    void MessageContainer::setPayload(const OCEncodedPayload* payload)
+    {
+        if (payload == nullptr)
+        {
+            return;
+        }
+
+        OCRepresentationCbor::decode(payload->data, payload->size, m_reps);
+    }
+}
@@ -0,0 +1,408 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the CBOR writer and reader of RepresentationSchema. They encode and
+ * decode values like the OCRepresentation codec does, given their types instead of reading
+ * them from an AttributeValue.
+ */
+
+#include <OCRepresentationSchema.h>
+
+#include <stdexcept>
+#include "cbor.h"
+#include "oic_malloc.h"
+
+namespace OC
+{
+    namespace
+    {
+        // Same first guess as OCConvertPayload
+        const size_t INIT_ENCODE_SIZE = 255;
+
+        // Out of memory is not a failure while encoding, tinycbor then keeps counting the
+        // bytes needed.
+        bool cborFailed(int64_t err)
+        {
+            return err != CborNoError && err != CborErrorOutOfMemory;
+        }
+
+        void checkDecode(CborError err)
+        {
+            if (err != CborNoError)
+            {
+                throw OCException(OC::Exception::MALFORMED_STACK_RESPONSE,
+                                  OC_STACK_MALFORMED_RESPONSE);
+            }
+        }
+    }
+
+    namespace detail
+    {
+        void schemaMismatch(const char* key)
+        {
+            throw OCException(OC::Exception::INVALID_ATTRIBUTE + std::string(key));
+        }
+    }
+
+    struct SchemaWriter::State
+    {
+        uint8_t* buffer = nullptr;
+        size_t bufferSize = INIT_ENCODE_SIZE;
+        size_t size = 0;
+        int64_t err = CborNoError;
+
+        // The encoder of the map or array being written last, the root one first
+        std::vector<CborEncoder> encoders;
+
+        CborEncoder* encoder()
+        {
+            return &encoders.back();
+        }
+    };
+
+    SchemaWriter::SchemaWriter()
+        : m_state(new State())
+    {
+    }
+
+    SchemaWriter::~SchemaWriter()
+    {
+        OICFree(m_state->buffer);
+    }
+
+    void SchemaWriter::begin()
+    {
+        State& state = *m_state;
+        if (!state.buffer)
+        {
+            state.buffer = static_cast<uint8_t*>(OICMalloc(state.bufferSize));
+            if (!state.buffer)
+            {
+                throw std::bad_alloc();
+            }
+        }
+
+        state.err = CborNoError;
+        state.encoders.resize(1);
+        cbor_encoder_init(state.encoder(), state.buffer, state.bufferSize, 0);
+    }
+
+    bool SchemaWriter::retry()
+    {
+        State& state = *m_state;
+        CborEncoder& root = state.encoders.front();
+
+        if (state.err == CborErrorOutOfMemory)
+        {
+            // The pass reported the exact size needed
+            size_t needed = state.bufferSize + (root.ptr - root.end);
+            if (needed <= state.bufferSize)
+            {
+                throw std::logic_error("Failed to encode representation: no size reported");
+            }
+
+            uint8_t* larger = static_cast<uint8_t*>(OICRealloc(state.buffer, needed));
+            if (!larger)
+            {
+                throw std::bad_alloc();
+            }
+            state.buffer = larger;
+            state.bufferSize = needed;
+            return true;
+        }
+
+        if (state.err != CborNoError)
+        {
+            throw std::logic_error(std::string("Failed to encode representation: ") +
+                    std::to_string(state.err));
+        }
+
+        state.size = root.ptr - state.buffer;
+        return false;
+    }
+
+    OCEncodedPayload* SchemaWriter::release()
+    {
+        State& state = *m_state;
+        OCEncodedPayload* payload = OCEncodedPayloadCreate(state.buffer, state.size);
+        if (!payload)
+        {
+            throw std::bad_alloc();
+        }
+        state.buffer = nullptr;
+        return payload;
+    }
+
+    void SchemaWriter::beginMap(size_t count)
+    {
+        // Pushed even when failed, so that end stays balanced
+        CborEncoder map = CborEncoder();
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encoder_create_map(m_state->encoder(), &map, count);
+        }
+        m_state->encoders.push_back(map);
+    }
+
+    void SchemaWriter::beginArray(size_t count)
+    {
+        CborEncoder array = CborEncoder();
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encoder_create_array(m_state->encoder(), &array, count);
+        }
+        m_state->encoders.push_back(array);
+    }
+
+    void SchemaWriter::end()
+    {
+        CborEncoder container = m_state->encoders.back();
+        m_state->encoders.pop_back();
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encoder_close_container(m_state->encoder(), &container);
+        }
+    }
+
+    void SchemaWriter::key(const char* key, size_t length)
+    {
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encode_text_string(m_state->encoder(), key, length);
+        }
+    }
+
+    void SchemaWriter::value(int val)
+    {
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encode_int(m_state->encoder(), val);
+        }
+    }
+
+    void SchemaWriter::value(double val)
+    {
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encode_double(m_state->encoder(), val);
+        }
+    }
+
+    void SchemaWriter::value(bool val)
+    {
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encode_boolean(m_state->encoder(), val);
+        }
+    }
+
+    void SchemaWriter::value(const std::string& val)
+    {
+        if (!cborFailed(m_state->err))
+        {
+            m_state->err |= cbor_encode_text_string(m_state->encoder(), val.c_str(),
+                                                    val.size());
+        }
+    }
+
+    struct SchemaReader::State
+    {
+        struct Container
+        {
+            CborValue item;
+            bool isNull;
+        };
+
+        CborParser parser;
+        CborValue root;
+
+        // The maps and arrays entered, the value read next is the item of the last one
+        std::vector<Container> containers;
+
+        CborValue* value()
+        {
+            return containers.empty() ? &root : &containers.back().item;
+        }
+    };
+
+    SchemaReader::SchemaReader(const uint8_t* data, size_t size)
+        : m_state(new State())
+    {
+        checkDecode(cbor_parser_init(data, size, 0, &m_state->parser, &m_state->root));
+    }
+
+    SchemaReader::~SchemaReader()
+    {
+    }
+
+    void SchemaReader::enterMap()
+    {
+        State::Container container = State::Container();
+        CborValue* value = m_state->value();
+        if (cbor_value_is_null(value))
+        {
+            checkDecode(cbor_value_advance(value));
+            container.isNull = true;
+        }
+        else if (cbor_value_is_map(value))
+        {
+            checkDecode(cbor_value_enter_container(value, &container.item));
+        }
+        else
+        {
+            detail::schemaMismatch(m_key.c_str());
+        }
+        m_state->containers.push_back(container);
+    }
+
+    void SchemaReader::enterArray()
+    {
+        State::Container container = State::Container();
+        CborValue* value = m_state->value();
+        if (cbor_value_is_null(value))
+        {
+            checkDecode(cbor_value_advance(value));
+            container.isNull = true;
+        }
+        else if (cbor_value_is_array(value))
+        {
+            checkDecode(cbor_value_enter_container(value, &container.item));
+        }
+        else
+        {
+            detail::schemaMismatch(m_key.c_str());
+        }
+        m_state->containers.push_back(container);
+    }
+
+    bool SchemaReader::atEnd() const
+    {
+        const State::Container& container = m_state->containers.back();
+        return container.isNull || !cbor_value_is_valid(&container.item);
+    }
+
+    void SchemaReader::leave()
+    {
+        State::Container container = m_state->containers.back();
+        m_state->containers.pop_back();
+        if (!container.isNull)
+        {
+            checkDecode(cbor_value_leave_container(m_state->value(), &container.item));
+        }
+    }
+
+    void SchemaReader::readKey()
+    {
+        CborValue* value = m_state->value();
+        if (!cbor_value_is_text_string(value))
+        {
+            checkDecode(CborUnknownError);
+        }
+        this->value(m_key);
+    }
+
+    void SchemaReader::skip()
+    {
+        checkDecode(cbor_value_advance(m_state->value()));
+    }
+
+    void SchemaReader::value(int& val)
+    {
+        CborValue* value = m_state->value();
+        if (cbor_value_is_null(value))
+        {
+            val = 0;
+            checkDecode(cbor_value_advance(value));
+            return;
+        }
+        if (!cbor_value_is_integer(value))
+        {
+            detail::schemaMismatch(m_key.c_str());
+        }
+
+        int64_t i = 0;
+        checkDecode(cbor_value_get_int64(value, &i));
+        checkDecode(cbor_value_advance_fixed(value));
+        val = static_cast<int>(i);
+    }
+
+    void SchemaReader::value(double& val)
+    {
+        CborValue* value = m_state->value();
+        if (cbor_value_is_null(value))
+        {
+            val = 0.0;
+            checkDecode(cbor_value_advance(value));
+            return;
+        }
+        if (!cbor_value_is_double(value))
+        {
+            detail::schemaMismatch(m_key.c_str());
+        }
+
+        checkDecode(cbor_value_get_double(value, &val));
+        checkDecode(cbor_value_advance_fixed(value));
+    }
+
+    void SchemaReader::value(bool& val)
+    {
+        CborValue* value = m_state->value();
+        if (cbor_value_is_null(value))
+        {
+            val = false;
+            checkDecode(cbor_value_advance(value));
+            return;
+        }
+        if (!cbor_value_is_boolean(value))
+        {
+            detail::schemaMismatch(m_key.c_str());
+        }
+
+        checkDecode(cbor_value_get_boolean(value, &val));
+        checkDecode(cbor_value_advance_fixed(value));
+    }
+
+    void SchemaReader::value(std::string& val)
+    {
+        CborValue* value = m_state->value();
+        if (cbor_value_is_null(value))
+        {
+            val.clear();
+            checkDecode(cbor_value_advance(value));
+            return;
+        }
+        if (!cbor_value_is_text_string(value))
+        {
+            detail::schemaMismatch(m_key.c_str());
+        }
+
+        size_t len = 0;
+        checkDecode(cbor_value_calculate_string_length(value, &len));
+
+        // tinycbor terminates the copy when there is room for it
+        size_t bufferLen = len + 1;
+        val.resize(bufferLen);
+        checkDecode(cbor_value_copy_text_string(value, &val[0], &bufferLen, value));
+        val.resize(len);
+    }
+}
@@ -40,22 +40,33 @@ OCResource::OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
                         const std::string& serverId, bool observable,
                         const std::vector<std::string>& resourceTypes,
                         const std::vector<std::string>& interfaces)
+ :  OCResource(clientWrapper, devAddr, uri, std::make_shared<const std::string>(serverId),
+               observable, std::make_shared<const std::vector<std::string>>(resourceTypes),
+               std::make_shared<const std::vector<std::string>>(interfaces))
+{
+}
+
+OCResource::OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
+                        const OCDevAddr& devAddr, const std::string& uri,
+                        std::shared_ptr<const std::string> serverId, bool observable,
+                        std::shared_ptr<const std::vector<std::string>> resourceTypes,
+                        std::shared_ptr<const std::vector<std::string>> interfaces)
  :  m_clientWrapper(clientWrapper), m_uri(uri),
-    m_resourceId(serverId, m_uri), m_devAddr(devAddr),
+    m_resourceId(std::move(serverId), m_uri), m_devAddr(devAddr),
     m_isObservable(observable), m_isCollection(false),
-    m_resourceTypes(resourceTypes), m_interfaces(interfaces),
+    m_resourceTypes(std::move(resourceTypes)), m_interfaces(std::move(interfaces)),
     m_observeHandle(nullptr)
 {
-    m_isCollection = std::find(m_interfaces.begin(), m_interfaces.end(), LINK_INTERFACE)
-                        != m_interfaces.end();
+    m_isCollection = std::find(m_interfaces->begin(), m_interfaces->end(), LINK_INTERFACE)
+                        != m_interfaces->end();
 
     if (m_uri.empty() ||
-        resourceTypes.empty() ||
-        interfaces.empty()||
+        m_resourceTypes->empty() ||
+        m_interfaces->empty()||
         m_clientWrapper.expired())
     {
-        throw ResourceInitException(m_uri.empty(), resourceTypes.empty(),
-                interfaces.empty(), m_clientWrapper.expired(), false, false);
+        throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                m_interfaces->empty(), m_clientWrapper.expired(), false, false);
     }
 }
 
@@ -66,18 +77,19 @@ OCResource::OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
                         const std::vector<std::string>& resourceTypes,
                         const std::vector<std::string>& interfaces)
  :  m_clientWrapper(clientWrapper), m_uri(uri),
-    m_resourceId(serverId, m_uri),
+    m_resourceId(std::make_shared<const std::string>(serverId), m_uri),
     m_devAddr{ OC_DEFAULT_ADAPTER, OC_DEFAULT_FLAGS, 0, {0}, 0
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
     , {0}
 #endif
     },
     m_isObservable(observable), m_isCollection(false),
-    m_resourceTypes(resourceTypes), m_interfaces(interfaces),
+    m_resourceTypes(std::make_shared<const std::vector<std::string>>(resourceTypes)),
+    m_interfaces(std::make_shared<const std::vector<std::string>>(interfaces)),
     m_observeHandle(nullptr)
 {
-    m_isCollection = std::find(m_interfaces.begin(), m_interfaces.end(), LINK_INTERFACE)
-                        != m_interfaces.end();
+    m_isCollection = std::find(m_interfaces->begin(), m_interfaces->end(), LINK_INTERFACE)
+                        != m_interfaces->end();
 
     if (m_uri.empty() ||
         resourceTypes.empty() ||
@@ -130,8 +142,8 @@ void OCResource::setHost(const std::string& host)
     }
     else
     {
-        throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-            m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+        throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+            m_interfaces->empty(), m_clientWrapper.expired(), false, false);
     }
 
     // remove 'coap://' or 'coaps://' or 'coap+tcp://'
@@ -143,8 +155,8 @@ void OCResource::setHost(const std::string& host)
 
         if(bracket == std::string::npos || bracket == 0)
         {
-            throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+            throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                m_interfaces->empty(), m_clientWrapper.expired(), false, false);
         }
         // extract the ipv6 address
         std::string ip6Addr = host_token.substr(1, bracket - 1);
@@ -154,8 +166,8 @@ void OCResource::setHost(const std::string& host)
         const char *cAddr = ip6Addr.c_str();
         if(0 == inet_pton(AF_INET6, cAddr, &buf))
         {
-            throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+            throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                m_interfaces->empty(), m_clientWrapper.expired(), false, false);
         }
 
         //skip ']' and ':' characters in host string
@@ -164,8 +176,8 @@ void OCResource::setHost(const std::string& host)
 
         if (0 > port || UINT16_MAX < port)
         {
-            throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+            throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                m_interfaces->empty(), m_clientWrapper.expired(), false, false);
         }
 
         ip6Addr.copy(m_devAddr.addr, sizeof(m_devAddr.addr));
@@ -175,8 +187,8 @@ void OCResource::setHost(const std::string& host)
     }
     else if (host_token[0] == ':')
     {
-        throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-            m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+        throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+            m_interfaces->empty(), m_clientWrapper.expired(), false, false);
     }
     else
     {
@@ -188,8 +200,8 @@ void OCResource::setHost(const std::string& host)
             // address validity check
             if (MAC_ADDR_STR_SIZE != macAddr.length())
             {
-                throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                    m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+                throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                    m_interfaces->empty(), m_clientWrapper.expired(), false, false);
             }
 
             for (size_t blockCnt = 0; blockCnt < MAC_ADDR_BLOCKS; blockCnt++)
@@ -198,8 +210,8 @@ void OCResource::setHost(const std::string& host)
 
                 if (std::string::npos != block.find_first_not_of("0123456789ABCDEFabcdef"))
                 {
-                    throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                        m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+                    throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                        m_interfaces->empty(), m_clientWrapper.expired(), false, false);
                 }
 
                 if (MAC_ADDR_BLOCKS - 1 > blockCnt)
@@ -208,8 +220,8 @@ void OCResource::setHost(const std::string& host)
 
                     if (':' != delimiter)
                     {
-                        throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                            m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+                        throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                            m_interfaces->empty(), m_clientWrapper.expired(), false, false);
                     }
                 }
             }
@@ -223,8 +235,8 @@ void OCResource::setHost(const std::string& host)
 
             if (colon == std::string::npos || colon == 0)
             {
-                throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                    m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+                throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                    m_interfaces->empty(), m_clientWrapper.expired(), false, false);
             }
 
             // extract the ipv4 address
@@ -235,8 +247,8 @@ void OCResource::setHost(const std::string& host)
             const char *cAddr = ip4Addr.c_str();
             if(0 == inet_pton(AF_INET, cAddr, &buf))
             {
-                throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                    m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+                throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                    m_interfaces->empty(), m_clientWrapper.expired(), false, false);
             }
 
             //skip ':' characters in host string
@@ -245,8 +257,8 @@ void OCResource::setHost(const std::string& host)
 
             if (0 > port || UINT16_MAX < port)
             {
-                throw ResourceInitException(m_uri.empty(), m_resourceTypes.empty(),
-                    m_interfaces.empty(), m_clientWrapper.expired(), false, false);
+                throw ResourceInitException(m_uri.empty(), m_resourceTypes->empty(),
+                    m_interfaces->empty(), m_clientWrapper.expired(), false, false);
             }
 
             ip4Addr.copy(m_devAddr.addr, sizeof(m_devAddr.addr));
@@ -258,6 +270,12 @@ void OCResource::setHost(const std::string& host)
 
 OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
                               GetCallback attributeHandler, QualityOfService QoS)
+{
+    return get(queryParametersMap, shareRepresentation(attributeHandler), QoS);
+}
+
+OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
+                              SharedGetCallback attributeHandler, QualityOfService QoS)
 {
     return checked_guard(m_clientWrapper.lock(),
                             &IClientWrapper::GetResourceRepresentation,
@@ -266,6 +284,14 @@ OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
                             attributeHandler, QoS);
 }
 
+OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
+                              SharedGetCallback attributeHandler)
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return result_guard(get(queryParametersMap, attributeHandler, defaultQos));
+}
+
 OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
                               GetCallback attributeHandler)
 {
@@ -305,12 +331,28 @@ OCStackResult OCResource::get(const std::string& resourceType, const std::string
 OCStackResult OCResource::put(const OCRepresentation& rep,
                               const QueryParamsMap& queryParametersMap, PutCallback attributeHandler,
                               QualityOfService QoS)
+{
+    return put(rep, queryParametersMap, shareRepresentation(attributeHandler), QoS);
+}
+
+OCStackResult OCResource::put(const OCRepresentation& rep,
+                              const QueryParamsMap& queryParametersMap,
+                              SharedPutCallback attributeHandler, QualityOfService QoS)
 {
     return checked_guard(m_clientWrapper.lock(), &IClientWrapper::PutResourceRepresentation,
                          m_devAddr, m_uri, rep, queryParametersMap,
                          m_headerOptions, attributeHandler, QoS);
 }
 
+OCStackResult OCResource::put(const OCRepresentation& rep,
+                              const QueryParamsMap& queryParametersMap,
+                              SharedPutCallback attributeHandler)
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return result_guard(put(rep, queryParametersMap, attributeHandler, defaultQos));
+}
+
 OCStackResult OCResource::put(const OCRepresentation& rep,
                               const QueryParamsMap& queryParametersMap, PutCallback attributeHandler)
 {
@@ -355,12 +397,28 @@ OCStackResult OCResource::put(const std::string& resourceType,
 OCStackResult OCResource::post(const OCRepresentation& rep,
                                const QueryParamsMap& queryParametersMap, PostCallback attributeHandler,
                                QualityOfService QoS)
+{
+    return post(rep, queryParametersMap, shareRepresentation(attributeHandler), QoS);
+}
+
+OCStackResult OCResource::post(const OCRepresentation& rep,
+                               const QueryParamsMap& queryParametersMap,
+                               SharedPostCallback attributeHandler, QualityOfService QoS)
 {
     return checked_guard(m_clientWrapper.lock(), &IClientWrapper::PostResourceRepresentation,
                          m_devAddr, m_uri, rep, queryParametersMap,
                          m_headerOptions, attributeHandler, QoS);
 }
 
+OCStackResult OCResource::post(const OCRepresentation& rep,
+                               const QueryParamsMap& queryParametersMap,
+                               SharedPostCallback attributeHandler)
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return result_guard(post(rep, queryParametersMap, attributeHandler, defaultQos));
+}
+
 OCStackResult OCResource::post(const OCRepresentation& rep,
                               const QueryParamsMap& queryParametersMap, PutCallback attributeHandler)
 {
@@ -416,9 +474,142 @@ OCStackResult OCResource::deleteResource(DeleteCallback deleteHandler)
     return result_guard(deleteResource(deleteHandler, defaultQos));
 }
 
+OCFuture<RequestResult> OCResource::requestAsync(OCMethod method, const OCRepresentation& rep,
+        const QueryParamsMap& queryParametersMap, QualityOfService QoS)
+{
+    // Sets the result to OC_STACK_REQUEST_CANCELLED when the stack drops the callback without
+    // calling it, once the last copy of the callback is gone.
+    struct Completion
+    {
+        OCPromise<RequestResult> promise;
+
+        ~Completion()
+        {
+            RequestResult cancelled;
+            cancelled.representation = std::make_shared<const OCRepresentation>();
+            cancelled.result = OC_STACK_REQUEST_CANCELLED;
+            promise.setValue(std::move(cancelled));
+        }
+    };
+
+    auto completion = std::make_shared<Completion>();
+    OCPromise<RequestResult> promise = completion->promise;
+
+    std::vector<BatchRequest> requests(1);
+    BatchRequest& request = requests.front();
+    request.devAddr = m_devAddr;
+    request.uri = m_uri;
+    request.method = method;
+    request.rep = rep;
+    request.queryParams = queryParametersMap;
+    request.headerOptions = m_headerOptions;
+    request.pending = std::make_shared<PendingRequest>();
+    request.sharedCallback =
+        [completion](const HeaderOptions& headerOptions,
+                     std::shared_ptr<const OCRepresentation> rep, const int eCode)
+        {
+            RequestResult result;
+            result.headerOptions = headerOptions;
+            result.representation = std::move(rep);
+            result.result = eCode;
+            completion->promise.setValue(std::move(result));
+        };
+    completion.reset();
+    std::shared_ptr<PendingRequest> pending = request.pending;
+
+    std::vector<OCDoHandle> handles;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::DoRequests, requests, handles, QoS);
+    requests.clear();
+
+    // The response marks the request completed under the mutex before the stack frees its
+    // handle, so the handle is still the request's own while it is not completed.
+    std::weak_ptr<IClientWrapper> clientWrapper = m_clientWrapper;
+    std::string uri = m_uri;
+    HeaderOptions headerOptions = m_headerOptions;
+    promise.setCanceller([promise, pending, clientWrapper, uri, headerOptions, QoS]
+        {
+            {
+                std::lock_guard<std::mutex> lock(pending->mutex);
+                auto client = clientWrapper.lock();
+                if (!pending->completed && client)
+                {
+                    client->CancelObserveResource(pending->handle, "", uri, headerOptions, QoS);
+                }
+            }
+
+            RequestResult cancelled;
+            cancelled.representation = std::make_shared<const OCRepresentation>();
+            cancelled.result = OC_STACK_REQUEST_CANCELLED;
+            promise.setValue(std::move(cancelled));
+        });
+    return promise.getFuture();
+}
+
+OCFuture<RequestResult> OCResource::getAsync(const QueryParamsMap& queryParametersMap)
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return getAsync(queryParametersMap, defaultQos);
+}
+
+OCFuture<RequestResult> OCResource::getAsync(const QueryParamsMap& queryParametersMap,
+                                             QualityOfService QoS)
+{
+    return requestAsync(OC_REST_GET, OCRepresentation(), queryParametersMap, QoS);
+}
+
+OCFuture<RequestResult> OCResource::putAsync(const OCRepresentation& rep,
+                                             const QueryParamsMap& queryParametersMap)
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return putAsync(rep, queryParametersMap, defaultQos);
+}
+
+OCFuture<RequestResult> OCResource::putAsync(const OCRepresentation& rep,
+                                             const QueryParamsMap& queryParametersMap,
+                                             QualityOfService QoS)
+{
+    return requestAsync(OC_REST_PUT, rep, queryParametersMap, QoS);
+}
+
+OCFuture<RequestResult> OCResource::postAsync(const OCRepresentation& rep,
+                                              const QueryParamsMap& queryParametersMap)
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return postAsync(rep, queryParametersMap, defaultQos);
+}
+
+OCFuture<RequestResult> OCResource::postAsync(const OCRepresentation& rep,
+                                              const QueryParamsMap& queryParametersMap,
+                                              QualityOfService QoS)
+{
+    return requestAsync(OC_REST_POST, rep, queryParametersMap, QoS);
+}
+
+OCFuture<RequestResult> OCResource::deleteResourceAsync()
+{
+    QualityOfService defaultQos = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQos);
+    return deleteResourceAsync(defaultQos);
+}
+
+OCFuture<RequestResult> OCResource::deleteResourceAsync(QualityOfService QoS)
+{
+    return requestAsync(OC_REST_DELETE, OCRepresentation(), QueryParamsMap(), QoS);
+}
+
 OCStackResult OCResource::observe(ObserveType observeType,
         const QueryParamsMap& queryParametersMap, ObserveCallback observeHandler,
         QualityOfService QoS)
+{
+    return observe(observeType, queryParametersMap, shareRepresentation(observeHandler), QoS);
+}
+
+OCStackResult OCResource::observe(ObserveType observeType,
+        const QueryParamsMap& queryParametersMap, SharedObserveCallback observeHandler,
+        QualityOfService QoS)
 {
     if(m_observeHandle != nullptr)
     {
@@ -440,6 +631,15 @@ OCStackResult OCResource::observe(ObserveType observeType,
     return result_guard(observe(observeType, queryParametersMap, observeHandler, defaultQoS));
 }
 
+OCStackResult OCResource::observe(ObserveType observeType,
+        const QueryParamsMap& queryParametersMap, SharedObserveCallback observeHandler)
+{
+    QualityOfService defaultQoS = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQoS);
+
+    return result_guard(observe(observeType, queryParametersMap, observeHandler, defaultQoS));
+}
+
 OCStackResult OCResource::cancelObserve()
 {
     QualityOfService defaultQoS = OC::QualityOfService::NaQos;
@@ -526,12 +726,12 @@ bool OCResource::isObservable() const
 
 std::vector<std::string> OCResource::getResourceTypes() const
 {
-    return m_resourceTypes;
+    return *m_resourceTypes;
 }
 
 std::vector<std::string> OCResource::getResourceInterfaces(void) const
 {
-    return m_interfaces;
+    return *m_interfaces;
 }
 
 OCResourceIdentifier OCResource::uniqueIdentifier() const
@@ -541,7 +741,7 @@ OCResourceIdentifier OCResource::uniqueIdentifier() const
 
 std::string OCResource::sid() const
 {
-    return this->uniqueIdentifier().m_representation;
+    return *m_resourceId.m_representation;
 }
 
 bool OCResource::operator==(const OCResource &other) const
@@ -574,22 +774,23 @@ bool OCResource::operator>=(const OCResource &other) const
     return m_resourceId >= other.m_resourceId;
 }
 
-OCResourceIdentifier::OCResourceIdentifier(const std::string& wireServerIdentifier,
+OCResourceIdentifier::OCResourceIdentifier(
+        std::shared_ptr<const std::string> wireServerIdentifier,
         const std::string& resourceUri)
-    :m_representation(wireServerIdentifier), m_resourceUri(resourceUri)
+    :m_representation(std::move(wireServerIdentifier)), m_resourceUri(resourceUri)
 {
 }
 
 std::ostream& operator <<(std::ostream& os, const OCResourceIdentifier& ri)
 {
-    os << ri.m_representation<<ri.m_resourceUri;
+    os << *ri.m_representation<<ri.m_resourceUri;
 
     return os;
 }
 
 bool OCResourceIdentifier::operator==(const OCResourceIdentifier &other) const
 {
-    return m_representation == other.m_representation
+    return *m_representation == *other.m_representation
         && m_resourceUri == other.m_resourceUri;
 }
 
@@ -602,7 +803,7 @@ bool OCResourceIdentifier::operator<(const OCResourceIdentifier &other) const
 {
     return m_resourceUri < other.m_resourceUri
         || (m_resourceUri == other.m_resourceUri &&
-                m_representation < other.m_representation);
+                *m_representation < *other.m_representation);
 }
 
 bool OCResourceIdentifier::operator>(const OCResourceIdentifier &other) const
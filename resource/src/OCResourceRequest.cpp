@@ -34,7 +34,7 @@ void OCResourceRequest::setPayload(OCPayload* payload)
     {
         return;
     }
-    if(payload->type != PAYLOAD_TYPE_REPRESENTATION)
+    if(payload->type != PAYLOAD_TYPE_REPRESENTATION && payload->type != PAYLOAD_TYPE_ENCODED)
     {
         throw std::logic_error("Wrong payload type");
         return;
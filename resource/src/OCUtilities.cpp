@@ -57,6 +57,37 @@ OC::Utilities::QueryParamsKeyVal OC::Utilities::getQueryParams(const std::string
 
 namespace OC {
 
+SharedGetCallback shareRepresentation(GetCallback callback)
+{
+    if (!callback)
+    {
+        return nullptr;
+    }
+    return [callback](const HeaderOptions& headerOptions,
+                      std::shared_ptr<const OCRepresentation> rep, const int eCode)
+           {
+               callback(headerOptions, *rep, eCode);
+           };
+}
+
+SharedObserveCallback shareRepresentation(ObserveCallback callback)
+{
+    if (!callback)
+    {
+        return nullptr;
+    }
+    return [callback](const HeaderOptions& headerOptions,
+                      std::shared_ptr<const OCRepresentation> rep, const int eCode,
+                      const int sequenceNumber)
+           {
+               callback(headerOptions, *rep, eCode, sequenceNumber);
+           };
+}
+
+} // namespace OC
+
+namespace OC {
+
 OCStackResult result_guard(const OCStackResult r)
 {
  std::ostringstream os;
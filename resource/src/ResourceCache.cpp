@@ -0,0 +1,183 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ResourceCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace OC
+{
+    // Tables are swept of their expired entries each time they double past this size
+    static const size_t MIN_SWEEP_SIZE = 64;
+
+    ResourceCache::ResourceCache(bool reuseResources)
+        : m_reuseResources(reuseResources),
+          m_stringsSweepAt(MIN_SWEEP_SIZE),
+          m_listsSweepAt(MIN_SWEEP_SIZE),
+          m_resourcesSweepAt(MIN_SWEEP_SIZE)
+    {
+    }
+
+    template <typename T>
+    void ResourceCache::sweep(Table<T>& table, size_t& sweepAt)
+    {
+        if (table.size() < sweepAt)
+        {
+            return;
+        }
+
+        for (auto it = table.begin(); it != table.end();)
+        {
+            if (it->second.expired())
+            {
+                it = table.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        sweepAt = std::max(MIN_SWEEP_SIZE, 2 * table.size());
+    }
+
+    std::shared_ptr<const std::string> ResourceCache::intern(const char* value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return internLocked(value);
+    }
+
+    ResourceCache::StringList ResourceCache::intern(const OCStringLL* values)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return internLocked(values);
+    }
+
+    std::shared_ptr<const std::string> ResourceCache::internLocked(const char* value)
+    {
+        m_internKey.assign(value ? value : "");
+
+        std::weak_ptr<const std::string>& entry = m_strings[m_internKey];
+        std::shared_ptr<const std::string> interned = entry.lock();
+        if (!interned)
+        {
+            interned = std::make_shared<const std::string>(m_internKey);
+            entry = interned;
+            sweep(m_strings, m_stringsSweepAt);
+        }
+        return interned;
+    }
+
+    ResourceCache::StringList ResourceCache::internLocked(const OCStringLL* values)
+    {
+        // The values are separated with a character they can not hold
+        m_internKey.clear();
+        for (const OCStringLL* value = values; value; value = value->next)
+        {
+            m_internKey.append(value->value ? value->value : "");
+            m_internKey.push_back('\0');
+        }
+
+        std::weak_ptr<const std::vector<std::string>>& entry = m_lists[m_internKey];
+        StringList interned = entry.lock();
+        if (!interned)
+        {
+            std::vector<std::string> list;
+            for (const OCStringLL* value = values; value; value = value->next)
+            {
+                list.push_back(value->value ? value->value : "");
+            }
+            interned = std::make_shared<const std::vector<std::string>>(std::move(list));
+            entry = interned;
+            sweep(m_lists, m_listsSweepAt);
+        }
+        return interned;
+    }
+
+    bool ResourceCache::equals(const std::vector<std::string>& list, const OCStringLL* values)
+    {
+        for (const std::string& item : list)
+        {
+            if (!values || item != (values->value ? values->value : ""))
+            {
+                return false;
+            }
+            values = values->next;
+        }
+        return !values;
+    }
+
+    bool ResourceCache::equals(const OCDevAddr& lhs, const OCDevAddr& rhs)
+    {
+        return lhs.adapter == rhs.adapter && lhs.flags == rhs.flags && lhs.port == rhs.port &&
+               lhs.interface == rhs.interface && strcmp(lhs.addr, rhs.addr) == 0;
+    }
+
+    bool ResourceCache::matches(const OCResource& cached, const OCDevAddr& devAddr,
+                                const char* sid, const OCResourcePayload* resource)
+    {
+        return equals(cached.m_devAddr, devAddr) &&
+               *cached.m_resourceId.m_representation == sid &&
+               cached.m_isObservable == ((resource->bitmap & OC_OBSERVABLE) == OC_OBSERVABLE) &&
+               equals(*cached.m_resourceTypes, resource->types) &&
+               equals(*cached.m_interfaces, resource->interfaces);
+    }
+
+    std::shared_ptr<OCResource> ResourceCache::resource(
+            const std::weak_ptr<IClientWrapper>& clientWrapper,
+            const OCDevAddr& devAddr, const char* sid, const OCResourcePayload* resource)
+    {
+        const char* uri = resource->uri ? resource->uri : "";
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_reuseResources)
+        {
+            // Keyed by host and URI, the rest of the address is compared by matches
+            m_resourceKey.assign(devAddr.addr);
+            m_resourceKey.push_back('\0');
+            m_resourceKey.append(reinterpret_cast<const char*>(&devAddr.port),
+                                 sizeof(devAddr.port));
+            m_resourceKey.append(uri);
+
+            auto it = m_resources.find(m_resourceKey);
+            if (it != m_resources.end())
+            {
+                std::shared_ptr<OCResource> cached = it->second.lock();
+                if (cached && matches(*cached, devAddr, sid, resource))
+                {
+                    return cached;
+                }
+            }
+        }
+
+        std::shared_ptr<OCResource> created(new OCResource(clientWrapper, devAddr,
+                std::string(uri), internLocked(sid),
+                (resource->bitmap & OC_OBSERVABLE) == OC_OBSERVABLE,
+                internLocked(resource->types), internLocked(resource->interfaces)));
+
+        if (m_reuseResources)
+        {
+            // A resource described differently replaces the one before, which its holders keep
+            m_resources[m_resourceKey] = created;
+            sweep(m_resources, m_resourcesSweepAt);
+        }
+        return created;
+    }
+}
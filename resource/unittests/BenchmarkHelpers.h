@@ -0,0 +1,48 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Shared timing helpers of the disabled benchmark tests.
+ */
+
+#ifndef OC_BENCHMARK_HELPERS_H_
+#define OC_BENCHMARK_HELPERS_H_
+
+#include <chrono>
+#include <iostream>
+#include <gtest/gtest.h>
+
+namespace OCBenchmark
+{
+    static const int BenchmarkRounds = 10000;
+
+    // Prints the time of one round and records it as a property of the test
+    inline void reportBenchmark(const char* name, std::chrono::steady_clock::duration elapsed)
+    {
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+                BenchmarkRounds;
+        std::cout << name << ": " << ns << " ns per round" << std::endl;
+        ::testing::Test::RecordProperty(name, static_cast<int>(ns));
+    }
+} // namespace OCBenchmark
+
+#endif // OC_BENCHMARK_HELPERS_H_
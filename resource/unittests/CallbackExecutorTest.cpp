@@ -0,0 +1,120 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <atomic>
+#include <future>
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace CallbackExecutorTests
+        {
+            using namespace OC;
+
+            TEST(CallbackExecutorTest, InlineRunsOnCaller)
+            {
+                CallbackExecutor executor(CallbackDispatch::Inline, 0);
+                std::thread::id caller = std::this_thread::get_id();
+                std::thread::id runner;
+
+                executor.post(nullptr, [&runner]{ runner = std::this_thread::get_id(); });
+                EXPECT_EQ(caller, runner);
+            }
+
+            TEST(CallbackExecutorTest, ThreadRunsTask)
+            {
+                CallbackExecutor executor(CallbackDispatch::Thread, 0);
+                std::promise<void> done;
+
+                executor.post(nullptr, [&done]{ done.set_value(); });
+                EXPECT_EQ(std::future_status::ready,
+                          done.get_future().wait_for(std::chrono::seconds(5)));
+            }
+
+            TEST(CallbackExecutorTest, PoolRunsEveryTask)
+            {
+                std::atomic<int> count(0);
+                {
+                    CallbackExecutor executor(CallbackDispatch::Pool, 4);
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        executor.post(&count, [&count]{ ++count; });
+                    }
+                }
+                // The executor runs the queued tasks before it is destroyed
+                EXPECT_EQ(1000, count);
+            }
+
+            TEST(CallbackExecutorTest, StrandKeepsOrder)
+            {
+                const int tasksPerStrand = 1000;
+                int strands[2];
+                std::vector<int> order[2];
+                std::atomic<int> running[2];
+                std::atomic<bool> overlapped(false);
+                running[0] = 0;
+                running[1] = 0;
+
+                {
+                    CallbackExecutor executor(CallbackDispatch::Strand, 4);
+                    for (int i = 0; i < tasksPerStrand; ++i)
+                    {
+                        for (int s = 0; s < 2; ++s)
+                        {
+                            executor.post(&strands[s], [&, s, i]
+                                {
+                                    if (++running[s] != 1)
+                                    {
+                                        overlapped = true;
+                                    }
+                                    order[s].push_back(i);
+                                    --running[s];
+                                });
+                        }
+                    }
+                }
+
+                EXPECT_FALSE(overlapped);
+                for (int s = 0; s < 2; ++s)
+                {
+                    ASSERT_EQ(static_cast<size_t>(tasksPerStrand), order[s].size());
+                    for (int i = 0; i < tasksPerStrand; ++i)
+                    {
+                        EXPECT_EQ(i, order[s][i]);
+                    }
+                }
+            }
+
+            TEST(CallbackExecutorTest, ExceptionDoesNotStopPool)
+            {
+                std::promise<void> done;
+                CallbackExecutor executor(CallbackDispatch::Strand, 1);
+
+                executor.post(&done, []{ throw std::runtime_error("callback failed"); });
+                executor.post(&done, [&done]{ done.set_value(); });
+                EXPECT_EQ(std::future_status::ready,
+                          done.get_future().wait_for(std::chrono::seconds(5)));
+            }
+        }
+    }
+}
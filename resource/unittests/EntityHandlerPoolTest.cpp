@@ -0,0 +1,113 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <atomic>
+#include <future>
+#include <gtest/gtest.h>
+#include <EntityHandlerPool.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace EntityHandlerPoolTests
+        {
+            using namespace OC;
+
+            // Posts tasks of one resource and returns how many of them ran at the same time
+            static int maxRunning(unsigned int threads, unsigned int defaultLimit,
+                                  int resourceLimit)
+            {
+                int resource;
+                std::atomic<int> running(0);
+                std::atomic<int> highest(0);
+                {
+                    EntityHandlerPool pool(threads, defaultLimit);
+                    if (resourceLimit >= 0)
+                    {
+                        pool.setLimit(&resource, resourceLimit);
+                    }
+                    for (int i = 0; i < 40; ++i)
+                    {
+                        pool.post(&resource, [&running, &highest]
+                            {
+                                int now = ++running;
+                                int seen = highest;
+                                while (now > seen && !highest.compare_exchange_weak(seen, now))
+                                {
+                                }
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                --running;
+                            });
+                    }
+                }
+                return highest;
+            }
+
+            TEST(EntityHandlerPoolTest, DefaultLimitSerializesResource)
+            {
+                EXPECT_EQ(1, maxRunning(4, 1, -1));
+            }
+
+            TEST(EntityHandlerPoolTest, ResourceLimitBoundsConcurrency)
+            {
+                int highest = maxRunning(4, 1, 2);
+                EXPECT_LE(highest, 2);
+                EXPECT_GE(highest, 1);
+            }
+
+            TEST(EntityHandlerPoolTest, NoLimitIsBoundByThreads)
+            {
+                EXPECT_LE(maxRunning(4, 1, 0), 4);
+            }
+
+            TEST(EntityHandlerPoolTest, ResourcesDoNotWaitForEachOther)
+            {
+                int first;
+                int second;
+                std::promise<void> secondRan;
+                std::atomic<bool> firstWaited(false);
+
+                {
+                    EntityHandlerPool pool(2, 1);
+                    pool.post(&first, [&secondRan, &firstWaited]
+                        {
+                            firstWaited = secondRan.get_future().wait_for(
+                                std::chrono::seconds(5)) == std::future_status::ready;
+                        });
+                    pool.post(&second, [&secondRan]{ secondRan.set_value(); });
+                }
+                EXPECT_TRUE(firstWaited);
+            }
+
+            TEST(EntityHandlerPoolTest, ExceptionReleasesSlot)
+            {
+                int resource;
+                std::promise<void> done;
+
+                EntityHandlerPool pool(1, 1);
+                pool.post(&resource, []{ throw std::runtime_error("handler failed"); });
+                pool.post(&resource, [&done]{ done.set_value(); });
+                EXPECT_EQ(std::future_status::ready,
+                          done.get_future().wait_for(std::chrono::seconds(5)));
+            }
+        }
+    }
+}
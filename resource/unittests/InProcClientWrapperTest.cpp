@@ -0,0 +1,119 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <InProcClientWrapper.h>
+#include "ocpayload.h"
+
+namespace OC
+{
+    namespace test
+    {
+        namespace InProcClientWrapperTests
+        {
+            using namespace OC;
+
+            struct Received
+            {
+                bool called = false;
+                std::shared_ptr<const OCRepresentation> rep;
+                int eCode = OC_STACK_OK;
+            };
+
+            // Runs getResourceCallback on a synthetic response, the callback runs inline
+            static OCStackApplicationResult deliverGetResponse(OCClientResponse& response,
+                    Received& received)
+            {
+                auto executor = std::make_shared<CallbackExecutor>(CallbackDispatch::Inline, 0);
+                ClientCallbackContext::GetContext context(
+                        [&received](const HeaderOptions&,
+                                    std::shared_ptr<const OCRepresentation> rep, const int eCode)
+                        {
+                            received.called = true;
+                            received.rep = std::move(rep);
+                            received.eCode = eCode;
+                        },
+                        executor);
+                return getResourceCallback(&context, nullptr, &response);
+            }
+
+            TEST(GetResourceCallbackTest, ParsesRepresentation)
+            {
+                OCRepPayload* payload = OCRepPayloadCreate();
+                ASSERT_TRUE(payload != nullptr);
+                EXPECT_TRUE(OCRepPayloadSetPropInt(payload, "power", 10));
+                EXPECT_TRUE(OCRepPayloadSetPropString(payload, "name", "light"));
+
+                OCClientResponse response = OCClientResponse();
+                response.result = OC_STACK_OK;
+                response.resourceUri = "/a/light";
+                response.payload = reinterpret_cast<OCPayload*>(payload);
+
+                Received received;
+                EXPECT_EQ(OC_STACK_DELETE_TRANSACTION, deliverGetResponse(response, received));
+                OCRepPayloadDestroy(payload);
+
+                ASSERT_TRUE(received.called);
+                ASSERT_TRUE(received.rep != nullptr);
+                EXPECT_EQ(OC_STACK_OK, received.eCode);
+                EXPECT_EQ("/a/light", received.rep->getUri());
+                EXPECT_EQ(10, received.rep->getValue<int>("power"));
+                EXPECT_EQ("light", received.rep->getValue<std::string>("name"));
+            }
+
+            TEST(GetResourceCallbackTest, ErrorGivesEmptyRepresentation)
+            {
+                OCClientResponse response = OCClientResponse();
+                response.result = OC_STACK_RESOURCE_DELETED;
+
+                Received received;
+                EXPECT_EQ(OC_STACK_DELETE_TRANSACTION, deliverGetResponse(response, received));
+
+                ASSERT_TRUE(received.called);
+                ASSERT_TRUE(received.rep != nullptr);
+                EXPECT_TRUE(received.rep->emptyData());
+                EXPECT_EQ(OC_STACK_RESOURCE_DELETED, received.eCode);
+            }
+
+            TEST(ShareRepresentationTest, PassesSharedRepresentation)
+            {
+                const OCRepresentation* seen = nullptr;
+                GetCallback callback =
+                    [&seen](const HeaderOptions&, const OCRepresentation& rep, const int)
+                    {
+                        seen = &rep;
+                    };
+
+                SharedGetCallback shared = shareRepresentation(callback);
+                ASSERT_TRUE(static_cast<bool>(shared));
+
+                auto rep = std::make_shared<const OCRepresentation>();
+                shared(HeaderOptions(), rep, OC_STACK_OK);
+                EXPECT_EQ(rep.get(), seen);
+            }
+
+            TEST(ShareRepresentationTest, NullCallback)
+            {
+                EXPECT_FALSE(static_cast<bool>(shareRepresentation(GetCallback())));
+                EXPECT_FALSE(static_cast<bool>(shareRepresentation(ObserveCallback())));
+            }
+        }
+    }
+}
@@ -0,0 +1,155 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <thread>
+#include <gtest/gtest.h>
+#include <OCFuture.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace OCFutureTests
+        {
+            using namespace OC;
+
+            TEST(OCFutureTest, DefaultIsNotValid)
+            {
+                OCFuture<int> future;
+                EXPECT_FALSE(future.valid());
+                EXPECT_THROW(future.ready(), std::logic_error);
+            }
+
+            TEST(OCFutureTest, ValueIsSetOnce)
+            {
+                OCPromise<int> promise;
+                OCFuture<int> future = promise.getFuture();
+                EXPECT_TRUE(future.valid());
+                EXPECT_FALSE(future.ready());
+
+                EXPECT_TRUE(promise.setValue(1));
+                EXPECT_FALSE(promise.setValue(2));
+                EXPECT_TRUE(future.ready());
+                EXPECT_EQ(1, future.get());
+                EXPECT_EQ(1, future.get());
+            }
+
+            TEST(OCFutureTest, GetWaitsForOtherThread)
+            {
+                OCPromise<int> promise;
+                OCFuture<int> future = promise.getFuture();
+                EXPECT_FALSE(future.waitFor(std::chrono::milliseconds(1)));
+
+                std::thread setter([promise]{ promise.setValue(42); });
+                EXPECT_EQ(42, future.get());
+                setter.join();
+            }
+
+            TEST(OCFutureTest, ThenRunsWhenSetOrRightAway)
+            {
+                OCPromise<int> promise;
+                OCFuture<int> future = promise.getFuture();
+                int before = 0;
+                int after = 0;
+
+                future.then([&before](const int& value){ before = value; });
+                EXPECT_EQ(0, before);
+                promise.setValue(3);
+                EXPECT_EQ(3, before);
+
+                future.then([&after](const int& value){ after = value; });
+                EXPECT_EQ(3, after);
+            }
+
+            TEST(OCFutureTest, CancelRunsCancellerOnce)
+            {
+                OCPromise<int> promise;
+                OCFuture<int> future = promise.getFuture();
+                int cancelled = 0;
+                promise.setCanceller([promise, &cancelled]
+                    {
+                        ++cancelled;
+                        promise.setValue(-1);
+                    });
+
+                future.cancel();
+                future.cancel();
+                EXPECT_EQ(1, cancelled);
+                EXPECT_EQ(-1, future.get());
+            }
+
+            TEST(OCFutureTest, CancelAfterValueDoesNothing)
+            {
+                OCPromise<int> promise;
+                bool cancelled = false;
+                promise.setCanceller([&cancelled]{ cancelled = true; });
+                promise.setValue(5);
+
+                promise.getFuture().cancel();
+                EXPECT_FALSE(cancelled);
+                EXPECT_EQ(5, promise.getFuture().get());
+            }
+
+            TEST(OCFutureTest, WhenAllKeepsOrder)
+            {
+                std::vector<OCPromise<int>> promises(3);
+                std::vector<OCFuture<int>> futures;
+                for (auto& promise : promises)
+                {
+                    futures.push_back(promise.getFuture());
+                }
+
+                OCFuture<std::vector<int>> all = when_all(futures);
+                promises[2].setValue(2);
+                promises[0].setValue(0);
+                EXPECT_FALSE(all.ready());
+                promises[1].setValue(1);
+
+                ASSERT_TRUE(all.ready());
+                EXPECT_EQ((std::vector<int>{0, 1, 2}), all.get());
+            }
+
+            TEST(OCFutureTest, WhenAllOfNothingIsReady)
+            {
+                OCFuture<std::vector<int>> all = when_all(std::vector<OCFuture<int>>());
+                ASSERT_TRUE(all.ready());
+                EXPECT_TRUE(all.get().empty());
+            }
+
+            TEST(OCFutureTest, WhenAllCancelsEachFuture)
+            {
+                std::vector<OCPromise<int>> promises(2);
+                std::vector<OCFuture<int>> futures;
+                for (auto& promise : promises)
+                {
+                    promise.setCanceller([promise]{ promise.setValue(-1); });
+                    futures.push_back(promise.getFuture());
+                }
+                promises[0].setValue(0);
+
+                OCFuture<std::vector<int>> all = when_all(futures);
+                all.cancel();
+
+                ASSERT_TRUE(all.ready());
+                EXPECT_EQ((std::vector<int>{0, -1}), all.get());
+            }
+        }
+    }
+}
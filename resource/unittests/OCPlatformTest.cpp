@@ -20,6 +20,7 @@
 
 #include <OCPlatform.h>
 #include <OCApi.h>
+#include <InProcServerWrapper.h>
 #include <gtest/gtest.h>
 
 namespace OCPlatformTest
@@ -344,6 +345,36 @@ namespace OCPlatformTest
         EXPECT_ANY_THROW(OC::OCPlatform::unregisterResource(HANDLE_ZERO));
     }
 
+    TEST(UnregisterTest, UnregisterResource)
+    {
+        OCResourceHandle handle = RegisterResource(std::string("/a/unregister"));
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(UnregisterTest, UnregisterResourceWithEntityHandlerPool)
+    {
+        auto csdkLock = std::make_shared<std::recursive_mutex>();
+        PlatformConfig cfg
+        { OC::ServiceType::InProc, OC::ModeType::Server, "0.0.0.0", 0,
+                OC::QualityOfService::LowQos, &gps };
+        cfg.entityHandlerThreads = 1;
+
+        {
+            InProcServerWrapper wrapper(csdkLock, cfg);
+            OCResourceHandle handle = nullptr;
+            std::string uri = "/a/unregisterpooled";
+            EntityHandler handler = entityHandler;
+            EXPECT_EQ(OC_STACK_OK, wrapper.registerResource(handle, uri, gResourceTypeName,
+                    gResourceInterface, handler, gResourceProperty));
+            EXPECT_EQ(OC_STACK_OK, wrapper.setEntityHandlerConcurrency(handle, 2));
+            EXPECT_EQ(OC_STACK_OK, wrapper.unregisterResource(handle));
+            EXPECT_ANY_THROW(wrapper.unregisterResource(handle));
+        }
+
+        // The wrapper stopped the stack the platform shares with it
+        EXPECT_EQ(OC_STACK_OK, OCInit1(OC_CLIENT_SERVER, OC_DEFAULT_FLAGS, OC_DEFAULT_FLAGS));
+    }
+
     //UnbindResourcesTest
     TEST(UnbindResourcesTest, UnbindResources)
     {
@@ -530,6 +561,35 @@ namespace OCPlatformTest
             interestedObservers, resourceResponse,OC::QualityOfService::HighQos));
     }
 
+    TEST(NotifyAllObserverTest, NotifyListOfObserversWithRepresentations)
+    {
+        OCResourceHandle resourceHome = RegisterResource(std::string("/a/obs11"),
+            std::string("core.obs"));
+
+        auto on = std::make_shared<OCRepresentation>();
+        on->setValue("state", true);
+        auto off = std::make_shared<OCRepresentation>();
+        off->setValue("state", false);
+
+        ObserverNotifications notifications{{1, on}, {2, off}, {3, on}};
+        EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCPlatform::notifyListOfObservers(resourceHome,
+            notifications));
+        EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCPlatform::notifyListOfObservers(resourceHome,
+            notifications, OC::QualityOfService::HighQos));
+    }
+
+    TEST(NotifyAllObserverTest, NotifyListOfObserversWithInvalidRepresentations)
+    {
+        OCResourceHandle resourceHome = RegisterResource(std::string("/a/obs12"),
+            std::string("core.obs"));
+
+        ObserverNotifications notifications;
+        EXPECT_ANY_THROW(OCPlatform::notifyListOfObservers(resourceHome, notifications));
+
+        notifications.emplace_back(1, nullptr);
+        EXPECT_ANY_THROW(OCPlatform::notifyListOfObservers(resourceHome, notifications));
+    }
+
     //DeviceEntityHandlerTest
     TEST(DeviceEntityHandlerTest, SetDefaultDeviceEntityHandler)
     {
@@ -693,6 +753,69 @@ namespace OCPlatformTest
                         OC::QualityOfService::NaQos));
     }
 
+    //SendRequests Test
+    std::vector<BatchRequest> makeBatch(size_t count, OCMethod method)
+    {
+        std::vector<BatchRequest> requests(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            requests[i].devAddr = OCDevAddr();
+            requests[i].devAddr.adapter = OC_ADAPTER_IP;
+            strncpy(requests[i].devAddr.addr, "127.0.0.1", sizeof(requests[i].devAddr.addr) - 1);
+            requests[i].devAddr.port = 5683;
+            requests[i].uri = "/a/light";
+            requests[i].method = method;
+            requests[i].callback = [](const HeaderOptions&, const OCRepresentation&, const int){};
+        }
+        return requests;
+    }
+
+    TEST(SendRequestsTest, DISABLED_SendRequestsWithValidParameters)
+    {
+        PlatformConfig cfg;
+        OCPlatform::Configure(cfg);
+        std::vector<BatchRequest> requests = makeBatch(10, OC_REST_GET);
+        requests[5].method = OC_REST_PUT;
+        requests[9].method = OC_REST_DELETE;
+        std::vector<OCDoHandle> handles;
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::sendRequests(requests, handles));
+        ASSERT_EQ(requests.size(), handles.size());
+        for (auto handle : handles)
+        {
+            EXPECT_NE(nullptr, handle);
+        }
+    }
+
+    TEST(SendRequestsTest, SendRequestsWithEmptyBatch)
+    {
+        PlatformConfig cfg;
+        OCPlatform::Configure(cfg);
+        std::vector<BatchRequest> requests;
+        std::vector<OCDoHandle> handles(1);
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::sendRequests(requests, handles));
+        EXPECT_TRUE(handles.empty());
+    }
+
+    TEST(SendRequestsTest, SendRequestsWithNullCallback)
+    {
+        PlatformConfig cfg;
+        OCPlatform::Configure(cfg);
+        std::vector<BatchRequest> requests = makeBatch(3, OC_REST_GET);
+        requests[1].callback = nullptr;
+        std::vector<OCDoHandle> handles;
+        EXPECT_THROW(OCPlatform::sendRequests(requests, handles), OC::OCException);
+    }
+
+    TEST(SendRequestsTest, SendRequestsWithInvalidMethod)
+    {
+        PlatformConfig cfg;
+        OCPlatform::Configure(cfg);
+        std::vector<BatchRequest> requests = makeBatch(3, OC_REST_GET);
+        requests[2].method = OC_REST_OBSERVE;
+        std::vector<OCDoHandle> handles;
+        EXPECT_THROW(OCPlatform::sendRequests(requests, handles), OC::OCException);
+    }
+
     //RegisterDeviceInfo test
     TEST(RegisterDeviceInfoTest, RegisterDeviceInfoWithValidParameters)
     {
@@ -676,6 +676,171 @@ namespace OCRepresentationEncodingTest
         OCPayloadDestroy(cparsed);
     }
 
+    // Decodes CBOR like the client does without OC_PAYLOAD_PARSE_ENCODED
+    static OC::MessageContainer decodeThroughPayload(const uint8_t* cborData, size_t cborSize)
+    {
+        OCPayload* cparsed = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OC::MessageContainer mc;
+        mc.setPayload(cparsed);
+        OCPayloadDestroy(cparsed);
+        return mc;
+    }
+
+    static OC::MessageContainer decodeDirect(const uint8_t* cborData, size_t cborSize)
+    {
+        uint8_t* copy = (uint8_t*)OICMalloc(cborSize);
+        memcpy(copy, cborData, cborSize);
+        OCEncodedPayload* encoded = OCEncodedPayloadCreate(copy, cborSize);
+        OC::MessageContainer mc;
+        mc.setPayload((OCPayload*)encoded);
+        OCPayloadDestroy((OCPayload*)encoded);
+        return mc;
+    }
+
+    static void expectDirectCodecMatchesPayload(const OC::MessageContainer& mc1)
+    {
+        // Encoded through an OCRepPayload
+        OCRepPayload* cstart = mc1.getPayload();
+        uint8_t* cborData = NULL;
+        size_t cborSize = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)cstart, &cborData, &cborSize));
+        OCPayloadDestroy((OCPayload*)cstart);
+
+        // Encoded directly
+        OCEncodedPayload* encoded = mc1.getEncodedPayload();
+        ASSERT_NE(nullptr, encoded);
+        EXPECT_EQ(PAYLOAD_TYPE_ENCODED, encoded->base.type);
+
+        OC::MessageContainer viaPayload = decodeThroughPayload(cborData, cborSize);
+        OC::MessageContainer directEncoded = decodeThroughPayload(encoded->data, encoded->size);
+        OC::MessageContainer directDecoded = decodeDirect(cborData, cborSize);
+        OC::MessageContainer direct = decodeDirect(encoded->data, encoded->size);
+
+        EXPECT_EQ(viaPayload.representations(), directEncoded.representations());
+        EXPECT_EQ(viaPayload.representations(), directDecoded.representations());
+        EXPECT_EQ(viaPayload.representations(), direct.representations());
+
+        OICFree(cborData);
+        OCPayloadDestroy((OCPayload*)encoded);
+    }
+
+    TEST(RepresentationEncodingDirect, BaseAttributeTypes)
+    {
+        OC::OCRepresentation subRep;
+        subRep.setUri("/sub");
+        subRep.setNULL("NullAttr");
+        subRep.setValue("IntAttr", -77);
+        subRep.setValue("StringAttr", std::string("String attr"));
+
+        OC::OCRepresentation startRep;
+        startRep.addResourceType("rt.first");
+        startRep.addResourceType("rt.second");
+        startRep.addResourceInterface(OC::DEFAULT_INTERFACE);
+        startRep.setNULL("NullAttr");
+        startRep.setValue("IntAttr", 1 << 20);
+        startRep.setValue("DoubleAttr", 3.333);
+        startRep.setValue("BoolAttr", true);
+        startRep.setValue("StringAttr", std::string("String attr"));
+        startRep.setValue("EmptyStringAttr", std::string());
+        startRep.setValue("RepAttr", subRep);
+
+        OC::MessageContainer mc1;
+        mc1.addRepresentation(startRep);
+        expectDirectCodecMatchesPayload(mc1);
+
+        OCEncodedPayload* encoded = mc1.getEncodedPayload();
+        OC::MessageContainer mc2 = decodeDirect(encoded->data, encoded->size);
+        OCPayloadDestroy((OCPayload*)encoded);
+
+        ASSERT_EQ(1u, mc2.representations().size());
+        const OC::OCRepresentation& r = mc2.representations()[0];
+        EXPECT_EQ(startRep.getResourceTypes(), r.getResourceTypes());
+        EXPECT_EQ(startRep.getResourceInterfaces(), r.getResourceInterfaces());
+        EXPECT_TRUE(r.isNULL("NullAttr"));
+        EXPECT_EQ(1 << 20, r.getValue<int>("IntAttr"));
+        EXPECT_EQ(3.333, r.getValue<double>("DoubleAttr"));
+        EXPECT_EQ(true, r.getValue<bool>("BoolAttr"));
+        EXPECT_EQ("String attr", r.getValue<std::string>("StringAttr"));
+        EXPECT_EQ("", r.getValue<std::string>("EmptyStringAttr"));
+
+        // Nested representations carry their values only
+        OC::OCRepresentation sub = r.getValue<OC::OCRepresentation>("RepAttr");
+        EXPECT_EQ("", sub.getUri());
+        EXPECT_EQ(-77, sub.getValue<int>("IntAttr"));
+        EXPECT_TRUE(sub.isNULL("NullAttr"));
+    }
+
+    TEST(RepresentationEncodingDirect, JaggedVectors)
+    {
+        OC::OCRepresentation subRep1;
+        OC::OCRepresentation subRep2;
+        subRep1.setValue("IntAttr", 77);
+        subRep2.setValue("BoolAttr", false);
+
+        OC::OCRepresentation startRep;
+        startRep["iarr"] = std::vector<int>{1, 2, 3};
+        startRep["empty"] = std::vector<int>{};
+        startRep["barr"] = std::vector<std::vector<bool>>{{true}, {false, true, true}};
+        startRep["darr"] = std::vector<std::vector<double>>{{1.5, 2.5}, {}, {3.5}};
+        startRep["strarr"] = std::vector<std::vector<std::vector<std::string>>>
+            {{{"a", "b"}, {"c"}}, {{"d"}}};
+        startRep["objarr"] = std::vector<std::vector<OC::OCRepresentation>>
+            {{subRep1}, {subRep2, subRep1}};
+
+        OC::MessageContainer mc1;
+        mc1.addRepresentation(startRep);
+        expectDirectCodecMatchesPayload(mc1);
+
+        OCEncodedPayload* encoded = mc1.getEncodedPayload();
+        OC::MessageContainer mc2 = decodeDirect(encoded->data, encoded->size);
+        OCPayloadDestroy((OCPayload*)encoded);
+        const OC::OCRepresentation& r = mc2.representations()[0];
+
+        // Arrays are received backfilled to be rectangular
+        std::vector<std::vector<double>> darr = r["darr"];
+        std::vector<std::vector<double>> expectedDarr {{1.5, 2.5}, {0.0, 0.0}, {3.5, 0.0}};
+        EXPECT_EQ(expectedDarr, darr);
+        std::vector<std::vector<std::vector<std::string>>> strarr = r["strarr"];
+        std::vector<std::vector<std::vector<std::string>>> expectedStrarr
+            {{{"a", "b"}, {"c", ""}}, {{"d", ""}, {"", ""}}};
+        EXPECT_EQ(expectedStrarr, strarr);
+        EXPECT_TRUE(r.isNULL("empty"));
+    }
+
+    TEST(RepresentationEncodingDirect, Collection)
+    {
+        OC::OCRepresentation parent;
+        parent.setUri("/a/collection");
+        parent.setValue("name", std::string("parent"));
+        OC::OCRepresentation child;
+        child.setUri("/a/child");
+        child.addResourceType("core.light");
+        child.setValue("power", 10);
+
+        OC::MessageContainer mc1;
+        mc1.addRepresentation(parent);
+        mc1.addRepresentation(child);
+        expectDirectCodecMatchesPayload(mc1);
+
+        OCEncodedPayload* encoded = mc1.getEncodedPayload();
+        OC::MessageContainer mc2 = decodeDirect(encoded->data, encoded->size);
+        OCPayloadDestroy((OCPayload*)encoded);
+
+        ASSERT_EQ(2u, mc2.representations().size());
+        EXPECT_EQ("/a/collection", mc2.representations()[0].getUri());
+        EXPECT_EQ("/a/child", mc2.representations()[1].getUri());
+        EXPECT_EQ(10, mc2.representations()[1].getValue<int>("power"));
+    }
+
+    TEST(RepresentationEncodingDirect, MixedArrayIsMalformed)
+    {
+        // {"a": [1, "x"]}
+        const uint8_t cborData[] = {0xa1, 0x61, 'a', 0x82, 0x01, 0x61, 'x'};
+        EXPECT_THROW(decodeDirect(cborData, sizeof(cborData)), OC::OCException);
+    }
+
     TEST(DiscoveryRTandIF, SingleItemNormal)
     {
         OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
@@ -0,0 +1,235 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <OCRepresentationSchema.h>
+#include "BenchmarkHelpers.h"
+
+namespace OCRepresentationSchemaTest
+{
+    using namespace OC;
+
+    struct Color
+    {
+        int hue;
+        double saturation;
+    };
+
+    struct Light
+    {
+        bool state;
+        int power;
+        double level;
+        std::string name;
+        std::vector<int> modes;
+        std::vector<std::vector<std::string>> scenes;
+        Color color;
+    };
+
+    static const auto colorSchema = makeSchema<Color>(
+            schemaField("hue", &Color::hue),
+            schemaField("saturation", &Color::saturation));
+
+    static const auto lightSchema = makeSchema<Light>(
+            schemaField("state", &Light::state),
+            schemaField("power", &Light::power),
+            schemaField("level", &Light::level),
+            schemaField("name", &Light::name),
+            schemaField("modes", &Light::modes),
+            schemaField("scenes", &Light::scenes),
+            schemaField("color", &Light::color, colorSchema));
+
+    static Light light()
+    {
+        Light light;
+        light.state = true;
+        light.power = -42;
+        light.level = 0.75;
+        light.name = "desk";
+        light.modes = {1, 2, 3};
+        light.scenes = {{"day", "night"}, {"away"}};
+        light.color.hue = 120;
+        light.color.saturation = 0.5;
+        return light;
+    }
+
+    static OCRepresentation lightRepresentation()
+    {
+        OCRepresentation color;
+        color.setValue("hue", 120);
+        color.setValue("saturation", 0.5);
+
+        OCRepresentation rep;
+        rep.setValue("state", true);
+        rep.setValue("power", -42);
+        rep.setValue("level", 0.75);
+        rep.setValue("name", std::string("desk"));
+        rep.setValue("modes", std::vector<int>{1, 2, 3});
+        rep.setValue("scenes", std::vector<std::vector<std::string>>{{"day", "night"},
+                                                                      {"away", ""}});
+        rep.setValue("color", color);
+        return rep;
+    }
+
+    static void expectLight(const Light& light)
+    {
+        EXPECT_TRUE(light.state);
+        EXPECT_EQ(-42, light.power);
+        EXPECT_EQ(0.75, light.level);
+        EXPECT_EQ("desk", light.name);
+        EXPECT_EQ((std::vector<int>{1, 2, 3}), light.modes);
+        ASSERT_EQ(2u, light.scenes.size());
+        EXPECT_EQ((std::vector<std::string>{"day", "night"}), light.scenes[0]);
+        EXPECT_EQ("away", light.scenes[1][0]);
+        EXPECT_EQ(120, light.color.hue);
+        EXPECT_EQ(0.5, light.color.saturation);
+    }
+
+    static std::shared_ptr<OCEncodedPayload> encodeRepresentation(const OCRepresentation& rep)
+    {
+        MessageContainer container;
+        container.addRepresentation(rep);
+        return std::shared_ptr<OCEncodedPayload>(container.getEncodedPayload(),
+                                                 OCEncodedPayloadDestroy);
+    }
+
+    TEST(RepresentationSchema, EncodingDecodesAsRepresentation)
+    {
+        std::shared_ptr<OCEncodedPayload> payload(lightSchema.encode(light()),
+                                                  OCEncodedPayloadDestroy);
+        ASSERT_NE(nullptr, payload);
+
+        MessageContainer container;
+        container.setPayload(payload.get());
+        ASSERT_EQ(1u, container.representations().size());
+        const OCRepresentation& rep = container.representations()[0];
+
+        EXPECT_EQ(7, rep.numberOfAttributes());
+        EXPECT_TRUE(rep.getValue<bool>("state"));
+        EXPECT_EQ(-42, rep.getValue<int>("power"));
+        EXPECT_EQ(0.75, rep.getValue<double>("level"));
+        EXPECT_EQ("desk", rep.getValue<std::string>("name"));
+        EXPECT_EQ((std::vector<int>{1, 2, 3}), rep.getValue<std::vector<int>>("modes"));
+        EXPECT_EQ(120, rep.getValue<OCRepresentation>("color").getValue<int>("hue"));
+    }
+
+    TEST(RepresentationSchema, DecodesRepresentationEncoding)
+    {
+        std::shared_ptr<OCEncodedPayload> payload = encodeRepresentation(lightRepresentation());
+
+        Light decoded = Light();
+        lightSchema.decode(payload.get(), decoded);
+        expectLight(decoded);
+    }
+
+    TEST(RepresentationSchema, RoundTrip)
+    {
+        std::shared_ptr<OCEncodedPayload> payload(lightSchema.encode(light()),
+                                                  OCEncodedPayloadDestroy);
+
+        Light decoded = Light();
+        lightSchema.decode(payload.get(), decoded);
+        expectLight(decoded);
+    }
+
+    TEST(RepresentationSchema, SkipsUnknownAndKeepsMissingAttributes)
+    {
+        OCRepresentation rep;
+        rep.setResourceTypes({"core.light"});
+        rep.setValue("power", 7);
+        rep.setValue("unknown", std::vector<double>{1.0, 2.0});
+        rep.setValue("nested", OCRepresentation());
+        rep.setNULL("name");
+        std::shared_ptr<OCEncodedPayload> payload = encodeRepresentation(rep);
+
+        Light decoded = light();
+        lightSchema.decode(payload.get(), decoded);
+        EXPECT_EQ(7, decoded.power);
+        EXPECT_TRUE(decoded.state);
+        EXPECT_EQ("", decoded.name);
+        EXPECT_EQ(120, decoded.color.hue);
+    }
+
+    TEST(RepresentationSchema, MismatchedTypeThrows)
+    {
+        OCRepresentation rep;
+        rep.setValue("power", std::string("high"));
+        std::shared_ptr<OCEncodedPayload> payload = encodeRepresentation(rep);
+
+        Light decoded = Light();
+        EXPECT_THROW(lightSchema.decode(payload.get(), decoded), OCException);
+        EXPECT_THROW(lightSchema.decode(rep, decoded), OCException);
+    }
+
+    TEST(RepresentationSchema, DecodesRepresentation)
+    {
+        Light decoded = Light();
+        lightSchema.decode(lightRepresentation(), decoded);
+        expectLight(decoded);
+    }
+
+    TEST(RepresentationSchema, EncodesLargeRepresentation)
+    {
+        Light large = light();
+        large.name = std::string(1000, 'n');
+        large.modes.assign(500, 7);
+
+        std::shared_ptr<OCEncodedPayload> payload(lightSchema.encode(large),
+                                                  OCEncodedPayloadDestroy);
+        Light decoded = Light();
+        lightSchema.decode(payload.get(), decoded);
+        EXPECT_EQ(large.name, decoded.name);
+        EXPECT_EQ(large.modes, decoded.modes);
+    }
+
+    // Compares the schema with OCRepresentation, run with
+    // --gtest_also_run_disabled_tests --gtest_filter=RepresentationSchemaBenchmark.*
+    using namespace OCBenchmark;
+
+    TEST(RepresentationSchemaBenchmark, DISABLED_EncodeDecode)
+    {
+        Light value = light();
+        size_t total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BenchmarkRounds; ++i)
+        {
+            std::shared_ptr<OCEncodedPayload> payload(lightSchema.encode(value),
+                                                      OCEncodedPayloadDestroy);
+            lightSchema.decode(payload.get(), value);
+            total += value.modes.size();
+        }
+        reportBenchmark("schema", std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BenchmarkRounds; ++i)
+        {
+            OCRepresentation rep = lightRepresentation();
+            std::shared_ptr<OCEncodedPayload> payload = encodeRepresentation(rep);
+            MessageContainer container;
+            container.setPayload(payload.get());
+            total += container.representations()[0]
+                    .getValue<std::vector<int>>("modes").size();
+        }
+        reportBenchmark("representation", std::chrono::steady_clock::now() - start);
+        EXPECT_EQ(6u * BenchmarkRounds, total);
+    }
+}
@@ -23,6 +23,8 @@
 #include <string>
 #include <limits>
 #include <boost/lexical_cast.hpp>
+#include <chrono>
+#include "BenchmarkHelpers.h"
 namespace OCRepresentationTest
 {
     using namespace OC;
@@ -1310,4 +1312,161 @@ namespace OCRepresentationTest
             }
         }
     }
+
+    TEST(OCRepresentationStorage, IteratesInNameOrder)
+    {
+        OCRepresentation rep;
+        rep.setValue("string", std::string("this is a string"));
+        rep.setValue("bool", true);
+        rep.setValue("int", 8);
+        rep.setValue("double", 8.8);
+        rep.setValue("int", 9);
+
+        vector<string> names;
+        for (const auto& item : rep)
+        {
+            names.push_back(item.attrname());
+        }
+        EXPECT_EQ((vector<string>{"bool", "double", "int", "string"}), names);
+        EXPECT_EQ(9, rep.getValue<int>("int"));
+
+        EXPECT_TRUE(rep.erase("double"));
+        EXPECT_FALSE(rep.erase("double"));
+        EXPECT_FALSE(rep.hasAttribute("double"));
+        EXPECT_TRUE(rep.hasAttribute("string"));
+        EXPECT_EQ(3, rep.numberOfAttributes());
+    }
+
+    TEST(OCRepresentationStorage, CopyKeepsChildrenUntilChanged)
+    {
+        OCRepresentation child;
+        child.setUri("/child1");
+        child.setValue("int", 1);
+
+        OCRepresentation rep;
+        rep.addChild(child);
+
+        OCRepresentation copy(rep);
+        EXPECT_EQ(&rep.getChildren(), &copy.getChildren());
+
+        child.setUri("/child2");
+        copy.addChild(child);
+        ASSERT_EQ(1u, rep.getChildren().size());
+        ASSERT_EQ(2u, copy.getChildren().size());
+        EXPECT_EQ("/child1", rep.getChildren()[0].getUri());
+        EXPECT_EQ("/child2", copy.getChildren()[1].getUri());
+
+        copy.clearChildren();
+        EXPECT_TRUE(copy.getChildren().empty());
+        EXPECT_EQ(1u, rep.getChildren().size());
+
+        copy.setChildren(rep.getChildren());
+        EXPECT_EQ(1, copy.getChildren()[0].getValue<int>("int"));
+        EXPECT_FALSE(copy.emptyData());
+    }
+
+    TEST(OCRepresentationStorage, ReleaseRepresentationsEmptiesContainer)
+    {
+        OCRepresentation rep;
+        rep.setUri("/a");
+        rep.setValue("int", 8);
+
+        MessageContainer container;
+        container.addRepresentation(rep);
+        rep.setUri("/b");
+        container.addRepresentation(std::move(rep));
+
+        vector<OCRepresentation> reps = container.releaseRepresentations();
+        EXPECT_TRUE(container.representations().empty());
+        ASSERT_EQ(2u, reps.size());
+        EXPECT_EQ("/a", reps[0].getUri());
+        EXPECT_EQ("/b", reps[1].getUri());
+        EXPECT_EQ(8, reps[1].getValue<int>("int"));
+
+        OCRepresentation root(std::move(reps[0]));
+        root.addChild(std::move(reps[1]));
+        ASSERT_EQ(1u, root.getChildren().size());
+        EXPECT_EQ("/b", root.getChildren()[0].getUri());
+    }
+
+    // Timings of the representation workloads above, run with
+    // --gtest_also_run_disabled_tests --gtest_filter=OCRepresentationBenchmark.*
+    using namespace OCBenchmark;
+
+    static OCRepresentation benchmarkRepresentation()
+    {
+        OCRepresentation sub;
+        sub.setUri("/sub");
+        sub.setValue("int", 1);
+
+        OCRepresentation rep;
+        rep.setUri("/this/is/a/uri");
+        rep.setValue("int", 8);
+        rep.setValue("double", 8.8);
+        rep.setValue("bool", true);
+        rep.setValue("string", std::string("this is a string"));
+        rep.setValue("rep", sub);
+        rep.setValue("intv", vector<int>{1, 2, 3, 4});
+        rep.setValue("stringv", vector<string>{"s1", "s2", "s3"});
+        rep.setValue("repv", vector<OCRepresentation>{sub, sub});
+        for (int i = 0; i < 4; ++i)
+        {
+            rep.addChild(sub);
+        }
+        return rep;
+    }
+
+    TEST(OCRepresentationBenchmark, DISABLED_Copy)
+    {
+        OCRepresentation rep = benchmarkRepresentation();
+        size_t total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BenchmarkRounds; ++i)
+        {
+            OCRepresentation copy(rep);
+            total += copy.size();
+        }
+        reportBenchmark("copy", std::chrono::steady_clock::now() - start);
+        EXPECT_EQ(rep.size() * BenchmarkRounds, total);
+    }
+
+    TEST(OCRepresentationBenchmark, DISABLED_Set)
+    {
+        size_t total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BenchmarkRounds; ++i)
+        {
+            OCRepresentation rep;
+            rep.setValue("int", i);
+            rep.setValue("double", 8.8);
+            rep.setValue("bool", true);
+            rep.setValue("string", std::string("this is a string"));
+            rep["power"] = i;
+            rep["state"] = false;
+            rep.setValue("int", i + 1);
+            total += rep.size();
+        }
+        reportBenchmark("set", std::chrono::steady_clock::now() - start);
+        EXPECT_EQ(6u * BenchmarkRounds, total);
+    }
+
+    TEST(OCRepresentationBenchmark, DISABLED_Iterate)
+    {
+        const OCRepresentation rep = benchmarkRepresentation();
+        size_t total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BenchmarkRounds; ++i)
+        {
+            for (const auto& item : rep)
+            {
+                total += item.depth();
+            }
+            total += rep.getValue<int>("int");
+        }
+        reportBenchmark("iterate", std::chrono::steady_clock::now() - start);
+        EXPECT_LT(0u, total);
+    }
 }
@@ -40,6 +40,19 @@ namespace OCResourceTest
         EXPECT_EQ(eCode, OC_STACK_OK);
     }
 
+    void onSharedObserve(const HeaderOptions&, std::shared_ptr<const OCRepresentation> rep,
+            const int, const int)
+    {
+        EXPECT_TRUE(rep != nullptr);
+    }
+
+    void onSharedGetPut(const HeaderOptions&, std::shared_ptr<const OCRepresentation> rep,
+            const int eCode)
+    {
+        EXPECT_TRUE(rep != nullptr);
+        EXPECT_EQ(eCode, OC_STACK_OK);
+    }
+
     void foundResource(std::shared_ptr<OCResource> )
     {
     }
@@ -194,6 +207,30 @@ namespace OCResourceTest
         EXPECT_EQ(OC_STACK_OK, resource->get("", DEFAULT_INTERFACE, QueryParamsMap(), &onGetPut));
     }
 
+    TEST(ResourceGetTest, DISABLED_ResourceGetSharedRepresentation)
+    {
+        OCResource::Ptr resource = ConstructResourceObject("coap://192.168.1.2:5000", "/resource");
+        EXPECT_TRUE(resource != NULL);
+        EXPECT_EQ(OC_STACK_OK, resource->get(OC::QueryParamsMap(), &onSharedGetPut));
+        EXPECT_EQ(OC_STACK_OK,
+                resource->get(OC::QueryParamsMap(), &onSharedGetPut, QualityOfService::NaQos));
+    }
+
+    TEST(ResourceGetTest, ResourceGetAsyncCancel)
+    {
+        OCResource::Ptr resource = ConstructResourceObject("coap://127.0.0.1:5000", "/resource");
+        EXPECT_TRUE(resource != NULL);
+        OCFuture<RequestResult> future = resource->getAsync(OC::QueryParamsMap());
+        future.cancel();
+        EXPECT_TRUE(future.ready());
+        EXPECT_EQ(OC_STACK_REQUEST_CANCELLED, future.get().result);
+        EXPECT_TRUE(future.get().representation != NULL);
+
+        // A second cancel once the result is set does nothing
+        future.cancel();
+        EXPECT_EQ(OC_STACK_REQUEST_CANCELLED, future.get().result);
+    }
+
     //Post Test
     TEST(ResourcePostTest, DISABLED_ResourcePostValidConfiguration)
     {
@@ -324,6 +361,16 @@ namespace OCResourceTest
         EXPECT_EQ(OC_STACK_OK, resource->observe(ObserveType::ObserveAll, query, &onObserve));
     }
 
+    TEST(ResourceObserveTest, DISABLED_ResourceObserveSharedRepresentation)
+    {
+        OCResource::Ptr resource =
+                ConstructResourceObject("coap://192.168.1.2:5000", "/Observe");
+        EXPECT_TRUE(resource != NULL);
+        QueryParamsMap query = {};
+        EXPECT_EQ(OC_STACK_OK,
+                resource->observe(ObserveType::ObserveAll, query, &onSharedObserve));
+    }
+
     TEST(ResourceObserveTest, DISABLED_ResourceObserveLoQos)
     {
         QueryParamsMap query = {};
@@ -0,0 +1,162 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <ResourceCache.h>
+#include <OutOfProcClientWrapper.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace ResourceCacheTests
+        {
+            using namespace OC;
+
+            static const char SID[] = "e61c3d2e-b4d2-4d3c-9e29-7a9a4f1cd7b0";
+
+            // Discovery payload of one resource, pointing into its own storage
+            class ResourcePayload
+            {
+                public:
+                    ResourcePayload(const char* uri, const char* type)
+                        : m_uri(uri), m_type(type), m_interface("oic.if.baseline")
+                    {
+                        memset(&m_types, 0, sizeof(m_types));
+                        memset(&m_interfaces, 0, sizeof(m_interfaces));
+                        memset(&m_payload, 0, sizeof(m_payload));
+                        m_types.value = &m_type[0];
+                        m_interfaces.value = &m_interface[0];
+                        m_payload.uri = &m_uri[0];
+                        m_payload.types = &m_types;
+                        m_payload.interfaces = &m_interfaces;
+                        m_payload.bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+                    }
+
+                    const OCResourcePayload* get() const
+                    {
+                        return &m_payload;
+                    }
+
+                private:
+                    std::string m_uri;
+                    std::string m_type;
+                    std::string m_interface;
+                    OCStringLL m_types;
+                    OCStringLL m_interfaces;
+                    OCResourcePayload m_payload;
+            };
+
+            class ResourceCacheTest : public testing::Test
+            {
+                protected:
+                    ResourceCacheTest()
+                        : m_clientWrapper(std::make_shared<OutOfProcClientWrapper>(
+                                    std::weak_ptr<std::recursive_mutex>(), PlatformConfig()))
+                    {
+                        memset(&m_devAddr, 0, sizeof(m_devAddr));
+                        m_devAddr.adapter = OC_ADAPTER_IP;
+                        strcpy(m_devAddr.addr, "192.168.1.2");
+                        m_devAddr.port = 5683;
+                    }
+
+                    std::shared_ptr<IClientWrapper> m_clientWrapper;
+                    OCDevAddr m_devAddr;
+            };
+
+            TEST_F(ResourceCacheTest, InternSharesEqualStrings)
+            {
+                ResourceCache cache(false);
+                ResourcePayload light("/a/light", "core.light");
+                ResourcePayload fan("/a/fan", "core.light");
+
+                EXPECT_EQ(cache.intern(SID), cache.intern(SID));
+                EXPECT_EQ(cache.intern(light.get()->types), cache.intern(fan.get()->types));
+                EXPECT_EQ("core.light", cache.intern(light.get()->types)->front());
+                EXPECT_NE(cache.intern(light.get()->types), cache.intern(light.get()->interfaces));
+            }
+
+            TEST_F(ResourceCacheTest, NewResourceWithoutReuse)
+            {
+                ResourceCache cache(false);
+                ResourcePayload light("/a/light", "core.light");
+
+                auto first = cache.resource(m_clientWrapper, m_devAddr, SID, light.get());
+                auto second = cache.resource(m_clientWrapper, m_devAddr, SID, light.get());
+                EXPECT_NE(first, second);
+                EXPECT_TRUE(*first == *second);
+            }
+
+            TEST_F(ResourceCacheTest, ReusesUnchangedResource)
+            {
+                ResourceCache cache(true);
+                ResourcePayload light("/a/light", "core.light");
+                ResourcePayload fan("/a/fan", "core.fan");
+
+                auto first = cache.resource(m_clientWrapper, m_devAddr, SID, light.get());
+                EXPECT_EQ(first, cache.resource(m_clientWrapper, m_devAddr, SID, light.get()));
+                EXPECT_NE(first, cache.resource(m_clientWrapper, m_devAddr, SID, fan.get()));
+
+                m_devAddr.port = 5684;
+                EXPECT_NE(first, cache.resource(m_clientWrapper, m_devAddr, SID, light.get()));
+            }
+
+            TEST_F(ResourceCacheTest, ReplacesChangedResource)
+            {
+                ResourceCache cache(true);
+                ResourcePayload light("/a/light", "core.light");
+                ResourcePayload dimmer("/a/light", "core.dimmer");
+
+                auto first = cache.resource(m_clientWrapper, m_devAddr, SID, light.get());
+                auto changed = cache.resource(m_clientWrapper, m_devAddr, SID, dimmer.get());
+                EXPECT_NE(first, changed);
+                EXPECT_EQ(std::vector<std::string>{"core.dimmer"}, changed->getResourceTypes());
+                EXPECT_EQ(std::vector<std::string>{"core.light"}, first->getResourceTypes());
+                EXPECT_EQ(changed, cache.resource(m_clientWrapper, m_devAddr, SID, dimmer.get()));
+            }
+
+            TEST_F(ResourceCacheTest, DropsReleasedResource)
+            {
+                ResourceCache cache(true);
+                ResourcePayload light("/a/light", "core.light");
+
+                auto first = cache.resource(m_clientWrapper, m_devAddr, SID, light.get());
+                std::weak_ptr<OCResource> released = first;
+                first.reset();
+                EXPECT_TRUE(released.expired());
+
+                auto second = cache.resource(m_clientWrapper, m_devAddr, SID, light.get());
+                EXPECT_EQ("/a/light", second->uri());
+            }
+
+            TEST_F(ResourceCacheTest, ThrowsForMissingType)
+            {
+                ResourceCache cache(true);
+                ResourcePayload light("/a/light", "core.light");
+                OCResourcePayload untyped = *light.get();
+                untyped.types = nullptr;
+
+                EXPECT_THROW(cache.resource(m_clientWrapper, m_devAddr, SID, &untyped),
+                             ResourceInitException);
+            }
+        }
+    }
+}